@@ -0,0 +1,443 @@
+// LibrifyBench.cpp
+//
+// Micro/macro benchmarks for the library hot paths: scanning, tag reading,
+// applying scan results, sorting, track updates, playlists and view loads.
+// Runs against a synthetic library (see SyntheticLibrary.h) or a real folder
+// and prints a table plus, with --output, a JSON report for CI comparisons.
+// Before timing anything it checks XxHash64 against reference vectors and
+// exits with 1 if they disagree.
+//
+//   librify_bench --tracks 20000 --artists 800 --cover-size 600 --output bench.json
+//   librify_bench --library ~/Music --iterations 3 --only "scan|sort"
+
+#include "LibraryScanner.h"
+#include "LocalMusicManager.h"
+#include "PlaylistManager.h"
+#include "SyntheticLibrary.h"
+#include "Trace.h"
+#include "TrackListModel.h"
+#include "XxHash64.h"
+
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+namespace {
+constexpr int SampleLimit = 500; // per-call benchmarks (updateTrack, playlists) use at most this many tracks
+const QString BenchPlaylist = QStringLiteral("librify_bench");
+
+struct Stats {
+    double minMs = 0, medianMs = 0, meanMs = 0, maxMs = 0;
+};
+
+//=============================================================================
+// HELPER: XXH64 against the reference implementation (python-xxhash 4.0)
+//=============================================================================
+// Byte i of the generated inputs is (i * 7 + 3) & 0xFF
+bool checkXxHash64(QTextStream &err) {
+    struct Vector {
+        QByteArray data;
+        uint64_t seed;
+        uint64_t expected;
+    };
+    const auto generated = [](int length) {
+        QByteArray data(length, Qt::Uninitialized);
+        for (int i = 0; i < length; ++i) data[i] = char((i * 7 + 3) & 0xFF);
+        return data;
+    };
+    const QByteArray fox = "The quick brown fox jumps over the lazy dog";
+    const Vector vectors[] = {
+        {QByteArray(), 0, 0xEF46DB3751D8E999ULL},
+        {QByteArray(), 0x9E3779B185EBCA87ULL, 0x6EC6D05F61C7E7A7ULL},
+        {"a", 0, 0xD24EC4F1A98C6E5BULL},
+        {"abc", 0, 0x44BC2CF5AD770999ULL},
+        {fox, 0, 0x0B242D361FDA71BCULL},           // 43 bytes: one stripe plus tail
+        {fox, 1, 0xDF5091B6DAD2C6DBULL},
+        {generated(100), 0, 0xA61F8D4C170FE531ULL},
+        {generated(100), 2654435761ULL, 0x86F549EDE5AC87E2ULL},
+        {generated(1031), 0, 0x94031867D2B2C622ULL},
+    };
+    bool ok = true;
+    for (const Vector &vector : vectors) {
+        const uint64_t oneShot = XxHash64::hash(vector.data.constData(), size_t(vector.data.size()), vector.seed);
+        // The same bytes in 13-byte pieces, so updates straddle the 32-byte stripes
+        XxHash64 streaming(vector.seed);
+        for (qsizetype offset = 0; offset < vector.data.size(); offset += 13) {
+            streaming.update(vector.data.constData() + offset, size_t(qMin<qsizetype>(13, vector.data.size() - offset)));
+        }
+        if (oneShot == vector.expected && streaming.digest() == vector.expected) continue;
+        err << "XXH64 of " << vector.data.size() << " bytes, seed " << vector.seed << ": expected "
+            << QString::number(vector.expected, 16) << ", got " << QString::number(oneShot, 16) << " / "
+            << QString::number(streaming.digest(), 16) << " (streaming)" << Qt::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+Stats summarize(QList<double> samples) {
+    Stats stats;
+    if (samples.isEmpty()) return stats;
+    std::sort(samples.begin(), samples.end());
+    const qsizetype n = samples.size();
+    stats.minMs = samples.first();
+    stats.maxMs = samples.last();
+    stats.medianMs = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    for (double sample : samples) stats.meanMs += sample;
+    stats.meanMs /= n;
+    return stats;
+}
+}
+
+/**
+ * @brief Drives LocalMusicManager/TrackListModel/PlaylistManager directly,
+ * including private members (it is a friend of the first two), without an
+ * event loop so only the measured code runs between timestamps.
+ */
+class LibrifyBench {
+public:
+    struct Options {
+        QString libraryPath;
+        int iterations = 5;
+        int warmup = 1;
+        QRegularExpression only;
+    };
+
+    explicit LibrifyBench(const Options &options) : m_options(options) {}
+
+    void run();
+    QJsonArray results() const { return m_results; }
+    int fileCount() const { return m_files.size(); }
+
+private:
+    using Step = std::function<void()>;
+    // setup/teardown run outside the timed region of each iteration
+    void measure(const QString &name, qint64 items, const Step &body, const Step &setup = {}, const Step &teardown = {});
+
+    void benchScanning();
+    void benchApplyResults();
+    void benchSorting();
+    void benchPlaylists();
+    void benchLoadTracks();
+
+    Options m_options;
+    LocalMusicManager m_manager;
+    TrackListModel m_model;
+    PlaylistManager m_playlists;
+    QStringList m_files;
+    LocalMusicManager::ScanResults m_scanResults;
+    QJsonArray m_results;
+};
+
+void LibrifyBench::measure(const QString &name, qint64 items, const Step &body, const Step &setup, const Step &teardown) {
+    if (!m_options.only.pattern().isEmpty() && !m_options.only.match(name).hasMatch()) return;
+
+    QList<double> samples;
+    for (int i = 0; i < m_options.warmup + m_options.iterations; ++i) {
+        if (setup) setup();
+        QElapsedTimer timer;
+        timer.start();
+        body();
+        const double ms = timer.nsecsElapsed() / 1e6;
+        if (teardown) teardown();
+        if (i >= m_options.warmup) samples.append(ms);
+    }
+
+    const Stats stats = summarize(samples);
+    const double itemsPerSecond = stats.medianMs > 0 ? items * 1000.0 / stats.medianMs : 0;
+    m_results.append(QJsonObject{{"name", name},
+                                 {"iterations", m_options.iterations},
+                                 {"items", items},
+                                 {"minMs", stats.minMs},
+                                 {"medianMs", stats.medianMs},
+                                 {"meanMs", stats.meanMs},
+                                 {"maxMs", stats.maxMs},
+                                 {"itemsPerSecond", itemsPerSecond}});
+    QTextStream(stdout) << QString("%1 %2 %3 %4 %5 %6\n")
+                               .arg(name, -40)
+                               .arg(items, 8)
+                               .arg(stats.minMs, 10, 'f', 2)
+                               .arg(stats.medianMs, 10, 'f', 2)
+                               .arg(stats.maxMs, 10, 'f', 2)
+                               .arg(itemsPerSecond, 12, 'f', 0);
+}
+
+void LibrifyBench::run() {
+    QTextStream(stdout) << QString("%1 %2 %3 %4 %5 %6\n")
+                               .arg("benchmark", -40).arg("items", 8).arg("min ms", 10)
+                               .arg("median ms", 10).arg("max ms", 10).arg("items/s", 12);
+    benchScanning();
+    benchApplyResults();
+    benchSorting();
+    benchPlaylists();
+    benchLoadTracks();
+}
+
+//=============================================================================
+// FUNCTION: Directory walk, tag reading, background scan (cold and warm index)
+//=============================================================================
+void LibrifyBench::benchScanning() {
+    const QString root = m_options.libraryPath;
+    LibraryScanner::recursiveScan(root, m_files);
+
+    measure("recursiveScan", m_files.size(), [&]() {
+        QStringList files;
+        LibraryScanner::recursiveScan(root, files);
+    });
+
+    const QStringList sample = m_files.mid(0, SampleLimit * 4);
+    measure("readId3Tags", sample.size(), [&]() {
+        for (const QString &filePath : sample) m_manager.readId3Tags(filePath);
+    });
+
+    // Cold: every file is read with TagLib; warm: unchanged files come from the index
+    measure("performBackgroundScan/cold", m_files.size(),
+            [&]() { m_scanResults = m_manager.performBackgroundScan({root}); },
+            [&]() { m_manager.m_libraryIndex.clear(); });
+    measure("performBackgroundScan/warm", m_files.size(),
+            [&]() { m_scanResults = m_manager.performBackgroundScan({root}); });
+    if (m_scanResults.cachedTracks.isEmpty()) m_scanResults = m_manager.performBackgroundScan({root});
+}
+
+//=============================================================================
+// FUNCTION: Applying scan results on the GUI thread
+//=============================================================================
+void LibrifyBench::benchApplyResults() {
+    const LocalMusicManager::ScanResults results = m_scanResults;
+    const auto install = [&]() {
+        m_manager.m_scanWatcher.setFuture(QtConcurrent::run([results]() { return results; }));
+        m_manager.m_scanWatcher.waitForFinished();
+    };
+    // Tempo and duplicate work started by the slot belongs to the background, not the slot
+    const auto settle = [&]() {
+        m_manager.m_tempoAnalyzer.analyze({});
+        m_manager.m_duplicateWatcher.waitForFinished();
+    };
+    measure("handleScanFinished", results.cachedTracks.size(), [&]() { m_manager.handleScanFinished(); }, install, settle);
+    if (m_manager.m_cachedFullTrackData.isEmpty() && !results.cachedTracks.isEmpty()) { // skipped by --only
+        install();
+        m_manager.handleScanFinished();
+        settle();
+    }
+}
+
+//=============================================================================
+// FUNCTION: TrackListModel sorting and single-track updates
+//=============================================================================
+void LibrifyBench::benchSorting() {
+    QVariantList tracks;
+    tracks.reserve(m_manager.m_cachedFullTrackData.size());
+    for (const QVariantMap &track : std::as_const(m_manager.m_cachedFullTrackData)) tracks.append(track);
+
+    const QList<QPair<QString, TrackListModel::SortColumn>> columns = {
+        {"Title", TrackListModel::Title},
+        {"ArtistAlbum", TrackListModel::ArtistAlbum},
+        {"Album", TrackListModel::Album},
+        {"Bpm", TrackListModel::Bpm},
+    };
+    QRandomGenerator random(1); // same shuffles on every run
+    for (const auto &[label, column] : columns) {
+        measure("TrackListModel::applySort/" + label, tracks.size(), [&]() { m_model.applySort(); }, [&, column = column]() {
+            QVariantList shuffled = tracks;
+            std::shuffle(shuffled.begin(), shuffled.end(), random);
+            m_model.m_tracks = shuffled;
+            m_model.m_sortColumn = column;
+            m_model.m_sortOrder = Qt::AscendingOrder;
+        });
+    }
+
+    m_model.m_sortColumn = TrackListModel::ArtistAlbum;
+    m_model.m_tracks = tracks;
+    m_model.applySort();
+    const int count = qMin<int>(SampleLimit, tracks.size());
+    measure("TrackListModel::updateTrack", count, [&]() {
+        for (int i = 0; i < count; ++i) {
+            QVariantMap track = tracks.at(i).toMap();
+            track["title"] = track.value("title").toString() + " (edit)";
+            m_model.updateTrack(track);
+        }
+    });
+}
+
+//=============================================================================
+// FUNCTION: Playlist add/remove round trips (JSON rewritten on every change)
+//=============================================================================
+void LibrifyBench::benchPlaylists() {
+    const QStringList paths = m_files.mid(0, SampleLimit);
+    const auto recreate = [&]() {
+        m_playlists.deletePlaylist(BenchPlaylist);
+        m_playlists.createPlaylist(BenchPlaylist, QString());
+    };
+    const auto fill = [&]() {
+        recreate();
+        for (const QString &path : paths) m_playlists.addTrack(BenchPlaylist, path);
+    };
+    measure("PlaylistManager::addTrack", paths.size(), [&]() {
+        for (const QString &path : paths) m_playlists.addTrack(BenchPlaylist, path);
+    }, recreate);
+    measure("PlaylistManager::removeTrack", paths.size(), [&]() {
+        for (const QString &path : paths) m_playlists.removeTrack(BenchPlaylist, path);
+    }, fill);
+    fill(); // left in place for loadTracksFor/local_playlist
+}
+
+//=============================================================================
+// FUNCTION: View loads for each sidebar grouping
+//=============================================================================
+void LibrifyBench::benchLoadTracks() {
+    qsizetype emitted = 0;
+    QObject::connect(&m_manager, &LocalMusicManager::tracksReadyForDisplay, &m_manager,
+                     [&emitted](const QVariantList &tracks) { emitted = tracks.size(); });
+
+    // Largest artist/album so the loads are not trivially small
+    QString topArtist, topAlbum;
+    for (const QString &artist : m_manager.m_artistIndexHash.uniqueKeys()) {
+        if (topArtist.isEmpty() || m_manager.m_artistIndexHash.count(artist) > m_manager.m_artistIndexHash.count(topArtist)) topArtist = artist;
+    }
+    for (const QString &album : m_manager.m_albumIndexHash.uniqueKeys()) {
+        if (topAlbum.isEmpty() || m_manager.m_albumIndexHash.count(album) > m_manager.m_albumIndexHash.count(topAlbum)) topAlbum = album;
+    }
+
+    const QList<QPair<QString, QString>> loads = {
+        {ALL_TRACKS_IDENTIFIER, "local_all"},
+        {topArtist, "local_artist"},
+        {topAlbum, "local_album"},
+        {DUPLICATES_IDENTIFIER, "local_duplicates"},
+        {BenchPlaylist, "local_playlist"},
+    };
+    for (const auto &[identifier, type] : loads) {
+        m_manager.loadTracksFor(identifier, type); // item count for the report
+        measure("loadTracksFor/" + type, emitted, [&, identifier = identifier, type = type]() {
+            m_manager.loadTracksFor(identifier, type);
+        });
+    }
+    m_playlists.deletePlaylist(BenchPlaylist);
+}
+
+//=============================================================================
+// FUNCTION: Entry point
+//=============================================================================
+int main(int argc, char *argv[]) {
+    // QImage/QPainter for cover generation need a GUI application, not a screen
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("Librify");
+    QCoreApplication::setApplicationName("librify_bench");
+    // Caches, index and playlists go to a test location, never the user's library data
+    QStandardPaths::setTestModeEnabled(true);
+    Trace::installFromEnvironment(); // LIBRIFY_TRACE=<file> records every benchmark iteration
+
+    const SyntheticLibraryConfig defaults;
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks Librify's library scan, sort and playlist paths.");
+    parser.addHelpOption();
+    QCommandLineOption libraryOption("library", "Benchmark an existing folder instead of generating one.", "dir");
+    QCommandLineOption generateOption("generate-into", "Generate the synthetic library here (kept afterwards).", "dir");
+    QCommandLineOption generateOnlyOption("generate-only", "Generate the library and exit.");
+    QCommandLineOption tracksOption("tracks", "Synthetic track count.", "n", QString::number(defaults.tracks));
+    QCommandLineOption artistsOption("artists", "Synthetic artist count.", "n", QString::number(defaults.artists));
+    QCommandLineOption albumsOption("albums-per-artist", "Albums per artist.", "n", QString::number(defaults.albumsPerArtist));
+    QCommandLineOption skewOption("artist-skew", "Zipf exponent of tracks per artist (0 = uniform).", "s", QString::number(defaults.artistSkew));
+    QCommandLineOption featuringOption("featuring-ratio", "Share of tracks with a featured artist.", "r", QString::number(defaults.featuringRatio));
+    QCommandLineOption coverOption("cover-size", "Embedded cover edge in px (0 = none).", "px", QString::number(defaults.coverSize));
+    QCommandLineOption depthOption("depth", "Directory depth below the root.", "n", QString::number(defaults.directoryDepth));
+    QCommandLineOption durationOption("duration", "Audio length per file in seconds.", "s", QString::number(defaults.durationSeconds));
+    QCommandLineOption seedOption("seed", "Generator seed.", "n", QString::number(defaults.seed));
+    QCommandLineOption iterationsOption("iterations", "Timed iterations per benchmark.", "n", "5");
+    QCommandLineOption warmupOption("warmup", "Untimed iterations per benchmark.", "n", "1");
+    QCommandLineOption onlyOption("only", "Run benchmarks whose name matches this regex.", "regex");
+    QCommandLineOption outputOption("output", "Write results as JSON to this file ('-' for stdout).", "file");
+    QCommandLineOption verboseOption("verbose", "Keep debug logging (slows the measured code).");
+    parser.addOptions({libraryOption, generateOption, generateOnlyOption, tracksOption, artistsOption, albumsOption,
+                       skewOption, featuringOption, coverOption, depthOption, durationOption, seedOption,
+                       iterationsOption, warmupOption, onlyOption, outputOption, verboseOption});
+    parser.process(app);
+
+    if (!parser.isSet(verboseOption)) QLoggingCategory::setFilterRules("*.debug=false");
+
+    SyntheticLibraryConfig config;
+    config.tracks = parser.value(tracksOption).toInt();
+    config.artists = parser.value(artistsOption).toInt();
+    config.albumsPerArtist = parser.value(albumsOption).toInt();
+    config.artistSkew = parser.value(skewOption).toDouble();
+    config.featuringRatio = parser.value(featuringOption).toDouble();
+    config.coverSize = parser.value(coverOption).toInt();
+    config.directoryDepth = parser.value(depthOption).toInt();
+    config.durationSeconds = parser.value(durationOption).toInt();
+    config.seed = parser.value(seedOption).toUInt();
+
+    QTextStream err(stderr);
+    // Duplicate detection and the index trust these hashes; no point timing a wrong one
+    if (!checkXxHash64(err)) return 1;
+
+    std::unique_ptr<QTemporaryDir> temporaryDir;
+    LibrifyBench::Options options;
+    options.iterations = qMax(1, parser.value(iterationsOption).toInt());
+    options.warmup = qMax(0, parser.value(warmupOption).toInt());
+    options.only = QRegularExpression(parser.value(onlyOption));
+
+    const bool generated = !parser.isSet(libraryOption);
+    if (generated) {
+        if (parser.isSet(generateOption)) {
+            options.libraryPath = QDir(parser.value(generateOption)).absolutePath();
+        } else {
+            temporaryDir = std::make_unique<QTemporaryDir>();
+            options.libraryPath = temporaryDir->path();
+        }
+        QElapsedTimer timer;
+        timer.start();
+        QString error;
+        if (SyntheticLibrary::generate(options.libraryPath, config, &error) < 0) {
+            err << "Generating the library failed: " << error << Qt::endl;
+            return 1;
+        }
+        err << "Generated " << config.tracks << " files in " << options.libraryPath << " ("
+            << timer.elapsed() << " ms)" << Qt::endl;
+        if (parser.isSet(generateOnlyOption)) return 0;
+    } else {
+        options.libraryPath = QDir(parser.value(libraryOption)).absolutePath();
+    }
+
+    LibrifyBench bench(options);
+    bench.run();
+
+    if (parser.isSet(outputOption)) {
+        QJsonObject report{{"benchmark", "librify_bench"},
+                           {"timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+                           {"qtVersion", qVersion()},
+                           {"cpu", QSysInfo::currentCpuArchitecture()},
+                           {"os", QSysInfo::prettyProductName()},
+                           {"idealThreadCount", QThread::idealThreadCount()},
+                           {"library", generated ? QJsonValue(QJsonObject::fromVariantMap(config.toVariantMap()))
+                                                 : QJsonValue(options.libraryPath)},
+                           {"files", bench.fileCount()},
+                           {"results", bench.results()}};
+        const QByteArray json = QJsonDocument(report).toJson();
+        if (parser.value(outputOption) == "-") {
+            QTextStream(stdout) << json;
+        } else {
+            QFile file(parser.value(outputOption));
+            if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+                err << "Cannot write " << file.fileName() << Qt::endl;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,408 @@
+// SchedulerHarness.cpp
+//
+// Deterministic checks of SpotifyRequestScheduler, and of SpotifyPager on
+// top of it, against a local HTTP stub (QTcpServer on 127.0.0.1) that
+// answers from a per-path script: 5xx, 429 with Retry-After, delayed
+// responses and fake paged JSON. With the RNG seeded, every backoff delay
+// is known in advance, so the checks assert the actual retry timing instead
+// of a range. Prints PASS/FAIL per check and exits with 1 on any failure.
+//
+//   librify_schedbench --seed 42
+
+#include "SpotifyPager.h"
+#include "SpotifyRequestScheduler.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QTimer>
+#include <functional>
+
+namespace {
+constexpr int TimerSlackMs = 5;     // QTimer firing early
+constexpr int ResponseSlackMs = 250; // loopback round trip and event loop latency on a busy CI machine
+constexpr int CheckTimeoutMs = 15000;
+
+//=============================================================================
+// HELPER: HTTP stub answering one request per connection from a script
+//=============================================================================
+class StubServer
+{
+public:
+    struct Reply {
+        int status = 200;
+        QByteArray body;
+        QByteArray headers; // extra "Name: value\r\n" lines
+        int delayMs = 0;
+    };
+
+    explicit StubServer(const QElapsedTimer &clock) : m_clock(clock) {
+        QObject::connect(&m_server, &QTcpServer::newConnection, &m_server, [this]() {
+            while (QTcpSocket *socket = m_server.nextPendingConnection()) accept(socket);
+        });
+    }
+
+    bool listen() { return m_server.listen(QHostAddress::LocalHost); }
+    QUrl url(const QString &path) const {
+        return QUrl(QStringLiteral("http://127.0.0.1:%1%2").arg(m_server.serverPort()).arg(path));
+    }
+
+    // Replies in order; the last one repeats
+    void script(const QByteArray &path, const QList<Reply> &replies) { m_scripts.insert(path, replies); }
+    // Arrival times of the requests for path, on the shared clock
+    QList<qint64> hits(const QByteArray &path) const { return m_hits.value(path); }
+    // Paths in the order their responses went out
+    QList<QByteArray> answered() const { return m_answered; }
+    // Most requests received but not yet answered at any one time
+    int maxOpen() const { return m_maxOpen; }
+
+private:
+    void accept(QTcpSocket *socket) {
+        auto *buffer = new QByteArray;
+        QObject::connect(socket, &QObject::destroyed, [buffer]() { delete buffer; });
+        QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket, buffer]() {
+            buffer->append(socket->readAll());
+            const qsizetype end = buffer->indexOf("\r\n\r\n");
+            if (end < 0) return;
+            // "GET /path HTTP/1.1"; GETs carry no body
+            const QList<QByteArray> requestLine = buffer->left(buffer->indexOf("\r\n")).split(' ');
+            buffer->clear();
+            respond(socket, requestLine.value(1));
+        });
+    }
+
+    void respond(QTcpSocket *socket, const QByteArray &path) {
+        QList<qint64> &hits = m_hits[path];
+        hits.append(m_clock.elapsed());
+        const QList<Reply> script = m_scripts.value(path, {Reply{404}});
+        const Reply reply = script.value(qMin(hits.size(), script.size()) - 1);
+        QByteArray response = "HTTP/1.1 " + QByteArray::number(reply.status) + " Stub\r\n"
+                              "Content-Type: application/json\r\n"
+                              "Content-Length: " + QByteArray::number(reply.body.size()) + "\r\n"
+                              "Connection: close\r\n" + reply.headers + "\r\n" + reply.body;
+        m_maxOpen = qMax(m_maxOpen, ++m_open);
+        QTimer::singleShot(reply.delayMs, socket, [this, socket, path, response]() {
+            --m_open;
+            m_answered.append(path);
+            socket->write(response);
+            socket->disconnectFromHost();
+        });
+    }
+
+    const QElapsedTimer &m_clock;
+    QTcpServer m_server;
+    QHash<QByteArray, QList<Reply>> m_scripts;
+    QHash<QByteArray, QList<qint64>> m_hits;
+    QList<QByteArray> m_answered;
+    int m_open = 0;
+    int m_maxOpen = 0;
+};
+
+struct Outcome {
+    bool finished = false;
+    int status = 0;
+    QByteArray body;
+};
+
+void track(SpotifyResponse *response, Outcome *outcome) {
+    QObject::connect(response, &SpotifyResponse::finished, response, [response, outcome]() {
+        outcome->finished = true;
+        outcome->status = response->statusCode();
+        outcome->body = response->body();
+    });
+}
+
+bool waitUntil(const std::function<bool()> &done, int timeoutMs = CheckTimeoutMs) {
+    QElapsedTimer timer;
+    timer.start();
+    QEventLoop loop;
+    QTimer poll;
+    poll.setInterval(5);
+    QObject::connect(&poll, &QTimer::timeout, &loop, [&]() {
+        if (done() || timer.elapsed() > timeoutMs) loop.quit();
+    });
+    poll.start();
+    loop.exec();
+    return done();
+}
+
+// Token bucket out of the way: these checks are about retries, not pacing
+SpotifyRequestScheduler::Config harnessConfig() {
+    SpotifyRequestScheduler::Config config;
+    config.tokensPerSecond = 1000.0;
+    config.burst = 100;
+    config.baseBackoffMs = 200;
+    config.maxBackoffMs = 1000;
+    config.maxRetries = 2;
+    return config;
+}
+
+// Mirrors SpotifyRequestScheduler::backoffDelayMs on an identically seeded generator
+QList<int> expectedBackoffs(quint32 seed, const SpotifyRequestScheduler::Config &config, int attempts) {
+    QRandomGenerator random(seed);
+    QList<int> delays;
+    for (int attempt = 1; attempt <= attempts; ++attempt) {
+        const qint64 ceiling = qMin<qint64>(config.maxBackoffMs, qint64(config.baseBackoffMs) << (attempt - 1));
+        const qint64 half = ceiling / 2;
+        delays.append(int(half + random.bounded(half + 1)));
+    }
+    return delays;
+}
+
+//=============================================================================
+// CHECKS: each returns an empty string on success, the reason otherwise
+//=============================================================================
+// 5xx twice, then 200: two retries exactly the seeded backoff apart; a path that
+// keeps failing gets maxRetries retries and then its 5xx is delivered
+QString checkBackoff(quint32 seed, const QElapsedTimer &clock) {
+    StubServer server(clock);
+    if (!server.listen()) return "stub server did not start";
+    server.script("/flaky", {{503}, {503}, {200, "\"flaky\""}});
+    server.script("/down", {{500}});
+
+    QNetworkAccessManager manager;
+    manager.setProxy(QNetworkProxy::NoProxy); // the stub is local whatever http_proxy says
+    SpotifyRequestScheduler scheduler(&manager);
+    const SpotifyRequestScheduler::Config config = harnessConfig();
+    scheduler.setConfig(config);
+    scheduler.setRandomSeed(seed);
+
+    Outcome flaky;
+    track(scheduler.get(QNetworkRequest(server.url("/flaky"))), &flaky);
+    if (!waitUntil([&]() { return flaky.finished; })) return "/flaky never finished";
+    if (flaky.status != 200 || flaky.body != "\"flaky\"") return QString("/flaky ended with %1").arg(flaky.status);
+    const QList<qint64> hits = server.hits("/flaky");
+    if (hits.size() != 3) return QString("/flaky was requested %1 times, expected 3").arg(hits.size());
+
+    const QList<int> delays = expectedBackoffs(seed, config, 2);
+    for (int i = 0; i < delays.size(); ++i) {
+        const qint64 gap = hits[i + 1] - hits[i];
+        if (gap < delays[i] - TimerSlackMs || gap > delays[i] + ResponseSlackMs) {
+            return QString("retry %1 came after %2 ms, backoff was %3 ms").arg(i + 1).arg(gap).arg(delays[i]);
+        }
+    }
+
+    Outcome down;
+    track(scheduler.get(QNetworkRequest(server.url("/down"))), &down);
+    if (!waitUntil([&]() { return down.finished; })) return "/down never finished";
+    if (down.status != 500) return QString("/down ended with %1, expected its 500").arg(down.status);
+    const int downHits = server.hits("/down").size();
+    if (downHits != 1 + config.maxRetries) {
+        return QString("/down was requested %1 times, expected %2").arg(downHits).arg(1 + config.maxRetries);
+    }
+    return QString();
+}
+
+// 429 with Retry-After: 1 pauses everything: the limited request and one made
+// while paused both wait out the second, the limited one goes first
+QString checkRateLimitPause(const QElapsedTimer &clock) {
+    StubServer server(clock);
+    if (!server.listen()) return "stub server did not start";
+    server.script("/limited", {{429, QByteArray(), "Retry-After: 1\r\n"}, {200, "\"limited\""}});
+    server.script("/other", {{200, "\"other\""}});
+
+    QNetworkAccessManager manager;
+    manager.setProxy(QNetworkProxy::NoProxy); // the stub is local whatever http_proxy says
+    SpotifyRequestScheduler scheduler(&manager);
+    scheduler.setConfig(harnessConfig());
+
+    Outcome limited, other;
+    int retryAfterMs = -1;
+    qint64 limitedAtMs = -1;
+    QObject::connect(&scheduler, &SpotifyRequestScheduler::rateLimited, &scheduler, [&](int ms) {
+        retryAfterMs = ms;
+        limitedAtMs = clock.elapsed();
+        track(scheduler.get(QNetworkRequest(server.url("/other"))), &other);
+    });
+    track(scheduler.get(QNetworkRequest(server.url("/limited"))), &limited);
+    if (!waitUntil([&]() { return limited.finished && other.finished; })) return "requests never finished";
+
+    if (retryAfterMs != 1000) return QString("rateLimited reported %1 ms, expected 1000").arg(retryAfterMs);
+    if (limited.status != 200 || other.status != 200) {
+        return QString("ended with %1 / %2").arg(limited.status).arg(other.status);
+    }
+    const QList<qint64> limitedHits = server.hits("/limited");
+    const QList<qint64> otherHits = server.hits("/other");
+    if (limitedHits.size() != 2 || otherHits.size() != 1) {
+        return QString("requested %1 / %2 times, expected 2 / 1").arg(limitedHits.size()).arg(otherHits.size());
+    }
+    if (limitedHits[1] - limitedAtMs < 1000 - TimerSlackMs) {
+        return QString("limited request retried %1 ms into a 1000 ms pause").arg(limitedHits[1] - limitedAtMs);
+    }
+    if (otherHits[0] - limitedAtMs < 1000 - TimerSlackMs) {
+        return QString("request made while paused went out after %1 ms").arg(otherHits[0] - limitedAtMs);
+    }
+    if (otherHits[0] < limitedHits[1]) return "request made while paused went before the limited one";
+    return QString();
+}
+
+// Identical GETs share one request, whether queued together or joining one in
+// flight; once it completed, the same GET is a new request
+QString checkCoalescing(const QElapsedTimer &clock) {
+    StubServer server(clock);
+    if (!server.listen()) return "stub server did not start";
+    server.script("/slow", {{200, "\"slow\"", QByteArray(), 300}});
+
+    QNetworkAccessManager manager;
+    manager.setProxy(QNetworkProxy::NoProxy); // the stub is local whatever http_proxy says
+    SpotifyRequestScheduler scheduler(&manager);
+    scheduler.setConfig(harnessConfig());
+
+    const QNetworkRequest request(server.url("/slow"));
+    Outcome outcomes[4];
+    track(scheduler.get(request), &outcomes[0]);
+    track(scheduler.get(request, SpotifyRequestScheduler::Background), &outcomes[1]);
+    if (!waitUntil([&]() { return server.hits("/slow").size() == 1; })) return "/slow was never requested";
+    track(scheduler.get(request), &outcomes[2]);
+    if (!waitUntil([&]() { return outcomes[0].finished && outcomes[1].finished && outcomes[2].finished; })) {
+        return "coalesced requests never finished";
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (outcomes[i].status != 200 || outcomes[i].body != "\"slow\"") {
+            return QString("waiter %1 got %2").arg(i).arg(outcomes[i].status);
+        }
+    }
+    if (server.hits("/slow").size() != 1) {
+        return QString("/slow was requested %1 times for three waiters").arg(server.hits("/slow").size());
+    }
+
+    track(scheduler.get(request), &outcomes[3]);
+    if (!waitUntil([&]() { return outcomes[3].finished; })) return "request after completion never finished";
+    if (server.hits("/slow").size() != 2) return "request after completion was served from the finished one";
+    return QString();
+}
+
+// Paging object with tracks t<offset>.. of a playlist of total tracks
+QByteArray trackPage(int offset, int limit, int total) {
+    QByteArray items;
+    for (int i = offset; i < qMin(offset + limit, total); ++i) {
+        if (!items.isEmpty()) items += ',';
+        items += "{\"track\":{\"id\":\"t" + QByteArray::number(i) + "\",\"name\":\"Track " + QByteArray::number(i) + "\"}}";
+    }
+    return "{\"items\":[" + items + "],\"limit\":" + QByteArray::number(limit) + ",\"offset\":"
+           + QByteArray::number(offset) + ",\"total\":" + QByteArray::number(total) + '}';
+}
+
+// 10 tracks in pages of 2, the first URL without offset/limit: the pager learns
+// total and limit from page 0, then requests offsets 2..8 at most two at a time.
+// Later pages answer first and offset 8 fails with a 503 once, yet items come
+// out contiguous and in playlist order.
+QString checkPager(quint32 seed, const QElapsedTimer &clock) {
+    constexpr int Total = 10;
+    constexpr int Limit = 2;
+    constexpr int MaxConcurrent = 2;
+    const QByteArray firstPath = "/v1/playlists/p/tracks";
+    const auto pagePath = [&](int offset) {
+        return firstPath + "?offset=" + QByteArray::number(offset) + "&limit=" + QByteArray::number(Limit);
+    };
+
+    StubServer server(clock);
+    if (!server.listen()) return "stub server did not start";
+    server.script(firstPath, {{200, trackPage(0, Limit, Total)}});
+    server.script(pagePath(2), {{200, trackPage(2, Limit, Total), QByteArray(), 400}});
+    server.script(pagePath(4), {{200, trackPage(4, Limit, Total), QByteArray(), 50}});
+    server.script(pagePath(6), {{200, trackPage(6, Limit, Total), QByteArray(), 150}});
+    server.script(pagePath(8), {{503}, {200, trackPage(8, Limit, Total)}});
+
+    QNetworkAccessManager manager;
+    manager.setProxy(QNetworkProxy::NoProxy); // the stub is local whatever http_proxy says
+    SpotifyRequestScheduler scheduler(&manager);
+    scheduler.setConfig(harnessConfig());
+    scheduler.setRandomSeed(seed);
+    SpotifyPager pager(&scheduler);
+    pager.setMaxConcurrentRequests(MaxConcurrent);
+
+    QStringList ids;
+    QString orderError;
+    int batches = 0;
+    int finishedTotal = -1;
+    QString failure;
+    QObject::connect(&pager, &SpotifyPager::itemsReady, &pager, [&](const QVariantList &items, int firstIndex) {
+        if (firstIndex != ids.size() && orderError.isEmpty()) {
+            orderError = QString("itemsReady at %1 after %2 items").arg(firstIndex).arg(ids.size());
+        }
+        for (const QVariant &item : items) ids.append(item.toMap().value("spotifyId").toString());
+        ++batches;
+    });
+    QObject::connect(&pager, &SpotifyPager::finished, &pager, [&](int total) { finishedTotal = total; });
+    QObject::connect(&pager, &SpotifyPager::failed, &pager, [&](const QString &error) { failure = error; });
+    pager.start(server.url(QString::fromLatin1(firstPath)));
+    if (!waitUntil([&]() { return finishedTotal >= 0 || !failure.isEmpty(); })) return "pager never finished";
+
+    if (!failure.isEmpty()) return "pager failed: " + failure;
+    if (!orderError.isEmpty()) return orderError;
+    QStringList expected;
+    for (int i = 0; i < Total; ++i) expected << QString("t%1").arg(i);
+    if (ids != expected) return "items out of order: " + ids.join(',');
+    if (finishedTotal != Total) return QString("finished with %1 items, expected %2").arg(finishedTotal).arg(Total);
+
+    // Discovery: exactly the pages total and limit call for, each once but the retried one
+    for (int offset = 2; offset < Total; offset += Limit) {
+        const int hits = server.hits(pagePath(offset)).size();
+        if (hits != (offset == 8 ? 2 : 1)) return QString("offset %1 was requested %2 times").arg(offset).arg(hits);
+    }
+    if (server.hits(firstPath).size() != 1) return "the first page was requested more than once";
+    if (server.maxOpen() > MaxConcurrent) {
+        return QString("%1 pages were open at once, the bound is %2").arg(server.maxOpen()).arg(MaxConcurrent);
+    }
+    // Out of order on the wire, in order in itemsReady: offset 4 answered before 2 was held back
+    const QList<QByteArray> answered = server.answered();
+    if (answered.indexOf(pagePath(4)) > answered.indexOf(pagePath(2))) {
+        return "pages completed in order, nothing was reassembled";
+    }
+    if (batches >= Total / Limit) return "every page was emitted on its own, nothing was held back";
+    return QString();
+}
+}
+
+//=============================================================================
+// FUNCTION: Entry point
+//=============================================================================
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("librify_schedbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Checks SpotifyRequestScheduler's retries, rate limit pause and coalescing, "
+                                     "and SpotifyPager's paging on top of it.");
+    parser.addHelpOption();
+    QCommandLineOption seedOption("seed", "Backoff jitter seed.", "n", "1");
+    QCommandLineOption verboseOption("verbose", "Keep the scheduler's warnings.");
+    parser.addOptions({seedOption, verboseOption});
+    parser.process(app);
+
+    if (!parser.isSet(verboseOption)) QLoggingCategory::setFilterRules("*.debug=false\n*.warning=false");
+    const quint32 seed = parser.value(seedOption).toUInt();
+
+    QElapsedTimer clock;
+    clock.start();
+    const QList<QPair<QString, std::function<QString()>>> checks = {
+        {"backoff", [&]() { return checkBackoff(seed, clock); }},
+        {"rate-limit-pause", [&]() { return checkRateLimitPause(clock); }},
+        {"coalescing", [&]() { return checkCoalescing(clock); }},
+        {"pager", [&]() { return checkPager(seed, clock); }},
+    };
+
+    QTextStream out(stdout);
+    int failures = 0;
+    for (const auto &check : checks) {
+        const QString failure = check.second();
+        if (failure.isEmpty()) {
+            out << "PASS " << check.first << Qt::endl;
+        } else {
+            out << "FAIL " << check.first << ": " << failure << Qt::endl;
+            ++failures;
+        }
+    }
+    return failures > 0 ? 1 : 0;
+}
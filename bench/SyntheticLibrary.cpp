@@ -0,0 +1,220 @@
+// SyntheticLibrary.cpp
+#include "SyntheticLibrary.h"
+
+#include <QBuffer>
+#include <QColor>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QLinearGradient>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+// MPEG-1 Layer III, 128 kbps, 44.1 kHz, no padding/CRC: 144 * 128000 / 44100 = 417 bytes, 1152 samples
+constexpr char FrameHeader[4] = {'\xFF', '\xFB', '\x90', '\x00'};
+constexpr int FrameBytes = 417;
+constexpr double FrameSeconds = 1152.0 / 44100.0;
+constexpr int TagPadding = 1024;
+
+const QStringList Words = {
+    "Night", "Café", "River", "Échos", "Gold", "Niño", "Signal", "Glass", "Ember", "Static",
+    "Über", "Summer", "Wire", "Halo", "Dust", "Mirror", "Søren", "Tide", "Velvet", "Orbit",
+};
+
+QString phrase(QRandomGenerator &random, int words) {
+    QStringList parts;
+    for (int i = 0; i < words; ++i) parts << Words.at(random.bounded(int(Words.size())));
+    return parts.join(' ');
+}
+
+void appendBigEndian32(QByteArray &out, quint32 value) {
+    out.append(char(value >> 24)).append(char(value >> 16)).append(char(value >> 8)).append(char(value));
+}
+
+void appendSyncsafe32(QByteArray &out, quint32 value) {
+    out.append(char((value >> 21) & 0x7F)).append(char((value >> 14) & 0x7F))
+       .append(char((value >> 7) & 0x7F)).append(char(value & 0x7F));
+}
+
+void appendFrame(QByteArray &tag, const char *id, const QByteArray &payload) {
+    tag.append(id, 4);
+    appendBigEndian32(tag, quint32(payload.size())); // ID3v2.3 frame sizes are plain big-endian
+    tag.append('\0').append('\0');
+    tag.append(payload);
+}
+
+void appendTextFrame(QByteArray &tag, const char *id, const QString &text) {
+    // Encoding 1: UTF-16 with BOM, so titles with diacritics survive
+    QByteArray payload(1, '\x01');
+    payload.append('\xFF').append('\xFE');
+    payload.append(reinterpret_cast<const char *>(text.utf16()), text.size() * 2);
+    appendFrame(tag, id, payload);
+}
+
+QByteArray coverJpeg(int size, quint32 albumSeed) {
+    QImage image(size, size, QImage::Format_RGB32);
+    QRandomGenerator random(albumSeed);
+    const QColor from = QColor::fromHsv(random.bounded(360), 160, 220);
+    const QColor to = QColor::fromHsv(random.bounded(360), 200, 90);
+    QPainter painter(&image);
+    QLinearGradient gradient(0, 0, size, size);
+    gradient.setColorAt(0, from);
+    gradient.setColorAt(1, to);
+    painter.fillRect(image.rect(), gradient);
+    for (int i = 0; i < 12; ++i) { // some detail so the JPEG is not trivially small
+        painter.setBrush(QColor::fromHsv(random.bounded(360), 180, 200));
+        painter.drawEllipse(random.bounded(size), random.bounded(size), random.bounded(size / 2 + 1), random.bounded(size / 2 + 1));
+    }
+    painter.end();
+
+    QByteArray jpeg;
+    QBuffer buffer(&jpeg);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "JPG", 85);
+    return jpeg;
+}
+
+// One generated file; generate() writes it, tracks() returns its tags
+struct TrackSpec {
+    int albumKey = 0;
+    int trackNumber = 0;
+    QString title;
+    QString artist;
+    QString album;
+    QString genre;
+    int year = 0;
+    QString directory;
+    QString filePath;
+};
+
+// Calls visit(const TrackSpec &) for every track in order; false from visit stops the walk
+template <typename Visit>
+bool forEachTrack(const QString &rootPath, const SyntheticLibraryConfig &config, Visit visit) {
+    QRandomGenerator random(config.seed);
+    const int artistCount = qMax(1, config.artists);
+    const int albumsPerArtist = qMax(1, config.albumsPerArtist);
+
+    // Zipf-like popularity: artist i gets weight 1 / (i + 1)^skew
+    std::vector<double> cumulative(artistCount);
+    double total = 0.0;
+    for (int i = 0; i < artistCount; ++i) {
+        total += 1.0 / std::pow(i + 1.0, config.artistSkew);
+        cumulative[i] = total;
+    }
+    QStringList artistNames;
+    for (int i = 0; i < artistCount; ++i) artistNames << QString("%1 %2").arg(phrase(random, 2)).arg(i + 1);
+
+    QHash<int, int> trackNumberByAlbum;
+    for (int n = 0; n < config.tracks; ++n) {
+        const double pick = random.generateDouble() * total;
+        const int artist = int(std::lower_bound(cumulative.begin(), cumulative.end(), pick) - cumulative.begin());
+        const int album = random.bounded(albumsPerArtist);
+
+        TrackSpec track;
+        track.albumKey = artist * albumsPerArtist + album;
+        track.trackNumber = ++trackNumberByAlbum[track.albumKey];
+        track.artist = artistNames.at(qMin(artist, artistCount - 1));
+        if (random.generateDouble() < config.featuringRatio) {
+            track.artist += " feat. " + artistNames.at(random.bounded(artistCount));
+        }
+        QRandomGenerator albumRandom(config.seed ^ quint32(track.albumKey)); // stable name per album
+        track.album = QString("%1 Vol. %2").arg(phrase(albumRandom, 2)).arg(album + 1);
+        track.title = QString("%1 %2").arg(phrase(random, 1 + random.bounded(3))).arg(n);
+        track.genre = Words.at(track.albumKey % Words.size());
+        track.year = 1970 + track.albumKey % 55;
+
+        track.directory = rootPath;
+        if (config.directoryDepth >= 1) track.directory += '/' + artistNames.at(artist);
+        if (config.directoryDepth >= 2) track.directory += '/' + track.album;
+        for (int level = 3; level <= config.directoryDepth; ++level) track.directory += QString("/Part %1").arg(level - 2);
+        track.filePath = QString("%1/%2 - %3.mp3").arg(track.directory).arg(track.trackNumber, 2, 10, QChar('0')).arg(track.title);
+        if (!visit(track)) return false;
+    }
+    return true;
+}
+}
+
+QVariantMap SyntheticLibraryConfig::toVariantMap() const {
+    return {{"tracks", tracks},
+            {"artists", artists},
+            {"albumsPerArtist", albumsPerArtist},
+            {"artistSkew", artistSkew},
+            {"featuringRatio", featuringRatio},
+            {"coverSize", coverSize},
+            {"directoryDepth", directoryDepth},
+            {"durationSeconds", durationSeconds},
+            {"seed", seed}};
+}
+
+int SyntheticLibrary::generate(const QString &rootPath, const SyntheticLibraryConfig &config, QString *error) {
+    // The audio payload is identical for every file; only tags differ
+    const int frameCount = qMax(1, int(config.durationSeconds / FrameSeconds));
+    QByteArray audio;
+    audio.reserve(frameCount * FrameBytes);
+    for (int i = 0; i < frameCount; ++i) {
+        audio.append(FrameHeader, 4);
+        audio.append(QByteArray(FrameBytes - 4, '\0'));
+    }
+
+    QHash<int, QByteArray> coverByAlbum;
+    const bool written = forEachTrack(rootPath, config, [&](const TrackSpec &track) {
+        if (!QDir().mkpath(track.directory)) {
+            if (error) *error = "Cannot create " + track.directory;
+            return false;
+        }
+
+        QByteArray frames;
+        appendTextFrame(frames, "TIT2", track.title);
+        appendTextFrame(frames, "TPE1", track.artist);
+        appendTextFrame(frames, "TALB", track.album);
+        appendTextFrame(frames, "TCON", track.genre);
+        appendTextFrame(frames, "TYER", QString::number(track.year));
+        appendTextFrame(frames, "TRCK", QString::number(track.trackNumber));
+        if (config.coverSize > 0) {
+            auto it = coverByAlbum.find(track.albumKey);
+            if (it == coverByAlbum.end()) it = coverByAlbum.insert(track.albumKey, coverJpeg(config.coverSize, config.seed ^ quint32(track.albumKey)));
+            QByteArray payload("\0image/jpeg\0\x03\0", 14); // encoding, MIME, cover (front), empty description
+            payload.append(*it);
+            appendFrame(frames, "APIC", payload);
+        }
+
+        QByteArray tag("ID3\x03\x00\x00", 6);
+        appendSyncsafe32(tag, quint32(frames.size() + TagPadding));
+        tag.append(frames);
+        tag.append(QByteArray(TagPadding, '\0'));
+
+        QFile file(track.filePath);
+        if (!file.open(QIODevice::WriteOnly) || file.write(tag) != tag.size() || file.write(audio) != audio.size()) {
+            if (error) *error = "Cannot write " + track.filePath;
+            return false;
+        }
+        return true;
+    });
+    return written ? config.tracks : -1;
+}
+
+QList<QVariantMap> SyntheticLibrary::tracks(const QString &rootPath, const SyntheticLibraryConfig &config) {
+    const int frameCount = qMax(1, int(config.durationSeconds / FrameSeconds));
+    const qint64 durationMs = qint64(frameCount * FrameSeconds * 1000);
+    QList<QVariantMap> tracks;
+    tracks.reserve(config.tracks);
+    forEachTrack(rootPath, config, [&](const TrackSpec &track) {
+        tracks.append({{"source", "local"},
+                       {"title", track.title},
+                       {"artist", track.artist},
+                       {"album", track.album},
+                       {"genre", track.genre},
+                       {"year", track.year},
+                       {"track", track.trackNumber},
+                       {"duration", durationMs},
+                       {"filePath", track.filePath}});
+        return true;
+    });
+    return tracks;
+}
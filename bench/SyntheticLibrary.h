@@ -0,0 +1,42 @@
+// SyntheticLibrary.h
+#ifndef SYNTHETICLIBRARY_H
+#define SYNTHETICLIBRARY_H
+
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+
+/**
+ * @brief Shape of a generated benchmark library.
+ */
+struct SyntheticLibraryConfig {
+    int tracks = 1000;
+    int artists = 100;
+    int albumsPerArtist = 4;
+    double artistSkew = 1.0;       // Zipf exponent of tracks per artist; 0 = uniform
+    double featuringRatio = 0.1;   // share of tracks credited "A feat. B"
+    int coverSize = 300;           // JPEG edge in px, one cover per album; 0 = no APIC
+    int directoryDepth = 2;        // 0 flat, 1 Artist/, 2 Artist/Album/, >2 adds "Part n" levels
+    int durationSeconds = 2;       // silent 128 kbps MPEG-1 Layer III frames
+    quint32 seed = 42;
+
+    QVariantMap toVariantMap() const;
+};
+
+/**
+ * @brief Writes N tagged MP3 files (ID3v2.3 text frames, optional APIC,
+ * valid MPEG frames) so scans and TagLib see realistic input.
+ * Deterministic for a given config.
+ */
+namespace SyntheticLibrary {
+
+// Returns the number of files written, -1 on error (message in *error)
+int generate(const QString &rootPath, const SyntheticLibraryConfig &config, QString *error = nullptr);
+
+// The tags generate() would write, as LibraryScanner::readTags() returns them
+// (no covers), without touching the disk; for UI runs with very large libraries
+QList<QVariantMap> tracks(const QString &rootPath, const SyntheticLibraryConfig &config);
+
+} // namespace SyntheticLibrary
+
+#endif // SYNTHETICLIBRARY_H
@@ -0,0 +1,427 @@
+// UiStressBench.cpp
+//
+// Frame-time stress test for the track list. Hosts TrackListPane.qml in an
+// offscreen window, installs a synthetic library (100k tracks by default,
+// built in memory, see SyntheticLibrary::tracks) into LocalMusicManager, then
+// scrolls, sorts and switches sidebar groupings while FrameTimeMonitor records
+// every frame. Prints p50/p99 per scenario and exits with 2 when a limit is
+// exceeded, so CI can gate on UI smoothness.
+//
+//   librify_uibench --tracks 100000 --max-scroll-p99-ms 20 --max-switch-ms 400 --output ui.json
+//
+// Each step waits for the previous frame to be swapped, so without vsync the
+// frame times are the GUI and render work per frame, not display refresh.
+// The software scene graph is used unless QSG_RHI_BACKEND/QT_QUICK_BACKEND say otherwise.
+
+#include "FrameTimeMonitor.h"
+#include "LocalMusicManager.h"
+#include "MetricsRegistry.h"
+#include "PlaylistManager.h"
+#include "SyntheticLibrary.h"
+#include "Trace.h"
+#include "TrackListModel.h"
+
+#include <QColor>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QQmlContext>
+#include <QQmlError>
+#include <QQuickItem>
+#include <QQuickStyle>
+#include <QQuickView>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QTimer>
+#include <QtConcurrent>
+#include <functional>
+
+namespace {
+constexpr int SettleFrames = 10;        // before every scenario, so it starts from an idle list
+constexpr int SwitchFrames = 30;        // shown after each sort/grouping switch
+constexpr int FrameTimeoutMs = 10000;   // no frame for this long: the scenario is abandoned
+const QString LibraryRoot = QStringLiteral("/synthetic/Music"); // never touched on disk
+
+// Same columns as LibrifyBench's sort benchmarks
+const QList<QPair<QString, TrackListModel::SortColumn>> SortColumns = {
+    {"Title", TrackListModel::Title},
+    {"ArtistAlbum", TrackListModel::ArtistAlbum},
+    {"Album", TrackListModel::Album},
+    {"Bpm", TrackListModel::Bpm},
+};
+const QStringList Groupings = {"ARTISTS", "ALBUMS", "GENRES", "DECADES", "YEARS", "FOLDERS"};
+}
+
+/**
+ * @brief Drives TrackListPane.qml through LocalMusicManager and
+ * TrackListModel the way the app wires them (see main.cpp) and reports the
+ * frames FrameTimeMonitor recorded for each scenario.
+ */
+class UiStressBench {
+public:
+    enum class Kind { Scroll, Switch };
+
+    struct Options {
+        SyntheticLibraryConfig library;
+        int scrollFrames = 600;
+        QSize windowSize{1280, 800};
+        QRegularExpression only;
+        double maxScrollP99Ms = 0; // 0 = no gate
+        double maxSwitchMs = 0;
+    };
+
+    explicit UiStressBench(const Options &options) : m_options(options) {}
+
+    bool setUp(QString *error);
+    void run();
+    QJsonArray results() const { return m_results; }
+    // Scenarios over their limit, empty when the run passes
+    QStringList failures() const { return m_failures; }
+
+private:
+    using Step = std::function<void(int frame)>;
+    // Shows frames frames, calling step (if any) before each one
+    bool drive(int frames, const Step &step = {});
+    void measure(const QString &name, Kind kind, const std::function<void()> &body);
+
+    void scrollBy(qreal pixels);
+    void loadLargestItem();
+
+    void benchScrolling();
+    void benchSorting();
+    void benchGroupings();
+
+    Options m_options;
+    LocalMusicManager m_manager;
+    TrackListModel m_model;
+    PlaylistManager m_playlists;
+    FrameTimeMonitor m_frameMonitor;
+    QQuickView m_view;
+    QObject *m_listView = nullptr;
+    QJsonArray m_results;
+    QStringList m_failures;
+};
+
+//=============================================================================
+// FUNCTION: Library, models and the offscreen view
+//=============================================================================
+bool UiStressBench::setUp(QString *error) {
+    QObject::connect(&m_manager, &LocalMusicManager::tracksReadyForDisplay, &m_model, &TrackListModel::updateTracks);
+    QObject::connect(&m_manager, &LocalMusicManager::tracksPatched, &m_model, &TrackListModel::patchTracks);
+
+    QQmlContext *context = m_view.rootContext();
+    context->setContextProperty("cppLocalManager", &m_manager);
+    context->setContextProperty("cppTrackModel", &m_model);
+    context->setContextProperty("cppPlaylistManager", &m_playlists);
+    context->setContextProperty("cppFrameMonitor", &m_frameMonitor);
+    context->setContextProperty("themeColor", QColor("#c0c0cc")); // Main.qml's default theme
+    m_view.setInitialProperties({{"trackModel", QVariant::fromValue(&m_model)}, {"currentTrackIndex", -1}});
+    m_view.setResizeMode(QQuickView::SizeRootObjectToView);
+    m_view.setSource(QUrl(QStringLiteral("qrc:/TrackListPane.qml")));
+    if (m_view.status() != QQuickView::Ready) {
+        QStringList messages;
+        for (const QQmlError &qmlError : m_view.errors()) messages << qmlError.toString();
+        *error = "Cannot load TrackListPane.qml: " + messages.join("; ");
+        return false;
+    }
+    m_listView = m_view.rootObject()->findChild<QObject *>("trackListView");
+    if (!m_listView) {
+        *error = "TrackListPane.qml has no trackListView";
+        return false;
+    }
+    m_frameMonitor.attach(&m_view);
+    m_view.resize(m_options.windowSize);
+    m_view.show();
+
+    // As if a scan had just finished: same slot, same indices, same tracksReadyForDisplay
+    LocalMusicManager::ScanResults results;
+    results.cachedTracks = SyntheticLibrary::tracks(LibraryRoot, m_options.library);
+    for (const QVariantMap &track : std::as_const(results.cachedTracks)) {
+        const QString album = track.value("album").toString();
+        results.uniqueArtists.insert(track.value("artist").toString());
+        results.uniqueAlbums.insert(album);
+        ++results.albumTrackCounts[album];
+    }
+    m_manager.m_scanRoots = {LibraryRoot};
+    m_manager.m_scanWatcher.setFuture(QtConcurrent::run([results]() { return results; }));
+    m_manager.m_scanWatcher.waitForFinished();
+    m_manager.handleScanFinished();
+    // The files do not exist: no tempo analysis, and duplicate hashing finds nothing
+    m_manager.m_tempoAnalyzer.analyze({});
+    m_manager.m_duplicateWatcher.waitForFinished();
+    QCoreApplication::processEvents();
+    return drive(SettleFrames);
+}
+
+//=============================================================================
+// HELPER: Frame pump
+//=============================================================================
+bool UiStressBench::drive(int frames, const Step &step) {
+    QEventLoop loop;
+    QTimer watchdog;
+    watchdog.setSingleShot(true);
+    watchdog.setInterval(FrameTimeoutMs);
+    bool timedOut = false;
+    int frame = 0;
+    const auto next = [&]() {
+        if (frame == frames) {
+            loop.quit();
+            return;
+        }
+        if (step) step(frame);
+        ++frame;
+        watchdog.start();
+        m_view.update(); // a frame even when the step changed nothing
+    };
+    QObject::connect(&watchdog, &QTimer::timeout, &loop, [&]() {
+        timedOut = true;
+        loop.quit();
+    });
+    // Queued: the next step runs once the swapped frame's signal reaches the GUI thread
+    const QMetaObject::Connection connection =
+        QObject::connect(&m_view, &QQuickWindow::frameSwapped, &loop, next, Qt::QueuedConnection);
+    QTimer::singleShot(0, &loop, next);
+    loop.exec();
+    QObject::disconnect(connection);
+    if (timedOut) QTextStream(stderr) << "No frame for " << FrameTimeoutMs << " ms, giving up after frame " << frame << Qt::endl;
+    return !timedOut;
+}
+
+void UiStressBench::measure(const QString &name, Kind kind, const std::function<void()> &body) {
+    if (!m_options.only.pattern().isEmpty() && !m_options.only.match(name).hasMatch()) return;
+
+    drive(SettleFrames);
+    MetricsRegistry::reset();
+    body();
+
+    const HdrHistogram &frames = Metrics::frameMicros;
+    const double p50Ms = frames.valueAtQuantile(0.5) / 1000.0;
+    const double p99Ms = frames.valueAtQuantile(0.99) / 1000.0;
+    const double maxMs = frames.max() / 1000.0;
+    const quint64 longFrames = Metrics::longFrames.load();
+    m_results.append(QJsonObject{{"name", name},
+                                 {"kind", kind == Kind::Scroll ? "scroll" : "switch"},
+                                 {"frames", qint64(frames.count())},
+                                 {"p50Ms", p50Ms},
+                                 {"p90Ms", frames.valueAtQuantile(0.9) / 1000.0},
+                                 {"p99Ms", p99Ms},
+                                 {"maxMs", maxMs},
+                                 {"renderP99Ms", Metrics::frameRenderMicros.valueAtQuantile(0.99) / 1000.0},
+                                 {"longFrames", qint64(longFrames)},
+                                 {"longFramesAfterReset", qint64(Metrics::longFramesAfterReset.load())},
+                                 {"longFramesWithDelegates", qint64(Metrics::longFramesWithDelegates.load())}});
+    QTextStream(stdout) << QString("%1 %2 %3 %4 %5 %6\n")
+                               .arg(name, -40)
+                               .arg(frames.count(), 8)
+                               .arg(p50Ms, 10, 'f', 2)
+                               .arg(p99Ms, 10, 'f', 2)
+                               .arg(maxMs, 10, 'f', 2)
+                               .arg(longFrames, 8);
+
+    // Scrolling is gated on its p99, a switch on its worst (the switching) frame
+    if (kind == Kind::Scroll && m_options.maxScrollP99Ms > 0 && p99Ms > m_options.maxScrollP99Ms) {
+        m_failures << QString("%1: p99 %2 ms > %3 ms").arg(name).arg(p99Ms, 0, 'f', 2).arg(m_options.maxScrollP99Ms);
+    } else if (kind == Kind::Switch && m_options.maxSwitchMs > 0 && maxMs > m_options.maxSwitchMs) {
+        m_failures << QString("%1: max %2 ms > %3 ms").arg(name).arg(maxMs, 0, 'f', 2).arg(m_options.maxSwitchMs);
+    }
+}
+
+void UiStressBench::scrollBy(qreal pixels) {
+    const qreal originY = m_listView->property("originY").toReal();
+    const qreal maxY = originY + m_listView->property("contentHeight").toReal() - m_listView->property("height").toReal();
+    const qreal y = m_listView->property("contentY").toReal() + pixels;
+    m_listView->setProperty("contentY", qBound(originY, y, qMax(originY, maxY)));
+}
+
+// Biggest section of the current grouping, as if the user clicked it
+void UiStressBench::loadLargestItem() {
+    const QList<SidebarModel::Item> &items = m_manager.sidebarModel()->items();
+    const SidebarModel::Item *largest = nullptr;
+    for (const SidebarModel::Item &item : items) {
+        if (!largest || item.count > largest->count) largest = &item;
+    }
+    if (largest) m_manager.loadTracksFor(largest->id, largest->type);
+}
+
+void UiStressBench::run() {
+    QTextStream(stdout) << QString("%1 %2 %3 %4 %5 %6\n")
+                               .arg("scenario", -40).arg("frames", 8).arg("p50 ms", 10)
+                               .arg("p99 ms", 10).arg("max ms", 10).arg("long", 8);
+    benchScrolling();
+    benchSorting();
+    benchGroupings();
+}
+
+//=============================================================================
+// FUNCTION: Scrolling the full library
+//=============================================================================
+void UiStressBench::benchScrolling() {
+    const qreal rowHeight = 65; // TrackListPane.baseRowHeight at rowScale 1
+    const int frames = m_options.scrollFrames;
+
+    m_listView->setProperty("contentY", m_listView->property("originY"));
+    measure("scroll/steady", Kind::Scroll, [&]() {
+        drive(frames, [&](int) { scrollBy(rowHeight / 2); }); // half a row per frame, a slow wheel scroll
+    });
+    measure("scroll/fast", Kind::Scroll, [&]() {
+        drive(frames, [&](int frame) { scrollBy(frame % 60 < 30 ? 10 * rowHeight : -10 * rowHeight); });
+    });
+    // Dragging the scroll bar: every frame lands somewhere else, no delegate is reused
+    QRandomGenerator random(1);
+    const int count = m_listView->property("count").toInt();
+    measure("scroll/jump", Kind::Scroll, [&]() {
+        drive(frames / 4, [&](int) {
+            QMetaObject::invokeMethod(m_listView, "positionViewAtIndex", Q_ARG(int, random.bounded(qMax(1, count))),
+                                      Q_ARG(int, 0 /* ListView.Beginning */));
+        });
+    });
+}
+
+//=============================================================================
+// FUNCTION: Re-sorting the full library (every delegate is rebuilt)
+//=============================================================================
+void UiStressBench::benchSorting() {
+    m_manager.loadTracksFor(ALL_TRACKS_IDENTIFIER, "local_all");
+    for (const auto &[label, column] : SortColumns) {
+        for (const Qt::SortOrder order : {Qt::AscendingOrder, Qt::DescendingOrder}) {
+            const QString name = QString("sort/%1/%2").arg(label, order == Qt::AscendingOrder ? "asc" : "desc");
+            measure(name, Kind::Switch, [&, column = column, order]() {
+                drive(SwitchFrames, [&](int frame) {
+                    if (frame > 0) return;
+                    m_view.rootObject()->setProperty("sortColumn", int(column));
+                    m_view.rootObject()->setProperty("sortOrder", int(order));
+                    m_model.sortTracksBy(column, order);
+                });
+            });
+        }
+    }
+}
+
+//=============================================================================
+// FUNCTION: Switching sidebar groupings and opening their largest section
+//=============================================================================
+void UiStressBench::benchGroupings() {
+    for (const QString &grouping : Groupings) {
+        measure("grouping/" + grouping, Kind::Switch, [&]() {
+            drive(SwitchFrames, [&](int frame) {
+                if (frame > 0) return;
+                m_manager.setGrouping(grouping);
+                loadLargestItem();
+            });
+        });
+    }
+    measure("grouping/back to all", Kind::Switch, [&]() {
+        drive(SwitchFrames, [&](int frame) {
+            if (frame == 0) m_manager.loadTracksFor(ALL_TRACKS_IDENTIFIER, "local_all");
+        });
+    });
+}
+
+//=============================================================================
+// FUNCTION: Entry point
+//=============================================================================
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    // No GPU is assumed (CI); the software adaptation renders on the GUI thread
+    if (qEnvironmentVariableIsEmpty("QSG_RHI_BACKEND") && qEnvironmentVariableIsEmpty("QT_QUICK_BACKEND")) {
+        QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    }
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("Librify");
+    QCoreApplication::setApplicationName("librify_uibench");
+    // Caches, index and playlists go to a test location, never the user's library data
+    QStandardPaths::setTestModeEnabled(true);
+    Trace::installFromEnvironment(); // LIBRIFY_TRACE=<file> shows every frame as a "ui" span
+    QQuickStyle::setStyle("Basic");
+    qmlRegisterUncreatableType<TrackListModel>("com.librify", 1, 0, "TrackListModel",
+                                               "Enums are only used for accessing constants");
+
+    SyntheticLibraryConfig defaults;
+    defaults.tracks = 100000;
+    defaults.artists = 2000;
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures track list frame times while scrolling, sorting and switching groupings.");
+    parser.addHelpOption();
+    QCommandLineOption tracksOption("tracks", "Synthetic track count.", "n", QString::number(defaults.tracks));
+    QCommandLineOption artistsOption("artists", "Synthetic artist count.", "n", QString::number(defaults.artists));
+    QCommandLineOption albumsOption("albums-per-artist", "Albums per artist.", "n", QString::number(defaults.albumsPerArtist));
+    QCommandLineOption skewOption("artist-skew", "Zipf exponent of tracks per artist (0 = uniform).", "s", QString::number(defaults.artistSkew));
+    QCommandLineOption depthOption("depth", "Directory depth below the root.", "n", QString::number(defaults.directoryDepth));
+    QCommandLineOption seedOption("seed", "Generator seed.", "n", QString::number(defaults.seed));
+    QCommandLineOption framesOption("scroll-frames", "Frames per scrolling scenario.", "n", "600");
+    QCommandLineOption sizeOption("size", "Window size.", "WxH", "1280x800");
+    QCommandLineOption onlyOption("only", "Run scenarios whose name matches this regex.", "regex");
+    QCommandLineOption scrollGateOption("max-scroll-p99-ms", "Fail when a scroll scenario's p99 frame exceeds this.", "ms", "0");
+    QCommandLineOption switchGateOption("max-switch-ms", "Fail when a sort/grouping switch's worst frame exceeds this.", "ms", "0");
+    QCommandLineOption outputOption("output", "Write results as JSON to this file ('-' for stdout).", "file");
+    QCommandLineOption verboseOption("verbose", "Keep debug logging (slows the measured code).");
+    parser.addOptions({tracksOption, artistsOption, albumsOption, skewOption, depthOption, seedOption, framesOption,
+                       sizeOption, onlyOption, scrollGateOption, switchGateOption, outputOption, verboseOption});
+    parser.process(app);
+
+    if (!parser.isSet(verboseOption)) QLoggingCategory::setFilterRules("*.debug=false");
+
+    UiStressBench::Options options;
+    options.library = defaults;
+    options.library.tracks = parser.value(tracksOption).toInt();
+    options.library.artists = parser.value(artistsOption).toInt();
+    options.library.albumsPerArtist = parser.value(albumsOption).toInt();
+    options.library.artistSkew = parser.value(skewOption).toDouble();
+    options.library.directoryDepth = parser.value(depthOption).toInt();
+    options.library.seed = parser.value(seedOption).toUInt();
+    options.library.coverSize = 0; // rows show the placeholder; covers are ThumbnailCache's business
+    options.scrollFrames = qMax(1, parser.value(framesOption).toInt());
+    const QStringList size = parser.value(sizeOption).split('x');
+    if (size.size() == 2) options.windowSize = QSize(size.at(0).toInt(), size.at(1).toInt());
+    options.only = QRegularExpression(parser.value(onlyOption));
+    options.maxScrollP99Ms = parser.value(scrollGateOption).toDouble();
+    options.maxSwitchMs = parser.value(switchGateOption).toDouble();
+
+    QTextStream err(stderr);
+    UiStressBench bench(options);
+    QElapsedTimer timer;
+    timer.start();
+    QString error;
+    if (!bench.setUp(&error)) {
+        err << error << Qt::endl;
+        return 1;
+    }
+    err << "Loaded " << options.library.tracks << " synthetic tracks (" << timer.elapsed() << " ms)" << Qt::endl;
+    bench.run();
+
+    if (parser.isSet(outputOption)) {
+        QJsonObject report{{"benchmark", "librify_uibench"},
+                           {"timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+                           {"qtVersion", qVersion()},
+                           {"cpu", QSysInfo::currentCpuArchitecture()},
+                           {"os", QSysInfo::prettyProductName()},
+                           {"platform", QGuiApplication::platformName()},
+                           {"library", QJsonObject::fromVariantMap(options.library.toVariantMap())},
+                           {"window", QString("%1x%2").arg(options.windowSize.width()).arg(options.windowSize.height())},
+                           {"results", bench.results()},
+                           {"failures", QJsonArray::fromStringList(bench.failures())}};
+        const QByteArray json = QJsonDocument(report).toJson();
+        if (parser.value(outputOption) == "-") {
+            QTextStream(stdout) << json;
+        } else {
+            QFile file(parser.value(outputOption));
+            if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+                err << "Cannot write " << file.fileName() << Qt::endl;
+                return 1;
+            }
+        }
+    }
+
+    for (const QString &failure : bench.failures()) err << "FAIL " << failure << Qt::endl;
+    return bench.failures().isEmpty() ? 0 : 2;
+}
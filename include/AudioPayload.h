@@ -0,0 +1,36 @@
+// AudioPayload.h
+#ifndef AUDIOPAYLOAD_H
+#define AUDIOPAYLOAD_H
+
+#include <QIODevice>
+#include <QString>
+
+/**
+ * @brief Locates and hashes the audio frames of an MP3, ignoring metadata.
+ *
+ * Leading ID3v2 tags (with their APIC frames and padding) and trailing
+ * APEv2/ID3v1 tags are excluded, so the same rip with different tags or
+ * cover art hashes identically.
+ */
+namespace AudioPayload {
+
+struct Range {
+    qint64 begin = 0;
+    qint64 end = 0; // exclusive
+    bool isValid() const { return end > begin; }
+};
+
+// Byte range of the audio payload inside an open, seekable device
+Range locate(QIODevice &device);
+
+// XXH64 of the audio payload; 0 if the file cannot be read
+quint64 hash(const QString &filePath);
+
+// Cheap identity check: XXH64 of the first and last FingerprintSpan bytes of
+// the payload, seeded with its length. Reads at most 128 KiB; 0 on failure.
+constexpr qint64 FingerprintSpan = 64 * 1024;
+quint64 fingerprint(const QString &filePath);
+
+} // namespace AudioPayload
+
+#endif // AUDIOPAYLOAD_H
@@ -4,15 +4,59 @@
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <QUrlQuery>
+#include <QHash>
+#include <QPointer>
+#include <QJsonDocument>
+#include <atomic>
+#include <optional>
 
+#include "HttpRequestParser.h"
+
+class PlaybackManager;
+class LocalMusicManager;
+
+/**
+ * @brief Embedded HTTP/1.1 server on localhost:8888.
+ *
+ * Besides the Spotify OAuth redirect (any request carrying ?code=), it
+ * serves a small JSON control API for scripts and a local dashboard:
+ *   POST /play, /pause, /next          transport
+ *   GET  /queue, POST /queue           {"filePath": "..."} or ?path=
+ *   GET  /search?q=...&limit=N         local library search
+ *   GET  /now-playing                  player state and track tags
+ *   GET  /metrics                      Prometheus text: connections, MetricsRegistry, memory
+ *   GET  /diagnostics                  MetricsRegistry snapshot as JSON
+ *   POST /trace/start, /trace/stop     span tracing on/off (see Trace.h)
+ *   GET  /trace                        recorded spans as Chrome trace-event JSON
+ * Connections are persistent (keep-alive, pipelining) and requests are
+ * parsed incrementally as bytes arrive.
+ *
+ * Any web page can make the browser talk to localhost, so only the OAuth
+ * redirect is open. Every request must name localhost or 127.0.0.1 in
+ * Host (no DNS rebinding) and carry no foreign Origin; the control API
+ * also needs "Authorization: Bearer <token>" with the token start()
+ * writes to tokenFilePath() (owner-only, new every run), and POSTs must
+ * be application/json, which a cross-site form cannot send.
+ */
 class AuthServer : public QTcpServer {
     Q_OBJECT
 public:
+    static constexpr quint16 DefaultPort = 8888;
+    static constexpr int IdleTimeoutMs = 15000;
+    static constexpr int MaxRequestsPerConnection = 1000;
+
     explicit AuthServer(QObject *parent = nullptr);
+    ~AuthServer();
 
     void start();
     void stop();
 
+    // AppDataLocation/control-token; exists while the server runs
+    static QString tokenFilePath();
+
+    void setPlaybackManager(PlaybackManager *playbackManager);
+    void setLocalMusicManager(LocalMusicManager *localMusicManager);
+
 signals:
     void authorizationCodeReceived(const QString &code);
 
@@ -20,7 +64,36 @@ private slots:
     void handleConnection();
 
 private:
-    QString extractCodeFromRequest(const QString &request);
+    struct Connection {
+        HttpRequestParser parser;
+        int handledRequests = 0;
+    };
+    struct Response {
+        int status = 200;
+        QByteArray contentType = "application/json";
+        QByteArray body;
+        bool close = false;
+    };
+
+    void handleReadyRead(QTcpSocket *socket);
+    Response route(const HttpRequest &request);
+    // Empty when the request may go on, else the response refusing it
+    std::optional<Response> refuse(const HttpRequest &request, bool authorizationCallback) const;
+    bool isLocalAuthority(const QByteArray &authority) const;
+    Response handleAuthorizationCallback(const HttpRequest &request);
+    QByteArray renderMetrics() const;
+    void writeResponse(QTcpSocket *socket, const Response &response, bool keepAlive);
+    static Response json(const QJsonDocument &document, int status = 200);
+    static Response error(int status, const QString &message);
+    static QByteArray reasonPhrase(int status);
+    QString extractCodeFromRequest(const HttpRequest &request);
+
+    QHash<QTcpSocket *, Connection *> m_connections;
+    QPointer<PlaybackManager> m_playbackManager;
+    QPointer<LocalMusicManager> m_localMusicManager;
+    std::atomic<quint64> m_requestsServed{0};
+    std::atomic<quint64> m_connectionsAccepted{0};
+    QByteArray m_token; // hex, per run
 };
 
 #endif // AUTHSERVER_H
@@ -0,0 +1,51 @@
+// DiagnosticsMonitor.h
+#ifndef DIAGNOSTICSMONITOR_H
+#define DIAGNOSTICSMONITOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVariantList>
+
+/**
+ * @brief Feeds the diagnostics pane in SidebarSettings with MetricsRegistry
+ * values, formatted for display and refreshed once a second while the pane
+ * is visible (memory probes walk whole containers, so nothing is polled
+ * while it is closed).
+ *
+ * Each row is {section, label, value}; exportSnapshot() writes the raw
+ * snapshot as JSON so it can be attached to a bug report.
+ */
+class DiagnosticsMonitor : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool active READ isActive WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(QVariantList rows READ rows NOTIFY rowsChanged)
+
+public:
+    explicit DiagnosticsMonitor(QObject *parent = nullptr);
+
+    bool isActive() const { return m_active; }
+    void setActive(bool active);
+    QVariantList rows() const { return m_rows; }
+
+    // Path of the written JSON file, empty on failure
+    Q_INVOKABLE QString exportSnapshot();
+    Q_INVOKABLE void copySnapshotToClipboard();
+    Q_INVOKABLE void resetMetrics();
+
+signals:
+    void activeChanged();
+    void rowsChanged();
+
+private slots:
+    void refresh();
+
+private:
+    static QString formatValue(double value, const QString &unit);
+
+    QTimer m_refreshTimer;
+    bool m_active = false;
+    QVariantList m_rows;
+};
+
+#endif // DIAGNOSTICSMONITOR_H
@@ -0,0 +1,42 @@
+// DuplicateDetector.h
+#ifndef DUPLICATEDETECTOR_H
+#define DUPLICATEDETECTOR_H
+
+#include <QList>
+#include <QString>
+
+class LibraryIndex;
+
+/**
+ * @brief Finds duplicate tracks in the local library.
+ *
+ * Exact duplicates share the same audio payload hash (tags and cover art
+ * ignored). Candidates are the remaining tracks with the same normalized
+ * title and durations within DurationToleranceMs. Payload hashes are read
+ * from and stored into the LibraryIndex, so only changed files are hashed.
+ */
+class DuplicateDetector
+{
+public:
+    static constexpr qint64 DurationToleranceMs = 2000;
+
+    struct Track {
+        int index = -1;        // caller's index, returned in the groups
+        QString filePath;
+        QString title;
+        qint64 durationMs = 0;
+    };
+
+    struct Group {
+        bool exact = false;    // identical payloads vs. title/duration candidates
+        QList<int> indices;
+    };
+
+    // Blocking; hashes in parallel on the global thread pool. Exact groups come first.
+    static QList<Group> findDuplicates(const QList<Track> &tracks, LibraryIndex *index);
+
+private:
+    static QString normalizedTitle(const QString &title);
+};
+
+#endif // DUPLICATEDETECTOR_H
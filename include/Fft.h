@@ -0,0 +1,35 @@
+// Fft.h
+#ifndef FFT_H
+#define FFT_H
+
+#include <vector>
+
+/**
+ * @brief Radix-2 complex FFT over split real/imaginary float arrays.
+ *
+ * Twiddles and the bit-reversal permutation are computed once in the
+ * constructor, so transform() never allocates. Each stage stores its twiddles
+ * contiguously, which keeps the butterfly loop a straight run over unit-stride
+ * arrays that the compiler turns into SIMD code.
+ */
+class Fft
+{
+public:
+    explicit Fft(int size); // size must be a power of two
+
+    int size() const { return m_size; }
+
+    // In-place forward transform. Both arrays must hold size() floats.
+    void transform(float *re, float *im) const;
+
+    // Builds a periodic Hann window of the given length.
+    static std::vector<float> hannWindow(int size);
+
+private:
+    int m_size;
+    std::vector<int> m_bitReverse;
+    std::vector<float> m_twiddleRe; // stage-major: 1 + 2 + 4 + ... + size/2 entries
+    std::vector<float> m_twiddleIm;
+};
+
+#endif // FFT_H
@@ -0,0 +1,63 @@
+// FolderTree.h
+#ifndef FOLDERTREE_H
+#define FOLDERTREE_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+/**
+ * @brief On-disk folder hierarchy of the library, built from the scanned
+ * file paths (no directory is listed again).
+ *
+ * Nodes exist only for folders that contain tracks somewhere below them;
+ * each keeps its direct tracks and the total below it, updated as tracks
+ * are added. Only the children of expanded nodes are visible, so the
+ * sidebar shows and builds just the open part of the tree. Expansion
+ * state survives clear() (a rescan).
+ */
+class FolderTree
+{
+public:
+    struct Node {
+        QString path;
+        QString name;
+        int parent = -1;
+        int depth = 0;
+        QList<int> children;    // sorted by name after finalize()
+        QList<int> tracks;      // track indices directly in this folder
+        int trackCount = 0;     // tracks in this folder and below
+    };
+
+    void clear();
+    // Top-level node for a library root; roots start expanded
+    void addRoot(const QString &rootPath);
+    // Files outside every root get their own folder as a root
+    void addTrack(const QString &filePath, int trackIndex);
+    // Sorts children by name; once after a batch of addTrack()
+    void finalize();
+
+    bool isEmpty() const { return m_nodes.isEmpty(); }
+    int nodeCount() const { return int(m_nodes.size()); }
+    const Node &node(int id) const { return m_nodes.at(id); }
+    int nodeFor(const QString &path) const { return m_byPath.value(path, -1); }
+    bool isExpanded(int id) const { return m_expandedPaths.contains(m_nodes.at(id).path); }
+    bool hasChildren(int id) const { return !m_nodes.at(id).children.isEmpty(); }
+
+    // Returns the new state
+    bool toggleExpanded(const QString &path);
+    // Pre-order walk of the roots and the children of expanded nodes
+    QList<int> visibleNodes() const;
+    // Track indices in the folder and every folder below it
+    QList<int> tracksUnder(const QString &path) const;
+
+private:
+    QList<Node> m_nodes;
+    QList<int> m_roots;
+    QHash<QString, int> m_byPath;
+    QSet<QString> m_expandedPaths;
+    QSet<QString> m_knownRoots; // roots expanded once by default
+};
+
+#endif // FOLDERTREE_H
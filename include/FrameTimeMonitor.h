@@ -0,0 +1,56 @@
+// FrameTimeMonitor.h
+#ifndef FRAMETIMEMONITOR_H
+#define FRAMETIMEMONITOR_H
+
+#include <QObject>
+#include <QPointer>
+
+class QQuickWindow;
+
+/**
+ * @brief Records frame times of a QQuickWindow into Metrics and attributes
+ * long frames to what ran since the previous frame.
+ *
+ * Frame time runs from the first note or beforeSynchronizing after the
+ * previous frameSwapped, whichever came first, to the next frameSwapped;
+ * render time is the span from beforeRendering to frameSwapped. Qt Quick
+ * only renders on change, so the time between a swap and whatever wakes
+ * the scene up is idle time and never counted. Models call
+ * noteModelReset() when they hand QML a new list, delegates call
+ * noteDelegateCreated() from Component.onCompleted; a frame over
+ * LongFrameMicros is counted against each cause seen since the frame
+ * before it. Frames also appear as "ui" spans in the trace, with the
+ * number of delegates created as the span argument.
+ */
+class FrameTimeMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr qint64 LongFrameMicros = 25000; // a missed vsync at 60 Hz, with some slack
+
+    explicit FrameTimeMonitor(QObject *parent = nullptr);
+
+    // One window at a time; a second call moves the monitor to the new window
+    void attach(QQuickWindow *window);
+
+    // Any thread
+    static void noteModelReset();
+    Q_INVOKABLE void noteDelegateCreated();
+
+private:
+    void handleBeforeSynchronizing();
+    void handleBeforeRendering();
+    void handleFrameSwapped();
+
+    QPointer<QQuickWindow> m_window;
+    QMetaObject::Connection m_beforeSynchronizingConnection;
+    QMetaObject::Connection m_beforeRenderingConnection;
+    QMetaObject::Connection m_frameSwappedConnection;
+    // Render thread only
+    qint64 m_lastSwapNs = -1;
+    qint64 m_syncStartNs = -1; // first beforeSynchronizing since the last swap
+    qint64 m_renderStartNs = -1;
+};
+
+#endif // FRAMETIMEMONITOR_H
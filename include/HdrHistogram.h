@@ -0,0 +1,48 @@
+// HdrHistogram.h
+#ifndef HDRHISTOGRAM_H
+#define HDRHISTOGRAM_H
+
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <limits>
+
+/**
+ * @brief Log-linear histogram in the style of HdrHistogram, safe to record
+ * into from any thread without locking.
+ *
+ * Values below 64 are counted exactly; larger ones fall into 32 sub-buckets
+ * per power of two, so any quantile is within ~3% of the recorded value over
+ * the whole qint64 range. The unit is up to the caller (microseconds,
+ * files/s, bytes, ...).
+ */
+class HdrHistogram
+{
+public:
+    static constexpr int ExactBits = 6;                      // values < 64 are exact
+    static constexpr int SubBuckets = 1 << (ExactBits - 1);  // per power of two above that
+    static constexpr int BucketCount = (1 << ExactBits) + (63 - ExactBits) * SubBuckets;
+
+    void record(qint64 value); // negative values are recorded as 0
+    // Not atomic with respect to concurrent record() calls
+    void reset();
+
+    quint64 count() const { return m_count.load(std::memory_order_relaxed); }
+    qint64 min() const;  // 0 when empty
+    qint64 max() const;
+    double mean() const;
+    // Value at quantile q in [0, 1] (0.5 = median); 0 when empty
+    qint64 valueAtQuantile(double q) const;
+
+private:
+    static int bucketIndex(quint64 value);
+    static qint64 bucketMidpoint(int index);
+
+    std::array<std::atomic<quint64>, BucketCount> m_buckets{};
+    std::atomic<quint64> m_count{0};
+    std::atomic<qint64> m_sum{0};
+    std::atomic<qint64> m_min{std::numeric_limits<qint64>::max()};
+    std::atomic<qint64> m_max{0};
+};
+
+#endif // HDRHISTOGRAM_H
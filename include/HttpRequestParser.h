@@ -0,0 +1,70 @@
+// HttpRequestParser.h
+#ifndef HTTPREQUESTPARSER_H
+#define HTTPREQUESTPARSER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QUrlQuery>
+
+/**
+ * @brief One parsed HTTP/1.x request.
+ */
+struct HttpRequest {
+    QByteArray method;
+    QByteArray target;                   // raw request-target, e.g. "/search?q=a%20b"
+    QString path;                        // decoded path without query
+    QUrlQuery query;
+    int minorVersion = 1;                // HTTP/1.<minorVersion>
+    QHash<QByteArray, QByteArray> headers; // names lower-cased
+    QByteArray body;
+
+    QByteArray header(const QByteArray &lowerCaseName) const { return headers.value(lowerCaseName); }
+    // HTTP/1.1 defaults to persistent connections, HTTP/1.0 has to ask for it
+    bool keepAlive() const;
+};
+
+/**
+ * @brief Incremental HTTP/1.x request parser for AuthServer.
+ *
+ * Bytes are fed as they arrive; a request may span any number of reads and
+ * one read may carry several pipelined requests. The header terminator is
+ * searched only in bytes not scanned before, so slow clients do not cause
+ * quadratic rescans. Bodies require Content-Length (no chunked uploads).
+ */
+class HttpRequestParser
+{
+public:
+    enum class Status { NeedMoreData, Complete, Error };
+
+    static constexpr qsizetype MaxHeaderBytes = 16 * 1024;
+    static constexpr qsizetype MaxBodyBytes = 1024 * 1024;
+
+    // Appends data and tries to complete the next request
+    Status feed(const QByteArray &data);
+    // Tries to complete the next request from already buffered bytes (pipelining)
+    Status next();
+    HttpRequest takeRequest();
+
+    // Suggested response status after Error (400, 413, 431, 501, 505)
+    int errorStatus() const { return m_errorStatus; }
+    QByteArray errorReason() const { return m_errorReason; }
+
+    void reset();
+
+private:
+    enum class State { Head, Body, Done, Failed };
+
+    Status fail(int status, const QByteArray &reason);
+    bool parseHead(const QByteArray &head);
+
+    QByteArray m_buffer;
+    qsizetype m_scanFrom = 0;     // where the next search for "\r\n\r\n" starts
+    qsizetype m_contentLength = 0;
+    State m_state = State::Head;
+    HttpRequest m_request;
+    int m_errorStatus = 0;
+    QByteArray m_errorReason;
+};
+
+#endif // HTTPREQUESTPARSER_H
@@ -0,0 +1,113 @@
+// LibraryIndex.h
+#ifndef LIBRARYINDEX_H
+#define LIBRARYINDEX_H
+
+#include <QHash>
+#include <QMultiHash>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+/**
+ * @brief Persistent per-file facts about the local library that are
+ * expensive to recompute: the tags read by the scan, the audio payload hash
+ * and the file identity used to follow renames and moves.
+ *
+ * Records are keyed by path and only trusted while size and mtime still
+ * match, so a rescan only reads tags of files that changed. A file that
+ * disappeared from one path and shows up at another is matched by
+ * (device, inode), or by size + mtime across filesystems, and confirmed
+ * with a cheap payload fingerprint before its record is carried over.
+ *
+ * Cover art is stored once per distinct image, keyed by its content hash;
+ * records and tracks only carry the "coverId". All methods are
+ * thread-safe; scan and hashing workers use the index concurrently.
+ */
+class LibraryIndex
+{
+public:
+    struct FileStat {
+        quint64 device = 0;    // 0 when the platform has no inode identity
+        quint64 inode = 0;
+        qint64 size = 0;
+        qint64 modified = 0;   // ms since epoch
+    };
+
+    struct Record {
+        qint64 size = 0;
+        qint64 modified = 0;
+        quint64 device = 0;
+        quint64 inode = 0;
+        quint64 fingerprint = 0; // AudioPayload::fingerprint, 0 if not taken
+        quint64 audioHash = 0;   // XXH64 of the audio frames, 0 if not hashed yet
+        quint64 coverKey = 0;    // key into the cover table, 0 if no cover
+        QVariantMap tags;        // readId3Tags() output without path/cover bytes/bpm
+    };
+
+    LibraryIndex();
+
+    static bool statFile(const QString &filePath, FileStat *stat);
+
+    // Fills record and returns true if filePath has a record matching stat
+    bool lookupFresh(const QString &filePath, const FileStat &stat, Record *record = nullptr) const;
+
+    // Stores the tags of a freshly read file (keeps a still valid audio hash)
+    void storeTags(const QString &filePath, const FileStat &stat, quint64 fingerprint, const QVariantMap &tags);
+    void storeAudioHash(const QString &filePath, const FileStat &stat, quint64 audioHash);
+    // Cached tags with filePath re-attached; empty if none cached
+    QVariantMap cachedTags(const QString &filePath) const;
+
+    // Moves readTags()' cover bytes out of tags into the cover table ("coverId" stays)
+    void takeCover(QVariantMap *tags);
+    // Original cover bytes, empty if unknown
+    QByteArray coverData(const QString &coverId, QString *mimeType = nullptr) const;
+    QStringList coverIds() const;
+
+    // Previous path of a moved/renamed file, verified by identity and fingerprint.
+    // Paths in stillPresent (or existing on disk) are never treated as moved away.
+    QString findMovedFrom(const QString &filePath, const FileStat &stat, const QSet<QString> &stillPresent) const;
+    // Re-keys a record to its new path and identity
+    void rename(const QString &oldPath, const QString &newPath, const FileStat &stat);
+
+    // Drops records of files that are neither in livePaths nor on disk anymore
+    void prune(const QSet<QString> &livePaths);
+    // Forgets every record, so the next scan reads all tags again
+    void clear();
+    int size() const;
+    // Estimated heap use of records and covers, for the diagnostics pane
+    qint64 memoryUsage() const;
+
+    // Re-keys records under fromPrefix to toPrefix, e.g. an index built on the
+    // file server for clients that mount the share elsewhere. Device/inode are
+    // dropped for re-keyed records (they name the server's filesystem).
+    int rebase(const QString &fromPrefix, const QString &toPrefix);
+
+    // Index file location; AppDataLocation/library.index unless set before load()
+    void setFilePath(const QString &filePath);
+    QString filePath() const { return indexFilePath(); }
+
+    void load();
+    bool save() const; // false if the file could not be written
+
+private:
+    using Identity = QPair<quint64, quint64>;   // (device, inode)
+    using Signature = QPair<qint64, qint64>;    // (size, mtime)
+
+    QString indexFilePath() const;
+    void insertLocked(const QString &filePath, const Record &record);
+    void removeLocked(const QString &filePath);
+    quint64 storeCoverLocked(const QVariantMap &tags);
+
+    mutable QMutex m_mutex;
+    QHash<QString, Record> m_records;
+    QHash<Identity, QString> m_byIdentity;
+    QMultiHash<Signature, QString> m_bySignature;
+    QHash<quint64, QPair<QString, QByteArray>> m_covers; // coverId -> (mime type, image bytes)
+    mutable bool m_dirty = false;
+    QString m_filePath;
+};
+
+#endif // LIBRARYINDEX_H
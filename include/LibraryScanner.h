@@ -0,0 +1,86 @@
+// LibraryScanner.h
+#ifndef LIBRARYSCANNER_H
+#define LIBRARYSCANNER_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+#include "TrackMatcher.h"
+
+class LibraryIndex;
+class ScanQuarantine;
+
+struct LibraryScanResults {
+    QList<QVariantMap> cachedTracks;
+    QSet<QString> uniqueArtists;
+    QSet<QString> uniqueAlbums;
+    QHash<QString, int> albumTrackCounts;
+    QHash<QString, QString> movedPaths; // old path -> new path
+    int reusedTags = 0;
+    int readTags = 0;
+    int isolatedReads = 0;              // read by the out-of-process worker
+    int quarantined = 0;                // skipped (or newly failed): file name only
+    TrackMatcher matcher;               // built off the GUI thread
+};
+
+/**
+ * @brief The library scan without any GUI dependency: directory walk,
+ * TagLib reads and LibraryIndex bookkeeping.
+ *
+ * Used by LocalMusicManager on a worker thread and by the librify-index
+ * tool (tools/), which prebuilds the index next to the music share so
+ * desktop clients start from a warm index. Roots are grouped by storage
+ * device (StorageScheduler): each device is walked and read by its own
+ * pool, sized for its media, and devices run in parallel. Moved files are
+ * matched sequentially so two new paths never claim the same record.
+ *
+ * Tag reads have budgets: files that are huge, declare a huge ID3v2 tag or
+ * do not look like MPEG audio are read by TagProbe in a separate process
+ * that is killed after ProbeTimeoutMs, covers above MaxPictureBytes are
+ * dropped, and files that time out or crash the reader are recorded in
+ * the ScanQuarantine and not read again until they change. In-process
+ * reads are journaled in the quarantine, so a file that crashes the app
+ * is isolated after the restart, and one still running after StuckReadMs
+ * is left to its thread and read by the probe instead.
+ * Detected tempo is not part of the core scan (see TempoAnalyzer).
+ */
+class LibraryScanner
+{
+public:
+    // Per-file budgets
+    static constexpr qint64 MaxInProcessBytes = 256ll * 1024 * 1024;   // larger files are read in isolation
+    static constexpr qint64 MaxInProcessTagBytes = 16ll * 1024 * 1024; // declared ID3v2 tag size
+    static constexpr qint64 MaxPictureBytes = 4ll * 1024 * 1024;       // larger covers are dropped
+    static constexpr int SlowReadMs = 2000;      // slower in-process reads are isolated next time
+    static constexpr int StuckReadMs = 10000;    // in-process reads still running after this go to the probe
+    static constexpr int ProbeTimeoutMs = 5000;  // isolated reads are killed after this
+    static constexpr int IsolatedWorkers = 2;
+
+    explicit LibraryScanner(LibraryIndex *index, ScanQuarantine *quarantine = nullptr);
+
+    // Blocking; call from a worker thread. Roots may overlap and span devices.
+    LibraryScanResults scan(const QStringList &rootPaths) const;
+
+    static void recursiveScan(const QString &folderPath, QStringList &foundMp3Files);
+    // TagLib read of one file; falls back to file name/unknowns if the tags are unreadable.
+    // An embedded cover comes as raw "imageData"/"imageMimeType" plus its "coverId";
+    // LibraryIndex::takeCover() moves it into the index's cover table.
+    static QVariantMap readTags(const QString &filePath);
+    // Title from the file name, unknown artist/album; what skipped files get
+    static QVariantMap fallbackTags(const QString &filePath);
+    // True if the file should not be parsed in-process (size or header, see MaxInProcess*)
+    static bool isRisky(const QString &filePath, qint64 size);
+    // Content hash of a cover image, 16 hex digits
+    static QString coverIdFor(const QByteArray &imageData);
+    static QStringList splitArtistName(const QString &artistName);
+
+private:
+    LibraryIndex *m_index;
+    ScanQuarantine *m_quarantine;
+};
+
+#endif // LIBRARYSCANNER_H
@@ -14,70 +14,163 @@
 #include <QtConcurrent>  
 #include <QSet>
 #include <QHash>
+#include <QElapsedTimer>
+
+#include "DuplicateDetector.h"
+#include "FolderTree.h"
+#include "LibraryIndex.h"
+#include "LibraryScanner.h"
+#include "ScanQuarantine.h"
+#include "SidebarModel.h"
+#include "TagEditJournal.h"
+#include "TagWriteQueue.h"
+#include "TempoAnalyzer.h"
+#include "TrackMatcher.h"
 
 class TrackListModel;
 const QString ALL_TRACKS_IDENTIFIER = QStringLiteral("*ALL_TRACKS*");
+const QString DUPLICATES_IDENTIFIER = QStringLiteral("*DUPLICATES*");
 
 class LocalMusicManager : public QObject
 {
     Q_OBJECT
-    Q_PROPERTY(QVariantList sidebarItems READ sidebarItems NOTIFY sidebarItemsChanged)
+    Q_PROPERTY(SidebarModel *sidebarModel READ sidebarModel CONSTANT)
 	Q_PROPERTY(QString defaultMusicPath READ defaultMusicPath WRITE setDefaultMusicPath NOTIFY defaultMusicPathChanged)
+    Q_PROPERTY(QStringList extraLibraryRoots READ extraLibraryRoots WRITE setExtraLibraryRoots NOTIFY extraLibraryRootsChanged)
+    Q_PROPERTY(bool canUndoTags READ canUndoTags NOTIFY tagUndoChanged)
+    Q_PROPERTY(QString undoTagsLabel READ undoTagsLabel NOTIFY tagUndoChanged)
 
 public:
     explicit LocalMusicManager(QObject *parent = nullptr);
     ~LocalMusicManager(); // Add destructor for watcher cleanup later maybe
-    QVariantList sidebarItems() const;
-    QStringList splitArtistName(const QString &artistName);
+    SidebarModel *sidebarModel();
+    // Index, quarantine and tag journal; deferred past the first frame (see main.cpp)
+    void loadStateAsync();
+    static QStringList splitArtistName(const QString &artistName);
 	QString defaultMusicPath() const;
+    // Folders scanned along with the default one, possibly on other disks
+    QStringList extraLibraryRoots() const { return m_extraLibraryRoots; }
+    // Default folder first, then the extra roots (duplicates dropped)
+    QStringList libraryRoots() const;
+    // Spotify tracks with local files substituted where the library has them
+    Q_INVOKABLE QVariantList resolveSpotifyTracks(const QVariantList &spotifyTracks) const;
+    // Tracks whose title/artist/album contain every word of query (no cover data)
+    Q_INVOKABLE QVariantList searchTracks(const QString &query, int limit = 50) const;
+    QVariantMap trackForPath(const QString &filePath) const;
+    // Estimated heap use, for the diagnostics pane (main thread)
+    qint64 libraryMemoryUsage() const; // track cache, lookup hashes and sidebar items
+    qint64 indexMemoryUsage() const { return m_libraryIndex.memoryUsage(); }
+    // Holds every distinct cover; thread-safe (ThumbnailCache reads it from workers)
+    const LibraryIndex &libraryIndex() const { return m_libraryIndex; }
+    // Sets fields (title, artist, album, genre, year, track) on every library track
+    // in filePaths: written in parallel, one tracksPatched, journaled for undo.
+    // Returns the number of tracks queued.
+    Q_INVOKABLE int writeBatchTags(const QStringList &filePaths, const QVariantMap &fields);
+    Q_INVOKABLE bool undoLastTagBatch();
+    bool canUndoTags() const { return !m_tagJournal.isEmpty() && m_undoTagBatches.isEmpty(); }
+    QString undoTagsLabel() const { return m_tagJournal.lastLabel(); }
 
 public slots:
     void selectAndScanParentFolderForArtists();
     Q_INVOKABLE void scanDefaultMusicFolder();
     void loadTracksFor(const QString &identifier, const QString &type);
+    // ARTISTS, ALBUMS, GENRES, YEARS, DECADES, FOLDERS or TEMPO
     void setGrouping(const QString &grouping);
+    // Opens/closes a folder row of the FOLDERS grouping
+    Q_INVOKABLE void toggleFolder(const QString &folderPath);
+    // Returns at once: the model is updated optimistically, the file in the background
     void writeTrackTags(const QString &filePath, const QString &title,
                         const QString &artist, const QString &album,
                         const QString &imagePath);
 	void setDefaultMusicPath(const QString &filePath);
+    void setExtraLibraryRoots(const QStringList &rootPaths);
 
 private slots: 
     void handleScanFinished();
+    void handleTempoBatch(const QHash<QString, double> &bpmByPath);
+    void handleDuplicatesFound();
+    void handleTagWriteFinished(int jobId, const QString &filePath, const QVariantMap &tags);
+    void handleTagWriteFailed(int jobId, const QString &filePath, const QString &error);
+    void handleTagBatchFinished(int batchId, const QList<QVariantMap> &tags, const QHash<QString, QString> &errors);
 
 signals:
 	void defaultMusicPathChanged();
-    void sidebarItemsChanged();
+    void extraLibraryRootsChanged();
     void loadingError(const QString &errorMsg);
     void loadingProgress(int current, int total);
     void tracksReadyForDisplay(const QVariantList& loadedTracks);
     void scanStateChanged(bool isScanning);
     void trackUpdated(const QVariantMap &updatedTrack);
+    void tracksPatched(const QVariantList &updatedTracks);
+    void libraryPathsMoved(const QHash<QString, QString> &movedPaths); // old path -> new path
+    void tagUndoChanged();
+    void stateLoaded();
 
 private:
-    struct ScanResults {
-        QList<QVariantMap> cachedTracks;
-        QSet<QString> uniqueArtists;
-        QSet<QString> uniqueAlbums;
-		QHash<QString, int> albumTrackCounts;
-    };
-    void startScanProcess(const QString& folderPath);
-    ScanResults performBackgroundScan(QString parentFolderPath); 
-    QVariantMap readId3Tags(const QString& filePath);
-    void recursiveScan(const QString& folderPath, QStringList& foundMp3Files);
+    friend class LibrifyBench; // bench/LibrifyBench.cpp times the private hot paths
+    friend class UiStressBench; // bench/UiStressBench.cpp installs a synthetic library
+
+    using ScanResults = LibraryScanResults;
+    void startScanProcess(const QStringList& rootPaths);
+    ScanResults performBackgroundScan(QStringList rootPaths);
+    QVariantMap readId3Tags(const QString& filePath); // LibraryScanner::readTags plus cached BPM, cover moved to the index
 	void rebuildSidebarModel();
+    QList<SidebarModel::Item> buildSidebarItems() const;
+    void addArtistIndex(const QString &artist, int index);
+    void removeArtistIndex(const QString &artist, int index);
+    void addAlbumIndex(const QString &album, int index);
+    void removeAlbumIndex(const QString &album, int index);
+    void addTempoIndex(int bucket, int index);
+    void removeTempoIndex(int bucket, int index);
+    void addGenreIndex(const QString &genre, int index);
+    void removeGenreIndex(const QString &genre, int index);
+    void addYearIndex(int year, int index);    // also the decade
+    void removeYearIndex(int year, int index);
+    bool updateCachedTrack(const QVariantMap &track);
+    bool replaceCachedTrack(int index, const QVariantMap &track);
+    int startTagBatch(const QList<TagWriteQueue::Edit> &edits); // returns the TagWriteQueue batch id
+    static int tempoBucket(double bpm);
 
     // Member variables
 	QString m_defaultMusicPath;
-    QVariantList m_sidebarItems;
-    QString m_selectedParentFolder;
+    SidebarModel m_sidebarModel;
+    QString m_selectedParentFolder;      // first of m_scanRoots
+    QStringList m_scanRoots;
+    QStringList m_extraLibraryRoots;
     void scanForArtists(const QString& parentFolderPath);
     QList<QVariantMap> m_cachedFullTrackData; // Use specific type for cache is fine
     QMultiHash<QString, int> m_artistIndexHash;
 	QMultiHash<QString, int> m_albumIndexHash;
     QHash<QString, int> m_albumTrackCounts;
+    QHash<QString, int> m_pathIndexHash;     // filePath -> index in m_cachedFullTrackData
+    QMultiHash<int, int> m_tempoIndexHash;   // 10 BPM bucket start -> track index
+    QList<int> m_duplicateIndices;           // duplicate groups flattened, group members adjacent
+    QStringList m_sortedArtists;             // sidebar keys, kept sorted as the indices change
+    QStringList m_sortedAlbums;
+    QList<int> m_sortedTempoBuckets;
+    QMultiHash<QString, int> m_genreIndexHash; // empty genre is not indexed
+    QMultiHash<int, int> m_yearIndexHash;      // year 0 (unknown) is not indexed
+    QMultiHash<int, int> m_decadeIndexHash;    // 1990 -> tracks from 1990-1999
+    QStringList m_sortedGenres;
+    QList<int> m_sortedYears;
+    QList<int> m_sortedDecades;
+    FolderTree m_folderTree;
     QString m_currentGrouping;
+    QElapsedTimer m_scanTimer;
 
     QFutureWatcher<ScanResults> m_scanWatcher;
+    QFutureWatcher<QList<DuplicateDetector::Group>> m_duplicateWatcher;
+    QFuture<void> m_stateLoad;
+    QFutureWatcher<void> m_stateWatcher;
+    LibraryIndex m_libraryIndex;
+    ScanQuarantine m_scanQuarantine; // files that stalled or crashed the tag reader
+    TrackMatcher m_trackMatcher;
+    TempoAnalyzer m_tempoAnalyzer;
+    TagWriteQueue m_tagWriter;
+    QHash<int, QVariantMap> m_pendingTagWrites; // job id -> track as it was before the edit
+    QHash<int, QHash<QString, QVariantMap>> m_pendingTagBatches; // batch id -> filePath -> track before
+    TagEditJournal m_tagJournal;
+    QHash<int, QDateTime> m_undoTagBatches; // batch id -> time of the journal batch it restores
 };
 
 #endif // LOCALMUSICMANAGER_H
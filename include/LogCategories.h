@@ -0,0 +1,19 @@
+// LogCategories.h
+#ifndef LOGCATEGORIES_H
+#define LOGCATEGORIES_H
+
+#include <QLoggingCategory>
+
+// Hot-path logging. Debug output is off by default; enable per area with
+// QT_LOGGING_RULES="librify.sort.debug=true". Release builds define
+// QT_NO_DEBUG_OUTPUT, which compiles qCDebug out entirely.
+Q_DECLARE_LOGGING_CATEGORY(lcScan)      // librify.scan: directory walk, scan results
+Q_DECLARE_LOGGING_CATEGORY(lcTags)      // librify.tags: per-file TagLib reads
+Q_DECLARE_LOGGING_CATEGORY(lcIndex)     // librify.index: library index load/save
+Q_DECLARE_LOGGING_CATEGORY(lcSort)      // librify.sort: TrackListModel sorting and resets
+Q_DECLARE_LOGGING_CATEGORY(lcLoad)      // librify.load: loadTracksFor
+Q_DECLARE_LOGGING_CATEGORY(lcPlaylist)  // librify.playlist: playlist files
+Q_DECLARE_LOGGING_CATEGORY(lcSpectrum)  // librify.spectrum: SpectrumAnalyzer capture and bands
+Q_DECLARE_LOGGING_CATEGORY(lcFrames)    // librify.frames: long frames (render thread)
+
+#endif // LOGCATEGORIES_H
@@ -0,0 +1,76 @@
+// MetricsRegistry.h
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+#include "HdrHistogram.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QVariantMap>
+#include <atomic>
+#include <functional>
+
+/**
+ * @brief Process-wide performance metrics, recorded lock-free from any thread.
+ *
+ * Shown live in the diagnostics pane (DiagnosticsMonitor), exported as a JSON
+ * snapshot for bug reports and appended to the control endpoint's /metrics.
+ */
+namespace Metrics {
+// Library scan (LibraryScanner::scan), one value per scan
+inline HdrHistogram scanFilesPerSecond;
+inline HdrHistogram scanBytesPerSecond;   // sum of the scanned files' sizes
+inline HdrHistogram indexBuildMicros;     // index lookups, move detection and tag reads
+inline HdrHistogram indexLoadMicros;      // LibraryIndex::load
+inline HdrHistogram tagReadMicros;        // one TagLib read
+inline std::atomic<quint64> scannedFiles{0};
+inline std::atomic<quint64> scannedBytes{0};
+inline std::atomic<quint64> isolatedReads{0};     // tag reads in the out-of-process worker
+inline std::atomic<quint64> quarantinedFiles{0};  // skipped or failed, file name only
+inline HdrHistogram scanMicros;           // folder scan, start to results applied
+
+// Startup (StartupProfiler): process start to first frame
+inline HdrHistogram startupMicros;
+
+// Frames (FrameTimeMonitor): swap to swap, and beforeRendering to swap
+inline HdrHistogram frameMicros;
+inline HdrHistogram frameRenderMicros;
+inline std::atomic<quint64> longFrames{0};
+inline std::atomic<quint64> longFramesAfterReset{0};     // a model handed QML a new list since the last frame
+inline std::atomic<quint64> longFramesWithDelegates{0};  // delegates were created since the last frame
+
+// Track list
+inline HdrHistogram sortMicros;           // TrackListModel::applySort
+inline HdrHistogram tracksChangedTracks;  // tracks QML re-reads per tracksChanged
+
+// Playback and control endpoint
+inline HdrHistogram playbackStartMicros;  // new media source to PlayingState
+inline HdrHistogram httpRequestMicros;    // AuthServer request handling
+
+// Cover thumbnails (ThumbnailCache): served from memory/disk vs. scaled from the original
+inline std::atomic<quint64> coverCacheHits{0};
+inline std::atomic<quint64> coverCacheMisses{0};
+}
+
+class MetricsRegistry
+{
+public:
+    // Returns the bytes a subsystem currently holds; called on the snapshot's thread
+    using MemoryProbe = std::function<qint64()>;
+    static void addMemoryProbe(const QString &subsystem, MemoryProbe probe);
+
+    // {system, histograms, counters, memory}; histograms carry count/min/max/mean/p50/p90/p99
+    static QVariantMap snapshot();
+    static QByteArray snapshotJson();
+    static void reset();
+
+    // Prometheus summaries and gauges for everything above
+    static void appendPrometheus(QByteArray &out);
+
+    // Resident set size of the process, -1 where unsupported
+    static qint64 residentMemoryBytes();
+    // Rough heap footprint of a value; implicitly shared data is counted by every holder
+    static qint64 estimateBytes(const QVariant &value);
+};
+
+#endif // METRICSREGISTRY_H
@@ -0,0 +1,29 @@
+// PcmDecoder.h
+#ifndef PCMDECODER_H
+#define PCMDECODER_H
+
+#include <QString>
+#include <QAudioBuffer>
+#include <atomic>
+#include <vector>
+
+/**
+ * @brief Blocking decode of an audio file to mono float PCM.
+ *
+ * Meant for background analysis jobs (waveforms, tempo): it spins a local
+ * event loop for QAudioDecoder, so call it from a worker thread only.
+ */
+namespace PcmDecoder {
+
+// Decodes up to maxDurationMs (or the whole file when <= 0) starting at
+// startMs. Returns an empty vector on failure or when cancel becomes true.
+std::vector<float> decodeMono(const QString &filePath, int sampleRate,
+                              qint64 startMs = 0, qint64 maxDurationMs = -1,
+                              const std::atomic_bool *cancel = nullptr);
+
+// Downmixes any supported QAudioBuffer sample format and appends it to out.
+void appendMono(const QAudioBuffer &buffer, std::vector<float> &out);
+
+} // namespace PcmDecoder
+
+#endif // PCMDECODER_H
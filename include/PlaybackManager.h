@@ -5,6 +5,9 @@
 #include <QMediaPlayer>
 #include <QAudioOutput>
 #include <QPointer>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVariantMap>
 #include <QtQml/qqmlregistration.h>
 
 class PlaybackManager : public QObject
@@ -15,6 +18,8 @@ class PlaybackManager : public QObject
     Q_PROPERTY(bool muted READ muted WRITE setMuted NOTIFY mutedChanged)
     // *** ADD READINESS PROPERTY ***
     Q_PROPERTY(bool ready READ ready NOTIFY readyChanged)
+    // Files to play before continuing with the track list (e.g. POST /queue)
+    Q_PROPERTY(QStringList queue READ queue NOTIFY queueChanged)
 
 public:
     explicit PlaybackManager(QObject *parent = nullptr);
@@ -23,22 +28,37 @@ public:
     bool muted() const;
     // *** Add getter for ready property ***
     bool ready() const;
+    QStringList queue() const;
+    // Source, state, position and duration of the player, for the control endpoint
+    QVariantMap nowPlaying() const;
 
     Q_INVOKABLE void setMediaPlayer(QMediaPlayer* player);
+    // Pops the next queued file; empty when the queue is empty
+    Q_INVOKABLE QString takeQueuedTrack();
 
 public slots:
     void setVolume(double volume);
     void setMuted(bool muted);
+    void play();
+    void pause();
+    void requestNext();
+    void enqueue(const QString &filePath);
 
 signals:
     void volumeChanged();
     void mutedChanged();
     // *** Add signal for readiness ***
     void readyChanged();
+    void queueChanged();
+    // Track selection lives in Main.qml; these ask it to act
+    void playRequested();
+    void nextRequested();
 
 private slots:
     void onAudioOutputVolumeChanged(qreal volume);
     void onAudioOutputMutedChanged(bool muted);
+    void onSourceChanged();
+    void onPlaybackStateChanged(QMediaPlayer::PlaybackState state);
 
 private:
     QPointer<QMediaPlayer> m_mediaPlayer = nullptr;
@@ -47,6 +67,8 @@ private:
     bool m_muted = false;
     // *** Add member for readiness state ***
     bool m_ready = false; // Start as not ready
+    QStringList m_queue;
+    QElapsedTimer m_startLatencyTimer; // new source -> PlayingState
 };
 
 #endif // PLAYBACKMANAGER_H
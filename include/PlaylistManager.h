@@ -9,6 +9,11 @@
 #include <QDir>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QHash>
+#include <QFutureWatcher>
+
+#include "PlaylistSync.h"
+#include "SidebarModel.h"
 
 struct Playlist {
 	QString id;
@@ -26,12 +31,15 @@ struct Playlist {
 class PlaylistManager : public QObject
 {
     Q_OBJECT
-	Q_PROPERTY(QVariantList sidebarItems READ sidebarItems NOTIFY sidebarItemsChanged)
+	Q_PROPERTY(SidebarModel *sidebarModel READ sidebarModel CONSTANT)
+	Q_PROPERTY(bool exporting READ isExporting NOTIFY exportingChanged)
 
 public:
 	explicit PlaylistManager(QObject *parent = nullptr);
+	// Parses the playlist files on a worker thread, then fills the sidebar model
+	void loadPlaylistsAsync();
 
-	QVariantList sidebarItems() const;
+	SidebarModel *sidebarModel() { return &m_sidebarModel; }
 	Q_INVOKABLE QVariantList getPlaylists() const;
     Q_INVOKABLE void refreshSidebarItems();
 
@@ -42,8 +50,21 @@ public:
 	Q_INVOKABLE void addTrack(const QString &playlistName, const QString &trackFilePath);
 	Q_INVOKABLE void removeTrack(const QString &playlistName, const QString &trackFilePath);
 
+	// Mirrors the named playlists into targetDir (a mounted phone, an SD card) in the
+	// background, see PlaylistSync. sourceRoots are the library roots, for the layout
+	// below Music/. False if an export is already running.
+	Q_INVOKABLE bool exportPlaylists(const QStringList &names, const QString &targetDir, const QStringList &sourceRoots);
+	bool isExporting() const { return m_exportWatcher.isRunning(); }
+
 signals:
-	void sidebarItemsChanged();
+	void playlistsLoaded();
+	void exportingChanged();
+	void exportProgress(int done, int total);
+	void exportFinished(const QVariantMap &summary); // PlaylistSync::Result::toVariantMap()
+
+public slots:
+	// Rewrites track references of moved/renamed files (old path -> new path) in every playlist
+	void remapTrackPaths(const QHash<QString, QString> &movedPaths);
 
 private:
 	QString playlistsDirPath() const;
@@ -52,9 +73,14 @@ private:
 	void savePlaylist(const QString &name, const QJsonObject &playlistObj);
 
 	void loadPlaylists();
+	static QList<SidebarModel::Item> readPlaylistItems(const QString &dirPath);
+	static QStringList readPlaylistTracks(const QString &filePath);
+	void updatePlaylistCount(const QString &name, int count);
 
 	QList<Playlist> m_playlists;
-	QVariantList m_sidebarItems;
+	SidebarModel m_sidebarModel;
+	QFutureWatcher<QList<SidebarModel::Item>> m_loadWatcher;
+	QFutureWatcher<PlaylistSync::Result> m_exportWatcher;
 };
 #endif // PLAYLISTMANAGER_H
 
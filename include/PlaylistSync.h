@@ -0,0 +1,96 @@
+// PlaylistSync.h
+#ifndef PLAYLISTSYNC_H
+#define PLAYLISTSYNC_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <functional>
+
+/**
+ * @brief Mirrors playlists into a folder on another device (a mounted
+ * phone, an SD card) and keeps it up to date incrementally.
+ *
+ * Tracks are laid out below Music/ as they sit below their library root,
+ * with names made safe for FAT/exFAT; every playlist becomes an M3U8 file
+ * in the target folder with paths relative to it. A manifest there
+ * (.librify-sync) remembers the source size and mtime of each copied file
+ * and which playlists use it, so a re-sync stats both sides and copies
+ * only what changed. Files no longer used by any synced playlist are
+ * deleted; playlists synced earlier but not part of this run are left
+ * alone, and so are copies whose source is missing (an unmounted root),
+ * which stay in their playlists.
+ *
+ * Checks run on the global thread pool, copies on a pool as wide as the
+ * target device takes (StorageScheduler). A copy is a reflink (FICLONE)
+ * or an in-kernel copy_file_range where the filesystems allow it, a plain
+ * read/write loop otherwise, and always goes through a temporary file so
+ * an unplugged device never holds a half-written track under its real
+ * name. No GUI dependency.
+ */
+class PlaylistSync
+{
+public:
+    struct Playlist {
+        QString name;
+        QStringList tracks; // source paths, in playlist order
+    };
+
+    struct Result {
+        int tracks = 0;      // distinct source files across the playlists
+        int copied = 0;
+        int cloned = 0;      // of copied: reflinked or copied by the kernel
+        int upToDate = 0;
+        int missing = 0;     // source file not found; a copy synced earlier stays on the device
+        int failed = 0;
+        int removed = 0;     // target files no synced playlist uses anymore
+        qint64 bytesCopied = 0;
+        qint64 elapsedMs = 0;
+        QStringList playlistFiles; // M3U8 files, relative to the target folder
+        QStringList errors;
+
+        QVariantMap toVariantMap() const;
+    };
+
+    enum class CopyMethod { Clone, Kernel, Stream };
+
+    // Once with done = 0 before any work, then from worker threads as tracks
+    // are found up to date or copied (not necessarily in increasing order)
+    using Progress = std::function<void(int done, int total)>;
+
+    // sourceRoots: library roots, for the layout below Music/
+    PlaylistSync(const QString &targetDir, const QStringList &sourceRoots);
+
+    Result run(const QList<Playlist> &playlists, const Progress &progress = {});
+
+    // "Music/<path below its root>", FAT-safe; tracks outside every root go below Music/Other/
+    QString targetPathFor(const QString &sourcePath) const;
+    // Drops characters FAT/exFAT reject and trailing dots/spaces
+    static QString safeFileName(const QString &name);
+
+    // Copies source over target via a temporary file and keeps source's mtime
+    static bool copyFile(const QString &source, const QString &target, CopyMethod *method, QString *error);
+
+private:
+    struct ManifestEntry {
+        QString target;         // relative to m_targetDir
+        qint64 sourceSize = -1; // -1: copy again on the next run
+        qint64 sourceModified = 0;
+        QStringList playlists;
+    };
+
+    QString manifestFilePath() const;
+    void loadManifest();
+    bool saveManifest() const;
+    // Writes only when the content differs, so unchanged playlists keep their mtime
+    bool writePlaylistFile(const QString &relativePath, const QByteArray &content, QString *error) const;
+    void removeTarget(const QString &relativePath) const;
+
+    QString m_targetDir;
+    QStringList m_sourceRoots;
+    QHash<QString, ManifestEntry> m_manifest; // by source path
+};
+
+#endif // PLAYLISTSYNC_H
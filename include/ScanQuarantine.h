@@ -0,0 +1,78 @@
+// ScanQuarantine.h
+#ifndef SCANQUARANTINE_H
+#define SCANQUARANTINE_H
+
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "LibraryIndex.h"
+
+/**
+ * @brief Files that misbehaved during a scan, so later scans do not pay
+ * for them again.
+ *
+ * A file that timed out or crashed the isolated tag reader is skipped
+ * (file name as title, no TagLib) until its size or mtime changes; one
+ * that was merely slow in-process is read in isolation next time.
+ *
+ * In-process reads can take the whole app down, so they are journaled:
+ * beginRead() appends the file to scan-quarantine.dat.reading before
+ * TagLib opens it and endRead() after. load() finds the reads a crashed
+ * run left open and isolates those files ("interrupted"); a file left
+ * open twice is skipped ("crash"). Written to
+ * AppDataLocation/scan-quarantine.dat; thread-safe, the scan workers
+ * consult it.
+ */
+class ScanQuarantine
+{
+public:
+    enum class Verdict { None, Isolate, Skip };
+
+    struct Entry {
+        qint64 size = 0;
+        qint64 modified = 0;
+        QString reason;     // "timeout", "crash" (skipped), "slow" or "interrupted" (isolated)
+        QDateTime time;
+    };
+
+    ScanQuarantine();
+
+    // Quarantine file location; AppDataLocation/scan-quarantine.dat unless set before load()
+    void setFilePath(const QString &filePath);
+    void load();
+    bool save() const;
+
+    // None once the file changed since it was quarantined
+    Verdict check(const QString &filePath, const LibraryIndex::FileStat &stat) const;
+    void add(const QString &filePath, const LibraryIndex::FileStat &stat, const QString &reason);
+    // Drops entries below rootPaths whose file the scan no longer found
+    void prune(const QStringList &rootPaths, const QSet<QString> &scannedPaths);
+    int count() const;
+
+    // Around one in-process read; a read that never returns is simply never ended
+    void beginRead(const QString &filePath, const LibraryIndex::FileStat &stat);
+    void endRead(const QString &filePath);
+
+private:
+    QString quarantineFilePath() const;
+    QString journalFilePath() const;
+    void appendToJournal(bool begin, const QString &filePath, const LibraryIndex::FileStat &stat);
+    // Entries for the reads a previous run left open; true if there were any
+    bool recoverJournal();
+
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    QString m_filePath;
+    mutable bool m_dirty = false;
+
+    mutable QMutex m_journalMutex;
+    mutable QFile m_journal;
+    mutable int m_readsInFlight = 0;
+};
+
+#endif // SCANQUARANTINE_H
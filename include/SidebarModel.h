@@ -0,0 +1,81 @@
+// SidebarModel.h
+#ifndef SIDEBARMODEL_H
+#define SIDEBARMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+
+/**
+ * @brief Rows of one sidebar section (artists, albums, tempo buckets, playlists).
+ *
+ * setItems() turns the current rows into the new ones with row-level
+ * inserts, removes, moves and dataChanged, so QML keeps every delegate
+ * that is still on screen; rows are identified by type + id (a list with a
+ * key twice is reset instead). resetItems()
+ * is for wholesale switches (another grouping), where a diff would touch
+ * every row anyway. Folder rows carry their tree depth and expansion
+ * state. Icons are URLs (qrc:/ or image://covers/...), never
+ * inline image data.
+ */
+class SidebarModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Role {
+        TypeRole = Qt::UserRole + 1,
+        NameRole,
+        ItemIdRole,
+        IconSourceRole,
+        CountRole,
+        DepthRole,
+        HasChildrenRole,
+        ExpandedRole
+    };
+
+    struct Item {
+        QString type;
+        QString name;
+        QString id;
+        QString iconSource;
+        int count = 0;
+        int depth = 0;            // folder tree rows only
+        bool hasChildren = false;
+        bool expanded = false;
+        bool operator==(const Item &other) const = default;
+    };
+
+    explicit SidebarModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return int(m_items.size()); }
+    // {type, name, id, iconSource, count, depth, hasChildren, expanded}, empty for an invalid row
+    Q_INVOKABLE QVariantMap get(int row) const;
+    Q_INVOKABLE int indexOf(const QString &type, const QString &id) const;
+
+    const QList<Item> &items() const { return m_items; }
+    void setItems(const QList<Item> &items);
+    void resetItems(const QList<Item> &items);
+    // Replaces the row with the same type + id; false if there is none
+    bool updateItem(const Item &item);
+    // Same maps as get(), for every row
+    QVariantList toVariantList() const;
+
+    qint64 memoryUsage() const;
+
+signals:
+    void countChanged();
+
+private:
+    static QString keyOf(const Item &item);
+
+    QList<Item> m_items;
+};
+
+#endif // SIDEBARMODEL_H
@@ -0,0 +1,81 @@
+// SpectrumAnalyzer.h
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <QMediaPlayer>
+#include <QAudioBuffer>
+#include <QAudioBufferOutput>
+#include <array>
+#include <vector>
+
+#include "Fft.h"
+#include "TripleBuffer.h"
+
+/**
+ * @brief Taps the decoded PCM of the QML MediaPlayer through a
+ * QAudioBufferOutput and turns it into log-spaced magnitude bands.
+ *
+ * All analysis runs on a dedicated thread into preallocated buffers. Results
+ * are handed to the GUI through a TripleBuffer, so SpectrumView can pull the
+ * newest frame while painting without locking or allocating.
+ */
+class SpectrumAnalyzer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+    Q_PROPERTY(int bandCount READ bandCount CONSTANT)
+
+public:
+    static constexpr int FftSize = 2048;
+    static constexpr int HopSize = FftSize / 2;
+    static constexpr int BandCount = 48;
+    using Bands = std::array<float, BandCount>;
+
+    explicit SpectrumAnalyzer(QObject *parent = nullptr);
+    ~SpectrumAnalyzer();
+
+    bool active() const;
+    int bandCount() const { return BandCount; }
+
+    Q_INVOKABLE void setMediaPlayer(QMediaPlayer *player);
+
+    // GUI side: returns true and fills bands if a new frame is available
+    bool takeLatestBands(Bands &bands);
+
+public slots:
+    void setActive(bool active);
+
+signals:
+    void activeChanged();
+    void bandsPublished(); // emitted from the analysis thread
+
+private:
+    void attachOutput();
+    void processBuffer(const QAudioBuffer &buffer); // analysis thread only
+    void analyzeWindow();                            // analysis thread only
+    void rebuildBandEdges(int sampleRate);           // analysis thread only
+
+    QPointer<QMediaPlayer> m_mediaPlayer;
+    QAudioBufferOutput *m_bufferOutput = nullptr;
+    QThread m_analysisThread;
+    QObject *m_analysisContext = nullptr; // lives on m_analysisThread
+    bool m_active = false;
+
+    // --- Analysis thread state (preallocated) ---
+    Fft m_fft{FftSize};
+    std::vector<float> m_window;
+    std::vector<float> m_history;    // last FftSize mono samples
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+    std::array<int, BandCount + 1> m_bandEdges{};
+    Bands m_levels{};
+    int m_sampleRate = 0;
+    int m_pendingSamples = 0;
+
+    TripleBuffer<Bands> m_published;
+};
+
+#endif // SPECTRUMANALYZER_H
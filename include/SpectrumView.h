@@ -0,0 +1,44 @@
+// SpectrumView.h
+#ifndef SPECTRUMVIEW_H
+#define SPECTRUMVIEW_H
+
+#include <QQuickPaintedItem>
+#include <QPointer>
+#include <QColor>
+
+#include "SpectrumAnalyzer.h"
+
+/**
+ * @brief Paints the bands published by SpectrumAnalyzer.
+ *
+ * Each publish schedules an update(); Qt Quick coalesces those into at most
+ * one repaint per vsync. paint() pulls the newest frame into a fixed array,
+ * so drawing never allocates on the GUI thread.
+ */
+class SpectrumView : public QQuickPaintedItem
+{
+    Q_OBJECT
+    Q_PROPERTY(SpectrumAnalyzer* analyzer READ analyzer WRITE setAnalyzer NOTIFY analyzerChanged)
+    Q_PROPERTY(QColor barColor READ barColor WRITE setBarColor NOTIFY barColorChanged)
+
+public:
+    explicit SpectrumView(QQuickItem *parent = nullptr);
+
+    SpectrumAnalyzer *analyzer() const;
+    void setAnalyzer(SpectrumAnalyzer *analyzer);
+    QColor barColor() const;
+    void setBarColor(const QColor &color);
+
+    void paint(QPainter *painter) override;
+
+signals:
+    void analyzerChanged();
+    void barColorChanged();
+
+private:
+    QPointer<SpectrumAnalyzer> m_analyzer;
+    QColor m_barColor = QColor("#c0c0cc");
+    SpectrumAnalyzer::Bands m_bands{};
+};
+
+#endif // SPECTRUMVIEW_H
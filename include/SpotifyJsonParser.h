@@ -0,0 +1,59 @@
+// SpotifyJsonParser.h
+#ifndef SPOTIFYJSONPARSER_H
+#define SPOTIFYJSONPARSER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+#include <vector>
+
+/**
+ * @brief Only the fields of a Spotify track object that Librify uses.
+ */
+struct SpotifyTrack {
+    QString id;
+    QString uri;
+    QString title;
+    QStringList artists;
+    QString album;
+    QString imageUrl;   // first (largest) album image
+    QString isrc;
+    qint64 durationMs = 0;
+    bool isLocal = false; // "local file" entry of a Spotify playlist
+
+    // Same keys as LocalMusicManager tracks where they overlap
+    QVariantMap toVariantMap() const;
+};
+
+/**
+ * @brief Single-pass scanner for Spotify paging responses.
+ *
+ * Walks the raw bytes once and copies out only the fields above; everything
+ * else (available_markets, added_by, ...) is skipped without being
+ * materialized, so no QJsonDocument DOM is built for large pages. Pure
+ * functions, safe to call from worker threads.
+ */
+namespace SpotifyJsonParser {
+
+struct PageInfo {
+    int total = -1;
+    int limit = 0;
+    int offset = 0;
+    bool isValid() const { return total >= 0; }
+};
+
+// total/limit/offset of a paging object; the "items" array is skipped
+PageInfo pageInfo(const QByteArray &body);
+
+// Tracks of a paging object whose items are tracks or {"track": {...}} wrappers;
+// *ok is false on malformed JSON, with the tracks before the error returned
+std::vector<SpotifyTrack> parseTrackRecords(const QByteArray &body, bool *ok = nullptr);
+
+// parseTrackRecords() as maps; SpotifyPager's default Parser
+QVariantList parseTracks(const QByteArray &body, bool *ok = nullptr);
+
+} // namespace SpotifyJsonParser
+
+#endif // SPOTIFYJSONPARSER_H
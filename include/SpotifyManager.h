@@ -77,12 +77,6 @@ signals:
 private:
     // --- Private Helper Methods ---
 
-    // Parses the JSON response from Spotify's track endpoint
-    QVariantList parseTracksFromJson(const QByteArray& jsonData);
-
-    // Future enhancement: Helper for recursive track fetching (pagination)
-    // void fetchPaginatedTracks(const QUrl& nextUrl);
-
     // --- Member Variables ---
     QNetworkAccessManager *manager;       // Manages network requests
     QString accessToken;                  // Stores the current OAuth access token
@@ -0,0 +1,106 @@
+// SpotifyPager.h
+#ifndef SPOTIFYPAGER_H
+#define SPOTIFYPAGER_H
+
+#include <QObject>
+#include <QMap>
+#include <QUrl>
+#include <QVariantList>
+#include <functional>
+
+#include "SpotifyJsonParser.h"
+#include "SpotifyRequestScheduler.h"
+
+/**
+ * @brief Fetches every page of an offset-paginated Spotify endpoint
+ * (e.g. /v1/playlists/{id}/tracks) as fast as the API allows.
+ *
+ * The first page is requested alone to learn "total" and "limit". All other
+ * offsets are then requested in parallel, with at most maxConcurrentRequests
+ * in flight, through the shared SpotifyRequestScheduler (rate limiting,
+ * retries, coalescing). Pages can complete in any order. They are
+ * reassembled, and items are emitted strictly in playlist order as soon as
+ * a contiguous run is available. Page bodies are parsed on the global thread
+ * pool (SpotifyJsonParser::parseTracks unless setParser() says otherwise) and
+ * handed back by move; a page that does not parse fails the fetch.
+ *
+ * With setSnapshot() and a cache on the scheduler, a playlist whose
+ * snapshot_id is unchanged is replayed from disk without any request.
+ *
+ * The URL is taken as given, so a local stub server can stand in for
+ * api.spotify.com.
+ */
+class SpotifyPager : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Turns one page body into items and sets *ok to false when the body is
+    // malformed; defaults to SpotifyJsonParser::parseTracks. Runs on a worker
+    // thread, so it must not touch shared state.
+    using Parser = std::function<QVariantList(const QByteArray &body, bool *ok)>;
+
+    static constexpr int DefaultMaxConcurrentRequests = 6;
+
+    explicit SpotifyPager(SpotifyRequestScheduler *scheduler, QObject *parent = nullptr);
+    ~SpotifyPager();
+
+    void setPriority(SpotifyRequestScheduler::Priority priority);
+    void setMaxConcurrentRequests(int count);
+    void setParser(Parser parser);
+    // Applies to the next start(): reuse/store the result for this playlist snapshot
+    void setSnapshot(const QString &playlistId, const QString &snapshotId);
+
+    bool isRunning() const { return m_running; }
+
+public slots:
+    // Starts fetching from firstPageUrl (its offset/limit query is honored); aborts a running fetch
+    void start(const QUrl &firstPageUrl);
+    void abort();
+
+signals:
+    void itemsReady(const QVariantList &items, int firstIndex); // in order, contiguous
+    void progress(int fetchedItems, int totalItems);
+    void finished(int totalItems);
+    void failed(const QString &error);
+
+private:
+    struct ParsedPage {
+        SpotifyJsonParser::PageInfo info; // page 0 only
+        QVariantList items;
+        bool ok = true;
+    };
+
+    void requestPage(int page);
+    void handleResponse(SpotifyResponse *response, int page, quint64 generation);
+    void handleParsedPage(int page, ParsedPage parsed, quint64 generation);
+    void issuePendingRequests();
+    void emitContiguousPages();
+    void fail(const QString &error);
+    bool replaySnapshot();
+    QUrl urlForPage(int page) const;
+
+    SpotifyRequestScheduler *m_scheduler;
+    SpotifyRequestScheduler::Priority m_priority = SpotifyRequestScheduler::Interactive;
+    Parser m_parser;
+    int m_maxConcurrent = DefaultMaxConcurrentRequests;
+
+    // --- State of the running fetch ---
+    quint64 m_generation = 0;       // replies of an aborted fetch are ignored
+    bool m_running = false;
+    QUrl m_baseUrl;
+    int m_firstOffset = 0;
+    int m_limit = 0;
+    int m_total = -1;               // unknown until the first page arrived
+    int m_pageCount = 0;
+    int m_nextPageToRequest = 1;    // page 0 is requested alone
+    int m_nextPageToEmit = 0;
+    int m_emittedItems = 0;
+    QMap<int, QVariantList> m_completedPages; // finished but not yet emitted (out of order)
+    QList<SpotifyResponse *> m_inFlight;
+    QString m_playlistId;
+    QString m_snapshotId;
+    QVariantList m_snapshotItems;   // everything emitted, stored once the fetch completes
+};
+
+#endif // SPOTIFYPAGER_H
@@ -0,0 +1,154 @@
+// SpotifyRequestScheduler.h
+#ifndef SPOTIFYREQUESTSCHEDULER_H
+#define SPOTIFYREQUESTSCHEDULER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QQueue>
+#include <QRandomGenerator>
+#include <QTimer>
+
+class QNetworkAccessManager;
+class SpotifyRequestScheduler;
+class SpotifyResponseCache;
+
+/**
+ * @brief Result handle of a scheduled GET. Emits finished() exactly once
+ * (unless abandoned) and deletes itself later.
+ */
+class SpotifyResponse : public QObject
+{
+    Q_OBJECT
+
+public:
+    int statusCode() const { return m_statusCode; }
+    QByteArray body() const { return m_body; }
+    QByteArray rawHeader(const QByteArray &name) const;
+    QNetworkReply::NetworkError error() const { return m_error; }
+    QString errorString() const { return m_errorString; }
+    bool isSuccess() const { return m_error == QNetworkReply::NoError; }
+    bool isFromCache() const { return m_fromCache; } // fresh hit or revalidated by a 304
+
+    // Caller lost interest: no finished() will follow; the request is
+    // dropped if nobody else shares it
+    void abandon();
+
+signals:
+    void finished();
+
+private:
+    friend class SpotifyRequestScheduler;
+    explicit SpotifyResponse(SpotifyRequestScheduler *scheduler);
+
+    QPointer<SpotifyRequestScheduler> m_scheduler;
+    int m_statusCode = 0;
+    QByteArray m_body;
+    QList<QNetworkReply::RawHeaderPair> m_headers;
+    QNetworkReply::NetworkError m_error = QNetworkReply::NoError;
+    QString m_errorString;
+    bool m_fromCache = false;
+};
+
+/**
+ * @brief Single gate for all Spotify Web API traffic.
+ *
+ * - Token bucket: sustained rate and burst size are bounded so imports and
+ *   sidebar bursts do not trip the API's rolling rate limit.
+ * - 429: the whole scheduler pauses for Retry-After, then retries.
+ * - 5xx / network errors: retried with capped exponential backoff and
+ *   jitter; the RNG is seedable for reproducible runs against a mock server.
+ * - Coalescing: identical GETs that are queued or in flight share one request.
+ * - Priority lanes: Interactive requests always go before Background sync.
+ * - Caching (optional): fresh entries of the SpotifyResponseCache are served
+ *   without a request, stale ones are revalidated with If-None-Match.
+ */
+class SpotifyRequestScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority { Interactive = 0, Background = 1 };
+    Q_ENUM(Priority)
+
+    struct Config {
+        double tokensPerSecond = 8.0;
+        int burst = 12;
+        int maxInFlight = 6;
+        int maxRetries = 4;
+        int baseBackoffMs = 500;
+        int maxBackoffMs = 30000;
+        int defaultRetryAfterMs = 5000; // 429 without a usable Retry-After
+    };
+
+    explicit SpotifyRequestScheduler(QNetworkAccessManager *manager, QObject *parent = nullptr);
+    ~SpotifyRequestScheduler() override;
+
+    void setConfig(const Config &config);
+    Config config() const { return m_config; }
+    void setAccessToken(const QString &accessToken);
+    void setRandomSeed(quint32 seed);
+    void setCache(SpotifyResponseCache *cache);
+    SpotifyResponseCache *cache() const { return m_cache; }
+
+    // Queues a GET; the Authorization header is added here, for the Web API host only
+    // (cover images come from CDN hosts that must never see the token)
+    SpotifyResponse *get(const QNetworkRequest &request, Priority priority = Interactive);
+
+    int queuedCount() const;
+    int inFlightCount() const { return m_inFlight; }
+
+signals:
+    void rateLimited(int retryAfterMs);
+
+private:
+    struct Job {
+        quint64 id = 0;
+        QString key;
+        QNetworkRequest request;
+        Priority priority = Interactive;
+        int failures = 0;              // transient failures; 429s are not counted
+        QNetworkReply *reply = nullptr;
+        bool waitingForRetry = false;
+        bool revalidating = false;     // If-None-Match was added from the cache
+        bool bypassCache = false;
+        QList<QPointer<SpotifyResponse>> waiters;
+    };
+
+    friend class SpotifyResponse;
+    void abandon(SpotifyResponse *response);
+
+    void schedule();
+    void refillTokens();
+    void send(Job *job);
+    void handleReply(Job *job);
+    void retryLater(Job *job, int delayMs);
+    void complete(Job *job, QNetworkReply *reply);
+    void deliverFromCache(SpotifyResponse *response, const QUrl &url);
+    void removeJob(Job *job);
+    int backoffDelayMs(int attempt);
+    static int parseRetryAfterMs(const QByteArray &value);
+    static QString keyFor(const QNetworkRequest &request);
+
+    QNetworkAccessManager *m_manager;
+    Config m_config;
+    QString m_accessToken;
+    QRandomGenerator m_random;
+    QPointer<SpotifyResponseCache> m_cache;
+
+    QQueue<Job *> m_lanes[2];          // indexed by Priority
+    QHash<QString, Job *> m_jobsByKey; // queued, waiting for retry or in flight
+    int m_inFlight = 0;
+
+    double m_tokens = 0.0;
+    qint64 m_lastRefillMs = 0;
+    qint64 m_pausedUntilMs = 0;        // set by 429 Retry-After
+    QElapsedTimer m_clock;
+    QTimer m_wakeTimer;
+};
+
+#endif // SPOTIFYREQUESTSCHEDULER_H
@@ -0,0 +1,88 @@
+// SpotifyResponseCache.h
+#ifndef SPOTIFYRESPONSECACHE_H
+#define SPOTIFYRESPONSECACHE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+
+/**
+ * @brief On-disk cache of Spotify Web API responses and cover images.
+ *
+ * Bodies are stored content-addressed (XXH64 of the bytes) under
+ * AppDataLocation/spotify-cache/blobs, so the same cover referenced by
+ * several playlists or URLs is kept once. Each URL entry remembers its ETag
+ * and Cache-Control lifetime: fresh entries are served without a request,
+ * stale ones are revalidated with If-None-Match by SpotifyRequestScheduler.
+ *
+ * Playlist track lists are additionally stored per snapshot_id, so a
+ * playlist whose snapshot did not change is not refetched at all.
+ *
+ * Total blob size is capped; least recently used entries are evicted first.
+ * Used from the GUI thread only.
+ */
+class SpotifyResponseCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr qint64 DefaultMaxBytes = 256LL * 1024 * 1024;
+    static constexpr int SaveDelayMs = 5000;
+
+    // An empty directory means AppDataLocation/spotify-cache
+    explicit SpotifyResponseCache(const QString &directory = QString(), QObject *parent = nullptr);
+    ~SpotifyResponseCache();
+
+    void setMaxBytes(qint64 maxBytes);
+    qint64 maxBytes() const { return m_maxBytes; }
+    qint64 totalBytes() const { return m_totalBytes; }
+    int entryCount() const { return m_entries.size(); }
+
+    // --- HTTP responses, keyed by URL ---
+    bool contains(const QUrl &url) const;
+    bool isFresh(const QUrl &url) const;      // within max-age: no request needed
+    QByteArray etag(const QUrl &url) const;
+    QByteArray body(const QUrl &url);         // marks the entry as used; empty if missing
+    void store(const QUrl &url, const QByteArray &body, const QByteArray &etag, const QByteArray &cacheControl);
+    void revalidated(const QUrl &url, const QByteArray &cacheControl); // after a 304
+
+    // --- Playlist track lists, valid for exactly one snapshot_id ---
+    QByteArray snapshotPayload(const QString &playlistId, const QString &snapshotId);
+    void storeSnapshot(const QString &playlistId, const QString &snapshotId, const QByteArray &payload);
+
+    // Seconds from Cache-Control max-age; -1 for no-store, 0 when absent
+    static qint64 maxAgeSeconds(const QByteArray &cacheControl);
+
+public slots:
+    void save();
+    void clear();
+
+private:
+    struct Entry {
+        quint64 blob = 0;         // content hash, names the blob file
+        qint64 size = 0;
+        QByteArray etag;
+        qint64 expiresAtMs = 0;   // epoch ms; 0 = always revalidate
+        qint64 lastUsedMs = 0;
+        QString snapshotId;       // snapshot entries only
+    };
+
+    QString blobPath(quint64 blob) const;
+    QByteArray readEntry(const QString &key);
+    void insert(const QString &key, Entry entry, const QByteArray &body);
+    void release(quint64 blob, qint64 size);
+    void evict();
+    void load();
+
+    QString m_directory;
+    qint64 m_maxBytes = DefaultMaxBytes;
+    qint64 m_totalBytes = 0;             // sum of distinct blobs
+    QHash<QString, Entry> m_entries;
+    QHash<quint64, int> m_blobRefs;
+    QTimer m_saveTimer;
+};
+
+#endif // SPOTIFYRESPONSECACHE_H
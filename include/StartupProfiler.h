@@ -0,0 +1,33 @@
+// StartupProfiler.h
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QString>
+#include <QVariantList>
+
+/**
+ * @brief Times the startup phases against the time-to-first-frame budget.
+ *
+ * main() marks the end of each synchronous phase; firstFrame() closes the
+ * critical path, logs the phase table and warns when it ran over
+ * BudgetMs. Work deferred past the first frame (playlists, library index,
+ * fonts) reports through deferred() with its own duration. Phases also
+ * appear as "startup" spans in the trace. Phase names must be string
+ * literals. GUI thread only.
+ */
+class StartupProfiler
+{
+public:
+    static constexpr qint64 BudgetMs = 300;
+
+    // Ends the phase that started at the previous mark (or process start)
+    static void mark(const char *phase);
+    static void firstFrame();
+    // A deferred task finished; startNs from Trace::Detail::nowNs()
+    static void deferred(const char *task, qint64 startNs);
+
+    // [{phase, ms, deferred}] in completion order
+    static QVariantList phases();
+};
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,48 @@
+// StorageScheduler.h
+#ifndef STORAGESCHEDULER_H
+#define STORAGESCHEDULER_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Groups library roots by the storage device underneath them and
+ * picks how many reads each device gets at once.
+ *
+ * Roots on the same device share one budget: a spinning disk is read by a
+ * single thread in inode order (seeks dominate, parallel reads only add
+ * more of them), while SSDs and NVMe drives get several readers to fill
+ * their queues. Different devices are scanned in parallel, so a library
+ * spread over several disks is read at roughly their combined bandwidth.
+ *
+ * The device comes from st_dev; on Linux /sys/dev/block/<major>:<minor>
+ * leads to the disk and its queue/rotational flag. Anything that is not a
+ * block device (network shares, FUSE, other platforms) is Unknown and gets
+ * a middle budget.
+ */
+class StorageScheduler
+{
+public:
+    enum class Media { Unknown, Rotational, Solid, NVMe };
+
+    struct Device {
+        QString key;            // "dev:<st_dev>" or the mount's device name
+        QString name;           // "sda", "nvme0n1", ... or the mount root
+        Media media = Media::Unknown;
+        int concurrency = 1;    // readers at once on this device
+        QStringList roots;
+    };
+
+    // Existing roots, grouped by device in first-seen order. Concurrency is
+    // capped by the global thread pool size (librify-index --jobs).
+    static QList<Device> groupRoots(const QStringList &rootPaths);
+
+    static int concurrencyFor(Media media);
+    static QString mediaName(Media media);
+
+private:
+    static Media probeMedia(quint64 device, QString *name);
+};
+
+#endif // STORAGESCHEDULER_H
@@ -0,0 +1,53 @@
+// TagEditJournal.h
+#ifndef TAGEDITJOURNAL_H
+#define TAGEDITJOURNAL_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+
+/**
+ * @brief Undo history for batch tag edits.
+ *
+ * Each entry holds, per file, the values the edited fields had before the
+ * batch (only those fields, so a 3000-track artist fix costs a few hundred
+ * KB). Written to AppDataLocation/tag-journal.dat on every change, so a
+ * batch stays reversible after a restart. Not thread-safe; GUI thread only.
+ */
+class TagEditJournal
+{
+public:
+    static constexpr int MaxBatches = 20;
+
+    struct Batch {
+        QString label;
+        QDateTime time;
+        QHash<QString, QVariantMap> originals; // filePath -> field -> value before the edit
+    };
+
+    TagEditJournal();
+
+    // Journal file location; AppDataLocation/tag-journal.dat unless set before load()
+    void setFilePath(const QString &filePath);
+    void load();
+    bool save() const;
+
+    bool isEmpty() const { return m_batches.isEmpty(); }
+    QString lastLabel() const { return m_batches.isEmpty() ? QString() : m_batches.last().label; }
+    // Drops the oldest batch beyond MaxBatches
+    void record(const Batch &batch);
+    Batch last() const { return m_batches.isEmpty() ? Batch() : m_batches.last(); }
+    // After an undo of the batch recorded at time: forgets the files it restored,
+    // and the batch once none are left, so a failed restore can be undone again
+    void markRestored(const QDateTime &time, const QStringList &filePaths);
+
+private:
+    QString journalFilePath() const;
+
+    QList<Batch> m_batches; // oldest first
+    QString m_filePath;
+};
+
+#endif // TAGEDITJOURNAL_H
@@ -0,0 +1,47 @@
+// TagProbe.h
+#ifndef TAGPROBE_H
+#define TAGPROBE_H
+
+#include <QString>
+#include <QVariantMap>
+#include <memory>
+
+class QProcess;
+
+/**
+ * @brief Reads tags of risky files in a separate process.
+ *
+ * The worker is `librify-index --probe`: it takes one path per line on
+ * stdin and answers each with a length-prefixed QDataStream of
+ * LibraryScanner::readTags(). A file that takes longer than the time
+ * budget gets the worker killed (and restarted for the next file); a
+ * TagLib crash only takes the worker down. Not thread-safe: one probe per
+ * thread, created and used on that thread (no event loop needed).
+ */
+class TagProbe
+{
+public:
+    enum class Status { Ok, Timeout, Crashed, Unavailable };
+
+    // program: path of librify-index; defaultProgram() when empty
+    explicit TagProbe(const QString &program = QString());
+    ~TagProbe();
+
+    // LIBRIFY_PROBE, else librify-index next to (or in tools/ below) the running binary
+    static QString defaultProgram();
+    bool isAvailable() const { return !m_program.isEmpty(); }
+
+    Status read(const QString &filePath, int timeoutMs, QVariantMap *tags);
+
+    // Worker side: serves stdin until it closes; returns the exit code
+    static int serve();
+
+private:
+    bool ensureStarted();
+    void stop();
+
+    QString m_program;
+    std::unique_ptr<QProcess> m_process;
+};
+
+#endif // TAGPROBE_H
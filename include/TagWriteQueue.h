@@ -0,0 +1,105 @@
+// TagWriteQueue.h
+#ifndef TAGWRITEQUEUE_H
+#define TAGWRITEQUEUE_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QVariantMap>
+
+/**
+ * @brief Background queue for tag edits, so saving never blocks the GUI
+ * thread on TagLib I/O (a rewrite of a whole MP3 on a NAS takes seconds).
+ *
+ * Edits of the same file run strictly in order, one at a time; different
+ * files are written in parallel, at most MaxWritesPerDevice at once per
+ * storage device so a NAS or a spinning disk is not thrashed. Each job
+ * re-reads the file's tags on its worker and reports them with
+ * writeFinished(), or, for batches, all together with batchFinished().
+ *
+ * New covers that already are JPEG or PNG are embedded byte for byte;
+ * only other formats are re-encoded. Every write keeps the ID3v2 tag at
+ * its on-disk size when it can (by resizing a reserve PRIV frame), and a
+ * tag that has to grow gets ReserveBytes of headroom, so later edits are
+ * overwritten in place instead of shifting the audio data.
+ */
+class TagWriteQueue : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+
+public:
+    static constexpr int MaxWorkers = 8;
+    static constexpr int MaxWritesPerDevice = 2;
+    static constexpr int ReserveBytes = 16 * 1024;
+
+    struct Edit {
+        QString filePath;
+        QVariantMap fields; // any of title, artist, album, genre (strings), year, track (numbers)
+        QString imagePath;  // new front cover (path or file:/qrc: URL), empty to keep the current one
+    };
+
+    struct Result {
+        bool ok = false;
+        bool inPlace = false; // the tag was overwritten without moving the audio data
+        QString error;
+        QVariantMap tags;     // LibraryScanner::readTags() after the write
+    };
+
+    explicit TagWriteQueue(QObject *parent = nullptr);
+    ~TagWriteQueue();
+
+    // Returns a job id, echoed by writeFinished/writeFailed
+    int enqueue(const Edit &edit);
+    // Returns a batch id, echoed by batchFinished once every edit is done
+    int enqueueBatch(const QList<Edit> &edits);
+    bool isBusy() const { return m_completed < m_total; }
+
+    // Blocking write of one edit; any thread
+    static Result write(const Edit &edit);
+
+signals:
+    void busyChanged();
+    void progressChanged(int completed, int total); // total resets when the queue drains
+    void writeFinished(int jobId, const QString &filePath, const QVariantMap &tags);
+    void writeFailed(int jobId, const QString &filePath, const QString &error);
+    // tags: re-read tags of the files that were written; errors: filePath -> message
+    void batchFinished(int batchId, const QList<QVariantMap> &tags, const QHash<QString, QString> &errors);
+
+private:
+    struct Job {
+        int id = 0;
+        int batchId = 0; // 0 for single edits
+        Edit edit;
+        QString device;  // deviceFor(edit.filePath), looked up once when queued
+    };
+
+    struct Batch {
+        int remaining = 0;
+        QList<QVariantMap> tags;
+        QHash<QString, QString> errors;
+    };
+
+    void addJob(Job job);
+    void startJobs();
+    void handleJobFinished(const Job &job, const Result &result);
+    QString deviceFor(const QString &filePath);
+
+    QHash<QString, QList<Job>> m_pending;           // per file, in submission order
+    QHash<QString, QList<QString>> m_filesByDevice; // files with pending jobs, oldest first
+    QList<QString> m_deviceOrder;                   // devices with pending files, oldest first
+    QSet<QString> m_running;
+    QHash<QString, int> m_runningPerDevice;
+    QHash<QString, QString> m_deviceByDirectory;
+    QHash<int, Batch> m_batches;
+    QThreadPool m_pool;
+    int m_nextJobId = 1;
+    int m_nextBatchId = 1;
+    int m_completed = 0;
+    int m_total = 0;
+};
+
+#endif // TAGWRITEQUEUE_H
@@ -0,0 +1,84 @@
+// TempoAnalyzer.h
+#ifndef TEMPOANALYZER_H
+#define TEMPOANALYZER_H
+
+#include <QObject>
+#include <QHash>
+#include <QQueue>
+#include <QSet>
+#include <QMutex>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <atomic>
+#include <vector>
+
+/**
+ * @brief Background BPM estimation for the local library.
+ *
+ * Each job decodes a 30 s segment of a track, builds an onset-strength
+ * envelope from half-wave rectified spectral flux and picks the tempo with
+ * the strongest (tempo-weighted) autocorrelation between 60 and 200 BPM.
+ *
+ * Jobs run on a low-priority pool capped at half the cores and only a
+ * handful are in flight at once. Results are cached per file (path, size,
+ * mtime) and saved periodically, so an interrupted run resumes where it
+ * stopped on the next scan. Results reach the GUI in batches.
+ */
+class TempoAnalyzer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int AnalysisSampleRate = 11025;
+    static constexpr qint64 SegmentStartMs = 30000;
+    static constexpr qint64 SegmentDurationMs = 30000;
+
+    explicit TempoAnalyzer(QObject *parent = nullptr);
+    ~TempoAnalyzer();
+
+    // Thread-safe; cached BPM of an unchanged file, 0 if unknown or undetectable
+    double cachedBpm(const QString &filePath) const;
+    // Thread-safe; carries the cached result of a moved/renamed file over
+    void renameEntry(const QString &oldPath, const QString &newPath);
+
+    // Tempo of mono PCM in BPM, 0 if no periodic onsets were found
+    static double estimateBpm(const std::vector<float> &samples, int sampleRate);
+
+public slots:
+    // Replaces the pending queue; files with a fresh cache entry are skipped
+    void analyze(const QStringList &filePaths);
+
+signals:
+    void tempoBatchReady(const QHash<QString, double> &bpmByPath);
+
+private:
+    struct Entry {
+        qint64 size = 0;
+        qint64 modified = 0;
+        float bpm = 0.0f;
+    };
+
+    void startJobs();
+    void handleJobFinished(const QString &filePath, const Entry &entry, bool computed);
+    void flushResults();
+    bool isFresh(const QString &filePath) const;
+    static Entry computeEntry(const QString &filePath, const std::atomic_bool *cancel);
+
+    QString cacheFilePath() const;
+    void loadCacheFile();
+    void saveCacheFile();
+
+    mutable QMutex m_entriesMutex; // cachedBpm() is called from the scan thread
+    QHash<QString, Entry> m_entries;
+
+    QQueue<QString> m_queue;
+    QSet<QString> m_running;
+    QHash<QString, double> m_pendingResults;
+    QThreadPool m_pool;
+    QTimer m_flushTimer;
+    QTimer m_saveTimer;
+    std::atomic_bool m_cancel{false};
+};
+
+#endif // TEMPOANALYZER_H
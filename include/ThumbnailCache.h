@@ -0,0 +1,83 @@
+// ThumbnailCache.h
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QStringList>
+#include <QThreadPool>
+#include <QQuickImageProvider>
+#include <atomic>
+
+class LibraryIndex;
+
+/**
+ * @brief Content-addressed cover thumbnails ("image://covers/<coverId>/<size>").
+ *
+ * Covers are stored once per distinct image in LibraryIndex; this cache
+ * pre-scales each one to the sizes the UI draws (track row, sidebar/album
+ * tile, now-playing) on worker threads and keeps the results on disk as
+ * <coverId>-<pixels>.jpg, so an album grid only ever decodes a few KB per
+ * album. Lookups go memory -> disk -> scale from the original.
+ */
+class ThumbnailCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Size { Row = 0, Tile = 1, NowPlaying = 2 };
+    static constexpr int SizeCount = 3;
+    static constexpr int MemoryBudgetBytes = 32 * 1024 * 1024;
+
+    explicit ThumbnailCache(QObject *parent = nullptr);
+    ~ThumbnailCache();
+
+    void setLibraryIndex(const LibraryIndex *index) { m_index = index; }
+
+    static int pixelsFor(Size size);
+    // Smallest size at least `pixels` wide/high (largest if none is)
+    static Size sizeForPixels(int pixels);
+    static QString sizeName(Size size);
+
+    // Thread-safe; null image if the cover is unknown
+    QImage thumbnail(const QString &coverId, Size size);
+    // "image://covers/<coverId>/<size>", empty for an empty coverId
+    static QString sourceFor(const QString &coverId, Size size);
+
+    qint64 memoryUsage() const;
+
+public slots:
+    // Scales every cover of the index that has no thumbnails on disk yet (background)
+    void prepareAll();
+
+private:
+    QString filePathFor(const QString &coverId, Size size) const;
+    // Decodes the original once and writes every size; returns the requested one
+    QImage generate(const QString &coverId, Size size);
+    void remember(const QString &coverId, Size size, const QImage &image);
+
+    const LibraryIndex *m_index = nullptr;
+    QString m_directory;
+    mutable QMutex m_memoryMutex;
+    QCache<QString, QImage> m_memory; // cost in bytes
+    QThreadPool m_pool;
+    std::atomic_bool m_cancel{false};
+};
+
+/**
+ * @brief Serves ThumbnailCache images to QML. Requests run on Qt Quick's
+ * image loader threads, never on the GUI thread.
+ */
+class CoverImageProvider : public QQuickImageProvider
+{
+public:
+    explicit CoverImageProvider(ThumbnailCache *cache);
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+private:
+    ThumbnailCache *m_cache;
+};
+
+#endif // THUMBNAILCACHE_H
@@ -0,0 +1,75 @@
+// Trace.h
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @brief Low-overhead span tracing for the hot paths, exported as Chrome
+ * trace-event JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ * Every thread records into its own fixed-size ring buffer, so recording
+ * takes no lock; the oldest events are overwritten once a ring is full.
+ * While tracing is disabled a span costs one relaxed atomic load.
+ * Category and name must be string literals (only the pointers are kept).
+ *
+ *   LIBRIFY_TRACE_SCOPE("scan", "readTags");
+ *
+ * Enabled at startup with LIBRIFY_TRACE=<file> (written on exit) or at
+ * runtime through the control endpoint (POST /trace/start, GET /trace).
+ */
+namespace Trace {
+
+constexpr int RingCapacity = 1 << 16; // events per thread
+
+namespace Detail {
+inline std::atomic_bool enabled{false};
+qint64 nowNs();
+void record(const char *category, const char *name, qint64 startNs, qint64 durationNs, qint64 arg);
+}
+
+inline bool isEnabled() { return Detail::enabled.load(std::memory_order_relaxed); }
+void setEnabled(bool enabled);
+void clear();
+
+// Snapshot of every thread's ring; spans still being written may be missing
+QByteArray chromeJson();
+bool writeChromeJson(const QString &filePath);
+
+// Reads LIBRIFY_TRACE; when set, tracing starts now and is written there on exit
+void installFromEnvironment();
+
+// Zero-length marker, e.g. a handoff to QML
+void instant(const char *category, const char *name, qint64 arg = -1);
+
+class Span {
+public:
+    Span(const char *category, const char *name)
+        : m_category(category), m_name(name), m_startNs(isEnabled() ? Detail::nowNs() : -1) {}
+    ~Span() {
+        if (m_startNs >= 0) Detail::record(m_category, m_name, m_startNs, Detail::nowNs() - m_startNs, m_arg);
+    }
+    // Shown as args.n in the viewer, e.g. the number of items processed
+    void setArg(qint64 arg) { m_arg = arg; }
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+private:
+    const char *m_category;
+    const char *m_name;
+    qint64 m_startNs;
+    qint64 m_arg = -1;
+};
+
+} // namespace Trace
+
+#define LIBRIFY_TRACE_CONCAT_(a, b) a##b
+#define LIBRIFY_TRACE_CONCAT(a, b) LIBRIFY_TRACE_CONCAT_(a, b)
+#define LIBRIFY_TRACE_SCOPE(category, name) \
+    Trace::Span LIBRIFY_TRACE_CONCAT(librifyTraceSpan_, __LINE__)(category, name)
+
+#endif // TRACE_H
@@ -18,7 +18,8 @@ public:
         None, // Default or no specific sort
         Title,
         ArtistAlbum, // Composite key: Artist first, then Album
-        Album        // Album first
+        Album,       // Album first
+        Bpm          // Detected tempo, unknown (0) first when ascending
     };
     Q_ENUM(SortColumn) // Make enum usable in QML/meta-system if needed later
 
@@ -31,6 +32,8 @@ public:
     Q_PROPERTY(Qt::SortOrder sortOrder READ sortOrder NOTIFY sortCriteriaChanged)
     SortColumn sortColumn() const;
     Qt::SortOrder sortOrder() const;
+    // Estimated size of the held tracks as of the last tracksChanged (GUI thread)
+    qint64 memoryUsage() const;
 
 
 public slots:
@@ -41,6 +44,8 @@ public slots:
     // Sets the sort criteria and resorts the CURRENTLY held tracks
     void sortTracksBy(SortColumn column, Qt::SortOrder order);
     void updateTrack(const QVariantMap &updatedTrack);
+    // Replaces every held track whose filePath matches, then sorts/emits once
+    void patchTracks(const QVariantList &updatedTracks);
 
 signals:
     void tracksChanged();
@@ -48,8 +53,11 @@ signals:
     void sortCriteriaChanged();
 
 private:
+    friend class LibrifyBench; // bench/LibrifyBench.cpp times the private hot paths
+
     // Helper function to perform the actual sort on m_tracks
     void applySort();
+    void emitTracksChanged();
     // Comparison function for std::sort
     static bool compareTracks(const QVariant& v1, const QVariant& v2, SortColumn column, Qt::SortOrder order);
 
@@ -57,6 +65,7 @@ private:
     QVariantList m_tracks;
     SortColumn m_sortColumn = SortColumn::None; // Default sort state
     Qt::SortOrder m_sortOrder = Qt::AscendingOrder; // Default sort order
+    mutable qint64 m_payloadBytes = -1; // -1: not estimated since the last tracksChanged
 };
 
 #endif // TRACKLISTMODEL_H
@@ -0,0 +1,75 @@
+// TrackMatcher.h
+#ifndef TRACKMATCHER_H
+#define TRACKMATCHER_H
+
+#include <QHash>
+#include <QList>
+#include <QMultiHash>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+
+/**
+ * @brief Joins Spotify tracks to local files for the unified library.
+ *
+ * Local tracks are indexed once by ISRC and by normalized
+ * (title, artist) keys, one key per credited artist. A Spotify track is then
+ * resolved with hash lookups only:
+ *  1. ISRC, when both sides have one;
+ *  2. the (title, artist) key, accepted when the durations agree;
+ *  3. only if several local files share that key, a fuzzy pick by album
+ *     similarity and duration distance.
+ *
+ * Normalization: NFKD with combining marks stripped, case folding,
+ * punctuation collapsed, bracketed/" - " title suffixes (feat., remaster,
+ * live, ...) dropped, artists split with LibraryScanner::splitArtistName.
+ *
+ * Immutable after build(), so lookups may run on any thread.
+ */
+class TrackMatcher
+{
+public:
+    enum class Method { Isrc, Exact, Fuzzy };
+
+    struct Match {
+        int localIndex = -1;
+        Method method = Method::Exact;
+        bool isValid() const { return localIndex >= 0; }
+    };
+
+    static constexpr qint64 DurationToleranceMs = 3000;
+
+    // Indexes the local library; indices refer to positions in localTracks
+    void build(const QList<QVariantMap> &localTracks);
+    void clear();
+    bool isEmpty() const { return m_tracks.isEmpty(); }
+
+    Match match(const QVariantMap &spotifyTrack) const;
+
+    // Copies of spotifyTracks where matched entries point at the local file
+    // ("filePath", "source" = "local") and keep their Spotify ids for reference;
+    // the others get "source" = "spotify"
+    QVariantList resolve(const QVariantList &spotifyTracks, int *matchedCount = nullptr) const;
+
+    static QString normalizeText(const QString &text);
+    static QString normalizeTitle(const QString &title);
+    static QStringList normalizeArtists(const QString &artist);
+
+private:
+    struct LocalTrack {
+        QString filePath;
+        QString album;     // normalized
+        qint64 durationMs = 0;
+    };
+
+    static QString joinKey(const QString &title, const QString &artist);
+    static bool durationsAgree(qint64 a, qint64 b);
+    static double albumSimilarity(const QString &a, const QString &b);
+
+    QList<LocalTrack> m_tracks;
+    QHash<QString, int> m_byIsrc;
+    QMultiHash<QString, int> m_byKey;
+};
+
+#endif // TRACKMATCHER_H
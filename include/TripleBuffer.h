@@ -0,0 +1,46 @@
+// TripleBuffer.h
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+
+/**
+ * @brief Single-producer/single-consumer triple buffer.
+ *
+ * The writer fills writeBuffer() and calls publish(); the reader calls
+ * consume() and then reads readBuffer(). Neither side ever blocks or
+ * allocates, and the reader always sees the most recently published frame.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    // --- Writer side ---
+    T &writeBuffer() { return m_buffers[m_writeIndex]; }
+    void publish() {
+        const int previous = m_middle.exchange(m_writeIndex | DirtyBit, std::memory_order_acq_rel);
+        m_writeIndex = previous & IndexMask;
+    }
+
+    // --- Reader side ---
+    // Returns true if a new frame was published since the last call.
+    bool consume() {
+        if (!(m_middle.load(std::memory_order_relaxed) & DirtyBit)) return false;
+        const int previous = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+        m_readIndex = previous & IndexMask;
+        return true;
+    }
+    const T &readBuffer() const { return m_buffers[m_readIndex]; }
+
+private:
+    static constexpr int IndexMask = 0x3;
+    static constexpr int DirtyBit = 0x4;
+
+    std::array<T, 3> m_buffers{};
+    int m_writeIndex = 0;
+    int m_readIndex = 1;
+    std::atomic<int> m_middle{2};
+};
+
+#endif // TRIPLEBUFFER_H
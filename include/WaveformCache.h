@@ -0,0 +1,100 @@
+// WaveformCache.h
+#ifndef WAVEFORMCACHE_H
+#define WAVEFORMCACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QQueue>
+#include <QMutex>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariantList>
+#include <QQuickImageProvider>
+#include <atomic>
+
+/**
+ * @brief Background generator and on-disk cache of per-track waveform
+ * overviews (min/max/RMS per bucket) used as the seek bar background.
+ *
+ * Jobs are priority-scheduled: the playing and the next track always get a
+ * worker immediately, while the rest of the library fills in one file at a
+ * time on an idle-priority thread. Summaries are packed to 3 bytes per
+ * bucket and persisted in a single cache file keyed by path, size and mtime.
+ */
+class WaveformCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int BucketCount = 256;
+    static constexpr int AnalysisSampleRate = 8000;
+    enum Priority { Idle = 0, Next = 1, Current = 2 };
+
+    explicit WaveformCache(QObject *parent = nullptr);
+    ~WaveformCache();
+
+    // Thread-safe; packed {int8 min, int8 max, uint8 rms} per bucket, empty if unknown
+    QByteArray summaryForImageId(const QString &imageId) const;
+
+    // "image://waveform/..." for a ready waveform, empty string otherwise
+    Q_INVOKABLE QString sourceFor(const QString &filePath) const;
+    Q_INVOKABLE void prioritize(const QString &currentPath, const QString &nextPath);
+
+    // Estimated heap use of the held summaries, for the diagnostics pane
+    qint64 memoryUsage() const;
+
+public slots:
+    void enqueueTracks(const QVariantList &tracks);
+
+signals:
+    void waveformReady(const QString &filePath);
+
+private:
+    struct Entry {
+        qint64 size = 0;
+        qint64 modified = 0;
+        QByteArray packed;
+    };
+
+    void request(const QString &filePath, Priority priority);
+    void startJobs();
+    void handleJobFinished(const QString &filePath, const Entry &entry, bool idleJob);
+    static Entry computeEntry(const QString &filePath, const std::atomic_bool *cancel);
+    bool isFresh(const QString &filePath) const;
+    bool hasEntry(const QString &filePath) const;
+    static QString imageIdFor(const QString &filePath);
+
+    QString cacheFilePath() const;
+    void loadCacheFile();
+    void saveCacheFile();
+
+    mutable QMutex m_entriesMutex; // m_entries/m_imageIds are read from the image provider thread
+    QHash<QString, Entry> m_entries;
+    QHash<QString, QString> m_imageIds; // image id -> filePath
+
+    QList<QString> m_urgentQueue;   // current track first, then next
+    QQueue<QString> m_idleQueue;    // rest of the library, FIFO
+    QSet<QString> m_idleQueued;
+    QSet<QString> m_running;
+    int m_runningIdleJobs = 0;
+    QThreadPool m_pool;
+    QTimer m_saveTimer;
+    std::atomic_bool m_cancel{false};
+};
+
+/**
+ * @brief Renders cached waveform summaries for QML Image elements
+ * ("image://waveform/<path hash>").
+ */
+class WaveformImageProvider : public QQuickImageProvider
+{
+public:
+    explicit WaveformImageProvider(const WaveformCache *cache);
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+private:
+    const WaveformCache *m_cache;
+};
+
+#endif // WAVEFORMCACHE_H
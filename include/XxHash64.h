@@ -0,0 +1,34 @@
+// XxHash64.h
+#ifndef XXHASH64_H
+#define XXHASH64_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Streaming XXH64 (bit-compatible with the reference xxHash).
+ *
+ * Four independent 64-bit accumulators per 32-byte stripe keep the CPU's
+ * multipliers busy, so hashing runs at memory speed. Used to fingerprint
+ * audio payloads; not a cryptographic hash.
+ */
+class XxHash64
+{
+public:
+    explicit XxHash64(uint64_t seed = 0);
+
+    void reset(uint64_t seed = 0);
+    void update(const void *data, size_t length);
+    uint64_t digest() const;
+
+    static uint64_t hash(const void *data, size_t length, uint64_t seed = 0);
+
+private:
+    uint64_t m_acc[4];
+    uint64_t m_seed = 0;
+    uint64_t m_totalLength = 0;
+    unsigned char m_buffer[32];
+    size_t m_bufferSize = 0;
+};
+
+#endif // XXHASH64_H
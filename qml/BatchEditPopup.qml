@@ -0,0 +1,77 @@
+// BatchEditPopup.qml
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+
+// Sets the checked fields on every listed track at once (cppLocalManager.writeBatchTags).
+// Unchecked fields are left alone; the whole batch can be undone from the track menu.
+Popup {
+    id: root
+    modal: true; anchors.centerIn: Overlay.overlay; width: 400; height: 360; padding: 10
+
+    property var filePaths: []
+
+    function openForTracks(tracks) {
+        var paths = []
+        for (var i = 0; i < tracks.length; i++) {
+            if (tracks[i].source === "local" && tracks[i].filePath) paths.push(tracks[i].filePath)
+        }
+        root.filePaths = paths
+        var first = paths.length > 0 ? tracks[0] : ({})
+        artistRow.text = first.artist || ""
+        albumRow.text = first.album || ""
+        genreRow.text = first.genre || ""
+        yearRow.text = first.year ? String(first.year) : ""
+        artistRow.checked = albumRow.checked = genreRow.checked = yearRow.checked = false
+        root.open()
+    }
+
+    component FieldRow: RowLayout {
+        property alias checked: check.checked
+        property alias text: input.text
+        property alias validator: input.validator
+        property string label: ""
+        Layout.fillWidth: true
+        CheckBox { id: check; text: parent.label; Layout.preferredWidth: 90 }
+        TextField { id: input; enabled: check.checked; Layout.fillWidth: true; placeholderText: parent.label }
+    }
+
+    ColumnLayout {
+        anchors.fill: parent; spacing: 10
+
+        Label {
+            text: "Edit " + root.filePaths.length + " tracks"
+            font.pixelSize: 16
+            Layout.alignment: Qt.AlignHCenter
+        }
+
+        FieldRow { id: artistRow; label: "Artist" }
+        FieldRow { id: albumRow; label: "Album" }
+        FieldRow { id: genreRow; label: "Genre" }
+        FieldRow { id: yearRow; label: "Year"; validator: IntValidator { bottom: 0; top: 9999 } }
+
+        Item { Layout.fillHeight: true }
+
+        RowLayout {
+            Button {
+                text: "Apply"
+                enabled: root.filePaths.length > 0
+                         && (artistRow.checked || albumRow.checked || genreRow.checked || yearRow.checked)
+                onClicked: {
+                    var fields = {}
+                    if (artistRow.checked) fields.artist = artistRow.text
+                    if (albumRow.checked) fields.album = albumRow.text
+                    if (genreRow.checked) fields.genre = genreRow.text
+                    if (yearRow.checked) fields.year = parseInt(yearRow.text) || 0
+                    var queued = cppLocalManager.writeBatchTags(root.filePaths, fields)
+                    console.log("[BatchEditPopup] Queued", queued, "of", root.filePaths.length, "tracks")
+                    root.close()
+                }
+            }
+            Button {
+                text: "Cancel"
+                onClicked: root.close()
+            }
+        }
+    }
+}
@@ -0,0 +1,120 @@
+// DiagnosticsPane.qml
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+
+// Live performance numbers from cppDiagnostics (DiagnosticsMonitor), shown in
+// SidebarSettings. The exported snapshot is meant for performance bug reports.
+Item {
+    id: pane
+
+    signal backRequested()
+
+    property string statusText: ""
+
+    // Polling only runs while the pane is on screen
+    Binding { target: cppDiagnostics; property: "active"; value: pane.visible }
+    onVisibleChanged: if (!visible) statusText = ""
+
+    ColumnLayout {
+        anchors.fill: parent; spacing: 10
+        Label {
+            text: "Diagnostics"
+            font.pixelSize: 18
+            color: "white"
+            Layout.alignment: Qt.AlignHCenter
+        }
+
+        ListView {
+            id: metricsList
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+            model: cppDiagnostics.rows
+            ScrollBar.vertical: ScrollBar {}
+            delegate: Column {
+                width: metricsList.width
+                // Section header above the first row of each section
+                Text {
+                    visible: index === 0 || cppDiagnostics.rows[index - 1].section !== modelData.section
+                    text: modelData.section
+                    color: "#AAAAAA"
+                    font.bold: true
+                    topPadding: index === 0 ? 0 : 8
+                    bottomPadding: 2
+                }
+                RowLayout {
+                    width: parent.width; spacing: 8
+                    Text {
+                        text: modelData.label
+                        color: "white"
+                        font.pixelSize: 12
+                        elide: Text.ElideRight
+                        Layout.preferredWidth: 140
+                    }
+                    Text {
+                        text: modelData.value
+                        color: "white"
+                        font.pixelSize: 12
+                        elide: Text.ElideRight
+                        horizontalAlignment: Text.AlignRight
+                        Layout.fillWidth: true
+                    }
+                }
+            }
+        }
+
+        Text {
+            visible: pane.statusText !== ""
+            text: pane.statusText
+            color: "#AAAAAA"
+            font.pixelSize: 11
+            wrapMode: Text.WrapAnywhere
+            Layout.fillWidth: true
+        }
+
+        // --- Action Buttons ---
+        RowLayout {
+            Layout.alignment: Qt.AlignRight; spacing: 10
+            Button {
+                text: "Export"
+                highlighted: true
+                MouseArea {
+                    anchors.fill: parent; hoverEnabled: true;
+                    cursorShape: Qt.PointingHandCursor; acceptedButtons: Qt.NoButton
+                }
+                onClicked: {
+                    var filePath = cppDiagnostics.exportSnapshot()
+                    pane.statusText = filePath !== "" ? "Saved to " + filePath : "Export failed"
+                }
+            }
+            Button {
+                text: "Copy"
+                MouseArea {
+                    anchors.fill: parent; hoverEnabled: true;
+                    cursorShape: Qt.PointingHandCursor; acceptedButtons: Qt.NoButton
+                }
+                onClicked: {
+                    cppDiagnostics.copySnapshotToClipboard()
+                    pane.statusText = "Snapshot copied to the clipboard"
+                }
+            }
+            Button {
+                text: "Reset"
+                MouseArea {
+                    anchors.fill: parent; hoverEnabled: true;
+                    cursorShape: Qt.PointingHandCursor; acceptedButtons: Qt.NoButton
+                }
+                onClicked: cppDiagnostics.resetMetrics()
+            }
+            Button {
+                text: "Back"
+                MouseArea {
+                    anchors.fill: parent; hoverEnabled: true;
+                    cursorShape: Qt.PointingHandCursor; acceptedButtons: Qt.NoButton
+                }
+                onClicked: pane.backRequested()
+            }
+        }
+    }
+}
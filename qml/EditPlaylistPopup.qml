@@ -35,6 +35,7 @@ Popup {
         titleField.text = playlist.name
 		imagePreview.source = playlist.iconSource ? playlist.iconSource : "qrc:/icons/default_playlist_cover.png"
 		modelData = playlist
+		exportStatus.text = ""
         root.open()
     }
 
@@ -69,6 +70,40 @@ Popup {
             }
         }
 
+		// --- Export: mirror this playlist into a device folder (incremental, M3U8) ---
+		RowLayout {
+			visible: !isCreateMode; Layout.fillWidth: true
+			Button {
+				text: "Export to Folder..."
+				enabled: !cppPlaylistManager.exporting
+				onClicked: exportFolderDialog.open()
+			}
+			Label {
+				id: exportStatus
+				Layout.fillWidth: true
+				elide: Text.ElideRight
+			}
+		}
+
+		FolderDialog {
+			id: exportFolderDialog
+			title: "Export Playlist To"
+			onAccepted: {
+				var targetPath = selectedFolder.toString().replace("file://", "")
+				var roots = [cppLocalManager.defaultMusicPath].concat(cppLocalManager.extraLibraryRoots)
+				if (cppPlaylistManager.exportPlaylists([modelData.name], targetPath, roots)) exportStatus.text = "Checking..."
+			}
+		}
+
+		Connections {
+			target: cppPlaylistManager
+			function onExportProgress(done, total) { exportStatus.text = done + " / " + total }
+			function onExportFinished(summary) {
+				exportStatus.text = summary.copied + " copied, " + summary.upToDate + " up to date"
+					+ (summary.failed > 0 ? ", " + summary.failed + " failed" : "")
+			}
+		}
+
 		// --- Action Buttons ---
         RowLayout {
             Button {
@@ -18,8 +18,8 @@ Popup {
         titleField.text = trackData.title;
         artistField.text = trackData.artist;
         albumField.text = trackData.album;
-        if (trackData.imageBase64) {
-            imagePreview.source = "data:" + trackData.imageMimeType + ";base64," + trackData.imageBase64
+        if (trackData.coverId) {
+            imagePreview.source = "image://covers/" + trackData.coverId + "/nowplaying"
         }
         root.open();
     }
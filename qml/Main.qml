@@ -86,6 +86,10 @@ Window {
             trackPlayer.play();
             currentlyPlayingIndex = index;
             currentlyPlayingFilePath = track.filePath;
+            if (cppWaveformCache) { // current and next track jump the waveform queue
+                var nextTrack = cppTrackModel.tracks[(index + 1) % cppTrackModel.tracks.length];
+                cppWaveformCache.prioritize(track.filePath, nextTrack ? nextTrack.filePath : "");
+            }
 			console.log("[Main] NOW PLAYING:", currentlyPlayingFilePath, "at index", index, "URL:", trackUrl);
         }
     }
@@ -142,7 +146,25 @@ Window {
             }
         }
     }
+    function playFilePath(filePath) {
+        for (var i = 0; i < cppTrackModel.tracks.length; ++i) {
+            if (cppTrackModel.tracks[i].filePath === filePath) {
+                playTrackAtIndex(i);
+                return;
+            }
+        }
+        // Not in the current view: play it anyway, the list continues from the top afterwards
+        trackPlayer.source = "file://" + filePath;
+        trackPlayer.play();
+        currentlyPlayingIndex = -1;
+        currentlyPlayingFilePath = filePath;
+    }
     function playNextTrack() {
+        var queued = cppPlaybackManager ? cppPlaybackManager.takeQueuedTrack() : "";
+        if (queued !== "") {
+            playFilePath(queued);
+            return;
+        }
         if (cppTrackModel.tracks.length === 0) return;
 
         var newIndex = currentlyPlayingIndex + 1;
@@ -218,6 +240,10 @@ Window {
         } else {
             console.error("[Main] Error: Cannot call setMediaPlayer in backend");
 		}
+        if (cppSpectrumAnalyzer) {
+            cppSpectrumAnalyzer.setMediaPlayer(trackPlayer);
+            cppSpectrumAnalyzer.active = String(appSettings.value("visualizerEnabled", false)) === "true";
+        }
 		// Load settings
 		themeColor = appSettings.value("themeColor", yzyMusic);
 		defaultDirectory = appSettings.value("defaultDirectory", "");
@@ -489,6 +515,8 @@ Window {
             console.log("[Main] Received onReadyChanged. New C++ ready state:", cppPlaybackManager.ready);
             backendIsReady = cppPlaybackManager.ready;
         }
+        function onPlayRequested() { mainWindow.playCurrentOrFirst(); } // remote control
+        function onNextRequested() { mainWindow.playNextTrack(); }
     }
 
     Connections { // To Spotify Manager for global auth state changes/playlist fetching
@@ -4,6 +4,7 @@ import QtQuick.Controls 2.15
 import QtQuick.Layouts 1.15
 import QtMultimedia 6.8 
 import Qt5Compat.GraphicalEffects
+import com.librify 1.0
 
 Rectangle {
 	id: controlsBar
@@ -23,6 +24,7 @@ Rectangle {
     property real progressValue: 0.0
     property string progressTextValue: ""
     property bool progressVisible: false
+    property int waveformRevision: 0
 
 	// --- SIGNALS --- 
 	signal nextTrackRequested() 
@@ -63,6 +65,14 @@ Rectangle {
         }
     }
 
+    Connections {
+        target: cppWaveformCache
+        ignoreUnknownSignals: true
+        function onWaveformReady(filePath) {
+            if (filePath === mainWindow.currentlyPlayingFilePath) waveformRevision++;
+        }
+    }
+
     // --- TIMER for delayed seek ---
     Timer {
         id: seekTimer
@@ -84,8 +94,29 @@ Rectangle {
 		id: mainLayout; 
 		spacing: 15; anchors.fill: parent;
 
+		// SPECTRUM VISUALIZER (click to toggle)
 		Item {
 			Layout.preferredWidth: mainLayout.width * 0.2
+			Layout.fillHeight: true
+			SpectrumView {
+				id: spectrumView
+				anchors.fill: parent; anchors.margins: 10
+				analyzer: cppSpectrumAnalyzer
+				barColor: Qt.rgba(themeColor.r, themeColor.g, themeColor.b, 0.8)
+				visible: cppSpectrumAnalyzer ? cppSpectrumAnalyzer.active : false
+			}
+			MouseArea {
+				anchors.fill: parent
+				cursorShape: Qt.PointingHandCursor
+				ToolTip.visible: containsMouse && cppSpectrumAnalyzer && !cppSpectrumAnalyzer.active
+				ToolTip.text: "Show visualizer"
+				hoverEnabled: true
+				onClicked: {
+					if (!cppSpectrumAnalyzer) return;
+					cppSpectrumAnalyzer.active = !cppSpectrumAnalyzer.active;
+					appSettings.setValue("visualizerEnabled", cppSpectrumAnalyzer.active);
+				}
+			}
 		}
 
 		// CENTRAL STACK
@@ -205,6 +236,20 @@ Rectangle {
 								anchors.horizontalCenter: parent.horizontalCenter
 								color: Qt.rgba(1, 1, 1, 0.3)
 							}
+							// 3b. Waveform overview of the playing track
+							Image {
+								id: waveformImage
+								width: parent.width
+								height: 24
+								anchors.centerIn: parent
+								sourceSize: Qt.size(Math.max(1, width), height)
+								asynchronous: true
+								cache: false
+								source: {
+									controlsBar.waveformRevision; // re-evaluate when a waveform finishes
+									return cppWaveformCache ? cppWaveformCache.sourceFor(mainWindow.currentlyPlayingFilePath) : "";
+								}
+							}
 							// 4. RED Filled Portion (Progress Bar)
 							Rectangle {
 								id: filledTrack
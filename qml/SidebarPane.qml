@@ -47,6 +47,8 @@ Rectangle {
             console.log("[SidebarPane] Component completed. Setting initial grouping to:", currentGrouping)
 			localManager.setGrouping(currentGrouping)
 			localManager.setDefaultMusicPath(mainWindow.defaultDirectory)
+			var extraRoots = String(settings.value("extraLibraryRoots", ""))
+			localManager.setExtraLibraryRoots(extraRoots.length > 0 ? extraRoots.split("\n") : [])
         }
     }
 
@@ -201,33 +203,41 @@ Rectangle {
             Layout.fillWidth: true; Layout.fillHeight: true; color: "transparent"
             ListView {
 				id: sidebarListView; anchors.fill: parent; clip: true; currentIndex: -1; spacing: 5
+				// SidebarModel: rows change by insert/remove/update, so delegates survive rescans and edits
 				model: {
-					if (currentGrouping === "PLAYLISTS") return playlistManager ? playlistManager.sidebarItems : null
-					return localManager ? localManager.sidebarItems : null
+					if (currentGrouping === "PLAYLISTS") return playlistManager ? playlistManager.sidebarModel : null
+					return localManager ? localManager.sidebarModel : null
 				}
-                onModelChanged: {
+				function selectDefaultItem() {
                     sidebarPane.defaultAllTracksIndex = -1
-					if (model) {
-						// Auto-select 2nd item when in PLAYLISTS, if it exists
-						if (currentGrouping === "PLAYLISTS" && model.length > 1) {
-							sidebarListView.currentIndex = 1
-						} else {
-							sidebarListView.currentIndex = sidebarPane.defaultAllTracksIndex >= 0
-								? sidebarPane.defaultAllTracksIndex
-								: 0
+					if (!model) return
+					for (var i = 0; i < model.count; i++) {
+						var item = model.get(i)
+						if (item.id === allTracksId || item.type === "local_all") {
+							sidebarPane.defaultAllTracksIndex = i
+							break
 						}
-
-						for (var i = 0; i < model.length; i++) {
-							if (model[i].id === allTracksId || model[i].type === "local_all") {
-								sidebarPane.defaultAllTracksIndex = i
-                                break
-                            }
-                        }
-                    }
-                }
+					}
+					// Auto-select 2nd item when in PLAYLISTS, if it exists
+					if (currentGrouping === "PLAYLISTS" && model.count > 1) {
+						sidebarListView.currentIndex = 1
+					} else {
+						sidebarListView.currentIndex = sidebarPane.defaultAllTracksIndex >= 0
+							? sidebarPane.defaultAllTracksIndex
+							: 0
+					}
+				}
+                onModelChanged: selectDefaultItem()
+				// First rows after a scan; later inserts/removes keep the current row
+				onCountChanged: if (currentIndex < 0 && count > 0) selectDefaultItem()
+				Connections {
+					target: sidebarListView.model
+					function onModelReset() { sidebarListView.selectDefaultItem() } // grouping switched
+				}
 				delegate: Rectangle {
 					id: delegateItem
                     width: sidebarListView.width
+                    Component.onCompleted: cppFrameMonitor.noteDelegateCreated() // long-frame attribution
                     height: !collapsed ? 50 : sidebarListView.width
                     radius: 3
                     color: sidebarListView.currentIndex === index ? "#40FFFFFF" :
@@ -238,18 +248,19 @@ Rectangle {
 							easing.type: Easing.InOutQuad
 						}
 					}
-                    property bool isSpotify: modelData.type === "spotify_playlist"
-					property bool isArtist: modelData.type === "local_artist"
-					property bool isAlbum: modelData.type === "local_album"
-					property bool isAllTracks: modelData.type === "local_all"
-					property bool isPlaylist: modelData.type === "local_playlist"
-					property bool isCreate: modelData.type === "create_playlist"
-                    property string displayName: modelData.name
+                    property bool isSpotify: model.type === "spotify_playlist"
+					property bool isArtist: model.type === "local_artist"
+					property bool isAlbum: model.type === "local_album"
+					property bool isAllTracks: model.type === "local_all"
+					property bool isPlaylist: model.type === "local_playlist"
+					property bool isCreate: model.type === "create_playlist"
+					property bool isFolder: model.type === "local_folder"
+                    property string displayName: model.name
 
 					RowLayout {
 						id: delegateRowLayout
 						anchors.fill: parent
-						anchors.leftMargin: collapsed ? 0 : 2
+						anchors.leftMargin: collapsed ? 0 : 2 + (isFolder ? model.depth * 14 : 0)
                         spacing: 5
 						Image {
                             Layout.preferredWidth: delegateItem.height - 5
@@ -263,13 +274,13 @@ Rectangle {
 								NumberAnimation { 
 									duration: transitionSpeed; easing.type: Easing.InOutQuad } }
                             source: {
-                                if (isAllTracks) return modelData.iconSource
+                                if (isAllTracks) return model.iconSource
                                 if (isSpotify) return "qrc:/icons/spotify_playlist_icon.png"
-                                if (isAlbum) return modelData.iconSource
-								if (isArtist) return modelData.iconSource
-								if (isPlaylist) return modelData.iconSource
+                                if (isAlbum) return model.iconSource
+								if (isArtist) return model.iconSource
+								if (isPlaylist) return model.iconSource
 								if (isCreate) return "qrc:/icons/create_playlist_icon.png"
-                                return ""
+                                return model.iconSource || "" // genre/year/decade/folder/tempo rows
                             }
                         } 
                         Column {
@@ -283,7 +294,8 @@ Rectangle {
 							visible: opacity > 0
                             Text {
                                 width: parent.width
-                                text: displayName
+                                text: isFolder && model.hasChildren ? (model.expanded ? "\u25BE " : "\u25B8 ") + displayName
+                                                                    : displayName
                                 color: "white"
                                 font { family: customFont.name; pixelSize: baseFontSize * rowScale }
                                 elide: Text.ElideRight
@@ -291,7 +303,7 @@ Rectangle {
                             Text {
                                 width: parent.width
                                 visible: !collapsed
-                                text: !isCreate ? modelData.count + " tracks" : "PLAYLIST"
+                                text: !isCreate ? model.count + " tracks" : "PLAYLIST"
                                 color: "#AAAAAA"
                                 font.pixelSize: baseFontSize * rowScale
                                 elide: Text.ElideRight
@@ -304,7 +316,7 @@ Rectangle {
 						anchors.fill: parent; hoverEnabled: true; cursorShape: Qt.PointingHandCursor
 						acceptedButtons: Qt.LeftButton | Qt.RightButton
 						onPressed: (mouse) => {
-							var item = modelData
+							var item = sidebarListView.model.get(index)
 							// === RIGHT CLICK: Open Edit Playlist Popup ===
 							if (mouse.button === Qt.RightButton) {
 								if (item.type === "local_playlist") {
@@ -319,7 +331,7 @@ Rectangle {
 							}
 						}
 						onClicked: {
-							var item = modelData
+							var item = sidebarListView.model.get(index)
 							// Special behaviour for CREATE PLAYLIST BUTTON
 							if (isCreate) {
 								if (editPlaylistPopup && typeof editPlaylistPopup.openForCreate === "function") {
@@ -336,6 +348,8 @@ Rectangle {
 								console.log("Selected:", item.name, "ID:", item.id, "Type:", item.type)
 							sidebarPane.currentSelectedId = item.id
 							sidebarPane.sidebarSelected(item.id)
+							// Folder rows open/close in place; their subtree rows are inserted or removed
+							if (item.type === "local_folder" && item.hasChildren) localManager.toggleFolder(item.id)
 
 							localManager.loadTracksFor(item.id, item.type)
                         }
@@ -395,6 +409,21 @@ Rectangle {
 						} else if (currentGrouping === "PLAYLISTS") {
 							currentGrouping = "ALBUMS"
 							sourceIcon = "qrc:/icons/all_tracks_icon.png"
+						} else if (currentGrouping === "ALBUMS") {
+							currentGrouping = "GENRES"
+							sourceIcon = "qrc:/icons/all_tracks_icon.png"
+						} else if (currentGrouping === "GENRES") {
+							currentGrouping = "DECADES"
+							sourceIcon = "qrc:/icons/all_tracks_icon.png"
+						} else if (currentGrouping === "DECADES") {
+							currentGrouping = "YEARS"
+							sourceIcon = "qrc:/icons/all_tracks_icon.png"
+						} else if (currentGrouping === "YEARS") {
+							currentGrouping = "FOLDERS"
+							sourceIcon = "qrc:/icons/album_icon.png"
+						} else if (currentGrouping === "FOLDERS") {
+							currentGrouping = "TEMPO"
+							sourceIcon = "qrc:/icons/all_tracks_icon.png"
 						} else {
 							currentGrouping = "ARTISTS"
 							sourceIcon = "qrc:/icons/artist_icon.png"
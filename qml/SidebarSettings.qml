@@ -8,7 +8,8 @@ import Qt.labs.platform as Platform
 
 Popup {
     id: root
-	modal: true; anchors.centerIn: Overlay.overlay; width: 360; height: 380; padding: 15
+	modal: true; anchors.centerIn: Overlay.overlay; padding: 15
+	width: showDiagnostics ? 480 : 360; height: showDiagnostics ? 480 : 520
 	background: Rectangle { color: "#2E2E2E"; radius: 5; border.color: "#444"; border.width: 1 }
 
 	required property var settings
@@ -23,6 +24,8 @@ Popup {
 	property color _selectedColor: initialColor
 	property string _selectedDirectory: initialDirectory
 	property list<color> _themeColorList: initialColorList
+	property bool showDiagnostics: false
+	property var _extraRoots: []
 
 	// --- FILE DIALOG FOR DIRECTORY ---
     Platform.FolderDialog {
@@ -36,17 +39,37 @@ Popup {
         }
     }
 
+    Platform.FolderDialog {
+        id: extraRootDialog
+		title: "Add Library Folder"
+        folder: StandardPaths.writableLocation(StandardPaths.MusicLocation)
+		onAccepted: {
+			var selectedPath = extraRootDialog.folder.toString().replace("file://", "")
+			if (_extraRoots.indexOf(selectedPath) < 0) _extraRoots = _extraRoots.concat([selectedPath])
+        }
+    }
+
 	function openSettings(currentGrouping, currentColor, currentDirectory, colorList) {
 		_selectedColor = initialColor;
         _selectedDirectory = initialDirectory;
         _themeColorList = initialColorList;
         directoryField.text = initialDirectory;
+        _extraRoots = cppLocalManager.extraLibraryRoots;
+        showDiagnostics = false;
         root.open()
     }
 
+    // --- DIAGNOSTICS PANE ---
+    DiagnosticsPane {
+        anchors.fill: parent
+        visible: root.showDiagnostics
+        onBackRequested: root.showDiagnostics = false
+    }
+
     // --- UI LAYOUT ---
     ColumnLayout {
         anchors.fill: parent; spacing: 15
+        visible: !root.showDiagnostics
         Label {
             text: "Settings"
             font.pixelSize: 18
@@ -94,6 +117,42 @@ Popup {
 
             }
         }
+		// Extra roots: scanned with the default folder, in parallel when on other disks
+		Label {
+			text: "Additional Library Folders"
+            color: "#AAAAAA"
+            font.bold: true
+		}
+		Repeater {
+			model: _extraRoots
+			delegate: RowLayout {
+				Layout.fillWidth: true
+				Text {
+					text: modelData
+					color: "white"
+					elide: Text.ElideMiddle
+					Layout.fillWidth: true
+				}
+				Text {
+					text: "Remove"
+					color: removeRootMouseArea.containsMouse ? "white" : "#AAAAAA"
+					MouseArea {
+						id: removeRootMouseArea
+						anchors.fill: parent; hoverEnabled: true; cursorShape: Qt.PointingHandCursor
+						onClicked: _extraRoots = _extraRoots.filter(function(path) { return path !== modelData })
+					}
+				}
+			}
+		}
+		Text {
+			text: "+ Add folder"
+			color: addRootMouseArea.containsMouse ? "white" : "#AAAAAA"
+			MouseArea {
+				id: addRootMouseArea
+				anchors.fill: parent; hoverEnabled: true; cursorShape: Qt.PointingHandCursor
+				onClicked: extraRootDialog.open()
+			}
+		}
 		// --- 2. THEME COLOR ---
         Label {
             text: "Theme Color"
@@ -175,6 +234,74 @@ Popup {
 					verticalAlignment: Text.AlignVCenter
 				}
             }
+            RadioButton {
+                id: tempoRadio
+                text: "Tempo"
+				ButtonGroup.group: groupingGroup
+				checked: root.initialGrouping === "TEMPO"
+				contentItem: Text {
+					text: parent.text
+					color: "white"
+					font: parent.font
+					leftPadding: parent.indicator.width + parent.spacing
+					verticalAlignment: Text.AlignVCenter
+				}
+            }
+        }
+        RowLayout {
+            spacing: 10
+            RadioButton {
+                id: genresRadio
+                text: "Genres"
+				ButtonGroup.group: groupingGroup
+				checked: root.initialGrouping === "GENRES"
+				contentItem: Text {
+					text: parent.text
+					color: "white"
+					font: parent.font
+					leftPadding: parent.indicator.width + parent.spacing
+					verticalAlignment: Text.AlignVCenter
+				}
+            }
+            RadioButton {
+                id: decadesRadio
+                text: "Decades"
+				ButtonGroup.group: groupingGroup
+				checked: root.initialGrouping === "DECADES"
+				contentItem: Text {
+					text: parent.text
+					color: "white"
+					font: parent.font
+					leftPadding: parent.indicator.width + parent.spacing
+					verticalAlignment: Text.AlignVCenter
+				}
+            }
+            RadioButton {
+                id: yearsRadio
+                text: "Years"
+				ButtonGroup.group: groupingGroup
+				checked: root.initialGrouping === "YEARS"
+				contentItem: Text {
+					text: parent.text
+					color: "white"
+					font: parent.font
+					leftPadding: parent.indicator.width + parent.spacing
+					verticalAlignment: Text.AlignVCenter
+				}
+            }
+            RadioButton {
+                id: foldersRadio
+                text: "Folders"
+				ButtonGroup.group: groupingGroup
+				checked: root.initialGrouping === "FOLDERS"
+				contentItem: Text {
+					text: parent.text
+					color: "white"
+					font: parent.font
+					leftPadding: parent.indicator.width + parent.spacing
+					verticalAlignment: Text.AlignVCenter
+				}
+            }
         }
 
         Item { Layout.fillHeight: true } // Spacer
@@ -183,6 +310,14 @@ Popup {
         // --- Action Buttons ---
         RowLayout {
             Layout.alignment: Qt.AlignRight; spacing: 10
+            Button {
+                text: "Diagnostics"
+				MouseArea {
+					anchors.fill: parent; hoverEnabled: true;
+					cursorShape: Qt.PointingHandCursor; acceptedButtons: Qt.NoButton
+				}
+				onClicked: root.showDiagnostics = true
+            }
             Button {
                 text: "Save"
 				highlighted: true
@@ -194,11 +329,18 @@ Popup {
 					var newGrouping = "ARTISTS";
                     if (albumsRadio.checked) newGrouping = "ALBUMS";
                     else if (playlistsRadio.checked) newGrouping = "PLAYLISTS";
+                    else if (tempoRadio.checked) newGrouping = "TEMPO";
+                    else if (genresRadio.checked) newGrouping = "GENRES";
+                    else if (decadesRadio.checked) newGrouping = "DECADES";
+                    else if (yearsRadio.checked) newGrouping = "YEARS";
+                    else if (foldersRadio.checked) newGrouping = "FOLDERS";
                     var newColor = _selectedColor;
 					var newDirectory = directoryField.text;
 					settings.setValue("sidebarGrouping", newGrouping);
                     settings.setValue("themeColor", newColor.toString());
                     settings.setValue("defaultDirectory", newDirectory);
+                    settings.setValue("extraLibraryRoots", _extraRoots.join("\n"));
+                    cppLocalManager.setExtraLibraryRoots(_extraRoots);
                     root.saveRequested(newDirectory, newColor, newGrouping)
                     root.close()
                 }
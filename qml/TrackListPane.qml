@@ -34,6 +34,7 @@ Rectangle {
     readonly property real baseRowHeight: 65
     readonly property real baseFontSize: 14
     readonly property real scrollSpeedMultiplier: 2.0
+    readonly property real bpmColumnWidth: 80
 	
 	// --- SIGNALS ---
     signal trackClicked(int index, variant modelData)
@@ -147,7 +148,7 @@ Rectangle {
             id: headerRow
             Layout.fillWidth: true
             spacing: 0
-            property real availableWidthForHeaders: trackListColumn.width - (tracklistPane.splitterInteractiveWidth * 2)
+            property real availableWidthForHeaders: trackListColumn.width - (tracklistPane.splitterInteractiveWidth * 2) - tracklistPane.bpmColumnWidth
 
             Loader { // Title Header
                 id: titleHeaderLoader; sourceComponent: headerComponent
@@ -216,10 +217,16 @@ Rectangle {
                 Layout.preferredWidth: headerRow.availableWidthForHeaders * tracklistPane.albumColumnFlex
                 onLoaded: { item.columnId = TrackListModel.Album; item.columnName = "ALBUM"; }
             }
+            Loader { // BPM Header (fixed width)
+                id: bpmHeaderLoader; sourceComponent: headerComponent
+                Layout.preferredWidth: tracklistPane.bpmColumnWidth
+                onLoaded: { item.columnId = TrackListModel.Bpm; item.columnName = "BPM"; }
+            }
         }
 
         ListView {
             id: localTrackView
+            objectName: "trackListView" // found by bench/UiStressBench.cpp
             Layout.fillWidth: true; Layout.fillHeight: true
             clip: true; cacheBuffer: 200
             model: tracklistPane.trackModel ? tracklistPane.trackModel.tracks : null
@@ -231,6 +238,7 @@ Rectangle {
                 width: localTrackView.width
                 height: tracklistPane.baseRowHeight * tracklistPane.rowScale
                 clip: true
+                Component.onCompleted: cppFrameMonitor.noteDelegateCreated() // long-frame attribution
 
                 readonly property real _actualAlbumArtWidth: Math.max(0, tracklistPane.baseImageSize * tracklistPane.rowScale)
                 readonly property real _delegateContentRowHorizontalMargins: (delegateContentRow.anchors.leftMargin + delegateContentRow.anchors.rightMargin)
@@ -389,7 +397,7 @@ Rectangle {
 						radius: 3; visible: width > 0 && height > 0
                         Image {
                             id: trackImage; anchors.fill: parent; fillMode: Image.PreserveAspectCrop; smooth: true
-                            source: modelData.source === "local" && modelData.imageBase64 ? ("data:" + modelData.imageMimeType + ";base64," + modelData.imageBase64) : ""
+                            source: modelData.source === "local" && modelData.coverId ? ("image://covers/" + modelData.coverId + "/row") : ""
                             visible: status == Image.Ready && trackImage.source !== ""
                         }
                         Text {
@@ -405,7 +413,7 @@ Rectangle {
 						Layout.fillWidth: true
 						Layout.alignment: Qt.AlignTop
                         spacing: 5 * tracklistPane.rowScale
-                        readonly property real _contentWidthForTextItems: Math.max(0, delegateRoot._widthAllocatedToTrackInfoTextLayout - (trackInfoTextLayout.spacing * 2))
+                        readonly property real _contentWidthForTextItems: Math.max(0, delegateRoot._widthAllocatedToTrackInfoTextLayout - (trackInfoTextLayout.spacing * 3) - tracklistPane.bpmColumnWidth)
 
                         // --- Title text with hover effects ---
                         Text {
@@ -456,6 +464,14 @@ Rectangle {
                                 propagateComposedEvents: true
                                 cursorShape: Qt.PointingHandCursor
                             }
+                        }
+                        Text { // bpmText (empty until tempo analysis reaches this track)
+                            id: bpmText; Layout.preferredWidth: tracklistPane.bpmColumnWidth
+                            horizontalAlignment: Text.AlignHCenter; font.family: customFont.name
+                            text: modelData.bpm > 0 ? Math.round(modelData.bpm) : ""
+                            color: themeColor
+                            font.pixelSize: tracklistPane.baseFontSize * 0.8 * tracklistPane.rowScale
+                            verticalAlignment: Text.AlignVCenter
                         }
 					} // End track info text layout
 				} // End Content Row
@@ -492,7 +508,7 @@ Rectangle {
 							submenu.removeItem(submenu.itemAt(submenu.count - 1))
 						}
 						try {
-							var playlistsData = cppPlaylistManager.sidebarItems
+							var playlistsData = cppPlaylistManager.getPlaylists()
 							console.log("Loaded playlists:", playlistsData.length)
 							
 							// Add each playlist as a menu item
@@ -550,6 +566,16 @@ Rectangle {
 							}		
 						}
 					}
+					MenuSeparator {}
+					MenuItem {
+						text: "Edit all listed tracks..."
+						onTriggered: batchEditPopup.openForTracks(tracklistPane.trackModel.tracks)
+					}
+					MenuItem {
+						text: cppLocalManager.canUndoTags ? "Undo " + cppLocalManager.undoTagsLabel : "Undo tag edit"
+						enabled: cppLocalManager.canUndoTags
+						onTriggered: cppLocalManager.undoLastTagBatch()
+					}
 				} // End options dropdown menu
             } // End delegate
         } // End ListView
@@ -564,4 +590,8 @@ Rectangle {
             }
         }
     }
+
+    BatchEditPopup {
+        id: batchEditPopup
+    }
 }
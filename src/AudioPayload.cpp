@@ -0,0 +1,105 @@
+// AudioPayload.cpp
+#include "AudioPayload.h"
+#include "XxHash64.h"
+
+#include <QFile>
+#include <QDebug>
+#include <vector>
+
+namespace {
+constexpr int MaxLeadingTags = 4;          // some taggers stack several ID3v2 tags
+constexpr qint64 ReadChunkSize = 1 << 20;
+
+quint32 readLe32(const char *p) {
+    return static_cast<quint8>(p[0]) | (static_cast<quint8>(p[1]) << 8)
+           | (static_cast<quint8>(p[2]) << 16) | (static_cast<quint32>(static_cast<quint8>(p[3])) << 24);
+}
+
+bool readAt(QIODevice &device, qint64 offset, char *out, qint64 length) {
+    return device.seek(offset) && device.read(out, length) == length;
+}
+}
+
+AudioPayload::Range AudioPayload::locate(QIODevice &device) {
+    Range range;
+    range.end = device.size();
+
+    // 1. Leading ID3v2: "ID3" + version(2) + flags(1) + syncsafe size(4), optional 10 byte footer
+    char header[10];
+    for (int i = 0; i < MaxLeadingTags && readAt(device, range.begin, header, sizeof(header)); ++i) {
+        if (header[0] != 'I' || header[1] != 'D' || header[2] != '3') break;
+        const quint8 *s = reinterpret_cast<const quint8 *>(header + 6);
+        if ((s[0] | s[1] | s[2] | s[3]) & 0x80) break; // not syncsafe, not a real tag
+        const qint64 tagSize = (qint64(s[0]) << 21) | (qint64(s[1]) << 14) | (qint64(s[2]) << 7) | qint64(s[3]);
+        const bool hasFooter = static_cast<quint8>(header[5]) & 0x10;
+        range.begin += 10 + tagSize + (hasFooter ? 10 : 0);
+    }
+    if (range.begin >= range.end) return Range();
+
+    // 2. Trailing ID3v1: fixed 128 bytes starting with "TAG"
+    char trailer[128];
+    if (range.end - range.begin >= 128 && readAt(device, range.end - 128, trailer, 128)
+        && trailer[0] == 'T' && trailer[1] == 'A' && trailer[2] == 'G') {
+        range.end -= 128;
+    }
+
+    // 3. Lyrics3v2 before ID3v1: ...<6 digit size>"LYRICS200"
+    char lyricsFooter[15];
+    if (range.end - range.begin >= 15 && readAt(device, range.end - 15, lyricsFooter, 15)
+        && QByteArray(lyricsFooter + 6, 9) == "LYRICS200") {
+        bool ok = false;
+        const qint64 lyricsSize = QByteArray(lyricsFooter, 6).toLongLong(&ok);
+        if (ok && lyricsSize + 15 <= range.end - range.begin) range.end -= lyricsSize + 15;
+    }
+
+    // 4. APEv2 footer: "APETAGEX", size (incl. footer) at 12, flags at 20; bit 31 = has header
+    char apeFooter[32];
+    if (range.end - range.begin >= 32 && readAt(device, range.end - 32, apeFooter, 32)
+        && QByteArray(apeFooter, 8) == "APETAGEX") {
+        const qint64 tagSize = readLe32(apeFooter + 12);
+        const bool hasHeader = readLe32(apeFooter + 20) & 0x80000000u;
+        const qint64 total = tagSize + (hasHeader ? 32 : 0);
+        if (tagSize >= 32 && total <= range.end - range.begin) range.end -= total;
+    }
+
+    return range.isValid() ? range : Range();
+}
+
+quint64 AudioPayload::hash(const QString &filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "[AudioPayload] Cannot open" << filePath;
+        return 0;
+    }
+    const Range range = locate(file);
+    if (!range.isValid() || !file.seek(range.begin)) return 0;
+
+    XxHash64 hasher;
+    std::vector<char> buffer(static_cast<size_t>(qMin(ReadChunkSize, range.end - range.begin)));
+    qint64 remaining = range.end - range.begin;
+    while (remaining > 0) {
+        const qint64 read = file.read(buffer.data(), qMin<qint64>(remaining, buffer.size()));
+        if (read <= 0) return 0;
+        hasher.update(buffer.data(), static_cast<size_t>(read));
+        remaining -= read;
+    }
+    return hasher.digest();
+}
+
+quint64 AudioPayload::fingerprint(const QString &filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return 0;
+    const Range range = locate(file);
+    if (!range.isValid()) return 0;
+
+    const qint64 length = range.end - range.begin;
+    const qint64 headLength = qMin(length, FingerprintSpan);
+    const qint64 tailLength = qMin(length - headLength, FingerprintSpan);
+    std::vector<char> buffer(static_cast<size_t>(headLength + tailLength));
+    if (!file.seek(range.begin) || file.read(buffer.data(), headLength) != headLength) return 0;
+    if (tailLength > 0
+        && (!file.seek(range.end - tailLength) || file.read(buffer.data() + headLength, tailLength) != tailLength)) {
+        return 0;
+    }
+    return XxHash64::hash(buffer.data(), buffer.size(), static_cast<quint64>(length)) | 1; // never 0
+}
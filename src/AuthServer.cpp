@@ -1,111 +1,360 @@
 #include "AuthServer.h"
-#include <QTextStream>
+#include "LocalMusicManager.h"
+#include "MetricsRegistry.h"
+#include "PlaybackManager.h"
+#include "Trace.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QTimer>
+
+namespace {
+// Same time for every mismatch position
+bool equalTokens(const QByteArray &a, const QByteArray &b) {
+    if (a.size() != b.size()) return false;
+    unsigned char difference = 0;
+    for (qsizetype i = 0; i < a.size(); ++i) difference |= uchar(a.at(i)) ^ uchar(b.at(i));
+    return difference == 0;
+}
+}
 
 AuthServer::AuthServer(QObject *parent) : QTcpServer(parent) {
     connect(this, &QTcpServer::newConnection, this, &AuthServer::handleConnection);
 }
 
+AuthServer::~AuthServer() {
+    if (!m_token.isEmpty()) QFile::remove(tokenFilePath());
+    qDeleteAll(m_connections);
+}
+
+QString AuthServer::tokenFilePath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/control-token";
+}
+
 void AuthServer::start() {
-    qDebug() << "[AuthServer] Attempting to start listening on localhost:8888...";
-    if (!listen(QHostAddress::LocalHost, 8888)) {
+    qDebug() << "[AuthServer] Attempting to start listening on localhost:" << DefaultPort;
+    if (!listen(QHostAddress::LocalHost, DefaultPort)) {
         qWarning() << "[AuthServer] Failed to start server:" << errorString();
+        return;
+    }
+    qDebug() << "[AuthServer] Server started on port" << DefaultPort;
+
+    // Control API token for this run; readable by the user's own scripts only
+    quint32 random[8];
+    QRandomGenerator::system()->fillRange(random);
+    m_token = QByteArray(reinterpret_cast<const char *>(random), sizeof(random)).toHex();
+    const QString tokenPath = tokenFilePath();
+    QDir().mkpath(QFileInfo(tokenPath).absolutePath());
+    // Created owner-only, never widened first; a file left by a crashed run may have
+    // other permissions, and open() only applies them when it creates the file
+    QFile::remove(tokenPath);
+    QFile tokenFile(tokenPath);
+    if (tokenFile.open(QIODevice::WriteOnly | QIODevice::NewOnly, QFileDevice::ReadOwner | QFileDevice::WriteOwner)
+        && tokenFile.write(m_token + '\n') == m_token.size() + 1) {
+        qDebug() << "[AuthServer] Control API token written to" << tokenPath;
     } else {
-        qDebug() << "[AuthServer] Server started on port 8888";
+        qWarning() << "[AuthServer] Cannot write" << tokenPath << "- control API unavailable";
+        tokenFile.close();
+        tokenFile.remove();
+        m_token.clear();
     }
 }
 
 void AuthServer::stop() {
     close();
+    if (!m_token.isEmpty()) QFile::remove(tokenFilePath());
+    m_token.clear();
+    const QList<QTcpSocket *> sockets = m_connections.keys();
+    for (QTcpSocket *socket : sockets) socket->disconnectFromHost();
 }
 
+void AuthServer::setPlaybackManager(PlaybackManager *playbackManager) { m_playbackManager = playbackManager; }
+
+void AuthServer::setLocalMusicManager(LocalMusicManager *localMusicManager) { m_localMusicManager = localMusicManager; }
+
+//=============================================================================
+// SLOT: Accepts a connection; it stays open for further requests (keep-alive)
+//=============================================================================
 void AuthServer::handleConnection() {
-    QTcpSocket *socket = nextPendingConnection();
-    connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
-        if (!socket) return; // Safety check
-
-        QString request = socket->readAll();
-        // Optionally log the request headers/body for debugging
-        // qDebug() << "AuthServer received request:\n" << request;
-
-        QString code = extractCodeFromRequest(request); // Your existing function
-
-        if (!code.isEmpty()) {
-            qDebug() << "[AuthServer] AuthServer extracted authorization code. Emitting signal.";
-            emit authorizationCodeReceived(code);
-            // Respond with HTML to close the tab
-            QTextStream os(socket);
-            os.setAutoDetectUnicode(true); // Handle encoding properly
-            os << "HTTP/1.1 200 OK\r\n"
-               << "Content-Type: text/html; charset=\"utf-8\"\r\n"
-               << "Connection: close\r\n" // Ask browser to close connection
-               << "\r\n" // End of headers
-               << "<!DOCTYPE html>\n"
-               << "<html>\n"
-               << "<head><title>Authorization Success</title></head>\n"
-               << "<body>\n"
-               << "Authentication successful! This window/tab should close automatically.\n"
-               << "<script type='text/javascript'>window.close();</script>\n" // <<< The key part
-               << "</body>\n"
-               << "</html>\n";
-
-        } else {
-            qWarning() << "[AuthServer] AuthServer did not find 'code' parameter in request.";
-            // Respond with an error message if no code was found
-            QTextStream os(socket);
-            os.setAutoDetectUnicode(true);
-            os << "HTTP/1.1 400 Bad Request\r\n"
-               << "Content-Type: text/html; charset=\"utf-8\"\r\n"
-               << "Connection: close\r\n"
-               << "\r\n"
-               << "<!DOCTYPE html><html><body>Error: Authorization code not found in request.</body></html>\n";
+    while (QTcpSocket *socket = nextPendingConnection()) {
+        ++m_connectionsAccepted;
+        m_connections.insert(socket, new Connection);
+
+        // Idle persistent connections are closed after a while
+        auto *idleTimer = new QTimer(socket);
+        idleTimer->setSingleShot(true);
+        idleTimer->setInterval(IdleTimeoutMs);
+        connect(idleTimer, &QTimer::timeout, socket, &QTcpSocket::disconnectFromHost);
+        idleTimer->start();
+
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket, idleTimer]() {
+            idleTimer->start();
+            handleReadyRead(socket);
+        });
+        // Handle socket errors and disconnection for cleanup
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            delete m_connections.take(socket);
+            socket->deleteLater(); // Safe cleanup after disconnect
+        });
+        connect(socket, &QTcpSocket::errorOccurred, this, [socket](QAbstractSocket::SocketError error) {
+            if (error == QAbstractSocket::RemoteHostClosedError) return; // normal end of a keep-alive connection
+            qWarning() << "[AuthServer] AuthServer socket error:" << error << socket->errorString();
+        });
+    }
+}
+
+void AuthServer::handleReadyRead(QTcpSocket *socket) {
+    Connection *connection = m_connections.value(socket);
+    if (!connection) return;
+
+    // A read may hold part of a request or several pipelined ones
+    HttpRequestParser::Status status = connection->parser.feed(socket->readAll());
+    while (status == HttpRequestParser::Status::Complete) {
+        QElapsedTimer timer;
+        timer.start();
+        const HttpRequest request = connection->parser.takeRequest();
+        const Response response = route(request);
+        const bool keepAlive = !response.close && request.keepAlive()
+                               && ++connection->handledRequests < MaxRequestsPerConnection;
+        writeResponse(socket, response, keepAlive);
+        ++m_requestsServed;
+        Metrics::httpRequestMicros.record(timer.nsecsElapsed() / 1000);
+        if (!keepAlive) {
+            socket->disconnectFromHost(); // may delete connection
+            return;
         }
+        status = connection->parser.next();
+    }
 
-        // Ensure data is written and close the socket connection
-        socket->flush();
+    if (status == HttpRequestParser::Status::Error) {
+        writeResponse(socket, error(connection->parser.errorStatus(), connection->parser.errorReason()), false);
         socket->disconnectFromHost();
+    }
+}
+
+//=============================================================================
+// HELPER: Request routing
+//=============================================================================
+AuthServer::Response AuthServer::route(const HttpRequest &request) {
+    // Spotify redirects the browser back here after login
+    const bool authorizationCallback = request.query.hasQueryItem("code") || request.query.hasQueryItem("error");
+    if (const std::optional<Response> refusal = refuse(request, authorizationCallback)) return *refusal;
+    if (authorizationCallback) return handleAuthorizationCallback(request);
+
+    const QString &path = request.path;
+    const bool isGet = request.method == "GET";
+    const bool isPost = request.method == "POST";
+
+    if (path == "/metrics") {
+        if (!isGet) return error(405, "Use GET");
+        Response response;
+        response.contentType = "text/plain; version=0.0.4";
+        response.body = renderMetrics();
+        return response;
+    }
+    if (path == "/diagnostics") {
+        if (!isGet) return error(405, "Use GET");
+        Response response;
+        response.body = MetricsRegistry::snapshotJson();
+        return response;
+    }
+
+    if (path == "/trace") {
+        if (!isGet) return error(405, "Use GET");
+        Response response;
+        response.body = Trace::chromeJson();
+        return response;
+    }
+    if (path == "/trace/start" || path == "/trace/stop") {
+        if (!isPost) return error(405, "Use POST");
+        const bool start = path == "/trace/start";
+        if (start) Trace::clear(); // a new recording starts empty
+        Trace::setEnabled(start);
+        return json(QJsonDocument(QJsonObject{{"tracing", start}}));
+    }
+
+    if (path == "/play" || path == "/pause" || path == "/next") {
+        if (!isPost) return error(405, "Use POST");
+        if (!m_playbackManager) return error(503, "Playback is not available");
+        if (path == "/play") m_playbackManager->play();
+        else if (path == "/pause") m_playbackManager->pause();
+        else m_playbackManager->requestNext();
+        return json(QJsonDocument(QJsonObject{{"ok", true}}));
+    }
+
+    if (path == "/queue") {
+        if (!m_playbackManager) return error(503, "Playback is not available");
+        if (isPost) {
+            QString filePath = QJsonDocument::fromJson(request.body).object().value("filePath").toString();
+            if (filePath.isEmpty()) filePath = request.query.queryItemValue("path", QUrl::FullyDecoded);
+            if (filePath.isEmpty() || !QFileInfo::exists(filePath)) return error(404, "No such file: " + filePath);
+            m_playbackManager->enqueue(filePath);
+        } else if (!isGet) {
+            return error(405, "Use GET or POST");
+        }
+        return json(QJsonDocument(QJsonObject{{"queue", QJsonArray::fromStringList(m_playbackManager->queue())}}));
+    }
+
+    if (path == "/search") {
+        if (!isGet) return error(405, "Use GET");
+        if (!m_localMusicManager) return error(503, "Library is not available");
+        const QString query = request.query.queryItemValue("q", QUrl::FullyDecoded).replace('+', ' ');
+        const int limit = qBound(1, request.query.queryItemValue("limit").toInt(), 500);
+        const QVariantList results =
+            m_localMusicManager->searchTracks(query, request.query.hasQueryItem("limit") ? limit : 50);
+        return json(QJsonDocument(QJsonObject{{"query", query}, {"results", QJsonArray::fromVariantList(results)}}));
+    }
+
+    if (path == "/now-playing") {
+        if (!isGet) return error(405, "Use GET");
+        if (!m_playbackManager) return error(503, "Playback is not available");
+        QVariantMap state = m_playbackManager->nowPlaying();
+        if (m_localMusicManager) {
+            const QVariantMap track = m_localMusicManager->trackForPath(state.value("filePath").toString());
+            for (const char *key : {"title", "artist", "album", "bpm"}) {
+                if (track.contains(key)) state.insert(key, track.value(key));
+            }
+        }
+        return json(QJsonDocument(QJsonObject::fromVariantMap(state)));
+    }
+
+    if (path == "/") {
+        return json(QJsonDocument(QJsonObject{
+            {"endpoints", QJsonArray{"POST /play", "POST /pause", "POST /next", "GET|POST /queue",
+                                     "GET /search?q=", "GET /now-playing", "GET /metrics",
+                                     "POST /trace/start", "POST /trace/stop", "GET /trace"}}}));
+    }
+    return error(404, "Unknown endpoint: " + path);
+}
+
+// "localhost" or "127.0.0.1", with this server's port if any
+bool AuthServer::isLocalAuthority(const QByteArray &authority) const {
+    QByteArray host = authority;
+    const qsizetype colon = host.lastIndexOf(':');
+    if (colon >= 0) {
+        if (host.mid(colon + 1) != QByteArray::number(serverPort())) return false;
+        host.truncate(colon);
+    }
+    return host.compare("localhost", Qt::CaseInsensitive) == 0 || host == "127.0.0.1";
+}
+
+std::optional<AuthServer::Response> AuthServer::refuse(const HttpRequest &request, bool authorizationCallback) const {
+    // A page on another site can reach us through a rebound DNS name or a cross-origin fetch
+    if (!isLocalAuthority(request.header("host"))) return error(403, "Host must be localhost");
+    const QByteArray origin = request.header("origin");
+    if (!origin.isEmpty() && !(origin.startsWith("http://") && isLocalAuthority(origin.mid(7)))) {
+        return error(403, "Cross-origin requests are not allowed");
+    }
+    if (authorizationCallback) return std::nullopt;
+
+    const QByteArray authorization = request.header("authorization");
+    if (m_token.isEmpty() || !authorization.startsWith("Bearer ")
+        || !equalTokens(authorization.mid(7).trimmed(), m_token)) {
+        return error(401, "Send the token from " + tokenFilePath() + " as 'Authorization: Bearer <token>'");
+    }
+    if (request.method == "POST" && !request.header("content-type").startsWith("application/json")) {
+        return error(415, "POST bodies must be application/json");
+    }
+    return std::nullopt;
+}
+
+AuthServer::Response AuthServer::handleAuthorizationCallback(const HttpRequest &request) {
+    Response response;
+    response.contentType = "text/html; charset=\"utf-8\"";
+    response.close = true; // Ask browser to close connection
+
+    QString code = extractCodeFromRequest(request);
+    if (!code.isEmpty()) {
+        qDebug() << "[AuthServer] AuthServer extracted authorization code. Emitting signal.";
+        emit authorizationCodeReceived(code);
+        // Respond with HTML to close the tab
+        response.body = "<!DOCTYPE html>\n"
+                        "<html>\n"
+                        "<head><title>Authorization Success</title></head>\n"
+                        "<body>\n"
+                        "Authentication successful! This window/tab should close automatically.\n"
+                        "<script type='text/javascript'>window.close();</script>\n"
+                        "</body>\n"
+                        "</html>\n";
+    } else {
+        qWarning() << "[AuthServer] AuthServer did not find 'code' parameter in request.";
+        response.status = 400;
+        response.body = "<!DOCTYPE html><html><body>Error: Authorization code not found in request.</body></html>\n";
+    }
+    return response;
+}
 
-        // Optional: Add a short delay before deleting the socket later
-        // connect(socket, &QTcpSocket::disconnected, socket, &QTcpSocket::deleteLater);
-        // For immediate cleanup if sure:
-        // socket->deleteLater(); // Might be problematic if disconnect isn't immediate?
-    });
+QByteArray AuthServer::renderMetrics() const {
+    QByteArray out;
+    out += "# TYPE librify_http_requests_total counter\n";
+    out += "librify_http_requests_total " + QByteArray::number(m_requestsServed.load()) + '\n';
+    out += "# TYPE librify_http_connections_total counter\n";
+    out += "librify_http_connections_total " + QByteArray::number(m_connectionsAccepted.load()) + '\n';
+    out += "# TYPE librify_http_open_connections gauge\n";
+    out += "librify_http_open_connections " + QByteArray::number(m_connections.size()) + '\n';
+    MetricsRegistry::appendPrometheus(out);
+    return out;
+}
+
+//=============================================================================
+// HELPER: Responses
+//=============================================================================
+void AuthServer::writeResponse(QTcpSocket *socket, const Response &response, bool keepAlive) {
+    QByteArray out;
+    out.reserve(response.body.size() + 160);
+    out += "HTTP/1.1 " + QByteArray::number(response.status) + ' ' + reasonPhrase(response.status) + "\r\n";
+    out += "Content-Type: " + response.contentType + "\r\n";
+    out += "Content-Length: " + QByteArray::number(response.body.size()) + "\r\n";
+    out += "Cache-Control: no-store\r\n";
+    out += keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    out += "\r\n";
+    out += response.body;
+    socket->write(out); // one write per response keeps pipelined replies in order and packets full
+}
+
+AuthServer::Response AuthServer::json(const QJsonDocument &document, int status) {
+    Response response;
+    response.status = status;
+    response.body = document.toJson(QJsonDocument::Compact);
+    return response;
+}
+
+AuthServer::Response AuthServer::error(int status, const QString &message) {
+    return json(QJsonDocument(QJsonObject{{"error", message}}), status);
+}
 
-    // Handle socket errors and disconnection for cleanup
-    connect(socket, &QTcpSocket::disconnected, this, [socket](){
-        // qDebug() << "AuthServer socket disconnected, cleaning up.";
-        socket->deleteLater(); // Safe cleanup after disconnect
-    });
-    connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::errorOccurred), this, [socket](QAbstractSocket::SocketError error){
-        qWarning() << "[AuthServer] AuthServer socket error:" << error << socket->errorString();
-        socket->deleteLater(); // Clean up on error too
-    });
+QByteArray AuthServer::reasonPhrase(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Content Too Large";
+    case 415: return "Unsupported Media Type";
+    case 431: return "Request Header Fields Too Large";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    case 505: return "HTTP Version Not Supported";
+    default: return "Unknown";
+    }
 }
 
 // Make sure extractCodeFromRequest is robust
-QString AuthServer::extractCodeFromRequest(const QString &request) {
-    // Find the first line (request line)
-    int firstLineEnd = request.indexOf("\r\n");
-    if (firstLineEnd == -1) return QString(); // Invalid request format
-    QString requestLine = request.left(firstLineEnd);
-
-    // Split the request line (e.g., "GET /callback?code=... HTTP/1.1")
-    QStringList parts = requestLine.split(' ');
-    if (parts.size() < 2) return QString(); // Invalid request line
-
-    // The second part should contain the path and query
-    QString pathAndQuery = parts[1];
-
-    // Use QUrl to parse the path and query items safely
-    // Need a base URL for QUrlQuery to work correctly with relative paths
-    QUrl url = QUrl::fromUserInput("http://localhost" + pathAndQuery);
-    QUrlQuery query(url.query()); // Pass the query part to QUrlQuery
-
-    if (query.hasQueryItem("code")) {
-        return query.queryItemValue("code");
-    } else if (query.hasQueryItem("error")) {
+QString AuthServer::extractCodeFromRequest(const HttpRequest &request) {
+    if (request.query.hasQueryItem("code")) {
+        return request.query.queryItemValue("code", QUrl::FullyDecoded);
+    } else if (request.query.hasQueryItem("error")) {
         // Optional: Handle error responses from Spotify
-        qWarning() << "[AuthServer] Spotify authorization error received:" << query.queryItemValue("error")
-                   << "[AuthServer] Description:" << query.queryItemValue("error_description");
+        qWarning() << "[AuthServer] Spotify authorization error received:" << request.query.queryItemValue("error")
+                   << "[AuthServer] Description:" << request.query.queryItemValue("error_description");
         return QString(); // Return empty on error
     }
 
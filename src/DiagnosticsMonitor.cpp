@@ -0,0 +1,172 @@
+// DiagnosticsMonitor.cpp
+#include "DiagnosticsMonitor.h"
+#include "MetricsRegistry.h"
+#include "StartupProfiler.h"
+
+#include <QClipboard>
+#include <QDateTime>
+#include <QDir>
+#include <QGuiApplication>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+constexpr int RefreshIntervalMs = 1000;
+
+struct HistogramRow {
+    const char *section;
+    const char *label;
+    const char *key;
+};
+
+// Display order; keys are MetricsRegistry histogram names
+const HistogramRow HistogramRows[] = {
+    {"Scan", "Throughput", "scanFilesPerSecond"},
+    {"Scan", "Throughput (data)", "scanBytesPerSecond"},
+    {"Scan", "Tag read", "tagReadMicros"},
+    {"Scan", "Scan", "scanMicros"},
+    {"Index", "Build", "indexBuildMicros"},
+    {"Index", "Load", "indexLoadMicros"},
+    {"Startup", "First frame", "startupMicros"},
+    {"Frames", "Frame time", "frameMicros"},
+    {"Frames", "Render", "frameRenderMicros"},
+    {"Track list", "Sort", "sortMicros"},
+    {"Track list", "tracksChanged payload", "tracksChangedTracks"},
+    {"Playback", "Start", "playbackStartMicros"},
+};
+
+QVariantMap row(const QString &section, const QString &label, const QString &value) {
+    return {{"section", section}, {"label", label}, {"value", value}};
+}
+}
+
+DiagnosticsMonitor::DiagnosticsMonitor(QObject *parent) : QObject(parent) {
+    m_refreshTimer.setInterval(RefreshIntervalMs);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &DiagnosticsMonitor::refresh);
+}
+
+void DiagnosticsMonitor::setActive(bool active) {
+    if (m_active == active) return;
+    m_active = active;
+    if (m_active) {
+        refresh();
+        m_refreshTimer.start();
+    } else {
+        m_refreshTimer.stop();
+    }
+    emit activeChanged();
+}
+
+//=============================================================================
+// SLOT: Rebuilds the pane rows from a fresh snapshot
+//=============================================================================
+void DiagnosticsMonitor::refresh() {
+    const QVariantMap snapshot = MetricsRegistry::snapshot();
+    const QVariantMap histograms = snapshot.value("histograms").toMap();
+    const QVariantMap counters = snapshot.value("counters").toMap();
+    const QVariantMap memory = snapshot.value("memory").toMap();
+
+    QVariantList rows;
+    for (const HistogramRow &entry : HistogramRows) {
+        const QVariantMap values = histograms.value(entry.key).toMap();
+        const QString unit = values.value("unit").toString();
+        const qint64 count = values.value("count").toLongLong();
+        const QString text = count == 0
+            ? QStringLiteral("–")
+            : QStringLiteral("p50 %1 · p99 %2 · max %3 (n=%4)")
+                  .arg(formatValue(values.value("p50").toDouble(), unit),
+                       formatValue(values.value("p99").toDouble(), unit),
+                       formatValue(values.value("max").toDouble(), unit))
+                  .arg(count);
+        rows.append(row(entry.section, entry.label, text));
+    }
+
+    const quint64 coverHits = counters.value("coverCacheHits").toULongLong();
+    const quint64 coverLookups = coverHits + counters.value("coverCacheMisses").toULongLong();
+    rows.append(row("Covers", "Cache hit rate",
+                    coverLookups == 0 ? QStringLiteral("–")
+                                      : QStringLiteral("%1% of %2 lookups")
+                                            .arg(counters.value("coverCacheHitRate").toDouble() * 100.0, 0, 'f', 1)
+                                            .arg(coverLookups)));
+    rows.append(row("Scan", "Total scanned",
+                    QStringLiteral("%1 files, %2")
+                        .arg(counters.value("scannedFiles").toULongLong())
+                        .arg(formatValue(counters.value("scannedBytes").toDouble(), "bytes"))));
+    rows.append(row("Scan", "Isolated / quarantined",
+                    QStringLiteral("%1 / %2")
+                        .arg(counters.value("isolatedReads").toULongLong())
+                        .arg(counters.value("quarantinedFiles").toULongLong())));
+
+    rows.append(row("Frames", "Long frames",
+                    QStringLiteral("%1 (after model reset %2 · creating delegates %3)")
+                        .arg(counters.value("longFrames").toULongLong())
+                        .arg(counters.value("longFramesAfterReset").toULongLong())
+                        .arg(counters.value("longFramesWithDelegates").toULongLong())));
+
+    for (const QVariant &entry : StartupProfiler::phases()) {
+        const QVariantMap phase = entry.toMap();
+        rows.append(row("Startup", (phase.value("deferred").toBool() ? "Deferred: " : "") + phase.value("phase").toString(),
+                        QStringLiteral("%1 ms").arg(phase.value("ms").toDouble(), 0, 'f', 1)));
+    }
+
+    const qint64 resident = memory.value("process").toLongLong();
+    rows.append(row("Memory", "Process (resident)", resident < 0 ? QStringLiteral("n/a") : formatValue(resident, "bytes")));
+    for (auto it = memory.cbegin(); it != memory.cend(); ++it) {
+        if (it.key() == "process") continue;
+        rows.append(row("Memory", it.key(), "~" + formatValue(it.value().toDouble(), "bytes")));
+    }
+
+    m_rows = rows;
+    emit rowsChanged();
+}
+
+//=============================================================================
+// FUNCTION: Snapshot export
+//=============================================================================
+QString DiagnosticsMonitor::exportSnapshot() {
+    const QString directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/diagnostics";
+    QDir().mkpath(directory);
+    const QString filePath = directory + "/librify-metrics-"
+                             + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".json";
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[DiagnosticsMonitor] Cannot write snapshot:" << filePath;
+        return QString();
+    }
+    file.write(MetricsRegistry::snapshotJson());
+    if (!file.commit()) {
+        qWarning() << "[DiagnosticsMonitor] Failed to write snapshot:" << filePath;
+        return QString();
+    }
+    qDebug() << "[DiagnosticsMonitor] Wrote snapshot to" << filePath;
+    return QDir::toNativeSeparators(filePath);
+}
+
+void DiagnosticsMonitor::copySnapshotToClipboard() {
+    QGuiApplication::clipboard()->setText(QString::fromUtf8(MetricsRegistry::snapshotJson()));
+}
+
+void DiagnosticsMonitor::resetMetrics() {
+    MetricsRegistry::reset();
+    if (m_active) refresh();
+}
+
+//=============================================================================
+// HELPER: Unit formatting
+//=============================================================================
+QString DiagnosticsMonitor::formatValue(double value, const QString &unit) {
+    if (unit == "us") {
+        if (value < 1000.0) return QString::number(value, 'f', 0) + " µs";
+        if (value < 1e6) return QString::number(value / 1000.0, 'f', 1) + " ms";
+        return QString::number(value / 1e6, 'f', 2) + " s";
+    }
+    if (unit == "bytes" || unit == "bytes/s") {
+        const QString suffix = unit == "bytes/s" ? "/s" : "";
+        if (value < 1024.0) return QString::number(value, 'f', 0) + " B" + suffix;
+        if (value < 1024.0 * 1024.0) return QString::number(value / 1024.0, 'f', 1) + " KB" + suffix;
+        if (value < 1024.0 * 1024.0 * 1024.0) return QString::number(value / (1024.0 * 1024.0), 'f', 1) + " MB" + suffix;
+        return QString::number(value / (1024.0 * 1024.0 * 1024.0), 'f', 2) + " GB" + suffix;
+    }
+    return QString::number(value, 'f', 0) + ' ' + unit;
+}
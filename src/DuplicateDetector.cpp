@@ -0,0 +1,102 @@
+// DuplicateDetector.cpp
+#include "DuplicateDetector.h"
+#include "AudioPayload.h"
+#include "LibraryIndex.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+
+//=============================================================================
+// FUNCTION: Hashes the library (cached) and clusters duplicates
+//=============================================================================
+QList<DuplicateDetector::Group> DuplicateDetector::findDuplicates(const QList<Track> &tracks, LibraryIndex *index) {
+    QElapsedTimer timer;
+    timer.start();
+    std::atomic_int hashedCount{0};
+
+    // 1. Payload hashes, in parallel; unchanged files come straight from the index
+    const QList<quint64> hashes = QtConcurrent::blockingMapped<QList<quint64>>(tracks,
+        [index, &hashedCount](const Track &track) -> quint64 {
+            LibraryIndex::FileStat stat;
+            if (!LibraryIndex::statFile(track.filePath, &stat)) return quint64(0);
+            LibraryIndex::Record record;
+            if (index && index->lookupFresh(track.filePath, stat, &record) && record.audioHash != 0) {
+                return record.audioHash;
+            }
+            const quint64 audioHash = AudioPayload::hash(track.filePath);
+            if (index && audioHash != 0) index->storeAudioHash(track.filePath, stat, audioHash);
+            ++hashedCount;
+            return audioHash;
+        });
+
+    // 2. Exact duplicates: identical payload hash
+    QList<Group> groups;
+    QHash<quint64, QList<int>> byHash;
+    for (int i = 0; i < tracks.size(); ++i) {
+        if (hashes.at(i) != 0) byHash[hashes.at(i)].append(i);
+    }
+    QSet<int> grouped;
+    for (auto it = byHash.cbegin(); it != byHash.cend(); ++it) {
+        if (it->size() < 2) continue;
+        Group group;
+        group.exact = true;
+        for (int i : *it) {
+            group.indices.append(tracks.at(i).index);
+            grouped.insert(i);
+        }
+        groups.append(group);
+    }
+    const int exactGroupCount = groups.size();
+
+    // 3. Candidates: same normalized title, chained by durations within the tolerance
+    QHash<QString, QList<int>> byTitle;
+    for (int i = 0; i < tracks.size(); ++i) {
+        if (grouped.contains(i) || tracks.at(i).durationMs <= 0) continue;
+        const QString key = normalizedTitle(tracks.at(i).title);
+        if (!key.isEmpty()) byTitle[key].append(i);
+    }
+    for (auto it = byTitle.begin(); it != byTitle.end(); ++it) {
+        QList<int> &members = it.value();
+        if (members.size() < 2) continue;
+        std::sort(members.begin(), members.end(), [&tracks](int a, int b) {
+            return tracks.at(a).durationMs < tracks.at(b).durationMs;
+        });
+        Group group;
+        for (int m = 0; m < members.size(); ++m) {
+            const bool continues = m > 0
+                && tracks.at(members.at(m)).durationMs - tracks.at(members.at(m - 1)).durationMs <= DurationToleranceMs;
+            if (!continues) {
+                if (group.indices.size() > 1) groups.append(group);
+                group = Group();
+            }
+            group.indices.append(tracks.at(members.at(m)).index);
+        }
+        if (group.indices.size() > 1) groups.append(group);
+    }
+
+    qDebug() << "[DuplicateDetector]" << tracks.size() << "tracks," << hashedCount.load() << "hashed in"
+             << timer.elapsed() << "ms:" << exactGroupCount << "exact groups,"
+             << groups.size() - exactGroupCount << "candidate groups.";
+    return groups;
+}
+
+//=============================================================================
+// HELPER: Case-folded title without bracketed suffixes or punctuation
+//=============================================================================
+QString DuplicateDetector::normalizedTitle(const QString &title) {
+    static const QRegularExpression bracketed(QStringLiteral("[\\(\\[][^\\)\\]]*[\\)\\]]"));
+    QString text = title;
+    text.remove(bracketed);
+    QString normalized;
+    normalized.reserve(text.size());
+    for (const QChar c : text) {
+        if (c.isLetterOrNumber()) normalized.append(c.toCaseFolded());
+    }
+    return normalized;
+}
@@ -0,0 +1,71 @@
+// Fft.cpp
+#include "Fft.h"
+
+#include <cmath>
+#include <utility>
+
+Fft::Fft(int size) : m_size(size) {
+    // bit-reversal permutation
+    int bits = 0;
+    while ((1 << bits) < m_size) ++bits;
+    m_bitReverse.resize(m_size);
+    for (int i = 0; i < m_size; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b)) reversed |= 1 << (bits - 1 - b);
+        }
+        m_bitReverse[i] = reversed;
+    }
+
+    // per-stage twiddles, laid out contiguously so the butterflies read them with unit stride
+    m_twiddleRe.reserve(m_size > 1 ? m_size - 1 : 0);
+    m_twiddleIm.reserve(m_size > 1 ? m_size - 1 : 0);
+    for (int len = 2; len <= m_size; len <<= 1) {
+        const int half = len / 2;
+        for (int j = 0; j < half; ++j) {
+            const double angle = -2.0 * M_PI * j / len;
+            m_twiddleRe.push_back(static_cast<float>(std::cos(angle)));
+            m_twiddleIm.push_back(static_cast<float>(std::sin(angle)));
+        }
+    }
+}
+
+void Fft::transform(float *re, float *im) const {
+    for (int i = 0; i < m_size; ++i) {
+        const int j = m_bitReverse[i];
+        if (j > i) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    const float *stageRe = m_twiddleRe.data();
+    const float *stageIm = m_twiddleIm.data();
+    for (int len = 2; len <= m_size; len <<= 1) {
+        const int half = len / 2;
+        for (int start = 0; start < m_size; start += len) {
+            float *ar = re + start;
+            float *ai = im + start;
+            float *br = ar + half;
+            float *bi = ai + half;
+            for (int j = 0; j < half; ++j) {
+                const float tr = br[j] * stageRe[j] - bi[j] * stageIm[j];
+                const float ti = br[j] * stageIm[j] + bi[j] * stageRe[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+        stageRe += half;
+        stageIm += half;
+    }
+}
+
+std::vector<float> Fft::hannWindow(int size) {
+    std::vector<float> window(size);
+    for (int i = 0; i < size; ++i) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * i / size));
+    }
+    return window;
+}
@@ -0,0 +1,113 @@
+// FolderTree.cpp
+#include "FolderTree.h"
+
+#include <QFileInfo>
+#include <QStringList>
+#include <algorithm>
+
+void FolderTree::clear() {
+    m_nodes.clear();
+    m_roots.clear();
+    m_byPath.clear();
+}
+
+void FolderTree::addRoot(const QString &rootPath) {
+    if (rootPath.isEmpty() || m_byPath.contains(rootPath)) return;
+    Node node;
+    node.path = rootPath;
+    node.name = QFileInfo(rootPath).fileName();
+    if (node.name.isEmpty()) node.name = rootPath; // "/" or "C:/"
+    const int id = int(m_nodes.size());
+    m_nodes.append(node);
+    m_byPath.insert(rootPath, id);
+    m_roots.append(id);
+    if (!m_knownRoots.contains(rootPath)) {
+        m_knownRoots.insert(rootPath);
+        m_expandedPaths.insert(rootPath);
+    }
+}
+
+//=============================================================================
+// FUNCTION: Files a track under its folder, creating missing folders
+//=============================================================================
+void FolderTree::addTrack(const QString &filePath, int trackIndex) {
+    const QString directory = filePath.left(qMax(0, int(filePath.lastIndexOf('/'))));
+    int id = m_byPath.value(directory, -1);
+    if (id < 0) {
+        // Walk up to the nearest known folder; everything in between is new
+        QStringList missing{directory};
+        QString ancestor = directory;
+        int ancestorId = -1;
+        for (int slash = int(ancestor.lastIndexOf('/')); slash > 0; slash = int(ancestor.lastIndexOf('/'))) {
+            ancestor.truncate(slash);
+            ancestorId = m_byPath.value(ancestor, -1);
+            if (ancestorId >= 0) break;
+            missing.prepend(ancestor);
+        }
+        if (ancestorId < 0) {
+            addRoot(directory);
+            id = m_byPath.value(directory, -1);
+            if (id < 0) return;
+        } else {
+            id = ancestorId;
+            for (const QString &path : std::as_const(missing)) {
+                Node node;
+                node.path = path;
+                node.name = path.mid(path.lastIndexOf('/') + 1);
+                node.parent = id;
+                node.depth = m_nodes.at(id).depth + 1;
+                const int childId = int(m_nodes.size());
+                m_nodes.append(node);
+                m_byPath.insert(path, childId);
+                m_nodes[id].children.append(childId);
+                id = childId;
+            }
+        }
+    }
+    m_nodes[id].tracks.append(trackIndex);
+    for (int node = id; node >= 0; node = m_nodes.at(node).parent) ++m_nodes[node].trackCount;
+}
+
+void FolderTree::finalize() {
+    for (Node &node : m_nodes) {
+        std::sort(node.children.begin(), node.children.end(), [this](int a, int b) {
+            return QString::compare(m_nodes.at(a).name, m_nodes.at(b).name, Qt::CaseInsensitive) < 0;
+        });
+    }
+}
+
+bool FolderTree::toggleExpanded(const QString &path) {
+    if (m_expandedPaths.remove(path)) return false;
+    m_expandedPaths.insert(path);
+    return true;
+}
+
+//=============================================================================
+// FUNCTION: Tree walks (cost is the size of what they return)
+//=============================================================================
+QList<int> FolderTree::visibleNodes() const {
+    QList<int> visible;
+    QList<int> stack(m_roots.crbegin(), m_roots.crend());
+    while (!stack.isEmpty()) {
+        const int id = stack.takeLast();
+        visible.append(id);
+        if (!isExpanded(id)) continue;
+        const QList<int> &children = m_nodes.at(id).children;
+        for (auto it = children.crbegin(); it != children.crend(); ++it) stack.append(*it);
+    }
+    return visible;
+}
+
+QList<int> FolderTree::tracksUnder(const QString &path) const {
+    QList<int> tracks;
+    const int start = nodeFor(path);
+    if (start < 0) return tracks;
+    tracks.reserve(m_nodes.at(start).trackCount);
+    QList<int> stack{start};
+    while (!stack.isEmpty()) {
+        const Node &node = m_nodes.at(stack.takeLast());
+        tracks += node.tracks;
+        stack += node.children;
+    }
+    return tracks;
+}
@@ -0,0 +1,96 @@
+// FrameTimeMonitor.cpp
+#include "FrameTimeMonitor.h"
+#include "LogCategories.h"
+#include "MetricsRegistry.h"
+#include "Trace.h"
+
+#include <QQuickWindow>
+
+#include <atomic>
+
+namespace {
+// Noted since the last frameSwapped; taken by the render thread
+std::atomic<quint64> pendingModelResets{0};
+std::atomic<quint64> pendingDelegates{0};
+std::atomic<qint64> firstNoteNs{-1}; // time of the first of them
+
+void noteNow() {
+    if (firstNoteNs.load(std::memory_order_relaxed) >= 0) return;
+    qint64 expected = -1;
+    firstNoteNs.compare_exchange_strong(expected, Trace::Detail::nowNs(), std::memory_order_relaxed);
+}
+}
+
+FrameTimeMonitor::FrameTimeMonitor(QObject *parent) : QObject(parent) {}
+
+void FrameTimeMonitor::attach(QQuickWindow *window) {
+    if (m_window) {
+        disconnect(m_beforeSynchronizingConnection);
+        disconnect(m_beforeRenderingConnection);
+        disconnect(m_frameSwappedConnection);
+    }
+    m_window = window;
+    m_lastSwapNs = -1;
+    m_syncStartNs = -1;
+    m_renderStartNs = -1;
+    if (!window) return;
+    // Direct: all three are emitted on the render thread, the handlers only touch atomics
+    m_beforeSynchronizingConnection = connect(window, &QQuickWindow::beforeSynchronizing, this,
+                                              [this]() { handleBeforeSynchronizing(); }, Qt::DirectConnection);
+    m_beforeRenderingConnection = connect(window, &QQuickWindow::beforeRendering, this,
+                                          [this]() { handleBeforeRendering(); }, Qt::DirectConnection);
+    m_frameSwappedConnection = connect(window, &QQuickWindow::frameSwapped, this,
+                                       [this]() { handleFrameSwapped(); }, Qt::DirectConnection);
+}
+
+void FrameTimeMonitor::noteModelReset() {
+    pendingModelResets.fetch_add(1, std::memory_order_relaxed);
+    noteNow();
+}
+
+void FrameTimeMonitor::noteDelegateCreated() {
+    pendingDelegates.fetch_add(1, std::memory_order_relaxed);
+    noteNow();
+}
+
+void FrameTimeMonitor::handleBeforeSynchronizing() {
+    if (m_syncStartNs < 0) m_syncStartNs = Trace::Detail::nowNs();
+}
+
+void FrameTimeMonitor::handleBeforeRendering() {
+    m_renderStartNs = Trace::Detail::nowNs();
+}
+
+//=============================================================================
+// FUNCTION: One frame on screen (render thread)
+//=============================================================================
+void FrameTimeMonitor::handleFrameSwapped() {
+    const qint64 now = Trace::Detail::nowNs();
+    const quint64 resets = pendingModelResets.exchange(0, std::memory_order_relaxed);
+    const quint64 delegates = pendingDelegates.exchange(0, std::memory_order_relaxed);
+    const qint64 noteNs = firstNoteNs.exchange(-1, std::memory_order_relaxed);
+    const qint64 syncStartNs = m_syncStartNs;
+    m_syncStartNs = -1;
+    if (m_renderStartNs >= 0) Metrics::frameRenderMicros.record((now - m_renderStartNs) / 1000);
+    m_renderStartNs = -1;
+
+    const qint64 previous = m_lastSwapNs;
+    m_lastSwapNs = now;
+    if (previous < 0) return;
+    // Qt Quick only renders on change, so the time since the previous swap may be
+    // any amount of idling: start at whatever woke the scene up instead
+    qint64 frameStartNs = syncStartNs;
+    if (noteNs >= previous && (frameStartNs < 0 || noteNs < frameStartNs)) frameStartNs = noteNs;
+    if (frameStartNs < 0) return;
+    const qint64 intervalNs = now - frameStartNs;
+
+    Metrics::frameMicros.record(intervalNs / 1000);
+    if (Trace::isEnabled()) Trace::Detail::record("ui", "frame", frameStartNs, intervalNs, qint64(delegates));
+    if (intervalNs / 1000 <= LongFrameMicros) return;
+
+    Metrics::longFrames.fetch_add(1, std::memory_order_relaxed);
+    if (resets > 0) Metrics::longFramesAfterReset.fetch_add(1, std::memory_order_relaxed);
+    if (delegates > 0) Metrics::longFramesWithDelegates.fetch_add(1, std::memory_order_relaxed);
+    qCDebug(lcFrames) << "[FrameTimeMonitor] Long frame:" << intervalNs / 1000000 << "ms after" << resets
+                      << "model resets," << delegates << "delegates created";
+}
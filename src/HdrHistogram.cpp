@@ -0,0 +1,67 @@
+// HdrHistogram.cpp
+#include "HdrHistogram.h"
+
+#include <bit>
+#include <cmath>
+
+int HdrHistogram::bucketIndex(quint64 value) {
+    if (value < (quint64(1) << ExactBits)) return int(value);
+    // Keep the top ExactBits bits: value >> shift lies in [SubBuckets, 2 * SubBuckets)
+    const int shift = int(std::bit_width(value)) - ExactBits;
+    const int subBucket = int(value >> shift) - SubBuckets;
+    return (1 << ExactBits) + (shift - 1) * SubBuckets + subBucket;
+}
+
+qint64 HdrHistogram::bucketMidpoint(int index) {
+    if (index < (1 << ExactBits)) return index;
+    const int offset = index - (1 << ExactBits);
+    const int shift = offset / SubBuckets + 1;
+    const qint64 lower = qint64(SubBuckets + offset % SubBuckets) << shift;
+    return lower + (qint64(1) << shift) / 2;
+}
+
+void HdrHistogram::record(qint64 value) {
+    value = qMax<qint64>(value, 0);
+    m_buckets[bucketIndex(quint64(value))].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    qint64 seen = m_min.load(std::memory_order_relaxed);
+    while (value < seen && !m_min.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+    seen = m_max.load(std::memory_order_relaxed);
+    while (value > seen && !m_max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+}
+
+void HdrHistogram::reset() {
+    for (auto &bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(std::numeric_limits<qint64>::max(), std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+qint64 HdrHistogram::min() const {
+    return count() == 0 ? 0 : m_min.load(std::memory_order_relaxed);
+}
+
+qint64 HdrHistogram::max() const {
+    return m_max.load(std::memory_order_relaxed);
+}
+
+double HdrHistogram::mean() const {
+    const quint64 n = count();
+    return n == 0 ? 0.0 : double(m_sum.load(std::memory_order_relaxed)) / double(n);
+}
+
+qint64 HdrHistogram::valueAtQuantile(double q) const {
+    // Sum the buckets rather than trusting m_count, which may run ahead of them
+    quint64 total = 0;
+    for (const auto &bucket : m_buckets) total += bucket.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+    const quint64 rank = qMax<quint64>(1, quint64(std::ceil(qBound(0.0, q, 1.0) * double(total))));
+    quint64 cumulative = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        cumulative += m_buckets[i].load(std::memory_order_relaxed);
+        if (cumulative >= rank) return qBound(min(), bucketMidpoint(i), max());
+    }
+    return max();
+}
@@ -0,0 +1,134 @@
+// HttpRequestParser.cpp
+#include "HttpRequestParser.h"
+
+#include <QUrl>
+
+bool HttpRequest::keepAlive() const {
+    const QByteArray connection = header("connection").toLower();
+    if (connection.contains("close")) return false;
+    return minorVersion >= 1 || connection.contains("keep-alive");
+}
+
+//=============================================================================
+// FUNCTION: Feeding bytes
+//=============================================================================
+HttpRequestParser::Status HttpRequestParser::feed(const QByteArray &data) {
+    if (m_state == State::Failed) return Status::Error;
+    m_buffer.append(data);
+    return next();
+}
+
+HttpRequestParser::Status HttpRequestParser::next() {
+    switch (m_state) {
+    case State::Failed: return Status::Error;
+    case State::Done: return Status::Complete;
+    case State::Body: break;
+    case State::Head: {
+        // Stray CRLFs between pipelined requests are allowed (RFC 9112 2.2)
+        while (m_scanFrom == 0 && m_buffer.startsWith("\r\n")) m_buffer.remove(0, 2);
+        const qsizetype end = m_buffer.indexOf("\r\n\r\n", qMax<qsizetype>(0, m_scanFrom - 3));
+        if (end < 0) {
+            m_scanFrom = m_buffer.size();
+            if (m_buffer.size() > MaxHeaderBytes) return fail(431, "Request Header Fields Too Large");
+            return Status::NeedMoreData;
+        }
+        if (end > MaxHeaderBytes) return fail(431, "Request Header Fields Too Large");
+        const QByteArray head = m_buffer.left(end);
+        m_buffer.remove(0, end + 4);
+        m_scanFrom = 0;
+        if (!parseHead(head)) return Status::Error;
+        m_state = State::Body;
+        break;
+    }
+    }
+
+    if (m_buffer.size() < m_contentLength) return Status::NeedMoreData;
+    m_request.body = m_buffer.left(m_contentLength);
+    m_buffer.remove(0, m_contentLength);
+    m_state = State::Done;
+    return Status::Complete;
+}
+
+HttpRequest HttpRequestParser::takeRequest() {
+    HttpRequest request = std::move(m_request);
+    m_request = HttpRequest();
+    m_contentLength = 0;
+    if (m_state == State::Done) m_state = State::Head;
+    return request;
+}
+
+void HttpRequestParser::reset() {
+    m_buffer.clear();
+    m_scanFrom = 0;
+    m_contentLength = 0;
+    m_state = State::Head;
+    m_request = HttpRequest();
+    m_errorStatus = 0;
+    m_errorReason.clear();
+}
+
+HttpRequestParser::Status HttpRequestParser::fail(int status, const QByteArray &reason) {
+    m_state = State::Failed;
+    m_errorStatus = status;
+    m_errorReason = reason;
+    m_buffer.clear();
+    return Status::Error;
+}
+
+//=============================================================================
+// HELPER: Request line and header fields
+//=============================================================================
+bool HttpRequestParser::parseHead(const QByteArray &head) {
+    const QList<QByteArray> lines = head.split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() != 3 || requestLine[0].isEmpty() || !requestLine[1].startsWith('/')) {
+        fail(400, "Bad Request");
+        return false;
+    }
+    if (requestLine[2] == "HTTP/1.1") m_request.minorVersion = 1;
+    else if (requestLine[2] == "HTTP/1.0") m_request.minorVersion = 0;
+    else {
+        fail(505, "HTTP Version Not Supported");
+        return false;
+    }
+
+    m_request.method = requestLine[0];
+    m_request.target = requestLine[1];
+    const qsizetype queryStart = m_request.target.indexOf('?');
+    m_request.path = QUrl::fromPercentEncoding(m_request.target.left(queryStart));
+    if (queryStart >= 0) m_request.query.setQuery(QString::fromUtf8(m_request.target.mid(queryStart + 1)));
+
+    for (qsizetype i = 1; i < lines.size(); ++i) {
+        const QByteArray line = lines[i].trimmed();
+        if (line.isEmpty()) continue;
+        const qsizetype colon = line.indexOf(':');
+        if (colon <= 0) {
+            fail(400, "Bad Request");
+            return false;
+        }
+        const QByteArray name = line.left(colon).trimmed().toLower();
+        const QByteArray value = line.mid(colon + 1).trimmed();
+        auto it = m_request.headers.find(name);
+        if (it == m_request.headers.end()) m_request.headers.insert(name, value);
+        else *it += ", " + value;
+    }
+
+    if (m_request.headers.contains("transfer-encoding")) {
+        fail(501, "Not Implemented");
+        return false;
+    }
+    m_contentLength = 0;
+    if (m_request.headers.contains("content-length")) {
+        bool ok = false;
+        m_contentLength = m_request.header("content-length").toLongLong(&ok);
+        if (!ok || m_contentLength < 0) {
+            fail(400, "Bad Request");
+            return false;
+        }
+        if (m_contentLength > MaxBodyBytes) {
+            fail(413, "Content Too Large");
+            return false;
+        }
+    }
+    return true;
+}
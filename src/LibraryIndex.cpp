@@ -0,0 +1,373 @@
+// LibraryIndex.cpp
+#include "LibraryIndex.h"
+#include "AudioPayload.h"
+#include "LogCategories.h"
+#include "MetricsRegistry.h"
+#include "Trace.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace {
+constexpr quint32 IndexMagic = 0x4C4C4931; // "LLI1"
+constexpr qint32 IndexVersion = 4; // 3: tags include "isrc"; 4: "coverId", covers as raw bytes
+
+// Per-file values that are not tags; they are re-attached on every lookup
+const QStringList VolatileKeys = {"filePath", "bpm", "imageData", "imageMimeType"};
+}
+
+LibraryIndex::LibraryIndex() = default;
+
+bool LibraryIndex::statFile(const QString &filePath, FileStat *stat) {
+#ifdef Q_OS_UNIX
+    struct ::stat st;
+    const QByteArray nativePath = QFile::encodeName(filePath);
+    if (::stat(nativePath.constData(), &st) != 0) return false;
+    stat->device = static_cast<quint64>(st.st_dev);
+    stat->inode = static_cast<quint64>(st.st_ino);
+    stat->size = static_cast<qint64>(st.st_size);
+#ifdef Q_OS_MACOS
+    stat->modified = qint64(st.st_mtimespec.tv_sec) * 1000 + st.st_mtimespec.tv_nsec / 1000000;
+#else
+    stat->modified = qint64(st.st_mtim.tv_sec) * 1000 + st.st_mtim.tv_nsec / 1000000;
+#endif
+#else
+    const QFileInfo info(filePath);
+    if (!info.exists()) return false;
+    stat->size = info.size();
+    stat->modified = info.lastModified().toMSecsSinceEpoch();
+#endif
+    return true;
+}
+
+//=============================================================================
+// Lookups / updates (any thread)
+//=============================================================================
+bool LibraryIndex::lookupFresh(const QString &filePath, const FileStat &stat, Record *record) const {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_records.constFind(filePath);
+    if (it == m_records.constEnd() || it->size != stat.size || it->modified != stat.modified) {
+        return false;
+    }
+    if (record) *record = *it;
+    return true;
+}
+
+void LibraryIndex::storeTags(const QString &filePath, const FileStat &stat, quint64 fingerprint, const QVariantMap &tags) {
+    QMutexLocker locker(&m_mutex);
+    Record record;
+    auto it = m_records.constFind(filePath);
+    if (it != m_records.constEnd() && it->size == stat.size && it->modified == stat.modified) {
+        record.audioHash = it->audioHash; // content unchanged, hash still valid
+    }
+    record.size = stat.size;
+    record.modified = stat.modified;
+    record.device = stat.device;
+    record.inode = stat.inode;
+    record.fingerprint = fingerprint;
+    record.coverKey = storeCoverLocked(tags);
+    record.tags = tags;
+    for (const QString &key : VolatileKeys) record.tags.remove(key);
+    insertLocked(filePath, record);
+}
+
+void LibraryIndex::storeAudioHash(const QString &filePath, const FileStat &stat, quint64 audioHash) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_records.find(filePath);
+    if (it != m_records.end() && it->size == stat.size && it->modified == stat.modified) {
+        it->audioHash = audioHash;
+        m_dirty = true;
+        return;
+    }
+    Record record;
+    record.size = stat.size;
+    record.modified = stat.modified;
+    record.device = stat.device;
+    record.inode = stat.inode;
+    record.audioHash = audioHash;
+    insertLocked(filePath, record);
+}
+
+QVariantMap LibraryIndex::cachedTags(const QString &filePath) const {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_records.constFind(filePath);
+    if (it == m_records.constEnd() || it->tags.isEmpty()) return QVariantMap();
+    QVariantMap tags = it->tags;
+    tags.insert("filePath", filePath);
+    return tags;
+}
+
+//=============================================================================
+// Cover table (any thread)
+//=============================================================================
+void LibraryIndex::takeCover(QVariantMap *tags) {
+    if (!tags->contains("imageData")) return;
+    {
+        QMutexLocker locker(&m_mutex);
+        storeCoverLocked(*tags);
+    }
+    tags->remove("imageData");
+    tags->remove("imageMimeType");
+}
+
+QByteArray LibraryIndex::coverData(const QString &coverId, QString *mimeType) const {
+    QMutexLocker locker(&m_mutex);
+    const QPair<QString, QByteArray> cover = m_covers.value(coverId.toULongLong(nullptr, 16));
+    if (mimeType) *mimeType = cover.first;
+    return cover.second;
+}
+
+QStringList LibraryIndex::coverIds() const {
+    QMutexLocker locker(&m_mutex);
+    QStringList ids;
+    ids.reserve(m_covers.size());
+    for (auto it = m_covers.cbegin(); it != m_covers.cend(); ++it) {
+        ids.append(QString::number(it.key(), 16).rightJustified(16, '0'));
+    }
+    return ids;
+}
+
+//=============================================================================
+// Move / rename tracking
+//=============================================================================
+QString LibraryIndex::findMovedFrom(const QString &filePath, const FileStat &stat, const QSet<QString> &stillPresent) const {
+    // 1. Candidates: same inode first (same filesystem), then same size+mtime (moved across filesystems)
+    QStringList candidates;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (stat.device != 0 || stat.inode != 0) {
+            const QString byIdentity = m_byIdentity.value(Identity(stat.device, stat.inode));
+            if (!byIdentity.isEmpty()) candidates.append(byIdentity);
+        }
+        const QList<QString> bySignature = m_bySignature.values(Signature(stat.size, stat.modified));
+        for (const QString &path : bySignature) {
+            if (!candidates.contains(path)) candidates.append(path);
+        }
+    }
+
+    // 2. Only records whose file really vanished, with unchanged content and a matching fingerprint
+    quint64 fingerprint = 0;
+    for (const QString &oldPath : std::as_const(candidates)) {
+        if (oldPath == filePath || stillPresent.contains(oldPath) || QFileInfo::exists(oldPath)) continue;
+        Record record;
+        {
+            QMutexLocker locker(&m_mutex);
+            auto it = m_records.constFind(oldPath);
+            if (it == m_records.constEnd()) continue;
+            record = *it;
+        }
+        if (record.size != stat.size || record.modified != stat.modified || record.fingerprint == 0) continue;
+        if (fingerprint == 0) fingerprint = AudioPayload::fingerprint(filePath);
+        if (fingerprint == record.fingerprint) return oldPath;
+    }
+    return QString();
+}
+
+void LibraryIndex::rename(const QString &oldPath, const QString &newPath, const FileStat &stat) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_records.constFind(oldPath);
+    if (it == m_records.constEnd()) return;
+    Record record = *it;
+    record.device = stat.device;
+    record.inode = stat.inode;
+    removeLocked(oldPath);
+    insertLocked(newPath, record);
+}
+
+void LibraryIndex::prune(const QSet<QString> &livePaths) {
+    QMutexLocker locker(&m_mutex);
+    QStringList stale;
+    for (auto it = m_records.cbegin(); it != m_records.cend(); ++it) {
+        // Records outside the scanned folder are kept while the file exists
+        if (!livePaths.contains(it.key()) && !QFileInfo::exists(it.key())) stale.append(it.key());
+    }
+    for (const QString &filePath : std::as_const(stale)) removeLocked(filePath);
+    if (!stale.isEmpty()) {
+        qCDebug(lcIndex) << "[LibraryIndex] Pruned" << stale.size() << "records of deleted files.";
+    }
+}
+
+void LibraryIndex::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_records.clear();
+    m_byIdentity.clear();
+    m_bySignature.clear();
+    m_covers.clear();
+    m_dirty = true;
+}
+
+int LibraryIndex::rebase(const QString &fromPrefix, const QString &toPrefix) {
+    // Whole path components only: /srv/music must not match /srv/music2
+    QString from = fromPrefix, to = toPrefix;
+    while (from.endsWith('/')) from.chop(1);
+    while (to.endsWith('/')) to.chop(1);
+    QMutexLocker locker(&m_mutex);
+    if (from == to) return 0;
+    QStringList keys;
+    for (auto it = m_records.cbegin(); it != m_records.cend(); ++it) {
+        if (it.key().startsWith(from + '/')) keys.append(it.key());
+    }
+    for (const QString &filePath : std::as_const(keys)) {
+        Record record = m_records.value(filePath);
+        removeLocked(filePath);
+        record.device = 0;
+        record.inode = 0;
+        insertLocked(to + filePath.mid(from.size()), record);
+    }
+    return keys.size();
+}
+
+int LibraryIndex::size() const {
+    QMutexLocker locker(&m_mutex);
+    return m_records.size();
+}
+
+qint64 LibraryIndex::memoryUsage() const {
+    QMutexLocker locker(&m_mutex);
+    qint64 bytes = 0;
+    for (auto it = m_records.cbegin(); it != m_records.cend(); ++it) {
+        bytes += qint64(sizeof(Record)) + 2 * it.key().size() + MetricsRegistry::estimateBytes(it->tags);
+    }
+    for (const auto &cover : std::as_const(m_covers)) bytes += 2 * cover.first.size() + cover.second.size();
+    // Lookup tables: a key and a (shared) path per entry
+    bytes += (m_byIdentity.size() + m_bySignature.size()) * qint64(sizeof(QString) + 2 * sizeof(qint64) + 16);
+    return bytes;
+}
+
+void LibraryIndex::insertLocked(const QString &filePath, const Record &record) {
+    removeLocked(filePath);
+    m_records.insert(filePath, record);
+    if (record.device != 0 || record.inode != 0) m_byIdentity.insert(Identity(record.device, record.inode), filePath);
+    m_bySignature.insert(Signature(record.size, record.modified), filePath);
+    m_dirty = true;
+}
+
+void LibraryIndex::removeLocked(const QString &filePath) {
+    auto it = m_records.find(filePath);
+    if (it == m_records.end()) return;
+    const Identity identity(it->device, it->inode);
+    if (m_byIdentity.value(identity) == filePath) m_byIdentity.remove(identity);
+    m_bySignature.remove(Signature(it->size, it->modified), filePath);
+    m_records.erase(it);
+    m_dirty = true;
+}
+
+// Keyed by coverId (LibraryScanner::coverIdFor); bytes of an already stored cover are dropped
+quint64 LibraryIndex::storeCoverLocked(const QVariantMap &tags) {
+    const quint64 key = tags.value("coverId").toString().toULongLong(nullptr, 16);
+    if (key == 0) return 0;
+    const QByteArray data = tags.value("imageData").toByteArray();
+    if (!data.isEmpty() && !m_covers.contains(key)) {
+        m_covers.insert(key, {tags.value("imageMimeType").toString(), data});
+    }
+    return key;
+}
+
+//=============================================================================
+// Persistence
+//=============================================================================
+void LibraryIndex::setFilePath(const QString &filePath) { m_filePath = filePath; }
+
+QString LibraryIndex::indexFilePath() const {
+    if (!m_filePath.isEmpty()) {
+        QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+        return m_filePath;
+    }
+    QString base = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(base);
+    return base + "/library.index";
+}
+
+void LibraryIndex::load() {
+    LIBRIFY_TRACE_SCOPE("index", "load");
+    QElapsedTimer timer;
+    timer.start();
+    QFile file(indexFilePath());
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != IndexMagic || version != IndexVersion || count < 0) {
+        qWarning() << "[LibraryIndex] Ignoring incompatible index file:" << file.fileName();
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_records.clear();
+    m_byIdentity.clear();
+    m_bySignature.clear();
+    m_covers.clear();
+    m_records.reserve(count);
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString filePath;
+        Record record;
+        in >> filePath >> record.size >> record.modified >> record.device >> record.inode
+           >> record.fingerprint >> record.audioHash >> record.coverKey >> record.tags;
+        insertLocked(filePath, record);
+    }
+    qint32 coverCount = 0;
+    in >> coverCount;
+    for (qint32 i = 0; i < coverCount && in.status() == QDataStream::Ok; ++i) {
+        quint64 key = 0;
+        QString mimeType;
+        QByteArray data;
+        in >> key >> mimeType >> data;
+        m_covers.insert(key, {mimeType, data});
+    }
+    m_dirty = false;
+    Metrics::indexLoadMicros.record(timer.nsecsElapsed() / 1000);
+    qCDebug(lcIndex) << "[LibraryIndex] Loaded" << m_records.size() << "records and" << m_covers.size() << "covers.";
+}
+
+bool LibraryIndex::save() const {
+    LIBRIFY_TRACE_SCOPE("index", "save");
+    QHash<QString, Record> records;
+    QHash<quint64, QPair<QString, QByteArray>> covers;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_dirty) return true;
+        records = m_records;
+        // Only covers still referenced by a record are written
+        for (const Record &record : std::as_const(m_records)) {
+            if (record.coverKey != 0 && !covers.contains(record.coverKey)) {
+                covers.insert(record.coverKey, m_covers.value(record.coverKey));
+            }
+        }
+        m_dirty = false;
+    }
+
+    QSaveFile file(indexFilePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[LibraryIndex] Failed to write index file:" << file.fileName();
+        return false;
+    }
+    QDataStream out(&file);
+    out << IndexMagic << IndexVersion << static_cast<qint32>(records.size());
+    for (auto it = records.cbegin(); it != records.cend(); ++it) {
+        out << it.key() << it->size << it->modified << it->device << it->inode
+            << it->fingerprint << it->audioHash << it->coverKey << it->tags;
+    }
+    out << static_cast<qint32>(covers.size());
+    for (auto it = covers.cbegin(); it != covers.cend(); ++it) {
+        out << it.key() << it->first << it->second;
+    }
+    if (!file.commit()) {
+        qWarning() << "[LibraryIndex] Failed to commit index file:" << file.fileName();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,509 @@
+// LibraryScanner.cpp
+#include "LibraryScanner.h"
+#include "AudioPayload.h"
+#include "LibraryIndex.h"
+#include "LogCategories.h"
+#include "MetricsRegistry.h"
+#include "ScanQuarantine.h"
+#include "StorageScheduler.h"
+#include "TagProbe.h"
+#include "Trace.h"
+#include "XxHash64.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <numeric>
+
+// --- TagLib Includes ---
+#include <taglib/taglib.h>
+#include <taglib/fileref.h>
+#include <taglib/tag.h>
+#include <taglib/audioproperties.h>
+#include <taglib/mpegfile.h>
+#include <taglib/id3v2tag.h>
+#include <taglib/attachedpictureframe.h>
+#include <taglib/tbytevector.h>
+#include <taglib/tpropertymap.h>
+
+namespace {
+// In-process reads run here rather than on the scan's own pools: a read that
+// never returns keeps its thread, so this pool must outlive every scan. Never
+// deleted for the same reason.
+QThreadPool *inProcessReaders() {
+    static QThreadPool *pool = new QThreadPool;
+    return pool;
+}
+
+// LibraryScanner::readTags() that stops waiting after timeoutMs; false if it did
+bool readTagsWithin(const QString &filePath, int timeoutMs, QVariantMap *tags) {
+    struct Read {
+        QSemaphore done;
+        QVariantMap tags;
+    };
+    auto read = std::make_shared<Read>();
+    QThreadPool *pool = inProcessReaders();
+    const auto task = [read, filePath]() {
+        read->tags = LibraryScanner::readTags(filePath);
+        read->done.release();
+    };
+    // One thread per waiting scan worker, plus whatever stuck reads hold
+    while (!pool->tryStart(task)) pool->setMaxThreadCount(pool->maxThreadCount() + 1);
+    if (!read->done.tryAcquire(1, timeoutMs)) return false;
+    *tags = std::move(read->tags);
+    return true;
+}
+}
+
+LibraryScanner::LibraryScanner(LibraryIndex *index, ScanQuarantine *quarantine)
+    : m_index(index), m_quarantine(quarantine) {}
+
+//=============================================================================
+// FUNCTION: Scan (worker thread)
+//=============================================================================
+LibraryScanResults LibraryScanner::scan(const QStringList &rootPaths) const {
+    LIBRIFY_TRACE_SCOPE("scan", "scan");
+    qCDebug(lcScan) << "[LibraryScanner] Starting scan of" << rootPaths << "on thread:" << QThread::currentThreadId();
+    LibraryScanResults results;
+    QStringList allMp3Files;
+    QElapsedTimer scanTimer;
+    scanTimer.start();
+
+    // 0. One reader budget per storage device; devices run side by side
+    const QList<StorageScheduler::Device> devices = StorageScheduler::groupRoots(rootPaths);
+    std::vector<std::unique_ptr<QThreadPool>> pools;
+    for (const StorageScheduler::Device &device : devices) {
+        pools.push_back(std::make_unique<QThreadPool>());
+        pools.back()->setMaxThreadCount(device.concurrency);
+    }
+
+    // 1. Find all files (Recursive), one walker per device
+    QList<int> deviceOf; // device index of every file in allMp3Files
+    {
+        Trace::Span span("scan", "walk");
+        QList<QStringList> deviceFiles(devices.size());
+        QList<int> deviceIndices(devices.size());
+        std::iota(deviceIndices.begin(), deviceIndices.end(), 0);
+        QtConcurrent::blockingMap(deviceIndices, [&devices, &deviceFiles](int d) {
+            for (const QString &rootPath : devices.at(d).roots) recursiveScan(rootPath, deviceFiles[d]);
+        });
+        QSet<QString> seen; // overlapping roots
+        for (int d = 0; d < deviceFiles.size(); ++d) {
+            for (const QString &filePath : std::as_const(deviceFiles.at(d))) {
+                if (seen.contains(filePath)) continue;
+                seen.insert(filePath);
+                allMp3Files.append(filePath);
+                deviceOf.append(d);
+            }
+        }
+        span.setArg(allMp3Files.size());
+    }
+    qCDebug(lcScan) << "[LibraryScanner] Found" << allMp3Files.count() << "MP3 file paths.";
+    if (m_quarantine) m_quarantine->prune(rootPaths, QSet<QString>(allMp3Files.cbegin(), allMp3Files.cend()));
+    if (allMp3Files.isEmpty()) {
+        qCWarning(lcScan) << "[LibraryScanner] No MP3 files found.";
+        return results;
+    }
+
+    // 2. Unchanged files straight from the index (parallel)
+    struct Entry {
+        LibraryIndex::FileStat stat;
+        bool hasStat = false;
+        QVariantMap tags;
+    };
+    LibraryIndex *index = m_index;
+    QElapsedTimer buildTimer;
+    buildTimer.start();
+    QList<Entry> entries(allMp3Files.size());
+    Entry *entryData = entries.data();
+    // Runs fn(i) for the files of each device on that device's pool, in list order
+    const auto runPerDevice = [&](const QList<int> &fileIndices, const std::function<void(int)> &fn) {
+        QList<QList<int>> perDevice(devices.size());
+        for (int i : fileIndices) perDevice[deviceOf.at(i)].append(i);
+        QList<QFuture<void>> futures;
+        for (int d = 0; d < perDevice.size(); ++d) {
+            if (!perDevice.at(d).isEmpty()) futures.append(QtConcurrent::map(pools[d].get(), perDevice[d], fn));
+        }
+        for (QFuture<void> &future : futures) future.waitForFinished();
+    };
+    QList<int> allIndices(allMp3Files.size());
+    std::iota(allIndices.begin(), allIndices.end(), 0);
+    runPerDevice(allIndices, [entryData, index, &allMp3Files](int i) {
+        LIBRIFY_TRACE_SCOPE("index", "lookup");
+        Entry &entry = entryData[i];
+        const QString &filePath = allMp3Files.at(i);
+        entry.hasStat = LibraryIndex::statFile(filePath, &entry.stat);
+        if (entry.hasStat && index && index->lookupFresh(filePath, entry.stat)) entry.tags = index->cachedTags(filePath);
+    });
+
+    // 3. Moved or renamed files carry their record over (sequential, see class comment)
+    Trace::Span movesSpan("index", "moves");
+    const QSet<QString> scannedPaths(allMp3Files.cbegin(), allMp3Files.cend());
+    QList<int> unreadIndices;
+    for (int i = 0; i < entries.size(); ++i) {
+        Entry &entry = entries[i];
+        if (!entry.tags.isEmpty()) {
+            ++results.reusedTags;
+            continue;
+        }
+        const QString &filePath = allMp3Files.at(i);
+        if (entry.hasStat && index) {
+            const QString oldPath = index->findMovedFrom(filePath, entry.stat, scannedPaths);
+            if (!oldPath.isEmpty()) {
+                index->rename(oldPath, filePath, entry.stat);
+                results.movedPaths.insert(oldPath, filePath);
+                entry.tags = index->cachedTags(filePath);
+                if (!entry.tags.isEmpty()) {
+                    ++results.reusedTags;
+                    continue;
+                }
+            }
+        }
+        unreadIndices.append(i);
+    }
+    movesSpan.setArg(results.movedPaths.size());
+
+    // 4. New or changed files: TagLib (parallel per device); the index is thread-safe
+    //    and keeps one copy of each distinct cover, the tracks only its coverId.
+    //    Spinning disks read in inode order, which follows the on-disk layout on ext4/XFS.
+    results.readTags = int(unreadIndices.size());
+    ScanQuarantine *quarantine = m_quarantine;
+    QMutex isolatedMutex;
+    QList<int> isolatedIndices;
+    std::atomic<int> skipped{0};
+    // Journaled in the quarantine while TagLib has the file; a stuck read stays open there
+    const auto readInProcess = [quarantine](Entry &entry, const QString &filePath) {
+        const bool journaled = quarantine && entry.hasStat;
+        if (journaled) quarantine->beginRead(filePath, entry.stat);
+        if (!readTagsWithin(filePath, StuckReadMs, &entry.tags)) return false;
+        if (journaled) quarantine->endRead(filePath);
+        return true;
+    };
+    const auto storeEntry = [index](Entry &entry, const QString &filePath) {
+        if (index) index->takeCover(&entry.tags);
+        if (entry.hasStat && index && !entry.tags.isEmpty()) {
+            index->storeTags(filePath, entry.stat, AudioPayload::fingerprint(filePath), entry.tags);
+        }
+    };
+    const auto readOrder = [&](int i) {
+        const bool rotational = devices.at(deviceOf.at(i)).media == StorageScheduler::Media::Rotational;
+        return std::pair<int, quint64>(deviceOf.at(i), rotational ? entries.at(i).stat.inode : quint64(i));
+    };
+    std::sort(unreadIndices.begin(), unreadIndices.end(), [&](int a, int b) { return readOrder(a) < readOrder(b); });
+    runPerDevice(unreadIndices, [&](int i) {
+        Entry &entry = entryData[i];
+        const QString &filePath = allMp3Files.at(i);
+        const ScanQuarantine::Verdict verdict = quarantine && entry.hasStat
+                                                    ? quarantine->check(filePath, entry.stat)
+                                                    : ScanQuarantine::Verdict::None;
+        if (verdict == ScanQuarantine::Verdict::Skip) {
+            entry.tags = fallbackTags(filePath); // not stored: a fixed file is read again
+            ++skipped;
+            return;
+        }
+        if (verdict == ScanQuarantine::Verdict::Isolate || isRisky(filePath, entry.stat.size)) {
+            QMutexLocker locker(&isolatedMutex);
+            isolatedIndices.append(i);
+            return;
+        }
+        QElapsedTimer readTimer;
+        readTimer.start();
+        const bool finished = readInProcess(entry, filePath);
+        Metrics::tagReadMicros.record(readTimer.nsecsElapsed() / 1000);
+        if (quarantine && entry.hasStat && readTimer.elapsed() > SlowReadMs) quarantine->add(filePath, entry.stat, "slow");
+        if (!finished) {
+            qCWarning(lcTags) << "[LibraryScanner] Tag read stuck after" << StuckReadMs << "ms, handing to the probe:" << filePath;
+            QMutexLocker locker(&isolatedMutex);
+            isolatedIndices.append(i);
+            return;
+        }
+        storeEntry(entry, filePath);
+    });
+
+    // 4b. Risky files: out of process with a hard time limit, a few workers at once
+    if (!isolatedIndices.isEmpty()) {
+        Trace::Span isolatedSpan("scan", "isolatedReads");
+        isolatedSpan.setArg(isolatedIndices.size());
+        std::sort(isolatedIndices.begin(), isolatedIndices.end());
+        QList<QList<int>> chunks(qMin<qsizetype>(IsolatedWorkers, isolatedIndices.size()));
+        for (int n = 0; n < isolatedIndices.size(); ++n) chunks[n % chunks.size()].append(isolatedIndices.at(n));
+        QtConcurrent::blockingMap(chunks, [&](const QList<int> &chunk) {
+            TagProbe probe; // one worker process per chunk, owned by this thread
+            for (int i : chunk) {
+                Entry &entry = entryData[i];
+                const QString &filePath = allMp3Files.at(i);
+                QElapsedTimer readTimer;
+                readTimer.start();
+                const TagProbe::Status status = probe.read(filePath, ProbeTimeoutMs, &entry.tags);
+                Metrics::tagReadMicros.record(readTimer.nsecsElapsed() / 1000);
+                if (status == TagProbe::Status::Ok) {
+                    storeEntry(entry, filePath);
+                } else if (status == TagProbe::Status::Unavailable && readInProcess(entry, filePath)) {
+                    // No worker binary next to the app: read in-process as before, covers capped
+                    storeEntry(entry, filePath);
+                } else if (status == TagProbe::Status::Unavailable) {
+                    if (quarantine && entry.hasStat) quarantine->add(filePath, entry.stat, "timeout");
+                    entry.tags = fallbackTags(filePath);
+                    ++skipped;
+                } else {
+                    if (quarantine && entry.hasStat) {
+                        quarantine->add(filePath, entry.stat, status == TagProbe::Status::Timeout ? "timeout" : "crash");
+                    }
+                    entry.tags = fallbackTags(filePath);
+                    ++skipped;
+                }
+            }
+        });
+        results.isolatedReads = int(isolatedIndices.size());
+        Metrics::isolatedReads.fetch_add(quint64(isolatedIndices.size()), std::memory_order_relaxed);
+    }
+    results.quarantined = skipped.load();
+    Metrics::quarantinedFiles.fetch_add(quint64(results.quarantined), std::memory_order_relaxed);
+    if (quarantine) quarantine->save();
+
+    Metrics::indexBuildMicros.record(buildTimer.nsecsElapsed() / 1000);
+
+    // 5. Populate results in file order
+    Trace::Span aggregateSpan("scan", "aggregate");
+    results.cachedTracks.reserve(entries.size());
+    qint64 scannedBytes = 0;
+    for (const Entry &entry : std::as_const(entries)) {
+        scannedBytes += entry.stat.size;
+        const QVariantMap &trackData = entry.tags;
+        if (trackData.value("filePath").toString().isEmpty()) continue;
+        results.cachedTracks.append(trackData);
+        // Process Artists
+        const QStringList individualArtists = splitArtistName(trackData.value("artist", "Unknown Artist").toString());
+        for (const QString &artist : individualArtists) {
+            if (!artist.isEmpty()) results.uniqueArtists.insert(artist);
+        }
+        // Process Albums
+        const QString albumValue = trackData.value("album", "Unknown Album").toString();
+        if (albumValue != "Unknown Album") {
+            results.uniqueAlbums.insert(albumValue);
+            results.albumTrackCounts[albumValue]++;
+        }
+    }
+    aggregateSpan.setArg(results.cachedTracks.size());
+    qCDebug(lcScan) << "[LibraryScanner] Finished reading tags. Found" << results.cachedTracks.count()
+             << "tracks and" << results.uniqueArtists.count() << "artists, and"
+             << results.uniqueAlbums.count() << "albums.";
+    qCDebug(lcScan) << "[LibraryScanner] Tags reused from index:" << results.reusedTags << "read:" << results.readTags
+             << "moved/renamed:" << results.movedPaths.size() << "isolated:" << results.isolatedReads
+             << "quarantined:" << results.quarantined;
+    {
+        LIBRIFY_TRACE_SCOPE("index", "matcherBuild");
+        results.matcher.build(results.cachedTracks);
+    }
+
+    // Throughput over the whole scan, walk and matcher included
+    const double seconds = qMax<qint64>(scanTimer.nsecsElapsed(), 1) / 1e9;
+    Metrics::scanFilesPerSecond.record(qint64(entries.size() / seconds));
+    Metrics::scanBytesPerSecond.record(qint64(scannedBytes / seconds));
+    Metrics::scannedFiles.fetch_add(quint64(entries.size()), std::memory_order_relaxed);
+    Metrics::scannedBytes.fetch_add(quint64(scannedBytes), std::memory_order_relaxed);
+    return results;
+}
+
+//=============================================================================
+// HELPER: Split artist names
+//=============================================================================
+QStringList LibraryScanner::splitArtistName(const QString& artistName) {
+    if (artistName.isEmpty()) {
+        return QStringList() << "Unknown Artist";
+    }
+
+    // Define common separators
+    QStringList separators = {
+        ", ", " & ", " and ", " ft. ", " feat. ", " feat ", " featuring ", " vs. ", " vs ", " with "
+    };
+
+    QString normalizedName = artistName;
+
+    // First, replace all variants of separators with a standard one
+    for (const QString& sep : separators) {
+        normalizedName = normalizedName.replace(sep, "|||", Qt::CaseInsensitive);
+    }
+
+    // Then split by our standard separator
+    QStringList artists = normalizedName.split("|||", Qt::SkipEmptyParts);
+    QStringList trimmedArtists;
+
+    // Trim whitespace and filter empty entries
+    for (QString& artist : artists) {
+        artist = artist.trimmed();
+        if (!artist.isEmpty()) {
+            trimmedArtists << artist;
+        }
+    }
+
+    // If we end up with no valid artists after splitting, use the original
+    if (trimmedArtists.isEmpty()) {
+        return QStringList() << artistName.trimmed();
+    }
+
+    return trimmedArtists;
+}
+
+//=============================================================================
+// HELPER: Recursively finds all MP3 file paths
+//=============================================================================
+void LibraryScanner::recursiveScan(const QString& folderPath, QStringList& foundMp3Files) {
+    QDir directory(folderPath);
+    if (!directory.exists()) return;
+
+    // Process files in the current directory
+    QStringList filters;
+    filters << "*.mp3";
+    QFileInfoList fileInfoList = directory.entryInfoList(filters, QDir::Files | QDir::Readable);
+    for (const QFileInfo &fileInfo : fileInfoList) {
+        foundMp3Files.append(fileInfo.absoluteFilePath());
+    }
+
+    // Recursively process subdirectories
+    QFileInfoList dirInfoList = directory.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable);
+    for (const QFileInfo &dirInfo : dirInfoList) {
+        recursiveScan(dirInfo.absoluteFilePath(), foundMp3Files); // Recurse
+    }
+}
+
+QVariantMap LibraryScanner::fallbackTags(const QString& filePath) {
+    QVariantMap tagsMap;
+    tagsMap["title"] = QFileInfo(filePath).baseName();
+    tagsMap["artist"] = "Unknown Artist";
+    tagsMap["album"] = "Unknown Album";
+    tagsMap["genre"] = "";
+    tagsMap["year"] = 0;
+    tagsMap["track"] = 0;
+    tagsMap["duration"] = 0;
+    tagsMap["filePath"] = filePath;
+    tagsMap["source"] = "local"; // Also add source to fallback
+    return tagsMap;
+}
+
+//=============================================================================
+// HELPER: Byte budget, from the size and the first 10 bytes
+//=============================================================================
+bool LibraryScanner::isRisky(const QString& filePath, qint64 size) {
+    if (size > MaxInProcessBytes) return true;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return false; // TagLib fails fast on its own
+    const QByteArray header = file.read(10);
+    if (header.size() < 10) return false;
+    const auto byte = [&header](int i) { return quint8(header.at(i)); };
+    if (header.startsWith("ID3")) {
+        // Synchsafe size: 4 x 7 bits
+        const qint64 tagBytes = (qint64(byte(6) & 0x7F) << 21) | (byte(7) & 0x7F) << 14 | (byte(8) & 0x7F) << 7 | (byte(9) & 0x7F);
+        return tagBytes > MaxInProcessTagBytes;
+    }
+    // No ID3v2 tag: expect an MPEG frame sync right away, else TagLib hunts through the whole file
+    return !(byte(0) == 0xFF && (byte(1) & 0xE0) == 0xE0);
+}
+
+QString LibraryScanner::coverIdFor(const QByteArray &imageData) {
+    const quint64 key = XxHash64::hash(imageData.constData(), size_t(imageData.size())) | 1; // never 0
+    return QString::number(key, 16).rightJustified(16, '0');
+}
+
+//=============================================================================
+// FUNCTION: Reads ID3 tags
+//=============================================================================
+QVariantMap LibraryScanner::readTags(const QString& filePath) {
+    LIBRIFY_TRACE_SCOPE("tags", "readTags");
+    QVariantMap tagsMap;
+    QByteArray imageData;
+    QString imageMimeType = "";
+    bool basicTagsRead = false;
+
+    tagsMap["source"] = "local"; // Add source type for local files
+
+    try {
+        { // FileRef scope
+			QByteArray pathUtf8 = filePath.toUtf8();
+			TagLib::FileRef f(pathUtf8.constData());
+            if (!f.isNull()) {
+                TagLib::Tag *basicTag = f.tag();
+                if (basicTag) {
+                    tagsMap["title"] = QString::fromUtf8(basicTag->title().toCString(true)).isEmpty() ? QFileInfo(filePath).baseName() : QString::fromUtf8(basicTag->title().toCString(true));
+                    tagsMap["artist"] = QString::fromUtf8(basicTag->artist().toCString(true)).isEmpty() ? "Unknown Artist" : QString::fromUtf8(basicTag->artist().toCString(true));
+                    tagsMap["album"] = QString::fromUtf8(basicTag->album().toCString(true)).isEmpty() ? "Unknown Album" : QString::fromUtf8(basicTag->album().toCString(true));
+                    tagsMap["genre"] = QString::fromUtf8(basicTag->genre().toCString(true));
+                    tagsMap["year"] = basicTag->year();
+                    tagsMap["track"] = basicTag->track();
+                    tagsMap["duration"] = f.audioProperties() ? f.audioProperties()->lengthInMilliseconds() : 0;
+                    // ISRC (ID3v2 TSRC) lets Spotify tracks match without fuzzy text comparison
+                    const TagLib::PropertyMap properties = f.file()->properties();
+                    if (properties.contains("ISRC") && !properties["ISRC"].isEmpty()) {
+                        tagsMap["isrc"] = QString::fromUtf8(properties["ISRC"].front().toCString(true)).trimmed();
+                    }
+                    tagsMap["filePath"] = filePath;
+                    basicTagsRead = true;
+                } else { qCDebug(lcTags) << "[LibraryScanner] TagLib::FileRef::tag() returned NULL for:" << filePath; }
+            } else { qCDebug(lcTags) << "[LibraryScanner] TagLib::FileRef creation failed (isNull) for:" << filePath; }
+        } // End FileRef scope
+
+
+        TagLib::ID3v2::Tag *id3v2tag = nullptr;
+        { // MPEG::File scope for image extraction
+		  QByteArray utf8Path = filePath.toUtf8();
+          TagLib::MPEG::File mpegFile(utf8Path.constData(), false, TagLib::AudioProperties::Fast);
+            if (mpegFile.isValid() && mpegFile.hasID3v2Tag()) {
+                id3v2tag = mpegFile.ID3v2Tag();
+                if (id3v2tag) {
+                    TagLib::ID3v2::FrameListMap frameListMap = id3v2tag->frameListMap();
+                    if (frameListMap.contains("APIC")) {
+                        TagLib::ID3v2::FrameList apicFrames = frameListMap["APIC"];
+                        if (!apicFrames.isEmpty()) {
+                            TagLib::ID3v2::AttachedPictureFrame *pictureFrame = dynamic_cast<TagLib::ID3v2::AttachedPictureFrame*>(apicFrames.front());
+                            if (pictureFrame && qint64(pictureFrame->size()) > MaxPictureBytes) {
+                                qCDebug(lcTags) << "[LibraryScanner] Dropping" << pictureFrame->size() << "byte cover of" << filePath;
+                            } else if (pictureFrame) {
+                                imageMimeType = QString::fromStdString(pictureFrame->mimeType().to8Bit(true));
+                                TagLib::ByteVector pictureData = pictureFrame->picture();
+                                if (!pictureData.isEmpty()) imageData = QByteArray(pictureData.data(), pictureData.size());
+                            }
+                        }
+                    }
+                }
+            }
+        } // End MPEG::File scope
+
+    } catch (const std::exception& e) { qCWarning(lcTags) << "[LibraryScanner] Exception processing TagLib for" << filePath << ":" << e.what(); }
+    catch (...) { qCWarning(lcTags) << "[LibraryScanner] Unknown exception processing TagLib for" << filePath; }
+
+    // Fallback Logic
+    if (!basicTagsRead) {
+        qCDebug(lcTags) << "[LibraryScanner] Applying fallback data for file:" << filePath;
+        tagsMap = fallbackTags(filePath);
+    } else {
+        if (!imageData.isEmpty()) {
+            tagsMap.insert("coverId", coverIdFor(imageData));
+            tagsMap.insert("imageData", imageData);
+            tagsMap.insert("imageMimeType", imageMimeType);
+        }
+        // Safety checks (optional if confident)
+        tagsMap.insert("artist", tagsMap.value("artist", "Unknown Artist"));
+        tagsMap.insert("album", tagsMap.value("album", "Unknown Album"));
+        tagsMap.insert("title", tagsMap.value("title", QFileInfo(filePath).baseName()));
+    }
+
+    // Final Log & Return
+    if (tagsMap.value("filePath").toString().isEmpty()) {
+        qCWarning(lcTags) << "[LibraryScanner] FATAL: Returning map WITHOUT filePath for:" << filePath;
+        return QVariantMap();
+    }
+    return tagsMap;
+}
+
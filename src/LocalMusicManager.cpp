@@ -1,6 +1,12 @@
 // LocalMusicManager.cpp
 #include "LocalMusicManager.h"
 #include "TrackListModel.h"
+#include "LibraryScanner.h"
+#include "LogCategories.h"
+#include "MetricsRegistry.h"
+#include "TagWriteQueue.h"
+#include "ThumbnailCache.h"
+#include "Trace.h"
 
 #include <QFileDialog>
 #include <QDir>
@@ -17,17 +23,6 @@
 #include <QSet>
 #include <QStringList>
 #include <QMultiHash>
-#include <QImage>
-#include <QBuffer>
-
-// --- TagLib Includes ---
-#include <taglib/taglib.h>
-#include <taglib/fileref.h>
-#include <taglib/tag.h>
-#include <taglib/mpegfile.h>
-#include <taglib/id3v2tag.h>
-#include <taglib/attachedpictureframe.h>
-#include <taglib/tbytevector.h>
 
 //=============================================================================
 // Constructor
@@ -42,6 +37,36 @@ LocalMusicManager::LocalMusicManager(QObject *parent) : QObject(parent){
 	m_defaultMusicPath = QStandardPaths::writableLocation(QStandardPaths::MusicLocation);
     connect(&m_scanWatcher, &QFutureWatcher<ScanResults>::finished,
         this, &LocalMusicManager::handleScanFinished, Qt::QueuedConnection);
+    connect(&m_tempoAnalyzer, &TempoAnalyzer::tempoBatchReady,
+        this, &LocalMusicManager::handleTempoBatch);
+    connect(&m_duplicateWatcher, &QFutureWatcher<QList<DuplicateDetector::Group>>::finished,
+        this, &LocalMusicManager::handleDuplicatesFound, Qt::QueuedConnection);
+    connect(&m_tagWriter, &TagWriteQueue::writeFinished,
+        this, &LocalMusicManager::handleTagWriteFinished);
+    connect(&m_tagWriter, &TagWriteQueue::writeFailed,
+        this, &LocalMusicManager::handleTagWriteFailed);
+    connect(&m_tagWriter, &TagWriteQueue::batchFinished,
+        this, &LocalMusicManager::handleTagBatchFinished);
+    connect(&m_tagWriter, &TagWriteQueue::progressChanged,
+        this, &LocalMusicManager::loadingProgress);
+    connect(&m_stateWatcher, &QFutureWatcher<void>::finished, this, [this]() {
+        m_tagJournal.load(); // small, and GUI-thread only
+        emit tagUndoChanged();
+        emit stateLoaded();
+    });
+}
+
+//=============================================================================
+// FUNCTION: Loads the library index and quarantine off the GUI thread
+//=============================================================================
+// Called once the first frame is up; a scan started before it finishes waits for it
+void LocalMusicManager::loadStateAsync() {
+    if (m_stateLoad.isValid()) return;
+    m_stateLoad = QtConcurrent::run([this]() {
+        m_libraryIndex.load();
+        m_scanQuarantine.load();
+    });
+    m_stateWatcher.setFuture(m_stateLoad);
 }
 
 //=============================================================================
@@ -53,10 +78,13 @@ LocalMusicManager::~LocalMusicManager() {
     // without cooperation from the running function (e.g., checking QFuture::isCanceled()).
     // For now, just wait if it's running (can block shutdown).
     // m_scanWatcher.waitForFinished(); // Or manage cancellation better
+    m_duplicateWatcher.waitForFinished(); // hashing workers write into m_libraryIndex
+    m_stateLoad.waitForFinished();
+    m_libraryIndex.save();
     qDebug() << "[LocalMusicManager] Instance destroyed.";
 }
 
-QVariantList LocalMusicManager::sidebarItems() const { return m_sidebarItems; }
+SidebarModel *LocalMusicManager::sidebarModel() { return &m_sidebarModel; }
 
 QString LocalMusicManager::defaultMusicPath() const { return m_defaultMusicPath; }
 
@@ -70,115 +98,334 @@ void LocalMusicManager::setDefaultMusicPath(const QString &filePath) {
     }
 }
 
+void LocalMusicManager::setExtraLibraryRoots(const QStringList &rootPaths) {
+    QStringList roots;
+    for (const QString &rootPath : rootPaths) {
+        const QString cleaned = QDir::cleanPath(rootPath.trimmed());
+        if (!rootPath.trimmed().isEmpty() && !roots.contains(cleaned)) roots.append(cleaned);
+    }
+    if (m_extraLibraryRoots == roots) return;
+    m_extraLibraryRoots = roots;
+    emit extraLibraryRootsChanged();
+}
+
+QStringList LocalMusicManager::libraryRoots() const {
+    QStringList roots;
+    if (!m_defaultMusicPath.isEmpty()) roots.append(QDir::cleanPath(m_defaultMusicPath));
+    for (const QString &rootPath : m_extraLibraryRoots) {
+        if (!roots.contains(rootPath)) roots.append(rootPath);
+    }
+    return roots;
+}
+
 //=============================================================================
 // FUNCTION: Rewrites the tags of a given mp3 file 
 //=============================================================================
 void LocalMusicManager::writeTrackTags(const QString &filePath, const QString &title,
                                       const QString &artist, const QString &album,
                                       const QString &imagePath) {
-    qDebug() << "[writeTrackTags] Saving tags to:" << QFileInfo(filePath).canonicalFilePath();
+    qDebug() << "[writeTrackTags] Queueing tag write for:" << filePath;
+    TagWriteQueue::Edit edit;
+    edit.filePath = filePath;
+    edit.fields = {{"title", title}, {"artist", artist}, {"album", album}};
+    edit.imagePath = imagePath;
+
+    // Optimistic update: the list shows the edit now, TagLib catches up in the
+    // background and the re-read tags (new cover included) replace it when done
+    const QVariantMap original = trackForPath(filePath);
+    if (!original.isEmpty()) {
+        QVariantMap optimistic = original;
+        for (auto it = edit.fields.cbegin(); it != edit.fields.cend(); ++it) optimistic.insert(it.key(), it.value());
+        if (updateCachedTrack(optimistic)) rebuildSidebarModel();
+        emit trackUpdated(optimistic);
+    }
+    m_pendingTagWrites.insert(m_tagWriter.enqueue(edit), original);
+}
 
-    try {
-        QString posixPath = QDir::toNativeSeparators(filePath);
-        QFile file(posixPath);
-        if (!file.exists()) {
-            qWarning() << "File not found:" << posixPath;
-            return;
-        }
+//=============================================================================
+// SLOT: A queued tag write landed on disk
+//=============================================================================
+void LocalMusicManager::handleTagWriteFinished(int jobId, const QString &filePath, const QVariantMap &tags) {
+    m_pendingTagWrites.remove(jobId);
+    if (tags.value("filePath").toString().isEmpty()) return;
+    QVariantMap track = tags;
+    m_libraryIndex.takeCover(&track);
+    track.insert("bpm", m_tempoAnalyzer.cachedBpm(filePath));
+    if (updateCachedTrack(track)) rebuildSidebarModel();
+    emit trackUpdated(track);
+}
 
-		QByteArray pathUtf8 = filePath.toUtf8();
-		TagLib::MPEG::File f(pathUtf8.constData());
-        if (!f.isValid() || !f.isOpen() || f.readOnly()) { // Added more checks
-            qWarning() << "TagLib: Failed to open file for writing or file is invalid/read-only:" << filePath;
-            if(!f.isValid()) qWarning() << "Reason: File not valid";
-            if(f.isOpen() && f.readOnly()) qWarning() << "Reason: File is read-only";
-            if(!f.isOpen()) qWarning() << "Reason: File could not be opened by TagLib";
-            return;
-        }
+//=============================================================================
+// SLOT: A queued tag write failed; rolls the optimistic update back
+//=============================================================================
+void LocalMusicManager::handleTagWriteFailed(int jobId, const QString &filePath, const QString &error) {
+    const QVariantMap original = m_pendingTagWrites.take(jobId);
+    if (!original.isEmpty()) {
+        if (updateCachedTrack(original)) rebuildSidebarModel();
+        emit trackUpdated(original);
+    }
+    emit loadingError(QStringLiteral("Could not save tags of %1: %2").arg(QFileInfo(filePath).fileName(), error));
+}
 
-        // Save text tags
-        TagLib::Tag *tag = f.tag();
-        tag->setTitle(TagLib::String(title.toStdString()));
-        tag->setArtist(TagLib::String(artist.toStdString()));
-        tag->setAlbum(TagLib::String(album.toStdString()));
+//=============================================================================
+// FUNCTION: Applies the same field changes to many tracks at once
+//=============================================================================
+int LocalMusicManager::writeBatchTags(const QStringList &filePaths, const QVariantMap &fields) {
+    static const QStringList BatchFields = {"title", "artist", "album", "genre", "year", "track"};
+    QVariantMap changes;
+    for (const QString &key : BatchFields) {
+        if (fields.contains(key)) changes.insert(key, fields.value(key));
+    }
+    if (changes.isEmpty()) return 0;
+
+    // Only library tracks: their cached tags are the originals the journal needs
+    TagEditJournal::Batch journalBatch;
+    QList<TagWriteQueue::Edit> edits;
+    edits.reserve(filePaths.size());
+    for (const QString &filePath : filePaths) {
+        const int index = m_pathIndexHash.value(filePath, -1);
+        if (index < 0 || journalBatch.originals.contains(filePath)) continue;
+        const QVariantMap &track = m_cachedFullTrackData.at(index);
+        QVariantMap before;
+        for (auto it = changes.cbegin(); it != changes.cend(); ++it) before.insert(it.key(), track.value(it.key()));
+        if (before == changes) continue;
+        journalBatch.originals.insert(filePath, before);
+        edits.append({filePath, changes, QString()});
+    }
+    if (edits.isEmpty()) return 0;
+
+    journalBatch.label = QStringLiteral("Edit of %1 tracks").arg(edits.size());
+    journalBatch.time = QDateTime::currentDateTime();
+    m_tagJournal.record(journalBatch);
+    emit tagUndoChanged();
+    qDebug() << "[LocalMusicManager] Batch tag edit of" << edits.size() << "tracks:" << changes.keys();
+    startTagBatch(edits);
+    return int(edits.size());
+}
 
-        TagLib::ID3v2::Tag *id3v2Tag = f.ID3v2Tag(true); // Get/create ID3v2 tag
-        if (!id3v2Tag) {
-            qWarning() << "TagLib: Could not get or create ID3v2 tag for:" << filePath;
-            return;
-        }
+//=============================================================================
+// FUNCTION: Restores the fields the most recent batch edit changed
+//=============================================================================
+bool LocalMusicManager::undoLastTagBatch() {
+    if (!canUndoTags()) return false;
+    // Stays journaled until handleTagBatchFinished knows which files were restored
+    const TagEditJournal::Batch batch = m_tagJournal.last();
+    QList<TagWriteQueue::Edit> edits;
+    edits.reserve(batch.originals.size());
+    for (auto it = batch.originals.cbegin(); it != batch.originals.cend(); ++it) {
+        edits.append({it.key(), it.value(), QString()});
+    }
+    qDebug() << "[LocalMusicManager] Undoing" << batch.label << "from" << batch.time.toString(Qt::ISODate);
+    m_undoTagBatches.insert(startTagBatch(edits), batch.time);
+    emit tagUndoChanged();
+    return true;
+}
+
+// Optimistic update of every edited track, one tracksPatched for the whole batch
+int LocalMusicManager::startTagBatch(const QList<TagWriteQueue::Edit> &edits) {
+    LIBRIFY_TRACE_SCOPE("tags", "startTagBatch");
+    QHash<QString, QVariantMap> rollback;
+    QVariantList patchedTracks;
+    patchedTracks.reserve(edits.size());
+    bool groupingChanged = false;
+    for (const TagWriteQueue::Edit &edit : edits) {
+        const int index = m_pathIndexHash.value(edit.filePath, -1);
+        if (index < 0) continue;
+        QVariantMap track = m_cachedFullTrackData.at(index);
+        rollback.insert(edit.filePath, track);
+        for (auto it = edit.fields.cbegin(); it != edit.fields.cend(); ++it) track.insert(it.key(), it.value());
+        groupingChanged |= replaceCachedTrack(index, track);
+        patchedTracks.append(track);
+    }
+    const int batchId = m_tagWriter.enqueueBatch(edits);
+    m_pendingTagBatches.insert(batchId, rollback);
+    if (groupingChanged) rebuildSidebarModel();
+    if (!patchedTracks.isEmpty()) emit tracksPatched(patchedTracks);
+    return batchId;
+}
 
-        if (id3v2Tag) {
-            QByteArray titleUtf8 = title.toUtf8();
-            QByteArray artistUtf8 = artist.toUtf8();
-            QByteArray albumUtf8 = album.toUtf8();
+//=============================================================================
+// SLOT: A batch landed on disk; re-read tags in, failed files rolled back
+//=============================================================================
+void LocalMusicManager::handleTagBatchFinished(int batchId, const QList<QVariantMap> &tags,
+                                               const QHash<QString, QString> &errors) {
+    const QHash<QString, QVariantMap> rollback = m_pendingTagBatches.take(batchId);
+    QVariantList patchedTracks;
+    patchedTracks.reserve(tags.size() + errors.size());
+    bool groupingChanged = false;
+    for (const QVariantMap &written : tags) {
+        const int index = m_pathIndexHash.value(written.value("filePath").toString(), -1);
+        if (index < 0) continue;
+        QVariantMap track = written;
+        m_libraryIndex.takeCover(&track);
+        track.insert("bpm", m_tempoAnalyzer.cachedBpm(track.value("filePath").toString()));
+        groupingChanged |= replaceCachedTrack(index, track);
+        patchedTracks.append(track);
+    }
+    for (auto it = errors.cbegin(); it != errors.cend(); ++it) {
+        const int index = m_pathIndexHash.value(it.key(), -1);
+        if (index < 0 || !rollback.contains(it.key())) continue;
+        groupingChanged |= replaceCachedTrack(index, rollback.value(it.key()));
+        patchedTracks.append(rollback.value(it.key()));
+    }
 
-            tag->setTitle(TagLib::String(titleUtf8.constData(), TagLib::String::UTF8));
-            tag->setArtist(TagLib::String(artistUtf8.constData(), TagLib::String::UTF8));
-            tag->setAlbum(TagLib::String(albumUtf8.constData(), TagLib::String::UTF8));
+    if (!patchedTracks.isEmpty()) m_trackMatcher.build(m_cachedFullTrackData);
+    if (groupingChanged) rebuildSidebarModel();
+    if (!patchedTracks.isEmpty()) emit tracksPatched(patchedTracks);
+    const QDateTime undoneBatch = m_undoTagBatches.take(batchId);
+    if (undoneBatch.isValid()) {
+        // Files that failed to restore stay in the journal, so the undo can be retried
+        QStringList restored;
+        restored.reserve(tags.size());
+        for (const QVariantMap &written : tags) restored.append(written.value("filePath").toString());
+        m_tagJournal.markRestored(undoneBatch, restored);
+        emit tagUndoChanged();
+    }
+    if (!errors.isEmpty()) {
+        emit loadingError(QStringLiteral("Could not save tags of %1 of %2 files (%3: %4)")
+                              .arg(errors.size()).arg(tags.size() + errors.size())
+                              .arg(QFileInfo(errors.cbegin().key()).fileName(), errors.cbegin().value()));
+    }
+}
+
+bool LocalMusicManager::updateCachedTrack(const QVariantMap &track) {
+    const int index = m_pathIndexHash.value(track.value("filePath").toString(), -1);
+    return index >= 0 && replaceCachedTrack(index, track);
+}
+
+// Swaps a cached track and moves it between the artist/album/genre/year/tempo buckets
+// that changed, instead of re-indexing the library; true if a grouping changed
+bool LocalMusicManager::replaceCachedTrack(int index, const QVariantMap &track) {
+    const QVariantMap &old = m_cachedFullTrackData.at(index);
+    bool groupingChanged = false;
+
+    const QString oldArtist = old.value("artist", "Unknown Artist").toString();
+    const QString newArtist = track.value("artist", "Unknown Artist").toString();
+    if (oldArtist != newArtist) {
+        for (const QString &artist : splitArtistName(oldArtist)) {
+            if (!artist.isEmpty()) removeArtistIndex(artist, index);
         }
-        else {
-            qWarning() << "File does not have an ID3v2 tag. Using generic tag interface which may have encoding limitations for:" << posixPath;
-            tag->setTitle(TagLib::String(title.toStdString())); // Might lose some chars if not UTF-8 aware
-            tag->setArtist(TagLib::String(artist.toStdString()));
-            tag->setAlbum(TagLib::String(album.toStdString()));
+        for (const QString &artist : splitArtistName(newArtist)) {
+            if (!artist.isEmpty()) addArtistIndex(artist, index);
         }
+        groupingChanged = true;
+    }
 
-        if (!imagePath.isEmpty() && id3v2Tag) { // Ensure we have an ID3v2 tag to add to
-            qDebug() << "[writeTrackTags] Processing imagePath:" << imagePath;
-            QString localImagePath = imagePath;
-            // If imagePath might be a "qrc:/" or "file:///" URL, convert to local file path
-            if (imagePath.startsWith("qrc:") || imagePath.startsWith("file:")) {
-                localImagePath = QUrl(imagePath).toLocalFile();
-                qDebug() << "[writeTrackTags] Converted imagePath to local file:" << localImagePath;
-            }
+    const QString oldAlbum = old.value("album", "Unknown Album").toString();
+    const QString newAlbum = track.value("album", "Unknown Album").toString();
+    if (oldAlbum != newAlbum) {
+        if (oldAlbum != "Unknown Album") removeAlbumIndex(oldAlbum, index);
+        if (newAlbum != "Unknown Album") addAlbumIndex(newAlbum, index);
+        groupingChanged = true;
+    }
 
-            QImage img(localImagePath);
-            if (!img.isNull()) {
-                qDebug() << "[writeTrackTags] Image loaded successfully. Format:" << img.format();
-                QByteArray ba;
-                QBuffer buffer(&ba);
-                QString mimeType = "image/jpeg"; // Default to JPEG
-                QString saveFormat = "JPEG";
+    const QString oldGenre = old.value("genre").toString();
+    const QString newGenre = track.value("genre").toString();
+    if (oldGenre != newGenre) {
+        if (!oldGenre.isEmpty()) removeGenreIndex(oldGenre, index);
+        if (!newGenre.isEmpty()) addGenreIndex(newGenre, index);
+        groupingChanged = true;
+    }
 
-                if (img.save(&buffer, saveFormat.toLatin1().constData())) { // Use QByteArray for format string
-                    qDebug() << "[writeTrackTags] Image saved to buffer. Byte array size:" << ba.size();
-                    id3v2Tag->removeFrames("APIC");
+    const int oldYear = old.value("year").toInt();
+    const int newYear = track.value("year").toInt();
+    if (oldYear != newYear) {
+        if (oldYear > 0) removeYearIndex(oldYear, index);
+        if (newYear > 0) addYearIndex(newYear, index);
+        groupingChanged = true;
+    }
 
-                    TagLib::ID3v2::AttachedPictureFrame *frame = new TagLib::ID3v2::AttachedPictureFrame;
-                    frame->setMimeType(mimeType.toStdString());
-                    frame->setPicture(TagLib::ByteVector(ba.constData(), ba.size()));
-                    frame->setType(TagLib::ID3v2::AttachedPictureFrame::FrontCover);
+    const double oldBpm = old.value("bpm").toDouble();
+    const double newBpm = track.value("bpm").toDouble();
+    if (tempoBucket(oldBpm) != tempoBucket(newBpm) || (oldBpm > 0) != (newBpm > 0)) {
+        if (oldBpm > 0) removeTempoIndex(tempoBucket(oldBpm), index);
+        if (newBpm > 0) addTempoIndex(tempoBucket(newBpm), index);
+        groupingChanged = true;
+    }
 
-                    id3v2Tag->addFrame(frame);
-                } else {
-                    qWarning() << "[writeTrackTags] Failed to save QImage to buffer for:" << localImagePath;
-                }
-            }
-        } else if (imagePath.isEmpty()) {
-            qDebug() << "[writeTrackTags] No imagePath provided, skipping image saving.";
-        } else if (!id3v2Tag) {
-            qWarning() << "[writeTrackTags] No ID3v2 tag available to save image to for:" << posixPath;
-        }
+    m_cachedFullTrackData[index] = track;
+    return groupingChanged;
+}
 
-        // Save all changes (text and image)
-        if (!f.save()) { // TagLib::MPEG::File::AllTags is default for MPEG::File::save()
-            qWarning() << "Failed to save tags (after image processing) for:" << posixPath;
-            // Consider returning here if save fails, as readId3Tags might show stale data
-            return;
-        }
-        qDebug() << "[writeTrackTags] TagLib::File::save() successful.";
+//=============================================================================
+// HELPER: Index updates that keep the sorted sidebar keys in step
+//=============================================================================
+namespace {
+bool lessCaseInsensitive(const QString &a, const QString &b) {
+    return QString::compare(a, b, Qt::CaseInsensitive) < 0;
+}
 
-        // Reread tags after save
-        qDebug() << "[writeTrackTags] Attempting to re-read tags after save...";
-        QVariantMap updatedTrackData = readId3Tags(filePath); // filePath is still the original QString
-        if (!updatedTrackData.value("filePath").toString().isEmpty()) {
-            emit trackUpdated(updatedTrackData);
-        }
+void insertSortedKey(QStringList &keys, const QString &key) {
+    keys.insert(std::upper_bound(keys.begin(), keys.end(), key, lessCaseInsensitive), key);
+}
 
-    } catch (const std::exception& e) {
-        qCritical() << "Exception:" << e.what();
-    }
+void removeSortedKey(QStringList &keys, const QString &key) {
+    auto range = std::equal_range(keys.begin(), keys.end(), key, lessCaseInsensitive);
+    auto it = std::find(range.first, range.second, key);
+    if (it != range.second) keys.erase(it);
+}
+
+void insertSortedKey(QList<int> &keys, int key) {
+    keys.insert(std::upper_bound(keys.begin(), keys.end(), key), key);
+}
+}
+
+void LocalMusicManager::addArtistIndex(const QString &artist, int index) {
+    if (!m_artistIndexHash.contains(artist)) insertSortedKey(m_sortedArtists, artist);
+    m_artistIndexHash.insert(artist, index);
+}
+
+void LocalMusicManager::removeArtistIndex(const QString &artist, int index) {
+    m_artistIndexHash.remove(artist, index);
+    if (!m_artistIndexHash.contains(artist)) removeSortedKey(m_sortedArtists, artist);
+}
+
+void LocalMusicManager::addAlbumIndex(const QString &album, int index) {
+    if (!m_albumIndexHash.contains(album)) insertSortedKey(m_sortedAlbums, album);
+    m_albumIndexHash.insert(album, index);
+    ++m_albumTrackCounts[album];
+}
+
+void LocalMusicManager::removeAlbumIndex(const QString &album, int index) {
+    m_albumIndexHash.remove(album, index);
+    if (--m_albumTrackCounts[album] <= 0) m_albumTrackCounts.remove(album);
+    if (!m_albumIndexHash.contains(album)) removeSortedKey(m_sortedAlbums, album);
+}
+
+void LocalMusicManager::addTempoIndex(int bucket, int index) {
+    if (!m_tempoIndexHash.contains(bucket)) insertSortedKey(m_sortedTempoBuckets, bucket);
+    m_tempoIndexHash.insert(bucket, index);
+}
+
+void LocalMusicManager::removeTempoIndex(int bucket, int index) {
+    m_tempoIndexHash.remove(bucket, index);
+    if (!m_tempoIndexHash.contains(bucket)) m_sortedTempoBuckets.removeOne(bucket);
+}
+
+void LocalMusicManager::addGenreIndex(const QString &genre, int index) {
+    if (!m_genreIndexHash.contains(genre)) insertSortedKey(m_sortedGenres, genre);
+    m_genreIndexHash.insert(genre, index);
+}
+
+void LocalMusicManager::removeGenreIndex(const QString &genre, int index) {
+    m_genreIndexHash.remove(genre, index);
+    if (!m_genreIndexHash.contains(genre)) removeSortedKey(m_sortedGenres, genre);
+}
+
+void LocalMusicManager::addYearIndex(int year, int index) {
+    const int decade = year / 10 * 10;
+    if (!m_yearIndexHash.contains(year)) insertSortedKey(m_sortedYears, year);
+    if (!m_decadeIndexHash.contains(decade)) insertSortedKey(m_sortedDecades, decade);
+    m_yearIndexHash.insert(year, index);
+    m_decadeIndexHash.insert(decade, index);
+}
+
+void LocalMusicManager::removeYearIndex(int year, int index) {
+    const int decade = year / 10 * 10;
+    m_yearIndexHash.remove(year, index);
+    m_decadeIndexHash.remove(decade, index);
+    if (!m_yearIndexHash.contains(year)) m_sortedYears.removeOne(year);
+    if (!m_decadeIndexHash.contains(decade)) m_sortedDecades.removeOne(decade);
 }
 
 //=============================================================================
@@ -201,27 +448,27 @@ void LocalMusicManager::scanDefaultMusicFolder() {
         return;
     }
 
-    qDebug() << "[LocalMusicManager] Starting scan of default music folder:" << defaultMusicPath();
-    startScanProcess(defaultMusicPath()); // Call the common helper
+    qDebug() << "[LocalMusicManager] Starting scan of library roots:" << libraryRoots();
+    startScanProcess(libraryRoots()); // Call the common helper
 }
-void LocalMusicManager::startScanProcess(const QString& folderPath) {
-    qDebug() << "[LocalMusicManager] Starting scan process for folder:" << folderPath;
-    m_selectedParentFolder = folderPath; // Keep if other parts of your class rely on this
+void LocalMusicManager::startScanProcess(const QStringList& rootPaths) {
+    qDebug() << "[LocalMusicManager] Starting scan process for folders:" << rootPaths;
+    // --- Clear UI immediately when the library changes; a rescan diffs into the current rows ---
+    if (m_scanRoots != rootPaths) m_sidebarModel.resetItems({});
+    m_scanRoots = rootPaths;
+    loadStateAsync(); // no-op after startup; the scan waits for the index either way
+    m_selectedParentFolder = rootPaths.value(0); // Keep if other parts of your class rely on this
 
-    // --- Clear UI immediately ---
-    if (!m_sidebarItems.isEmpty()) {
-        m_sidebarItems.clear();
-        emit sidebarItemsChanged();
-    }
     // tracksReadyForDisplay will be emitted by handleScanFinished with new/empty data
     // emit tracksReadyForDisplay(QVariantList()); // Current behavior updates this in handleScanFinished
 
     emit loadingProgress(0, 1); // Indicate indeterminate start
     emit scanStateChanged(true); // Notify UI scan has started
+    m_scanTimer.start();
 
     // --- Launch Background Scan ---
     qDebug() << "[LocalMusicManager] Launching background scan...";
-    QFuture<ScanResults> scanFuture = QtConcurrent::run(&LocalMusicManager::performBackgroundScan, this, folderPath); // Pass folderPath
+    QFuture<ScanResults> scanFuture = QtConcurrent::run(&LocalMusicManager::performBackgroundScan, this, rootPaths); // Pass the roots
     m_scanWatcher.setFuture(scanFuture);
 }
 
@@ -244,95 +491,85 @@ void LocalMusicManager::selectAndScanParentFolderForArtists() {
 
     if (!dirPath.isEmpty()) {
         qDebug() << "[LocalMusicManager] Selected parent folder for scan:" << dirPath;
-        startScanProcess(dirPath); 
+        startScanProcess({dirPath});
     } else {
         qDebug() << "[LocalMusicManager] No parent folder selected.";
     }
 }
 
 //=============================================================================
-// HELPER: Split artist names
+// FUNCTION: Unified library - prefer local files for Spotify tracks
 //=============================================================================
-QStringList LocalMusicManager::splitArtistName(const QString& artistName) {
-    if (artistName.isEmpty()) {
-        return QStringList() << "Unknown Artist";
-    }
-
-    // Define common separators
-    QStringList separators = {
-        ", ", " & ", " and ", " ft. ", " feat. ", " feat ", " featuring ", " vs. ", " vs ", " with "
-    };
-
-    QString normalizedName = artistName;
-
-    // First, replace all variants of separators with a standard one
-    for (const QString& sep : separators) {
-        normalizedName = normalizedName.replace(sep, "|||", Qt::CaseInsensitive);
-    }
-
-    // Then split by our standard separator
-    QStringList artists = normalizedName.split("|||", Qt::SkipEmptyParts);
-    QStringList trimmedArtists;
+QVariantList LocalMusicManager::resolveSpotifyTracks(const QVariantList& spotifyTracks) const {
+    int matched = 0;
+    const QVariantList resolved = m_trackMatcher.resolve(spotifyTracks, &matched);
+    qDebug() << "[LocalMusicManager] Matched" << matched << "of" << spotifyTracks.size() << "Spotify tracks to local files.";
+    return resolved;
+}
 
-    // Trim whitespace and filter empty entries
-    for (QString& artist : artists) {
-        artist = artist.trimmed();
-        if (!artist.isEmpty()) {
-            trimmedArtists << artist;
+//=============================================================================
+// FUNCTION: Search / lookup for the control endpoint
+//=============================================================================
+QVariantList LocalMusicManager::searchTracks(const QString& query, int limit) const {
+    const QStringList words = query.toCaseFolded().split(' ', Qt::SkipEmptyParts);
+    QVariantList results;
+    if (words.isEmpty()) return results;
+    for (const QVariantMap& track : m_cachedFullTrackData) {
+        const QString haystack = (track.value("title").toString() + ' ' + track.value("artist").toString() + ' '
+                                  + track.value("album").toString()).toCaseFolded();
+        bool matches = true;
+        for (const QString& word : words) {
+            if (!haystack.contains(word)) { matches = false; break; }
         }
+        if (!matches) continue;
+        QVariantMap result;
+        for (const char *key : {"title", "artist", "album", "filePath", "duration", "bpm"}) result.insert(key, track.value(key));
+        results.append(result);
+        if (results.size() >= limit) break;
     }
+    return results;
+}
 
-    // If we end up with no valid artists after splitting, use the original
-    if (trimmedArtists.isEmpty()) {
-        return QStringList() << artistName.trimmed();
-    }
+QVariantMap LocalMusicManager::trackForPath(const QString& filePath) const {
+    const int index = m_pathIndexHash.value(filePath, -1);
+    return index >= 0 ? m_cachedFullTrackData.at(index) : QVariantMap();
+}
+
+qint64 LocalMusicManager::libraryMemoryUsage() const {
+    qint64 bytes = m_sidebarModel.memoryUsage();
+    bytes += (m_sortedArtists.size() + m_sortedAlbums.size() + m_sortedGenres.size()) * qint64(sizeof(QString))
+             + (m_sortedTempoBuckets.size() + m_sortedYears.size() + m_sortedDecades.size()) * qint64(sizeof(int));
+    bytes += m_folderTree.nodeCount() * qint64(sizeof(FolderTree::Node) + 64);
+    for (const QVariantMap &track : m_cachedFullTrackData) bytes += MetricsRegistry::estimateBytes(track);
+    // Hash nodes: key, int and bucket overhead; the keys share the cached strings
+    const qint64 hashEntries = m_artistIndexHash.size() + m_albumIndexHash.size() + m_albumTrackCounts.size()
+                               + m_pathIndexHash.size() + m_tempoIndexHash.size() + m_genreIndexHash.size()
+                               + m_yearIndexHash.size() + m_decadeIndexHash.size();
+    return bytes + hashEntries * qint64(sizeof(QString) + 16) + m_duplicateIndices.size() * qint64(sizeof(int));
+}
 
-    return trimmedArtists;
+//=============================================================================
+// HELPER: Split artist names (shared with the core scan)
+//=============================================================================
+QStringList LocalMusicManager::splitArtistName(const QString& artistName) {
+    return LibraryScanner::splitArtistName(artistName);
 }
 
 //=============================================================================
 // FUNCTION: Background Task Implementation
 //=============================================================================
-LocalMusicManager::ScanResults LocalMusicManager::performBackgroundScan(QString parentFolderPath) {
-    qDebug() << "[BG Scan] Starting background scan for:" << parentFolderPath << "on thread:" << QThread::currentThreadId();
-    ScanResults results;
-    QStringList allMp3Files;
-
-    // 1. Find all files (Recursive)
-    recursiveScan(parentFolderPath, allMp3Files);
-    qDebug() << "[BG Scan] Found" << allMp3Files.count() << "MP3 file paths.";
-    if (allMp3Files.isEmpty()) {
-        qWarning() << "[BG Scan] No MP3 files found.";
-        return results; 
-    }
-
-    // 2. Read tags and populate results
-    results.cachedTracks.reserve(allMp3Files.count());
-    int totalFiles = allMp3Files.count();
-    for(int i = 0; i < totalFiles; ++i) {
-        const QString& filePath = allMp3Files.at(i);
-        QVariantMap trackData = readId3Tags(filePath);
-        if (!trackData.value("filePath").toString().isEmpty()) {
-            results.cachedTracks.append(trackData);
-			// Process Artists
-            QString artistValue = trackData.value("artist", "Unknown Artist").toString();
-            QStringList individualArtists = splitArtistName(artistValue);
-            for (const QString& artist : individualArtists) {
-                if (!artist.isEmpty()) {
-                    results.uniqueArtists.insert(artist); 
-                }
-            }
-			// Process Albums
-            QString albumValue = trackData.value("album", "Unknown Album").toString();
-            if (albumValue != "Unknown Album") {
-                results.uniqueAlbums.insert(albumValue);
-                results.albumTrackCounts[albumValue]++; 
-            }
-        } 
-    } 
-    qDebug() << "[BG Scan] Finished reading tags. Found" << results.cachedTracks.count() 
-			 << "tracks and" << results.uniqueArtists.count() << "artists, and"
-			 << results.uniqueAlbums.count() << "albums.";
+LocalMusicManager::ScanResults LocalMusicManager::performBackgroundScan(QStringList rootPaths) {
+    m_stateLoad.waitForFinished(); // warm index, not a cold scan
+    // Grouped by storage device and read in parallel across devices (see LibraryScanner)
+    ScanResults results = LibraryScanner(&m_libraryIndex, &m_scanQuarantine).scan(rootPaths);
+
+    // Tempo is not part of the core scan: follow moves, then attach cached BPM
+    for (auto it = results.movedPaths.cbegin(); it != results.movedPaths.cend(); ++it) {
+        m_tempoAnalyzer.renameEntry(it.key(), it.value());
+    }
+    for (QVariantMap& track : results.cachedTracks) {
+        track.insert("bpm", m_tempoAnalyzer.cachedBpm(track.value("filePath").toString()));
+    }
     return results;
 }
 
@@ -341,7 +578,8 @@ LocalMusicManager::ScanResults LocalMusicManager::performBackgroundScan(QString
 //=============================================================================
 void LocalMusicManager::handleScanFinished() {
 	// 1. Start scan
-    qDebug() << "[LocalMusicManager] >>> handleScanFinished SLOT STARTING on thread:" << QThread::currentThreadId();
+    LIBRIFY_TRACE_SCOPE("scan", "handleScanFinished");
+    qCDebug(lcScan) << "[LocalMusicManager] >>> handleScanFinished SLOT STARTING on thread:" << QThread::currentThreadId();
     emit scanStateChanged(false);
     if (m_scanWatcher.isCanceled()) {
         qDebug() << "[LocalMusicManager] Scan was cancelled.";
@@ -349,15 +587,33 @@ void LocalMusicManager::handleScanFinished() {
         return;
     }
     ScanResults results = m_scanWatcher.result();
-    qDebug() << "[LocalMusicManager] Received scan results. Tracks:" << results.cachedTracks.count();
+    qCDebug(lcScan) << "[LocalMusicManager] Received scan results. Tracks:" << results.cachedTracks.count();
 
     // 2. Update caches and index hashes
     m_cachedFullTrackData = results.cachedTracks; 
 	m_albumTrackCounts = results.albumTrackCounts;
+    m_trackMatcher = results.matcher;
     m_artistIndexHash.clear();
     m_albumIndexHash.clear();
+    m_pathIndexHash.clear();
+    m_tempoIndexHash.clear();
+    m_genreIndexHash.clear();
+    m_yearIndexHash.clear();
+    m_decadeIndexHash.clear();
+    m_sortedArtists.clear();
+    m_sortedAlbums.clear();
+    m_sortedTempoBuckets.clear();
+    m_folderTree.clear();
+    for (const QString &rootPath : std::as_const(m_scanRoots)) m_folderTree.addRoot(rootPath);
+    m_duplicateIndices.clear();
+    QStringList tracksWithoutTempo;
+    QList<DuplicateDetector::Track> duplicateInput;
+    duplicateInput.reserve(m_cachedFullTrackData.size());
     for(int i = 0; i < m_cachedFullTrackData.size(); ++i) {
 		const QVariantMap& track = m_cachedFullTrackData.at(i);
+        const QString filePath = track.value("filePath").toString();
+        m_pathIndexHash.insert(filePath, i);
+        duplicateInput.append({i, filePath, track.value("title").toString(), track.value("duration").toLongLong()});
 		// Artist Indexing
         QString artistValue = track.value("artist", "Unknown Artist").toString();
         QStringList individualArtists = splitArtistName(artistValue);
@@ -370,21 +626,119 @@ void LocalMusicManager::handleScanFinished() {
         QString albumValue = track.value("album", "Unknown Album").toString();
         if (albumValue != "Unknown Album") {
             m_albumIndexHash.insert(albumValue, i);
+        }
+		// Genre / Year / Decade Indexing
+        const QString genreValue = track.value("genre").toString();
+        if (!genreValue.isEmpty()) m_genreIndexHash.insert(genreValue, i);
+        const int yearValue = track.value("year").toInt();
+        if (yearValue > 0) {
+            m_yearIndexHash.insert(yearValue, i);
+            m_decadeIndexHash.insert(yearValue / 10 * 10, i);
+        }
+		// Folder tree, from the scanned paths (no directory is listed again)
+        m_folderTree.addTrack(filePath, i);
+		// Tempo Indexing (cached BPM is filled in by readId3Tags)
+        const double bpm = track.value("bpm").toDouble();
+        if (bpm > 0) {
+            m_tempoIndexHash.insert(tempoBucket(bpm), i);
+        } else {
+            tracksWithoutTempo.append(filePath);
         }
     }
-    qDebug() << "[LocalMusicManager] Caches updated.";
+    qCDebug(lcScan) << "[LocalMusicManager] Caches updated.";
+    m_libraryIndex.save();
+    if (!results.movedPaths.isEmpty()) {
+        qDebug() << "[LocalMusicManager]" << results.movedPaths.size() << "files were moved or renamed.";
+        emit libraryPathsMoved(results.movedPaths);
+    }
 
-    // 3. Build Sidebar List based on current grouping
+    // 3. Build Sidebar List based on current grouping (keys sorted once per scan)
+    m_sortedArtists = m_artistIndexHash.uniqueKeys();
+    m_sortedArtists.sort(Qt::CaseInsensitive);
+    m_sortedAlbums = m_albumIndexHash.uniqueKeys();
+    m_sortedAlbums.sort(Qt::CaseInsensitive);
+    m_sortedTempoBuckets = m_tempoIndexHash.uniqueKeys();
+    std::sort(m_sortedTempoBuckets.begin(), m_sortedTempoBuckets.end());
+    m_sortedGenres = m_genreIndexHash.uniqueKeys();
+    m_sortedGenres.sort(Qt::CaseInsensitive);
+    m_sortedYears = m_yearIndexHash.uniqueKeys();
+    std::sort(m_sortedYears.begin(), m_sortedYears.end());
+    m_sortedDecades = m_decadeIndexHash.uniqueKeys();
+    std::sort(m_sortedDecades.begin(), m_sortedDecades.end());
+    m_folderTree.finalize();
 	rebuildSidebarModel();
 
     // 4. emit full track list
     QVariantList tracksForSignal;
     tracksForSignal.reserve(m_cachedFullTrackData.size());
     for (const QVariantMap& trackMap : m_cachedFullTrackData) { tracksForSignal.append(trackMap); }
-    qDebug() << "[LocalMusicManager] Emitting tracksReadyForDisplay()";
-    emit tracksReadyForDisplay(tracksForSignal);
+    qCDebug(lcScan) << "[LocalMusicManager] Emitting tracksReadyForDisplay()";
+    {
+        Trace::Span span("qml", "tracksReadyForDisplay");
+        span.setArg(tracksForSignal.size());
+        emit tracksReadyForDisplay(tracksForSignal);
+    }
     emit loadingProgress(m_cachedFullTrackData.count(), m_cachedFullTrackData.count());
-    qDebug() << "[LocalMusicManager] <<< handleScanFinished SLOT EXITED.";
+    if (m_scanTimer.isValid()) Metrics::scanMicros.record(m_scanTimer.nsecsElapsed() / 1000);
+
+    // 5. Resume tempo analysis for everything not cached yet
+    m_tempoAnalyzer.analyze(tracksWithoutTempo);
+
+    // 6. Look for duplicates in the background (only changed files get hashed)
+    m_duplicateWatcher.setFuture(QtConcurrent::run(&DuplicateDetector::findDuplicates,
+                                                   duplicateInput, &m_libraryIndex));
+    qCDebug(lcScan) << "[LocalMusicManager] <<< handleScanFinished SLOT EXITED.";
+}
+
+//=============================================================================
+// SLOT: Merges a batch of detected tempos into the cache and indices
+//=============================================================================
+void LocalMusicManager::handleTempoBatch(const QHash<QString, double> &bpmByPath) {
+    QVariantList updatedTracks;
+    updatedTracks.reserve(bpmByPath.size());
+    for (auto it = bpmByPath.cbegin(); it != bpmByPath.cend(); ++it) {
+        const int index = m_pathIndexHash.value(it.key(), -1);
+        if (index < 0) continue; // no longer part of the library
+        QVariantMap &track = m_cachedFullTrackData[index];
+        const double oldBpm = track.value("bpm").toDouble();
+        if (oldBpm > 0) removeTempoIndex(tempoBucket(oldBpm), index);
+        track["bpm"] = it.value();
+        addTempoIndex(tempoBucket(it.value()), index);
+        updatedTracks.append(track);
+    }
+    if (updatedTracks.isEmpty()) return;
+
+    qDebug() << "[LocalMusicManager] Tempo detected for" << updatedTracks.size() << "tracks.";
+    if (m_currentGrouping == "TEMPO") rebuildSidebarModel();
+    emit tracksPatched(updatedTracks);
+}
+
+//=============================================================================
+// SLOT: Stores duplicate groups and shows the virtual "Duplicates" item
+//=============================================================================
+void LocalMusicManager::handleDuplicatesFound() {
+    if (m_duplicateWatcher.isCanceled()) return;
+    const QList<DuplicateDetector::Group> groups = m_duplicateWatcher.result();
+
+    m_duplicateIndices.clear();
+    for (const DuplicateDetector::Group &group : groups) {
+        for (int index : group.indices) {
+            if (index >= 0 && index < m_cachedFullTrackData.size()) m_duplicateIndices.append(index);
+        }
+    }
+    qDebug() << "[LocalMusicManager]" << groups.size() << "duplicate groups," << m_duplicateIndices.size() << "tracks.";
+
+    QSet<QString> livePaths;
+    livePaths.reserve(m_pathIndexHash.size());
+    for (auto it = m_pathIndexHash.cbegin(); it != m_pathIndexHash.cend(); ++it) livePaths.insert(it.key());
+    m_libraryIndex.prune(livePaths);
+    m_libraryIndex.save();
+
+    rebuildSidebarModel();
+}
+
+int LocalMusicManager::tempoBucket(double bpm) {
+    return static_cast<int>(bpm) / 10 * 10;
 }
 
 //=============================================================================
@@ -394,105 +748,107 @@ void LocalMusicManager::setGrouping(const QString& grouping) {
     if (m_currentGrouping == grouping) return; 
     qDebug() << "[LocalMusicManager] Grouping changed to:" << grouping;
     m_currentGrouping = grouping;
-    rebuildSidebarModel();
+    // A different section: replaces every row, so a reset is cheaper than a diff
+    m_sidebarModel.resetItems(buildSidebarItems());
 }
 
 //=============================================================================
-// HELPER: Builds the sidebar list based on current grouping
+// SLOT: Opens or closes one folder of the FOLDERS grouping
 //=============================================================================
-void LocalMusicManager::rebuildSidebarModel() {
-	QVariantList newSidebarItems;
+void LocalMusicManager::toggleFolder(const QString& folderPath) {
+    if (m_folderTree.nodeFor(folderPath) < 0) return;
+    m_folderTree.toggleExpanded(folderPath);
+    // The diff inserts/removes just the rows of that subtree
+    if (m_currentGrouping == "FOLDERS") rebuildSidebarModel();
+}
+
+//=============================================================================
+// HELPER: Builds the sidebar rows for the current grouping
+//=============================================================================
+// Keys come presorted (m_sorted*), so this is a linear walk
+QList<SidebarModel::Item> LocalMusicManager::buildSidebarItems() const {
+    LIBRIFY_TRACE_SCOPE("sidebar", "buildSidebarItems");
+    QList<SidebarModel::Item> items;
 	// 1. Add "All Tracks" item (always present)
     if (!m_cachedFullTrackData.isEmpty()) {
-        QVariantMap allTracksMap;
-        allTracksMap["type"] = "local_all";
-        allTracksMap["name"] = "All Tracks";
-        allTracksMap["id"] = ALL_TRACKS_IDENTIFIER;
-        allTracksMap["iconSource"] = "qrc:/icons/all_tracks_icon.png";
-        allTracksMap["count"] = m_cachedFullTrackData.size();
-        newSidebarItems.append(allTracksMap);
+        items.append(SidebarModel::Item{"local_all", "All Tracks", ALL_TRACKS_IDENTIFIER,
+                      "qrc:/icons/all_tracks_icon.png", int(m_cachedFullTrackData.size())});
+    }
+    if (!m_duplicateIndices.isEmpty()) {
+        items.append(SidebarModel::Item{"local_duplicates", "Duplicates", DUPLICATES_IDENTIFIER,
+                      "qrc:/icons/all_tracks_icon.png", int(m_duplicateIndices.size())});
     }
 
     // 2. Add items based on current grouping mode
 	if (m_currentGrouping == "ARTISTS") {
-		QStringList sortedArtists = m_artistIndexHash.uniqueKeys();
-		sortedArtists.sort(Qt::CaseInsensitive);
-		for(const QString& artistName : sortedArtists) {
-			QVariantMap artistMap;
-			artistMap["type"] = "local_artist";
-			artistMap["name"] = artistName;
-			artistMap["id"] = artistName; 
-			artistMap["iconSource"] = "qrc:/icons/artist_icon.png";
-			artistMap["count"] = m_artistIndexHash.count(artistName);
-			newSidebarItems.append(artistMap);
+        items.reserve(items.size() + m_sortedArtists.size());
+		for (const QString& artistName : m_sortedArtists) {
+            items.append(SidebarModel::Item{"local_artist", artistName, artistName, "qrc:/icons/artist_icon.png",
+                          int(m_artistIndexHash.count(artistName))});
 		}
 	} else if (m_currentGrouping == "ALBUMS") {
-        QStringList sortedAlbums = m_albumIndexHash.uniqueKeys();
-        sortedAlbums.sort(Qt::CaseInsensitive);
-        for (const QString& albumName : sortedAlbums) {
-            int trackCount = m_albumTrackCounts.value(albumName, 0);
-            if (m_currentGrouping == "ALBUMS" && trackCount <= 1) {
-                continue;
+        for (const QString& albumName : m_sortedAlbums) {
+            const int trackCount = m_albumTrackCounts.value(albumName, 0);
+            if (trackCount <= 1) continue;
+            SidebarModel::Item album{"local_album", albumName, albumName, "qrc:/icons/album_icon.png", trackCount};
+            // Album: cover by reference, a pre-scaled tile from the thumbnail cache
+            const int firstTrackIndex = m_albumIndexHash.value(albumName, -1);
+            if (firstTrackIndex >= 0 && firstTrackIndex < m_cachedFullTrackData.size()) {
+                const QString coverId = m_cachedFullTrackData.at(firstTrackIndex).value("coverId").toString();
+                if (!coverId.isEmpty()) album.iconSource = ThumbnailCache::sourceFor(coverId, ThumbnailCache::Tile);
             }
-            QVariantMap albumMap;
-            albumMap["type"] = "local_album";
-            albumMap["name"] = albumName;
-            albumMap["id"] = albumName;
-            albumMap["iconSource"] = "qrc:/icons/album_icon.png";
-            albumMap["count"] = trackCount;
-			// Album: Get cover art
-			if (m_albumIndexHash.contains(albumName)) {
-				int firstTrackIndex = m_albumIndexHash.value(albumName);
-				if (firstTrackIndex >= 0 && firstTrackIndex < m_cachedFullTrackData.size()) {
-                    const QVariantMap& trackData = m_cachedFullTrackData.at(firstTrackIndex);
-                    const QString imageBase64 = trackData.value("imageBase64").toString();
-                    if (!imageBase64.isEmpty()) {
-                        const QString mimeType = trackData.value("imageMimeType", "image/jpeg").toString();
-                        // Format the string as a data URI for QML's Image source
-                        albumMap["iconSource"] = QString("data:%1;base64,%2").arg(mimeType, imageBase64);
-                    }
-                }
-			}
-            newSidebarItems.append(albumMap);
+            items.append(album);
+        }
+    } else if (m_currentGrouping == "GENRES") {
+        items.reserve(items.size() + m_sortedGenres.size());
+        for (const QString& genre : m_sortedGenres) {
+            items.append(SidebarModel::Item{"local_genre", genre, genre, "qrc:/icons/all_tracks_icon.png",
+                          int(m_genreIndexHash.count(genre))});
+        }
+    } else if (m_currentGrouping == "YEARS") {
+        for (int year : m_sortedYears) {
+            items.append(SidebarModel::Item{"local_year", QString::number(year), QString::number(year),
+                          "qrc:/icons/all_tracks_icon.png", int(m_yearIndexHash.count(year))});
+        }
+    } else if (m_currentGrouping == "DECADES") {
+        for (int decade : m_sortedDecades) {
+            items.append(SidebarModel::Item{"local_decade", QString("%1s").arg(decade), QString::number(decade),
+                          "qrc:/icons/all_tracks_icon.png", int(m_decadeIndexHash.count(decade))});
+        }
+    } else if (m_currentGrouping == "FOLDERS") {
+        // Only the open part of the tree becomes rows
+        for (int id : m_folderTree.visibleNodes()) {
+            const FolderTree::Node &node = m_folderTree.node(id);
+            SidebarModel::Item folder{"local_folder", node.name, node.path, "qrc:/icons/album_icon.png", node.trackCount};
+            folder.depth = node.depth;
+            folder.hasChildren = m_folderTree.hasChildren(id);
+            folder.expanded = folder.hasChildren && m_folderTree.isExpanded(id);
+            items.append(folder);
+        }
+    } else if (m_currentGrouping == "TEMPO") {
+        for (int bucket : m_sortedTempoBuckets) {
+            items.append(SidebarModel::Item{"local_tempo", QString("%1-%2 BPM").arg(bucket).arg(bucket + 9), QString::number(bucket),
+                          "qrc:/icons/all_tracks_icon.png", int(m_tempoIndexHash.count(bucket))});
         }
     }
-	qDebug() << "[LocalMusicManager] New sidebar list built for grouping" 
-		     << m_currentGrouping << ". Count:" << newSidebarItems.count();
-
-	// 3. Emit sidebarItemsChanged
-    if (m_sidebarItems != newSidebarItems) {
-        m_sidebarItems = newSidebarItems;
-        emit sidebarItemsChanged();
-    }
+    return items;
 }
 
 //=============================================================================
-// HELPER: Recursively finds all MP3 file paths
+// HELPER: Brings the sidebar rows up to date with the indices (row diff)
 //=============================================================================
-void LocalMusicManager::recursiveScan(const QString& folderPath, QStringList& foundMp3Files) {
-    QDir directory(folderPath);
-    if (!directory.exists()) return;
-
-    // Process files in the current directory
-    QStringList filters;
-    filters << "*.mp3";
-    QFileInfoList fileInfoList = directory.entryInfoList(filters, QDir::Files | QDir::Readable);
-    for (const QFileInfo &fileInfo : fileInfoList) {
-        foundMp3Files.append(fileInfo.absoluteFilePath());
-    }
-
-    // Recursively process subdirectories
-    QFileInfoList dirInfoList = directory.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable);
-    for (const QFileInfo &dirInfo : dirInfoList) {
-        recursiveScan(dirInfo.absoluteFilePath(), foundMp3Files); // Recurse
-    }
+void LocalMusicManager::rebuildSidebarModel() {
+    m_sidebarModel.setItems(buildSidebarItems());
+	qDebug() << "[LocalMusicManager] Sidebar updated for grouping"
+		     << m_currentGrouping << ". Count:" << m_sidebarModel.count();
 }
 
 //=============================================================================
 // SLOT: Loads tracks for a given identifier (artist/album/playlist)
 //=============================================================================
 void LocalMusicManager::loadTracksFor(const QString& identifier, const QString& type) {
-	qDebug() << "[LocalMusicManager] Request received to load tracks for:" << identifier << "of type:" << type;
+    Trace::Span span("load", "loadTracksFor");
+	qCDebug(lcLoad) << "[LocalMusicManager] Request received to load tracks for:" << identifier << "of type:" << type;
     if (m_selectedParentFolder.isEmpty()) {
         emit tracksReadyForDisplay(QVariantList());
         return;
@@ -502,18 +858,36 @@ void LocalMusicManager::loadTracksFor(const QString& identifier, const QString&
 	QList<int> indices;
 
     if (identifier == ALL_TRACKS_IDENTIFIER || type == "local_all") {
-        qDebug() << "[loadTracksFor] Loading ALL tracks from cache.";
+        qCDebug(lcLoad) << "[loadTracksFor] Loading ALL tracks from cache.";
         for (const QVariantMap& trackMap : m_cachedFullTrackData) {
             tracksToShow.append(trackMap); 
         }
     } else if (type == "local_artist") {
-        qDebug() << "[loadTracksFor" << identifier << "] Filtering cache for artist:" << identifier;
+        qCDebug(lcLoad) << "[loadTracksFor" << identifier << "] Filtering cache for artist:" << identifier;
         indices = m_artistIndexHash.values(identifier);
     } else if (type == "local_album") {
-		qDebug() << "[loadTracksFor" << identifier << "] Filtering cache for album:" << identifier;
+		qCDebug(lcLoad) << "[loadTracksFor" << identifier << "] Filtering cache for album:" << identifier;
 		indices = m_albumIndexHash.values(identifier);
+	} else if (type == "local_duplicates") {
+		qCDebug(lcLoad) << "[loadTracksFor] Loading duplicate groups";
+		indices = m_duplicateIndices;
+	} else if (type == "local_tempo") {
+		qCDebug(lcLoad) << "[loadTracksFor" << identifier << "] Filtering cache for tempo bucket:" << identifier;
+		indices = m_tempoIndexHash.values(identifier.toInt());
+		std::sort(indices.begin(), indices.end()); // keep library order within a bucket
+	} else if (type == "local_genre" || type == "local_year" || type == "local_decade") {
+		qCDebug(lcLoad) << "[loadTracksFor" << identifier << "] Filtering cache for" << type;
+		if (type == "local_genre") indices = m_genreIndexHash.values(identifier);
+		else if (type == "local_year") indices = m_yearIndexHash.values(identifier.toInt());
+		else indices = m_decadeIndexHash.values(identifier.toInt());
+		std::sort(indices.begin(), indices.end());
+	} else if (type == "local_folder") {
+		qCDebug(lcLoad) << "[loadTracksFor" << identifier << "] Collecting folder subtree";
+		indices = m_folderTree.tracksUnder(identifier);
+		std::sort(indices.begin(), indices.end());
 	} else if (type == "local_playlist") {
-		qDebug() << "[loadTracksFor" << identifier << "] Loading playlist tracks";
+		qCDebug(lcLoad) << "[loadTracksFor" << identifier << "] Loading playlist tracks";
+        LIBRIFY_TRACE_SCOPE("playlist", "readPlaylist");
         // Build path to playlist JSON
         QString playlistPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
                                + "/playlists/" + identifier + ".json";
@@ -541,7 +915,7 @@ void LocalMusicManager::loadTracksFor(const QString& identifier, const QString&
                 if (!trackMap.isEmpty()) {
                     tracksToShow.append(trackMap);
                 } else {
-                    qWarning() << "[loadTracksFor][playlist] Skipping unreadable track:" << filePath;
+                    qCWarning(lcLoad) << "[loadTracksFor][playlist] Skipping unreadable track:" << filePath;
                 }
             }
         }
@@ -549,7 +923,7 @@ void LocalMusicManager::loadTracksFor(const QString& identifier, const QString&
 
 	if (!indices.isEmpty()) {
         tracksToShow.reserve(indices.size());
-        qDebug() << "[loadTracksFor] Found" << indices.size() << "indices.";
+        qCDebug(lcLoad) << "[loadTracksFor] Found" << indices.size() << "indices.";
         for (int index : indices) {
             if (index >= 0 && index < m_cachedFullTrackData.size()) {
                 tracksToShow.append(m_cachedFullTrackData.at(index));
@@ -557,7 +931,10 @@ void LocalMusicManager::loadTracksFor(const QString& identifier, const QString&
         }
     }
 	
-    qDebug() << "[loadTracksFor] Emitting" << tracksToShow.count() << "tracks for display.";
+    qCDebug(lcLoad) << "[loadTracksFor] Emitting" << tracksToShow.count() << "tracks for display.";
+    span.setArg(tracksToShow.size());
+    Trace::Span handoff("qml", "tracksReadyForDisplay");
+    handoff.setArg(tracksToShow.size());
     emit tracksReadyForDisplay(tracksToShow);
 }
 
@@ -565,91 +942,9 @@ void LocalMusicManager::loadTracksFor(const QString& identifier, const QString&
 // FUNCTION: Reads ID3 tags
 //=============================================================================
 QVariantMap LocalMusicManager::readId3Tags(const QString& filePath) {
-    QVariantMap tagsMap;
-    QString imageBase64 = "";
-    QString imageMimeType = "";
-    bool basicTagsRead = false;
-
-    tagsMap["source"] = "local"; // Add source type for local files
-
-    try {
-        { // FileRef scope
-			QByteArray pathUtf8 = filePath.toUtf8();
-			TagLib::FileRef f(pathUtf8.constData());
-            if (!f.isNull()) {
-                TagLib::Tag *basicTag = f.tag();
-                if (basicTag) {
-                    tagsMap["title"] = QString::fromUtf8(basicTag->title().toCString(true)).isEmpty() ? QFileInfo(filePath).baseName() : QString::fromUtf8(basicTag->title().toCString(true));
-                    tagsMap["artist"] = QString::fromUtf8(basicTag->artist().toCString(true)).isEmpty() ? "Unknown Artist" : QString::fromUtf8(basicTag->artist().toCString(true));
-                    tagsMap["album"] = QString::fromUtf8(basicTag->album().toCString(true)).isEmpty() ? "Unknown Album" : QString::fromUtf8(basicTag->album().toCString(true));
-                    tagsMap["genre"] = QString::fromUtf8(basicTag->genre().toCString(true));
-                    tagsMap["year"] = basicTag->year();
-                    tagsMap["track"] = basicTag->track();
-                    tagsMap["filePath"] = filePath;
-                    basicTagsRead = true;
-                } else { qWarning() << "[readId3Tags] TagLib::FileRef::tag() returned NULL for:" << filePath; }
-            } else { qWarning() << "[readId3Tags] TagLib::FileRef creation failed (isNull) for:" << filePath; }
-        } // End FileRef scope
-
-
-        TagLib::ID3v2::Tag *id3v2tag = nullptr;
-        { // MPEG::File scope for image extraction
-		  QByteArray utf8Path = filePath.toUtf8();
-          TagLib::MPEG::File mpegFile(utf8Path.constData(), false, TagLib::AudioProperties::Fast);
-            if (mpegFile.isValid() && mpegFile.hasID3v2Tag()) {
-                id3v2tag = mpegFile.ID3v2Tag();
-                if (id3v2tag) {
-                    TagLib::ID3v2::FrameListMap frameListMap = id3v2tag->frameListMap();
-                    if (frameListMap.contains("APIC")) {
-                        TagLib::ID3v2::FrameList apicFrames = frameListMap["APIC"];
-                        if (!apicFrames.isEmpty()) {
-                            TagLib::ID3v2::AttachedPictureFrame *pictureFrame = dynamic_cast<TagLib::ID3v2::AttachedPictureFrame*>(apicFrames.front());
-                            if (pictureFrame) {
-                                imageMimeType = QString::fromStdString(pictureFrame->mimeType().to8Bit(true));
-                                TagLib::ByteVector pictureData = pictureFrame->picture();
-                                if (!pictureData.isEmpty()) {
-                                    QByteArray imageData(pictureData.data(), pictureData.size());
-                                    imageBase64 = QString::fromUtf8(imageData.toBase64());
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        } // End MPEG::File scope
-
-    } catch (const std::exception& e) { qWarning() << "[readId3Tags] Exception processing TagLib for" << filePath << ":" << e.what(); }
-    catch (...) { qWarning() << "[readId3Tags] Unknown exception processing TagLib for" << filePath; }
-
-    // Fallback Logic
-    if (!basicTagsRead) {
-        qDebug() << "[readId3Tags] Applying fallback data for file:" << filePath;
-        tagsMap.clear();
-        tagsMap["title"] = QFileInfo(filePath).baseName();
-        tagsMap["artist"] = "Unknown Artist";
-        tagsMap["album"] = "Unknown Album";
-        tagsMap["genre"] = "";
-        tagsMap["year"] = 0;
-        tagsMap["track"] = 0;
-        tagsMap["filePath"] = filePath;
-        tagsMap["imageBase64"] = "";
-        tagsMap["imageMimeType"] = "";
-        tagsMap["source"] = "local"; // Also add source to fallback
-    } else {
-        tagsMap.insert("imageBase64", imageBase64);
-        tagsMap.insert("imageMimeType", imageMimeType);
-        // Safety checks (optional if confident)
-        tagsMap.insert("artist", tagsMap.value("artist", "Unknown Artist"));
-        tagsMap.insert("album", tagsMap.value("album", "Unknown Album"));
-        tagsMap.insert("title", tagsMap.value("title", QFileInfo(filePath).baseName()));
-    }
-
-    // Final Log & Return
-    // qDebug() << "[readId3Tags] Returning map for file:" << filePath << " Title:" << tagsMap.value("title");
-    if (tagsMap.value("filePath").toString().isEmpty()) {
-        qWarning() << "[readId3Tags] FATAL: Returning map WITHOUT filePath for:" << filePath;
-        return QVariantMap();
-    }
+    QVariantMap tagsMap = LibraryScanner::readTags(filePath);
+    m_libraryIndex.takeCover(&tagsMap); // tracks only carry the coverId
+    // Detected tempo, if this exact file was analyzed before
+    if (!tagsMap.isEmpty()) tagsMap.insert("bpm", m_tempoAnalyzer.cachedBpm(filePath));
     return tagsMap;
 }
-
@@ -0,0 +1,11 @@
+// LogCategories.cpp
+#include "LogCategories.h"
+
+Q_LOGGING_CATEGORY(lcScan, "librify.scan", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcTags, "librify.tags", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcIndex, "librify.index", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcSort, "librify.sort", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcLoad, "librify.load", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcPlaylist, "librify.playlist", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcSpectrum, "librify.spectrum", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcFrames, "librify.frames", QtInfoMsg)
@@ -0,0 +1,244 @@
+// MetricsRegistry.cpp
+#include "MetricsRegistry.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QList>
+#include <QMutex>
+#include <QSysInfo>
+#include <QThread>
+
+#if defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#elif defined(Q_OS_WIN)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+namespace {
+struct HistogramInfo {
+    const char *name;
+    const char *unit;
+    const char *help;
+    HdrHistogram *histogram;
+};
+
+const HistogramInfo Histograms[] = {
+    {"scanFilesPerSecond", "files/s", "Library scan throughput in files per second.", &Metrics::scanFilesPerSecond},
+    {"scanBytesPerSecond", "bytes/s", "Library scan throughput in bytes of audio files per second.", &Metrics::scanBytesPerSecond},
+    {"indexBuildMicros", "us", "Index lookups, move detection and tag reads of one scan.", &Metrics::indexBuildMicros},
+    {"indexLoadMicros", "us", "Loading the library index file.", &Metrics::indexLoadMicros},
+    {"tagReadMicros", "us", "Reading the tags of one file with TagLib.", &Metrics::tagReadMicros},
+    {"scanMicros", "us", "Library scan, start to results applied.", &Metrics::scanMicros},
+    {"startupMicros", "us", "Process start to the first frame on screen.", &Metrics::startupMicros},
+    {"frameMicros", "us", "Time between two frames on screen while the UI is updating.", &Metrics::frameMicros},
+    {"frameRenderMicros", "us", "Render thread time from beforeRendering to the buffer swap.", &Metrics::frameRenderMicros},
+    {"sortMicros", "us", "Sorting the track list.", &Metrics::sortMicros},
+    {"tracksChangedTracks", "tracks", "Tracks handed to QML per tracksChanged.", &Metrics::tracksChangedTracks},
+    {"playbackStartMicros", "us", "New media source to playing.", &Metrics::playbackStartMicros},
+    {"httpRequestMicros", "us", "Control endpoint request handling.", &Metrics::httpRequestMicros},
+};
+
+struct CounterInfo {
+    const char *name;
+    const char *help;
+    std::atomic<quint64> *counter;
+};
+
+const CounterInfo Counters[] = {
+    {"scannedFiles", "Audio files visited by library scans.", &Metrics::scannedFiles},
+    {"scannedBytes", "Bytes of audio files visited by library scans.", &Metrics::scannedBytes},
+    {"isolatedReads", "Risky files whose tags were read in the separate worker process.", &Metrics::isolatedReads},
+    {"quarantinedFiles", "Files given file-name-only tags after timing out or crashing the reader.", &Metrics::quarantinedFiles},
+    {"longFrames", "Frames over the long-frame threshold.", &Metrics::longFrames},
+    {"longFramesAfterReset", "Long frames preceded by a model reset.", &Metrics::longFramesAfterReset},
+    {"longFramesWithDelegates", "Long frames that created delegates.", &Metrics::longFramesWithDelegates},
+    {"coverCacheHits", "Cover thumbnails served from memory or disk.", &Metrics::coverCacheHits},
+    {"coverCacheMisses", "Cover thumbnails scaled from the original image.", &Metrics::coverCacheMisses},
+};
+
+struct ProbeList {
+    QMutex mutex;
+    QList<QPair<QString, MetricsRegistry::MemoryProbe>> probes;
+};
+
+ProbeList &probeList() {
+    static ProbeList instance;
+    return instance;
+}
+
+QList<QPair<QString, MetricsRegistry::MemoryProbe>> memoryProbes() {
+    ProbeList &list = probeList();
+    QMutexLocker locker(&list.mutex);
+    return list.probes;
+}
+
+// Prometheus names: scanFilesPerSecond -> librify_scan_files_per_second
+QByteArray prometheusName(const char *name) {
+    QByteArray out = "librify_";
+    for (const char *c = name; *c; ++c) {
+        if (*c >= 'A' && *c <= 'Z') {
+            out += '_';
+            out += char(*c - 'A' + 'a');
+        } else {
+            out += *c;
+        }
+    }
+    return out;
+}
+
+double coverHitRate() {
+    const quint64 hits = Metrics::coverCacheHits.load(std::memory_order_relaxed);
+    const quint64 total = hits + Metrics::coverCacheMisses.load(std::memory_order_relaxed);
+    return total == 0 ? 0.0 : double(hits) / double(total);
+}
+}
+
+void MetricsRegistry::addMemoryProbe(const QString &subsystem, MemoryProbe probe) {
+    ProbeList &list = probeList();
+    QMutexLocker locker(&list.mutex);
+    list.probes.append({subsystem, std::move(probe)});
+}
+
+//=============================================================================
+// FUNCTION: Snapshot
+//=============================================================================
+QVariantMap MetricsRegistry::snapshot() {
+    QVariantMap system;
+    system.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    system.insert("application", QCoreApplication::applicationName());
+    system.insert("version", QCoreApplication::applicationVersion());
+    system.insert("qt", QString::fromLatin1(qVersion()));
+    system.insert("os", QSysInfo::prettyProductName());
+    system.insert("cpu", QSysInfo::currentCpuArchitecture());
+    system.insert("idealThreads", QThread::idealThreadCount());
+
+    QVariantMap histograms;
+    for (const HistogramInfo &info : Histograms) {
+        const HdrHistogram &h = *info.histogram;
+        QVariantMap values;
+        values.insert("unit", QString::fromLatin1(info.unit));
+        values.insert("count", h.count());
+        values.insert("min", h.min());
+        values.insert("max", h.max());
+        values.insert("mean", h.mean());
+        values.insert("p50", h.valueAtQuantile(0.50));
+        values.insert("p90", h.valueAtQuantile(0.90));
+        values.insert("p99", h.valueAtQuantile(0.99));
+        histograms.insert(QString::fromLatin1(info.name), values);
+    }
+
+    QVariantMap counters;
+    for (const CounterInfo &info : Counters) {
+        counters.insert(QString::fromLatin1(info.name), info.counter->load(std::memory_order_relaxed));
+    }
+    counters.insert("coverCacheHitRate", coverHitRate());
+
+    QVariantMap memory;
+    memory.insert("process", residentMemoryBytes());
+    for (const auto &probe : memoryProbes()) memory.insert(probe.first, probe.second());
+
+    QVariantMap result;
+    result.insert("system", system);
+    result.insert("histograms", histograms);
+    result.insert("counters", counters);
+    result.insert("memory", memory);
+    return result;
+}
+
+QByteArray MetricsRegistry::snapshotJson() {
+    return QJsonDocument::fromVariant(snapshot()).toJson(QJsonDocument::Indented);
+}
+
+void MetricsRegistry::reset() {
+    for (const HistogramInfo &info : Histograms) info.histogram->reset();
+    for (const CounterInfo &info : Counters) info.counter->store(0, std::memory_order_relaxed);
+}
+
+void MetricsRegistry::appendPrometheus(QByteArray &out) {
+    for (const HistogramInfo &info : Histograms) {
+        const HdrHistogram &h = *info.histogram;
+        const QByteArray metric = prometheusName(info.name);
+        out += "# HELP " + metric + ' ' + info.help + " Unit: " + info.unit + '\n';
+        out += "# TYPE " + metric + " summary\n";
+        for (const char *quantile : {"0.5", "0.9", "0.99"}) {
+            out += metric + "{quantile=\"" + quantile + "\"} "
+                   + QByteArray::number(h.valueAtQuantile(QByteArray(quantile).toDouble())) + '\n';
+        }
+        out += metric + "_sum " + QByteArray::number(h.mean() * double(h.count()), 'f', 0) + '\n';
+        out += metric + "_count " + QByteArray::number(h.count()) + '\n';
+    }
+    for (const CounterInfo &info : Counters) {
+        const QByteArray metric = prometheusName(info.name) + "_total";
+        out += "# HELP " + metric + ' ' + info.help + '\n';
+        out += "# TYPE " + metric + " counter\n";
+        out += metric + ' ' + QByteArray::number(info.counter->load(std::memory_order_relaxed)) + '\n';
+    }
+    out += "# HELP librify_memory_bytes Resident memory of the process and estimated heap use per subsystem.\n";
+    out += "# TYPE librify_memory_bytes gauge\n";
+    out += "librify_memory_bytes{subsystem=\"process\"} " + QByteArray::number(residentMemoryBytes()) + '\n';
+    for (const auto &probe : memoryProbes()) {
+        out += "librify_memory_bytes{subsystem=\"" + probe.first.toLatin1() + "\"} "
+               + QByteArray::number(probe.second()) + '\n';
+    }
+}
+
+//=============================================================================
+// HELPER: Memory
+//=============================================================================
+qint64 MetricsRegistry::residentMemoryBytes() {
+#if defined(Q_OS_MACOS)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return -1;
+    }
+    return qint64(info.resident_size);
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+    return qint64(counters.WorkingSetSize);
+#elif defined(Q_OS_UNIX)
+    // Second field of /proc/self/statm: resident pages
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) return -1;
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) return -1;
+    return fields.at(1).toLongLong() * qint64(sysconf(_SC_PAGESIZE));
+#else
+    return -1;
+#endif
+}
+
+qint64 MetricsRegistry::estimateBytes(const QVariant &value) {
+    constexpr qint64 NodeOverhead = 32; // container node / variant bookkeeping
+    switch (value.typeId()) {
+    case QMetaType::QString:
+        return NodeOverhead + 2 * qint64(value.toString().size());
+    case QMetaType::QByteArray:
+        return NodeOverhead + qint64(value.toByteArray().size());
+    case QMetaType::QVariantMap: {
+        const QVariantMap map = value.toMap();
+        qint64 bytes = NodeOverhead;
+        for (auto it = map.cbegin(); it != map.cend(); ++it) {
+            bytes += NodeOverhead + 2 * qint64(it.key().size()) + estimateBytes(it.value());
+        }
+        return bytes;
+    }
+    case QMetaType::QVariantList: {
+        const QVariantList list = value.toList();
+        qint64 bytes = NodeOverhead;
+        for (const QVariant &item : list) bytes += estimateBytes(item);
+        return bytes;
+    }
+    default:
+        return qint64(sizeof(QVariant));
+    }
+}
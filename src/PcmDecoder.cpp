@@ -0,0 +1,117 @@
+// PcmDecoder.cpp
+#include "PcmDecoder.h"
+
+#include <QAudioDecoder>
+#include <QAudioFormat>
+#include <QEventLoop>
+#include <QTimer>
+#include <QUrl>
+#include <QDebug>
+
+namespace {
+constexpr int DecodeTimeoutMs = 120000; // hard stop for decoders that never report finished
+
+template <typename Sample>
+void downmix(const Sample *data, qsizetype frames, int channels, float scale, float offset, std::vector<float> &out) {
+    const size_t base = out.size();
+    out.resize(base + frames);
+    for (qsizetype f = 0; f < frames; ++f) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            sum += (static_cast<float>(data[f * channels + c]) - offset) * scale;
+        }
+        out[base + f] = sum / channels;
+    }
+}
+}
+
+void PcmDecoder::appendMono(const QAudioBuffer &buffer, std::vector<float> &out) {
+    const QAudioFormat format = buffer.format();
+    const int channels = qMax(1, format.channelCount());
+    const qsizetype frames = buffer.frameCount();
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Float:
+        downmix(buffer.constData<float>(), frames, channels, 1.0f, 0.0f, out);
+        break;
+    case QAudioFormat::Int16:
+        downmix(buffer.constData<qint16>(), frames, channels, 1.0f / 32768.0f, 0.0f, out);
+        break;
+    case QAudioFormat::Int32:
+        downmix(buffer.constData<qint32>(), frames, channels, 1.0f / 2147483648.0f, 0.0f, out);
+        break;
+    case QAudioFormat::UInt8:
+        downmix(buffer.constData<quint8>(), frames, channels, 1.0f / 128.0f, 128.0f, out);
+        break;
+    default:
+        break;
+    }
+}
+
+std::vector<float> PcmDecoder::decodeMono(const QString &filePath, int sampleRate,
+                                          qint64 startMs, qint64 maxDurationMs,
+                                          const std::atomic_bool *cancel) {
+    std::vector<float> samples;
+    const qint64 skipSamples = startMs > 0 ? startMs * sampleRate / 1000 : 0;
+    const qint64 maxSamples = maxDurationMs > 0 ? maxDurationMs * sampleRate / 1000 : -1;
+    qint64 skipped = 0;
+    bool failed = false;
+    bool done = false;
+
+    QAudioFormat format;
+    format.setSampleFormat(QAudioFormat::Float);
+    format.setChannelCount(1);
+    format.setSampleRate(sampleRate);
+
+    QAudioDecoder decoder;
+    decoder.setAudioFormat(format);
+    decoder.setSource(QUrl::fromLocalFile(filePath));
+
+    QEventLoop loop;
+    // Errors can be reported synchronously from start(), before the loop runs
+    auto finish = [&]() {
+        done = true;
+        loop.quit();
+    };
+    QObject::connect(&decoder, &QAudioDecoder::bufferReady, &loop, [&]() {
+        const QAudioBuffer buffer = decoder.read();
+        if (!buffer.isValid()) return;
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            failed = true;
+            decoder.stop();
+            finish();
+            return;
+        }
+        const size_t before = samples.size();
+        appendMono(buffer, samples);
+        // Drop whatever still falls before the requested start offset
+        if (skipped < skipSamples) {
+            const qint64 drop = qMin<qint64>(skipSamples - skipped, static_cast<qint64>(samples.size() - before));
+            samples.erase(samples.begin() + before, samples.begin() + before + drop);
+            skipped += drop;
+        }
+        if (maxSamples > 0 && static_cast<qint64>(samples.size()) >= maxSamples) {
+            samples.resize(maxSamples);
+            decoder.stop();
+            finish();
+        }
+    });
+    QObject::connect(&decoder, &QAudioDecoder::finished, &loop, finish);
+    QObject::connect(&decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), &loop,
+                     [&](QAudioDecoder::Error) {
+                         qWarning() << "[PcmDecoder] Decode error for" << filePath << ":" << decoder.errorString();
+                         failed = true;
+                         finish();
+                     });
+    QTimer::singleShot(DecodeTimeoutMs, &loop, [&]() {
+        qWarning() << "[PcmDecoder] Decode timed out for" << filePath;
+        failed = true;
+        finish();
+    });
+
+    decoder.start();
+    if (!done) loop.exec();
+    decoder.stop();
+
+    if (failed) samples.clear();
+    return samples;
+}
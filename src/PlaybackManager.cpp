@@ -1,5 +1,6 @@
 // PlaybackManager.cpp
 #include "PlaybackManager.h"
+#include "MetricsRegistry.h"
 #include <QDebug>
 #include <QtMath>
 
@@ -8,6 +9,7 @@ PlaybackManager::PlaybackManager(QObject *parent) : QObject(parent){}
 bool PlaybackManager::ready() const {return m_ready;}
 double PlaybackManager::volume() const {return m_volume;}
 bool PlaybackManager::muted() const {return m_muted;}
+QStringList PlaybackManager::queue() const {return m_queue;}
 
 // ***** SET MEDIAPLAYER *****
 void PlaybackManager::setMediaPlayer(QMediaPlayer *player) {
@@ -27,9 +29,12 @@ void PlaybackManager::setMediaPlayer(QMediaPlayer *player) {
     }
     m_audioOutput = nullptr; // Clear pointer
 
+    if (m_mediaPlayer) disconnect(m_mediaPlayer, nullptr, this, nullptr);
     m_mediaPlayer = player; // Store player pointer
 
     if (m_mediaPlayer) {
+        connect(m_mediaPlayer, &QMediaPlayer::sourceChanged, this, &PlaybackManager::onSourceChanged);
+        connect(m_mediaPlayer, &QMediaPlayer::playbackStateChanged, this, &PlaybackManager::onPlaybackStateChanged);
         m_audioOutput = m_mediaPlayer->audioOutput(); // Get the audioOutput
 
         if (m_audioOutput) {
@@ -98,3 +103,60 @@ void PlaybackManager::onAudioOutputMutedChanged(bool muted) {
         emit mutedChanged();
     }
 }
+
+// ***** TRANSPORT (control endpoint / scripts) *****
+void PlaybackManager::play() {
+    if (m_mediaPlayer && !m_mediaPlayer->source().isEmpty()) {
+        m_mediaPlayer->play();
+    } else {
+        emit playRequested(); // nothing loaded yet: Main.qml picks the track
+    }
+}
+void PlaybackManager::pause() {
+    if (m_mediaPlayer) m_mediaPlayer->pause();
+}
+void PlaybackManager::requestNext() {
+    emit nextRequested();
+}
+void PlaybackManager::enqueue(const QString &filePath) {
+    if (filePath.isEmpty()) return;
+    m_queue.append(filePath);
+    emit queueChanged();
+}
+QString PlaybackManager::takeQueuedTrack() {
+    if (m_queue.isEmpty()) return QString();
+    const QString filePath = m_queue.takeFirst();
+    emit queueChanged();
+    return filePath;
+}
+
+QVariantMap PlaybackManager::nowPlaying() const {
+    QVariantMap state;
+    state["queueLength"] = m_queue.size();
+    state["volume"] = m_volume;
+    state["muted"] = m_muted;
+    if (!m_mediaPlayer) {
+        state["state"] = "unavailable";
+        return state;
+    }
+    switch (m_mediaPlayer->playbackState()) {
+    case QMediaPlayer::PlayingState: state["state"] = "playing"; break;
+    case QMediaPlayer::PausedState: state["state"] = "paused"; break;
+    default: state["state"] = "stopped"; break;
+    }
+    state["filePath"] = m_mediaPlayer->source().toLocalFile();
+    state["positionMs"] = m_mediaPlayer->position();
+    state["durationMs"] = m_mediaPlayer->duration();
+    return state;
+}
+
+// ***** PLAYBACK START LATENCY *****
+void PlaybackManager::onSourceChanged() {
+    m_startLatencyTimer.start();
+}
+void PlaybackManager::onPlaybackStateChanged(QMediaPlayer::PlaybackState state) {
+    if (state == QMediaPlayer::PlayingState && m_startLatencyTimer.isValid()) {
+        Metrics::playbackStartMicros.record(m_startLatencyTimer.nsecsElapsed() / 1000);
+        m_startLatencyTimer.invalidate();
+    }
+}
@@ -1,14 +1,33 @@
 // PlaylistManager.cpp
 #include "PlaylistManager.h"
 #include "TrackListModel.h"
+#include "LogCategories.h"
+#include "Trace.h"
 #include <QFile>
 #include <QFileInfo>
 #include <QJsonDocument>
 #include <QImage>
 #include <QUrl>
+#include <QtConcurrent>
 
+// Playlists are read by loadPlaylistsAsync() once the window is up (see main.cpp)
 PlaylistManager::PlaylistManager(QObject *parent) : QObject(parent) {
-    loadPlaylists();
+    connect(&m_loadWatcher, &QFutureWatcher<QList<SidebarModel::Item>>::finished, this, [this]() {
+        m_sidebarModel.setItems(m_loadWatcher.result());
+        emit playlistsLoaded();
+    });
+    connect(&m_exportWatcher, &QFutureWatcher<PlaylistSync::Result>::progressValueChanged, this, [this](int done) {
+        emit exportProgress(done, m_exportWatcher.progressMaximum());
+    });
+    connect(&m_exportWatcher, &QFutureWatcher<PlaylistSync::Result>::finished, this, [this]() {
+        emit exportingChanged();
+        emit exportFinished(m_exportWatcher.result().toVariantMap());
+    });
+}
+
+void PlaylistManager::loadPlaylistsAsync() {
+    if (m_loadWatcher.isRunning()) return;
+    m_loadWatcher.setFuture(QtConcurrent::run(&PlaylistManager::readPlaylistItems, playlistsDirPath()));
 }
 
 QString PlaylistManager::playlistsDirPath() const {
@@ -22,14 +41,12 @@ QString PlaylistManager::playlistFilePath(const QString &name) const {
 }
 
 QVariantList PlaylistManager::getPlaylists() const { 
-	if (m_sidebarItems.size() <= 1) {
+	if (m_sidebarModel.count() <= 1) {
 		return QVariantList();
 	}
-	return m_sidebarItems.mid(1);
+	return m_sidebarModel.toVariantList().mid(1);
 }
 
-QVariantList PlaylistManager::sidebarItems() const { return m_sidebarItems; }
-
 void PlaylistManager::createPlaylist(const QString &name, const QString &image) {
     QJsonObject obj;
 	obj["id"] = name;
@@ -47,22 +64,22 @@ void PlaylistManager::deletePlaylist(const QString &name) {
 }
 
 void PlaylistManager::refreshSidebarItems() {
-	qDebug() << "[PlaylistManager] New sidebar list build for PLAYLISTS";
+	qCDebug(lcPlaylist) << "[PlaylistManager] New sidebar list build for PLAYLISTS";
     loadPlaylists();
 }
 
 void PlaylistManager::loadPlaylists() {
-    m_sidebarItems.clear();
+    m_sidebarModel.setItems(readPlaylistItems(playlistsDirPath()));
+}
 
-    QDir dir(playlistsDirPath());
+// Any thread: no member state
+QList<SidebarModel::Item> PlaylistManager::readPlaylistItems(const QString &dirPath) {
+    Trace::Span span("playlist", "loadPlaylists");
+    QList<SidebarModel::Item> items;
+
+    QDir dir(dirPath);
     QFileInfoList files = dir.entryInfoList(QStringList() << "*.json", QDir::Files);
-	QVariantMap createMap;
-    createMap["type"] = "create_playlist";
-    createMap["name"] = "Create";
-    createMap["id"] = "Create";
-    createMap["iconSource"] = "qrc:/icons/all_tracks_icon.png";
-    createMap["count"] = 0;
-    m_sidebarItems.append(createMap);
+    items.append(SidebarModel::Item{"create_playlist", "Create", "Create", "qrc:/icons/all_tracks_icon.png", 0});
 
     for (const QFileInfo &fi : files) {
         QFile file(fi.filePath());
@@ -72,22 +89,80 @@ void PlaylistManager::loadPlaylists() {
         QJsonDocument doc = QJsonDocument::fromJson(data);
         QJsonObject obj = doc.object();
 
-        QVariantMap item;
-		item["id"] = obj.value("name").toString();
-        item["name"] = obj.value("name").toString();
-        item["iconSource"] = obj.value("iconSource").toString();
-		item["type"] = obj.value("type").toString();
-		item["count"] = obj.value("tracks").toArray().size();
-        m_sidebarItems.append(item);
+        SidebarModel::Item item;
+		item.id = obj.value("name").toString();
+        item.name = obj.value("name").toString();
+        item.iconSource = obj.value("iconSource").toString();
+		item.type = obj.value("type").toString();
+		item.count = int(obj.value("tracks").toArray().size());
+        items.append(item);
+    }
+    span.setArg(files.size());
+    return items;
+}
+
+// Any thread: no member state
+QStringList PlaylistManager::readPlaylistTracks(const QString &filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return QStringList();
+    QStringList tracks;
+    const QJsonArray array = QJsonDocument::fromJson(file.readAll()).object().value("tracks").toArray();
+    for (const QJsonValue &value : array) tracks.append(value.toString());
+    return tracks;
+}
+
+// Track added/removed: only that row's count changes, no need to re-read every playlist
+void PlaylistManager::updatePlaylistCount(const QString &name, int count) {
+    const int row = m_sidebarModel.indexOf("local_playlist", name);
+    if (row < 0) {
+        loadPlaylists();
+        return;
+    }
+    SidebarModel::Item item = m_sidebarModel.items().at(row);
+    item.count = count;
+    m_sidebarModel.updateItem(item);
+}
+
+void PlaylistManager::remapTrackPaths(const QHash<QString, QString> &movedPaths) {
+    if (movedPaths.isEmpty()) return;
+
+    int rewritten = 0;
+    QDir dir(playlistsDirPath());
+    const QFileInfoList files = dir.entryInfoList(QStringList() << "*.json", QDir::Files);
+    for (const QFileInfo &fi : files) {
+        QFile file(fi.filePath());
+        if (!file.open(QIODevice::ReadOnly)) continue;
+        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+        file.close();
+        if (!doc.isObject()) continue;
+
+        QJsonObject playlistObj = doc.object();
+        QJsonArray tracks = playlistObj["tracks"].toArray();
+        bool changed = false;
+        for (int i = 0; i < tracks.size(); ++i) {
+            auto it = movedPaths.constFind(tracks.at(i).toString());
+            if (it == movedPaths.constEnd()) continue;
+            tracks[i] = it.value();
+            changed = true;
+            ++rewritten;
+        }
+        if (changed) {
+            playlistObj["tracks"] = tracks;
+            savePlaylist(fi.completeBaseName(), playlistObj);
+        }
     }
 
-    emit sidebarItemsChanged();
+    if (rewritten > 0) {
+        qDebug() << "[PlaylistManager] Rewrote" << rewritten << "moved track references.";
+        loadPlaylists();
+    }
 }
 
 void PlaylistManager::savePlaylist(const QString &name, const QJsonObject &playlistObj) {
+    LIBRIFY_TRACE_SCOPE("playlist", "savePlaylist");
     QFile file(playlistFilePath(name));
     if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Failed to save playlist file:" << file.fileName();
+        qCWarning(lcPlaylist) << "Failed to save playlist file:" << file.fileName();
         return;
     }
 
@@ -172,7 +247,7 @@ void PlaylistManager::addTrack(const QString &playlistName, const QString &track
     playlistObj["tracks"] = tracks;
 
     savePlaylist(playlistName, playlistObj);
-	refreshSidebarItems();   
+	updatePlaylistCount(playlistName, int(tracks.size()));
 }
 
 void PlaylistManager::removeTrack(const QString &playlistName, const QString &trackFilepath) {
@@ -203,5 +278,31 @@ void PlaylistManager::removeTrack(const QString &playlistName, const QString &tr
     playlistObj["tracks"] = newTracks;
 
     savePlaylist(playlistName, playlistObj);
-    refreshSidebarItems();
+    updatePlaylistCount(playlistName, int(newTracks.size()));
+}
+
+//=============================================================================
+// FUNCTION: Export / sync to a device folder
+//=============================================================================
+bool PlaylistManager::exportPlaylists(const QStringList &names, const QString &targetDir, const QStringList &sourceRoots) {
+    if (m_exportWatcher.isRunning() || names.isEmpty() || targetDir.isEmpty()) return false;
+    QStringList filePaths;
+    for (const QString &name : names) filePaths.append(playlistFilePath(name));
+    qDebug() << "[PlaylistManager] Exporting" << names << "to" << targetDir;
+
+    m_exportWatcher.setFuture(QtConcurrent::run(
+        [names, filePaths, targetDir, sourceRoots](QPromise<PlaylistSync::Result> &promise) {
+            QList<PlaylistSync::Playlist> playlists;
+            for (int i = 0; i < names.size(); ++i) playlists.append({names.at(i), readPlaylistTracks(filePaths.at(i))});
+            PlaylistSync sync(targetDir, sourceRoots);
+            promise.addResult(sync.run(playlists, [&promise](int done, int total) {
+                if (done == 0) {
+                    promise.setProgressRange(0, total);
+                } else {
+                    promise.setProgressValue(done); // ignored when a later value got there first
+                }
+            }));
+        }));
+    emit exportingChanged();
+    return true;
 }
@@ -0,0 +1,486 @@
+// PlaylistSync.cpp
+#include "PlaylistSync.h"
+#include "LibraryIndex.h"
+#include "LogCategories.h"
+#include "StorageScheduler.h"
+#include "Trace.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr quint32 ManifestMagic = 0x4C505331; // "LPS1"
+constexpr qint32 ManifestVersion = 1;
+constexpr int MaxReportedErrors = 20;
+constexpr int MaxNameLength = 255;            // UTF-16 units per FAT/exFAT name
+constexpr qint64 StreamChunkBytes = 1 << 20;
+const QString MusicFolder = QStringLiteral("Music");
+const QString PartialSuffix = QStringLiteral(".librify-part");
+
+enum class JobState { Pending, Copy, UpToDate, Copied, Missing, Failed };
+
+// A manifest target is only trusted below Music/ of the target folder: the
+// manifest lives on the device and anything may have written it
+bool isSafeTarget(const QString &relativePath) {
+    if (!relativePath.startsWith(MusicFolder + '/') || QDir::isAbsolutePath(relativePath)) return false;
+    const QStringList parts = relativePath.split('/');
+    return !parts.contains(QStringLiteral("..")) && !parts.contains(QStringLiteral(".")) && !parts.contains(QString());
+}
+
+struct Job {
+    QString source;
+    QString target; // relative to the target folder
+    LibraryIndex::FileStat stat;
+    JobState state = JobState::Pending;
+    bool cloned = false;
+    QString error;
+};
+
+#ifdef Q_OS_LINUX
+// Plain read/write from the current offsets to the end of in
+bool streamCopy(int in, int out) {
+    QByteArray buffer(StreamChunkBytes, Qt::Uninitialized);
+    for (;;) {
+        const ssize_t got = ::read(in, buffer.data(), size_t(buffer.size()));
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) return false;
+        if (got == 0) return true;
+        for (ssize_t written = 0; written < got;) {
+            const ssize_t n = ::write(out, buffer.constData() + written, size_t(got - written));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            written += n;
+        }
+    }
+}
+#endif
+}
+
+QVariantMap PlaylistSync::Result::toVariantMap() const {
+    return {{"tracks", tracks},
+            {"copied", copied},
+            {"cloned", cloned},
+            {"upToDate", upToDate},
+            {"missing", missing},
+            {"failed", failed},
+            {"removed", removed},
+            {"bytesCopied", bytesCopied},
+            {"elapsedMs", elapsedMs},
+            {"playlistFiles", playlistFiles},
+            {"errors", errors}};
+}
+
+PlaylistSync::PlaylistSync(const QString &targetDir, const QStringList &sourceRoots)
+    : m_targetDir(QDir::cleanPath(targetDir)) {
+    for (const QString &root : sourceRoots) {
+        if (!root.trimmed().isEmpty()) m_sourceRoots.append(QDir::cleanPath(root.trimmed()));
+    }
+    // Nested roots: the deepest one decides the layout
+    std::sort(m_sourceRoots.begin(), m_sourceRoots.end(),
+              [](const QString &a, const QString &b) { return a.size() > b.size(); });
+}
+
+QString PlaylistSync::manifestFilePath() const {
+    return m_targetDir + "/.librify-sync";
+}
+
+//=============================================================================
+// HELPER: Target layout
+//=============================================================================
+QString PlaylistSync::safeFileName(const QString &name) {
+    QString safe;
+    safe.reserve(name.size());
+    for (const QChar c : name) {
+        safe.append(c.unicode() < 0x20 || QStringLiteral("<>:\"/\\|?*").contains(c) ? QChar('_') : c);
+    }
+    while (safe.endsWith(' ') || safe.endsWith('.')) safe.chop(1);
+    if (safe.size() > MaxNameLength) {
+        const QString suffix = QFileInfo(safe).suffix();
+        const int keep = MaxNameLength - (suffix.isEmpty() ? 0 : int(suffix.size()) + 1);
+        safe = suffix.isEmpty() ? safe.left(keep) : safe.left(keep) + '.' + suffix;
+    }
+    return safe.isEmpty() ? QStringLiteral("_") : safe;
+}
+
+QString PlaylistSync::targetPathFor(const QString &sourcePath) const {
+    const QString cleaned = QDir::cleanPath(sourcePath);
+    QString relative;
+    for (const QString &root : m_sourceRoots) {
+        if (cleaned.startsWith(root + '/')) {
+            relative = cleaned.mid(root.size() + 1);
+            break;
+        }
+    }
+    if (relative.isEmpty()) {
+        const QFileInfo info(cleaned);
+        relative = QStringLiteral("Other/") + info.dir().dirName() + '/' + info.fileName();
+    }
+    QStringList parts = relative.split('/', Qt::SkipEmptyParts);
+    for (QString &part : parts) part = safeFileName(part);
+    return MusicFolder + '/' + parts.join('/');
+}
+
+//=============================================================================
+// FUNCTION: One incremental sync
+//=============================================================================
+PlaylistSync::Result PlaylistSync::run(const QList<Playlist> &playlists, const Progress &progress) {
+    LIBRIFY_TRACE_SCOPE("playlist", "sync");
+    QElapsedTimer timer;
+    timer.start();
+    Result result;
+    if (!QDir().mkpath(m_targetDir)) {
+        result.errors << "Cannot create " + m_targetDir;
+        return result;
+    }
+    loadManifest();
+
+    // 1. Distinct source files, each with a target that stays put across runs
+    QList<Job> jobs;
+    QHash<QString, int> jobOf;
+    for (const Playlist &playlist : playlists) {
+        for (const QString &source : playlist.tracks) {
+            if (source.isEmpty() || jobOf.contains(source)) continue;
+            jobOf.insert(source, int(jobs.size()));
+            jobs.append(Job{source});
+        }
+    }
+    QSet<QString> takenTargets; // lower case: FAT and exFAT ignore case
+    for (const ManifestEntry &entry : std::as_const(m_manifest)) takenTargets.insert(entry.target.toLower());
+    for (Job &job : jobs) {
+        auto it = m_manifest.constFind(job.source);
+        if (it != m_manifest.constEnd()) {
+            job.target = it->target;
+            continue;
+        }
+        const QString preferred = targetPathFor(job.source);
+        const QFileInfo info(preferred);
+        QString candidate = preferred;
+        for (int n = 2; takenTargets.contains(candidate.toLower()); ++n) {
+            candidate = QStringLiteral("%1/%2 (%3)").arg(info.path(), info.completeBaseName()).arg(n);
+            if (!info.suffix().isEmpty()) candidate += '.' + info.suffix();
+        }
+        takenTargets.insert(candidate.toLower());
+        job.target = candidate;
+    }
+    result.tracks = int(jobs.size());
+
+    // 2. Compare both sides against the manifest (stat only, global pool)
+    std::atomic<int> done{0};
+    const int total = int(jobs.size());
+    const auto reportDone = [&]() {
+        const int current = done.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (progress) progress(current, total);
+    };
+    if (progress) progress(0, total);
+    {
+        LIBRIFY_TRACE_SCOPE("playlist", "syncCheck");
+        QtConcurrent::blockingMap(jobs, [this, &reportDone](Job &job) {
+            if (!LibraryIndex::statFile(job.source, &job.stat)) {
+                job.state = JobState::Missing;
+                reportDone();
+                return;
+            }
+            const auto it = m_manifest.constFind(job.source);
+            LibraryIndex::FileStat targetStat;
+            const bool unchanged = it != m_manifest.constEnd() && it->sourceSize == job.stat.size
+                                   && it->sourceModified == job.stat.modified
+                                   && LibraryIndex::statFile(m_targetDir + '/' + job.target, &targetStat)
+                                   && targetStat.size == job.stat.size; // mtimes: FAT keeps 2 s steps
+            job.state = unchanged ? JobState::UpToDate : JobState::Copy;
+            if (unchanged) reportDone();
+        });
+    }
+
+    // 3. Copy what changed, as many at once as the target device takes
+    QList<int> copyIndices;
+    for (int i = 0; i < jobs.size(); ++i) {
+        if (jobs.at(i).state == JobState::Copy) copyIndices.append(i);
+    }
+    if (!copyIndices.isEmpty()) {
+        Trace::Span span("playlist", "syncCopy");
+        span.setArg(copyIndices.size());
+        const QList<StorageScheduler::Device> devices = StorageScheduler::groupRoots({m_targetDir});
+        QThreadPool pool;
+        pool.setMaxThreadCount(devices.isEmpty() ? StorageScheduler::concurrencyFor(StorageScheduler::Media::Unknown)
+                                                 : devices.first().concurrency);
+        Job *jobData = jobs.data();
+        QtConcurrent::blockingMap(&pool, copyIndices, [this, jobData, &reportDone](int i) {
+            Job &job = jobData[i];
+            CopyMethod method = CopyMethod::Stream;
+            if (copyFile(job.source, m_targetDir + '/' + job.target, &method, &job.error)) {
+                job.state = JobState::Copied;
+                job.cloned = method != CopyMethod::Stream;
+            } else {
+                job.state = JobState::Failed;
+            }
+            reportDone();
+        });
+    }
+
+    for (const Job &job : std::as_const(jobs)) {
+        switch (job.state) {
+        case JobState::UpToDate: ++result.upToDate; break;
+        case JobState::Missing: ++result.missing; break;
+        case JobState::Copied:
+            ++result.copied;
+            if (job.cloned) ++result.cloned;
+            result.bytesCopied += job.stat.size;
+            break;
+        case JobState::Failed:
+            ++result.failed;
+            if (result.errors.size() < MaxReportedErrors) result.errors << job.source + ": " + job.error;
+            break;
+        default: break;
+        }
+    }
+
+    // 4. Manifest: this run's playlists now use exactly this run's files. A source
+    // that is missing (unmounted root, offline share) keeps its copy: it may be
+    // the only one left
+    QSet<QString> syncedNames;
+    for (const Playlist &playlist : playlists) syncedNames.insert(playlist.name);
+    for (ManifestEntry &entry : m_manifest) {
+        entry.playlists.removeIf([&syncedNames](const QString &name) { return syncedNames.contains(name); });
+    }
+    for (const Playlist &playlist : playlists) {
+        for (const QString &source : playlist.tracks) {
+            const Job &job = jobs.at(jobOf.value(source));
+            if (job.state == JobState::Missing) {
+                const auto it = m_manifest.find(source);
+                if (it != m_manifest.end() && !it->playlists.contains(playlist.name)) it->playlists.append(playlist.name);
+                continue;
+            }
+            ManifestEntry &entry = m_manifest[source];
+            entry.target = job.target;
+            const bool current = job.state == JobState::Copied || job.state == JobState::UpToDate;
+            entry.sourceSize = current ? job.stat.size : -1; // a failed copy is retried next time
+            entry.sourceModified = current ? job.stat.modified : 0;
+            if (!entry.playlists.contains(playlist.name)) entry.playlists.append(playlist.name);
+        }
+    }
+
+    // 5. Files no synced playlist uses anymore
+    for (auto it = m_manifest.begin(); it != m_manifest.end();) {
+        if (!it->playlists.isEmpty()) {
+            ++it;
+            continue;
+        }
+        removeTarget(it->target);
+        ++result.removed;
+        it = m_manifest.erase(it);
+    }
+
+    // 6. M3U8 playlists next to Music/, paths relative to them
+    for (const Playlist &playlist : playlists) {
+        QByteArray content = "#EXTM3U\n#PLAYLIST:" + playlist.name.toUtf8() + '\n';
+        for (const QString &source : playlist.tracks) {
+            const Job &job = jobs.at(jobOf.value(source));
+            const bool onDevice = job.state == JobState::Copied || job.state == JobState::UpToDate
+                                  || (job.state == JobState::Missing && m_manifest.contains(source));
+            if (onDevice) content += job.target.toUtf8() + '\n';
+        }
+        const QString fileName = safeFileName(playlist.name) + QStringLiteral(".m3u8");
+        QString error;
+        if (writePlaylistFile(fileName, content, &error)) {
+            result.playlistFiles << fileName;
+        } else if (result.errors.size() < MaxReportedErrors) {
+            result.errors << error;
+        }
+    }
+
+    if (!saveManifest()) result.errors << "Cannot write " + manifestFilePath();
+    result.elapsedMs = timer.elapsed();
+    qCDebug(lcPlaylist) << "[PlaylistSync] Synced" << result.tracks << "tracks to" << m_targetDir << "in"
+                        << result.elapsedMs << "ms:" << result.copied << "copied (" << result.cloned << "cloned),"
+                        << result.upToDate << "up to date," << result.removed << "removed," << result.missing
+                        << "missing," << result.failed << "failed";
+    for (const QString &error : std::as_const(result.errors)) qCWarning(lcPlaylist) << "[PlaylistSync]" << error;
+    return result;
+}
+
+//=============================================================================
+// FUNCTION: Copy one file (any thread)
+//=============================================================================
+bool PlaylistSync::copyFile(const QString &source, const QString &target, CopyMethod *method, QString *error) {
+    const QString directory = QFileInfo(target).absolutePath();
+    if (!QDir().mkpath(directory)) {
+        if (error) *error = "Cannot create " + directory;
+        return false;
+    }
+    const QString partial = target + PartialSuffix;
+#ifdef Q_OS_LINUX
+    const int in = ::open(QFile::encodeName(source).constData(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        if (error) *error = qt_error_string(errno);
+        return false;
+    }
+    struct stat sourceStat;
+    const int out = ::fstat(in, &sourceStat) == 0
+                        ? ::open(QFile::encodeName(partial).constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)
+                        : -1;
+    if (out < 0) {
+        if (error) *error = qt_error_string(errno);
+        ::close(in);
+        return false;
+    }
+
+    bool copied = false;
+#ifdef FICLONE
+    if (::ioctl(out, FICLONE, in) == 0) { // shares the extents: copy-on-write filesystems only
+        copied = true;
+        *method = CopyMethod::Clone;
+    }
+#endif
+    if (!copied) {
+        // In-kernel copy; EXDEV/EOPNOTSUPP across most filesystem pairs, then streamed instead
+        off_t remaining = sourceStat.st_size;
+        bool kernel = true;
+        while (remaining > 0) {
+            const ssize_t n = ::copy_file_range(in, nullptr, out, nullptr, size_t(remaining), 0);
+            if (n < 0 && errno == EINTR) continue;
+            // Some FUSE/MTP mounts report 0 on the first call instead of failing
+            if (n < 0 || (n == 0 && remaining == sourceStat.st_size)) {
+                kernel = false;
+                break;
+            }
+            if (n == 0) break; // source shrank while copying, caught by the size check below
+            remaining -= n;
+        }
+        if (kernel) {
+            copied = true;
+            *method = CopyMethod::Kernel;
+        } else if (::lseek(in, 0, SEEK_SET) == 0 && ::lseek(out, 0, SEEK_SET) == 0 && ::ftruncate(out, 0) == 0) {
+            copied = streamCopy(in, out);
+            *method = CopyMethod::Stream;
+        }
+    }
+    struct stat targetStat;
+    if (copied && (::fstat(out, &targetStat) != 0 || targetStat.st_size != sourceStat.st_size)) {
+        copied = false;
+        errno = EIO; // short copy: never put a truncated track under its real name
+    }
+    if (copied) {
+        const struct timespec times[2] = {{0, UTIME_OMIT}, sourceStat.st_mtim}; // keep the source's mtime
+        ::futimens(out, times);
+    }
+    const int savedErrno = errno;
+    copied = ::close(out) == 0 && copied;
+    ::close(in);
+    if (copied && ::rename(QFile::encodeName(partial).constData(), QFile::encodeName(target).constData()) == 0) return true;
+    if (error) *error = qt_error_string(copied ? errno : savedErrno);
+    QFile::remove(partial);
+    return false;
+#else
+    QFile in(source);
+    QFile out(partial);
+    if (!in.open(QIODevice::ReadOnly) || !out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = in.isOpen() ? out.errorString() : in.errorString();
+        return false;
+    }
+    while (!in.atEnd()) {
+        const QByteArray chunk = in.read(StreamChunkBytes);
+        if (chunk.isEmpty() || out.write(chunk) != chunk.size()) {
+            if (error) *error = out.errorString();
+            out.close();
+            QFile::remove(partial);
+            return false;
+        }
+    }
+    *method = CopyMethod::Stream;
+    out.setFileTime(QFileInfo(source).lastModified(), QFileDevice::FileModificationTime);
+    out.close();
+    QFile::remove(target);
+    if (QFile::rename(partial, target)) return true;
+    if (error) *error = "Cannot rename " + partial;
+    QFile::remove(partial);
+    return false;
+#endif
+}
+
+//=============================================================================
+// HELPER: Target folder files
+//=============================================================================
+bool PlaylistSync::writePlaylistFile(const QString &relativePath, const QByteArray &content, QString *error) const {
+    const QString filePath = m_targetDir + '/' + relativePath;
+    QFile existing(filePath);
+    if (existing.open(QIODevice::ReadOnly) && existing.size() == content.size() && existing.readAll() == content) return true;
+    existing.close();
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size() || !file.commit()) {
+        if (error) *error = "Cannot write " + filePath + ": " + file.errorString();
+        return false;
+    }
+    return true;
+}
+
+// Deletes the file and every directory it leaves empty, up to the target folder
+void PlaylistSync::removeTarget(const QString &relativePath) const {
+    if (!isSafeTarget(relativePath)) return;
+    const QString filePath = m_targetDir + '/' + relativePath;
+    QFile::remove(filePath);
+    QFile::remove(filePath + PartialSuffix);
+    QString directory = QFileInfo(filePath).absolutePath();
+    while (directory.startsWith(m_targetDir + '/') && QDir().rmdir(directory)) {
+        directory = QFileInfo(directory).absolutePath();
+    }
+}
+
+//=============================================================================
+// Persistence
+//=============================================================================
+void PlaylistSync::loadManifest() {
+    m_manifest.clear();
+    QFile file(manifestFilePath());
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != ManifestMagic || version != ManifestVersion || count < 0) {
+        qCWarning(lcPlaylist) << "[PlaylistSync] Ignoring incompatible manifest:" << file.fileName();
+        return;
+    }
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString source;
+        ManifestEntry entry;
+        in >> source >> entry.target >> entry.sourceSize >> entry.sourceModified >> entry.playlists;
+        if (!isSafeTarget(entry.target)) {
+            qCWarning(lcPlaylist) << "[PlaylistSync] Ignoring manifest entry outside Music/:" << entry.target;
+            continue;
+        }
+        m_manifest.insert(source, entry);
+    }
+}
+
+bool PlaylistSync::saveManifest() const {
+    QSaveFile file(manifestFilePath());
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    QDataStream out(&file);
+    out << ManifestMagic << ManifestVersion << static_cast<qint32>(m_manifest.size());
+    for (auto it = m_manifest.cbegin(); it != m_manifest.cend(); ++it) {
+        out << it.key() << it->target << it->sourceSize << it->sourceModified << it->playlists;
+    }
+    return file.commit();
+}
@@ -0,0 +1,194 @@
+// ScanQuarantine.cpp
+#include "ScanQuarantine.h"
+#include "LogCategories.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+constexpr quint32 QuarantineMagic = 0x4C535131; // "LSQ1"
+constexpr qint32 QuarantineVersion = 1;
+constexpr quint8 JournalBegin = 1;
+constexpr quint8 JournalEnd = 0;
+}
+
+ScanQuarantine::ScanQuarantine() = default;
+
+void ScanQuarantine::setFilePath(const QString &filePath) { m_filePath = filePath; }
+
+QString ScanQuarantine::quarantineFilePath() const {
+    if (!m_filePath.isEmpty()) {
+        QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+        return m_filePath;
+    }
+    QString base = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(base);
+    return base + "/scan-quarantine.dat";
+}
+
+QString ScanQuarantine::journalFilePath() const {
+    return quarantineFilePath() + QStringLiteral(".reading");
+}
+
+//=============================================================================
+// Lookups / updates (any thread)
+//=============================================================================
+ScanQuarantine::Verdict ScanQuarantine::check(const QString &filePath, const LibraryIndex::FileStat &stat) const {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.constFind(filePath);
+    if (it == m_entries.constEnd() || it->size != stat.size || it->modified != stat.modified) return Verdict::None;
+    const bool isolate = it->reason == QLatin1String("slow") || it->reason == QLatin1String("interrupted");
+    return isolate ? Verdict::Isolate : Verdict::Skip;
+}
+
+void ScanQuarantine::add(const QString &filePath, const LibraryIndex::FileStat &stat, const QString &reason) {
+    QMutexLocker locker(&m_mutex);
+    m_entries.insert(filePath, {stat.size, stat.modified, reason, QDateTime::currentDateTimeUtc()});
+    m_dirty = true;
+    qCWarning(lcScan) << "[ScanQuarantine] Quarantined" << filePath << "(" << reason << ")";
+}
+
+void ScanQuarantine::prune(const QStringList &rootPaths, const QSet<QString> &scannedPaths) {
+    QMutexLocker locker(&m_mutex);
+    const auto belowRoot = [&rootPaths](const QString &filePath) {
+        return std::any_of(rootPaths.cbegin(), rootPaths.cend(), [&filePath](const QString &root) {
+            return filePath.startsWith(root.endsWith('/') ? root : root + '/');
+        });
+    };
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (!scannedPaths.contains(it.key()) && belowRoot(it.key())) {
+            it = m_entries.erase(it);
+            m_dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+int ScanQuarantine::count() const {
+    QMutexLocker locker(&m_mutex);
+    return int(m_entries.size());
+}
+
+//=============================================================================
+// In-process read journal (any thread)
+//=============================================================================
+void ScanQuarantine::beginRead(const QString &filePath, const LibraryIndex::FileStat &stat) {
+    appendToJournal(true, filePath, stat);
+}
+
+void ScanQuarantine::endRead(const QString &filePath) {
+    appendToJournal(false, filePath, {});
+}
+
+// One unbuffered write per record, so it is in the kernel before TagLib runs
+void ScanQuarantine::appendToJournal(bool begin, const QString &filePath, const LibraryIndex::FileStat &stat) {
+    QByteArray record;
+    {
+        QDataStream out(&record, QIODevice::WriteOnly);
+        out << (begin ? JournalBegin : JournalEnd) << filePath;
+        if (begin) out << stat.size << stat.modified;
+    }
+    QMutexLocker locker(&m_journalMutex);
+    m_readsInFlight += begin ? 1 : -1;
+    if (!m_journal.isOpen()) {
+        m_journal.setFileName(journalFilePath());
+        if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered)) return;
+    }
+    m_journal.write(record);
+}
+
+bool ScanQuarantine::recoverJournal() {
+    QFile file(journalFilePath());
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QHash<QString, LibraryIndex::FileStat> open;
+    QDataStream in(&file);
+    while (!in.atEnd()) {
+        quint8 kind = 0;
+        QString filePath;
+        LibraryIndex::FileStat stat;
+        in >> kind >> filePath;
+        if (kind == JournalBegin) in >> stat.size >> stat.modified;
+        if (in.status() != QDataStream::Ok) break; // torn last record
+        if (kind == JournalBegin) open.insert(filePath, stat);
+        else open.remove(filePath);
+    }
+    file.close();
+    file.remove();
+
+    QMutexLocker locker(&m_mutex);
+    for (auto it = open.cbegin(); it != open.cend(); ++it) {
+        auto existing = m_entries.find(it.key());
+        const bool known = existing != m_entries.end() && existing->size == it->size && existing->modified == it->modified;
+        if (known && existing->reason != QLatin1String("interrupted")) continue; // already isolated or skipped
+        const QString reason = known ? QStringLiteral("crash") : QStringLiteral("interrupted");
+        m_entries.insert(it.key(), {it->size, it->modified, reason, QDateTime::currentDateTimeUtc()});
+        qCWarning(lcScan) << "[ScanQuarantine] Tag read of" << it.key() << "did not finish last time (" << reason << ")";
+    }
+    if (!open.isEmpty()) m_dirty = true;
+    return !open.isEmpty();
+}
+
+//=============================================================================
+// Persistence
+//=============================================================================
+void ScanQuarantine::load() {
+    QFile file(quarantineFilePath());
+    if (file.open(QIODevice::ReadOnly)) {
+        QDataStream in(&file);
+        quint32 magic = 0;
+        qint32 version = 0;
+        qint32 count = 0;
+        in >> magic >> version >> count;
+        if (magic != QuarantineMagic || version != QuarantineVersion || count < 0) {
+            qWarning() << "[ScanQuarantine] Ignoring incompatible quarantine file:" << file.fileName();
+        } else {
+            QMutexLocker locker(&m_mutex);
+            m_entries.clear();
+            for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+                QString filePath;
+                Entry entry;
+                in >> filePath >> entry.size >> entry.modified >> entry.reason >> entry.time;
+                m_entries.insert(filePath, entry);
+            }
+            m_dirty = false;
+            qCDebug(lcScan) << "[ScanQuarantine] Loaded" << m_entries.size() << "quarantined files.";
+        }
+    }
+    // Saved right away: the same file may crash this run before the next save()
+    if (recoverJournal()) save();
+}
+
+// Only writes when something changed since load()/the last save(); drops the
+// read journal once no read is in flight
+bool ScanQuarantine::save() const {
+    {
+        QMutexLocker journalLocker(&m_journalMutex);
+        if (m_readsInFlight == 0 && m_journal.isOpen()) {
+            m_journal.close();
+            m_journal.remove();
+        }
+    }
+    QMutexLocker locker(&m_mutex);
+    if (!m_dirty) return true;
+    QSaveFile file(quarantineFilePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[ScanQuarantine] Failed to write quarantine file:" << file.fileName();
+        return false;
+    }
+    QDataStream out(&file);
+    out << QuarantineMagic << QuarantineVersion << static_cast<qint32>(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        out << it.key() << it->size << it->modified << it->reason << it->time;
+    }
+    if (!file.commit()) return false;
+    m_dirty = false;
+    return true;
+}
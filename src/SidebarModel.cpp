@@ -0,0 +1,178 @@
+// SidebarModel.cpp
+#include "SidebarModel.h"
+#include "FrameTimeMonitor.h"
+#include "Trace.h"
+
+#include <QSet>
+#include <algorithm>
+
+SidebarModel::SidebarModel(QObject *parent) : QAbstractListModel(parent) {}
+
+int SidebarModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : int(m_items.size());
+}
+
+QVariant SidebarModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_items.size()) return QVariant();
+    const Item &item = m_items.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole: return item.name;
+    case TypeRole: return item.type;
+    case ItemIdRole: return item.id;
+    case IconSourceRole: return item.iconSource;
+    case CountRole: return item.count;
+    case DepthRole: return item.depth;
+    case HasChildrenRole: return item.hasChildren;
+    case ExpandedRole: return item.expanded;
+    default: return QVariant();
+    }
+}
+
+// "id" is reserved in QML, so the id role is exposed as "itemId"
+QHash<int, QByteArray> SidebarModel::roleNames() const {
+    return {
+        {TypeRole, "type"},
+        {NameRole, "name"},
+        {ItemIdRole, "itemId"},
+        {IconSourceRole, "iconSource"},
+        {CountRole, "count"},
+        {DepthRole, "depth"},
+        {HasChildrenRole, "hasChildren"},
+        {ExpandedRole, "expanded"},
+    };
+}
+
+QVariantMap SidebarModel::get(int row) const {
+    if (row < 0 || row >= m_items.size()) return QVariantMap();
+    const Item &item = m_items.at(row);
+    return {
+        {"type", item.type},
+        {"name", item.name},
+        {"id", item.id},
+        {"iconSource", item.iconSource},
+        {"count", item.count},
+        {"depth", item.depth},
+        {"hasChildren", item.hasChildren},
+        {"expanded", item.expanded},
+    };
+}
+
+int SidebarModel::indexOf(const QString &type, const QString &id) const {
+    for (int row = 0; row < m_items.size(); ++row) {
+        if (m_items.at(row).type == type && m_items.at(row).id == id) return row;
+    }
+    return -1;
+}
+
+QVariantList SidebarModel::toVariantList() const {
+    QVariantList list;
+    list.reserve(m_items.size());
+    for (int row = 0; row < m_items.size(); ++row) list.append(get(row));
+    return list;
+}
+
+qint64 SidebarModel::memoryUsage() const {
+    qint64 bytes = qint64(m_items.capacity()) * qint64(sizeof(Item));
+    for (const Item &item : m_items) {
+        bytes += (item.type.capacity() + item.name.capacity() + item.id.capacity()
+                  + item.iconSource.capacity()) * qint64(sizeof(QChar));
+    }
+    return bytes;
+}
+
+QString SidebarModel::keyOf(const Item &item) {
+    return item.type + QChar(0x1F) + item.id;
+}
+
+//=============================================================================
+// FUNCTION: Applies the difference between the current and the new rows
+//=============================================================================
+void SidebarModel::setItems(const QList<Item> &items) {
+    Trace::Span span("qml", "sidebarDiff");
+    span.setArg(items.size());
+    const int oldCount = count();
+
+    // The diff needs every key once on each side; anything else is reset
+    QSet<QString> newKeys;
+    newKeys.reserve(items.size());
+    for (const Item &item : items) newKeys.insert(keyOf(item));
+    QSet<QString> oldKeys;
+    oldKeys.reserve(m_items.size());
+    for (const Item &item : std::as_const(m_items)) oldKeys.insert(keyOf(item));
+    if (newKeys.size() != items.size() || oldKeys.size() != m_items.size()) {
+        resetItems(items);
+        return;
+    }
+
+    // 1. Drop rows that are gone, last to first, one signal per contiguous run
+    for (int row = int(m_items.size()) - 1; row >= 0;) {
+        if (newKeys.contains(keyOf(m_items.at(row)))) { --row; continue; }
+        int first = row;
+        while (first > 0 && !newKeys.contains(keyOf(m_items.at(first - 1)))) --first;
+        beginRemoveRows(QModelIndex(), first, row);
+        m_items.remove(first, row - first + 1);
+        endRemoveRows();
+        row = first - 1;
+    }
+
+    // 2. Walk the new order: keep (maybe update), move up, or insert runs of new rows
+    QSet<QString> currentKeys;
+    currentKeys.reserve(m_items.size());
+    for (const Item &item : std::as_const(m_items)) currentKeys.insert(keyOf(item));
+    for (int i = 0; i < items.size();) {
+        const QString key = keyOf(items.at(i));
+        if (i < m_items.size() && keyOf(m_items.at(i)) == key) {
+            if (!(m_items.at(i) == items.at(i))) {
+                m_items[i] = items.at(i);
+                emit dataChanged(index(i), index(i));
+            }
+            ++i;
+            continue;
+        }
+        if (currentKeys.contains(key)) {
+            int from = i + 1;
+            while (from < m_items.size() && keyOf(m_items.at(from)) != key) ++from;
+            Q_ASSERT(from < m_items.size()); // keys are unique and rows before i are final
+            if (from == m_items.size()) {
+                resetItems(items);
+                break;
+            }
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), i);
+            m_items.move(from, i);
+            endMoveRows();
+            continue; // row i now has the key; updated on the next pass
+        }
+        int last = i;
+        while (last + 1 < items.size() && !currentKeys.contains(keyOf(items.at(last + 1)))) ++last;
+        beginInsertRows(QModelIndex(), i, last);
+        m_items.insert(i, last - i + 1, Item());
+        std::copy(items.cbegin() + i, items.cbegin() + last + 1, m_items.begin() + i);
+        endInsertRows();
+        i = last + 1;
+    }
+
+    if (count() != oldCount) emit countChanged();
+}
+
+void SidebarModel::resetItems(const QList<Item> &items) {
+    const int oldCount = count();
+    FrameTimeMonitor::noteModelReset();
+    beginResetModel();
+    m_items = items;
+    endResetModel();
+    if (count() != oldCount) emit countChanged();
+}
+
+bool SidebarModel::updateItem(const Item &item) {
+    const QString key = keyOf(item);
+    for (int row = 0; row < m_items.size(); ++row) {
+        if (keyOf(m_items.at(row)) != key) continue;
+        if (!(m_items.at(row) == item)) {
+            m_items[row] = item;
+            emit dataChanged(index(row), index(row));
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,180 @@
+// SpectrumAnalyzer.cpp
+#include "SpectrumAnalyzer.h"
+#include "LogCategories.h"
+
+#include <QAudioFormat>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr float MinFrequency = 40.0f;
+constexpr float MaxFrequency = 16000.0f;
+constexpr float FloorDb = -72.0f;
+constexpr float DecayFactor = 0.82f; // per analysis frame, keeps bars from flickering
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(QObject *parent) : QObject(parent) {
+    m_window = Fft::hannWindow(FftSize);
+    m_history.assign(FftSize, 0.0f);
+    m_re.assign(FftSize, 0.0f);
+    m_im.assign(FftSize, 0.0f);
+
+    // Ask the backend for mono float PCM so the analysis thread never has to
+    // convert sample formats or downmix.
+    QAudioFormat format;
+    format.setSampleFormat(QAudioFormat::Float);
+    format.setChannelCount(1);
+    format.setSampleRate(44100);
+    m_bufferOutput = new QAudioBufferOutput(format, this);
+
+    m_analysisContext = new QObject;
+    m_analysisContext->moveToThread(&m_analysisThread);
+    m_analysisThread.setObjectName("SpectrumAnalyzer");
+    m_analysisThread.start(QThread::LowPriority);
+
+    // The lambda runs on m_analysisThread because of the context object's affinity.
+    // QAudioBuffer is implicitly shared, so the queued copy does not duplicate samples.
+    connect(m_bufferOutput, &QAudioBufferOutput::audioBufferReceived,
+            m_analysisContext, [this](const QAudioBuffer &buffer) { processBuffer(buffer); });
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+    if (m_mediaPlayer && m_mediaPlayer->audioBufferOutput() == m_bufferOutput) {
+        m_mediaPlayer->setAudioBufferOutput(nullptr);
+    }
+    m_analysisThread.quit();
+    m_analysisThread.wait();
+    delete m_analysisContext; // thread has finished, safe to delete directly
+}
+
+bool SpectrumAnalyzer::active() const { return m_active; }
+
+//=============================================================================
+// SLOT: Attaches the analyzer to the QML MediaPlayer
+//=============================================================================
+void SpectrumAnalyzer::setMediaPlayer(QMediaPlayer *player) {
+    if (m_mediaPlayer == player) return;
+    if (m_mediaPlayer) {
+        disconnect(m_mediaPlayer, nullptr, this, nullptr);
+        if (m_mediaPlayer->audioBufferOutput() == m_bufferOutput) {
+            m_mediaPlayer->setAudioBufferOutput(nullptr);
+        }
+    }
+    m_mediaPlayer = player;
+    if (m_mediaPlayer) {
+        // Drop the bars to zero when playback stops so the view does not freeze mid-frame
+        connect(m_mediaPlayer, &QMediaPlayer::playbackStateChanged, this, [this](QMediaPlayer::PlaybackState state) {
+            if (state == QMediaPlayer::PlayingState) return;
+            QMetaObject::invokeMethod(m_analysisContext, [this]() {
+                m_levels.fill(0.0f);
+                m_published.writeBuffer().fill(0.0f);
+                m_published.publish();
+                emit bandsPublished();
+            });
+        });
+    }
+    qCDebug(lcSpectrum) << "[SpectrumAnalyzer] MediaPlayer set:" << player;
+    attachOutput();
+}
+
+//=============================================================================
+// SLOT: Enables or disables PCM capture (zero cost while disabled)
+//=============================================================================
+void SpectrumAnalyzer::setActive(bool active) {
+    if (m_active == active) return;
+    m_active = active;
+    qCDebug(lcSpectrum) << "[SpectrumAnalyzer] Active:" << m_active;
+    attachOutput();
+    emit activeChanged();
+}
+
+void SpectrumAnalyzer::attachOutput() {
+    if (!m_mediaPlayer) return;
+    if (m_active) {
+        m_mediaPlayer->setAudioBufferOutput(m_bufferOutput);
+    } else if (m_mediaPlayer->audioBufferOutput() == m_bufferOutput) {
+        m_mediaPlayer->setAudioBufferOutput(nullptr);
+    }
+}
+
+bool SpectrumAnalyzer::takeLatestBands(Bands &bands) {
+    if (!m_published.consume()) return false;
+    bands = m_published.readBuffer();
+    return true;
+}
+
+//=============================================================================
+// ANALYSIS THREAD: Appends PCM to the history ring and analyzes once per hop
+//=============================================================================
+void SpectrumAnalyzer::processBuffer(const QAudioBuffer &buffer) {
+    const QAudioFormat format = buffer.format();
+    if (format.sampleFormat() != QAudioFormat::Float || format.channelCount() != 1) {
+        return; // we requested mono float, anything else is a backend mismatch
+    }
+    if (format.sampleRate() != m_sampleRate) {
+        rebuildBandEdges(format.sampleRate());
+    }
+
+    const float *samples = buffer.constData<float>();
+    const int frameCount = static_cast<int>(buffer.frameCount());
+
+    // Only the newest FftSize samples matter, older ones would be overwritten anyway
+    const int skip = std::max(0, frameCount - FftSize);
+    const int keep = frameCount - skip;
+    std::move(m_history.begin() + keep, m_history.end(), m_history.begin());
+    std::copy(samples + skip, samples + frameCount, m_history.end() - keep);
+
+    // At most one FFT per delivered buffer: if we fall behind we skip hops
+    // instead of queuing work, which keeps the per-frame cost fixed.
+    m_pendingSamples += frameCount;
+    if (m_pendingSamples >= HopSize) {
+        m_pendingSamples = 0;
+        analyzeWindow();
+    }
+}
+
+void SpectrumAnalyzer::analyzeWindow() {
+    for (int i = 0; i < FftSize; ++i) {
+        m_re[i] = m_history[i] * m_window[i];
+    }
+    std::fill(m_im.begin(), m_im.end(), 0.0f);
+    m_fft.transform(m_re.data(), m_im.data());
+
+    // Full-scale sine through a Hann window peaks at N/4
+    const float reference = static_cast<float>(FftSize) / 4.0f;
+    const float referencePower = reference * reference;
+
+    Bands &out = m_published.writeBuffer();
+    for (int band = 0; band < BandCount; ++band) {
+        float peakPower = 0.0f;
+        for (int bin = m_bandEdges[band]; bin < m_bandEdges[band + 1]; ++bin) {
+            peakPower = std::max(peakPower, m_re[bin] * m_re[bin] + m_im[bin] * m_im[bin]);
+        }
+        const float db = 10.0f * std::log10(peakPower / referencePower + 1e-12f);
+        const float level = std::clamp((db - FloorDb) / -FloorDb, 0.0f, 1.0f);
+        m_levels[band] = std::max(level, m_levels[band] * DecayFactor);
+        out[band] = m_levels[band];
+    }
+    m_published.publish();
+    emit bandsPublished();
+}
+
+void SpectrumAnalyzer::rebuildBandEdges(int sampleRate) {
+    m_sampleRate = sampleRate;
+    if (sampleRate <= 0) {
+        m_bandEdges.fill(0);
+        return;
+    }
+    const int nyquistBin = FftSize / 2;
+    const float maxFrequency = std::min(MaxFrequency, sampleRate / 2.0f);
+    const float ratio = maxFrequency / MinFrequency;
+    int previousEdge = 1; // skip DC
+    for (int band = 0; band <= BandCount; ++band) {
+        const float frequency = MinFrequency * std::pow(ratio, static_cast<float>(band) / BandCount);
+        int edge = static_cast<int>(frequency * FftSize / sampleRate);
+        edge = std::min(std::max(edge, band == 0 ? 1 : previousEdge + 1), nyquistBin);
+        m_bandEdges[band] = edge;
+        previousEdge = edge;
+    }
+    qCDebug(lcSpectrum) << "[SpectrumAnalyzer] Band edges rebuilt for sample rate" << sampleRate;
+}
@@ -0,0 +1,49 @@
+// SpectrumView.cpp
+#include "SpectrumView.h"
+
+#include <QPainter>
+
+SpectrumView::SpectrumView(QQuickItem *parent) : QQuickPaintedItem(parent) {
+    setAntialiasing(false);
+    setOpaquePainting(false);
+}
+
+SpectrumAnalyzer *SpectrumView::analyzer() const { return m_analyzer; }
+QColor SpectrumView::barColor() const { return m_barColor; }
+
+void SpectrumView::setAnalyzer(SpectrumAnalyzer *analyzer) {
+    if (m_analyzer == analyzer) return;
+    if (m_analyzer) disconnect(m_analyzer, nullptr, this, nullptr);
+    m_analyzer = analyzer;
+    if (m_analyzer) {
+        // bandsPublished is emitted on the analysis thread; queue it onto ours
+        connect(m_analyzer, &SpectrumAnalyzer::bandsPublished, this, [this]() { update(); }, Qt::QueuedConnection);
+    }
+    m_bands.fill(0.0f);
+    update();
+    emit analyzerChanged();
+}
+
+void SpectrumView::setBarColor(const QColor &color) {
+    if (m_barColor == color) return;
+    m_barColor = color;
+    update();
+    emit barColorChanged();
+}
+
+void SpectrumView::paint(QPainter *painter) {
+    if (m_analyzer) m_analyzer->takeLatestBands(m_bands);
+
+    const qreal w = width();
+    const qreal h = height();
+    if (w <= 0 || h <= 0) return;
+
+    const int count = SpectrumAnalyzer::BandCount;
+    const qreal slot = w / count;
+    const qreal barWidth = qMax<qreal>(1.0, slot - 1.0);
+    for (int i = 0; i < count; ++i) {
+        const qreal barHeight = m_bands[i] * h;
+        if (barHeight < 0.5) continue;
+        painter->fillRect(QRectF(i * slot, h - barHeight, barWidth, barHeight), m_barColor);
+    }
+}
@@ -0,0 +1,314 @@
+// SpotifyJsonParser.cpp
+#include "SpotifyJsonParser.h"
+
+#include <string_view>
+
+namespace {
+
+/**
+ * Minimal pull scanner over UTF-8 JSON. Members and elements are visited
+ * through callbacks which must consume exactly one value; anything not
+ * needed is skipped byte-wise. Keys are compared raw (Spotify keys never
+ * contain escapes). Any syntax error makes every call return false.
+ */
+class Scanner
+{
+public:
+    explicit Scanner(const QByteArray &data) : m_p(data.constData()), m_end(data.constData() + data.size()) {}
+
+    char peek() {
+        skipWhitespace();
+        return m_p < m_end ? *m_p : '\0';
+    }
+
+    template <typename MemberFn>
+    bool forEachMember(MemberFn &&member) {
+        if (peek() == 'n') return skipValue(); // null object
+        if (!consume('{')) return false;
+        if (consume('}')) return true;
+        do {
+            std::string_view key;
+            if (!readKey(&key) || !consume(':') || !member(key)) return false;
+        } while (consume(','));
+        return consume('}');
+    }
+
+    template <typename ElementFn>
+    bool forEachElement(ElementFn &&element) {
+        if (peek() == 'n') return skipValue(); // null array
+        if (!consume('[')) return false;
+        if (consume(']')) return true;
+        do {
+            if (!element()) return false;
+        } while (consume(','));
+        return consume(']');
+    }
+
+    bool readString(QString *out) {
+        if (peek() == 'n') return skipValue();
+        if (!consume('"')) return false;
+        const char *start = m_p;
+        while (m_p < m_end && *m_p != '"' && *m_p != '\\') ++m_p;
+        if (m_p < m_end && *m_p == '"') {
+            // Common case: no escapes, decode straight from the buffer
+            *out = QString::fromUtf8(start, m_p - start);
+            ++m_p;
+            return true;
+        }
+        QByteArray decoded(start, m_p - start);
+        while (m_p < m_end && *m_p != '"') {
+            if (*m_p != '\\') {
+                decoded.append(*m_p++);
+                continue;
+            }
+            if (++m_p >= m_end) return false;
+            switch (*m_p++) {
+            case '"': decoded.append('"'); break;
+            case '\\': decoded.append('\\'); break;
+            case '/': decoded.append('/'); break;
+            case 'b': decoded.append('\b'); break;
+            case 'f': decoded.append('\f'); break;
+            case 'n': decoded.append('\n'); break;
+            case 'r': decoded.append('\r'); break;
+            case 't': decoded.append('\t'); break;
+            case 'u': {
+                char32_t codePoint = 0;
+                if (!readHex4(&codePoint)) return false;
+                if (codePoint >= 0xD800 && codePoint < 0xE000) {
+                    // Only a high surrogate directly followed by a low one is a character
+                    char32_t low = 0;
+                    if (codePoint < 0xDC00 && readLowSurrogate(&low)) {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    } else {
+                        codePoint = 0xFFFD;
+                    }
+                }
+                decoded.append(QString::fromUcs4(&codePoint, 1).toUtf8());
+                break;
+            }
+            default: return false;
+            }
+        }
+        if (m_p >= m_end) return false;
+        ++m_p;
+        *out = QString::fromUtf8(decoded);
+        return true;
+    }
+
+    bool readInteger(qint64 *out) {
+        skipWhitespace();
+        const bool negative = m_p < m_end && *m_p == '-';
+        if (negative) ++m_p;
+        qint64 value = 0;
+        const char *digits = m_p;
+        while (m_p < m_end && *m_p >= '0' && *m_p <= '9') value = value * 10 + (*m_p++ - '0');
+        if (m_p == digits) return skipValue(); // null
+        while (m_p < m_end && (*m_p == '.' || *m_p == 'e' || *m_p == 'E' || *m_p == '+' || *m_p == '-'
+                               || (*m_p >= '0' && *m_p <= '9'))) {
+            ++m_p; // fractional part is not needed
+        }
+        *out = negative ? -value : value;
+        return true;
+    }
+
+    bool readBool(bool *out) {
+        if (peek() == 't') *out = true;
+        else if (peek() == 'f') *out = false;
+        return skipValue();
+    }
+
+    bool skipValue() {
+        switch (peek()) {
+        case '"':
+            return skipString();
+        case '{':
+        case '[': {
+            int depth = 0;
+            while (m_p < m_end) {
+                const char c = *m_p;
+                if (c == '"') {
+                    if (!skipString()) return false;
+                    continue;
+                }
+                ++m_p;
+                if (c == '{' || c == '[') ++depth;
+                else if ((c == '}' || c == ']') && --depth == 0) return true;
+            }
+            return false;
+        }
+        case '\0':
+            return false;
+        default: {
+            // number, true, false, null
+            const char *start = m_p;
+            while (m_p < m_end && *m_p != ',' && *m_p != '}' && *m_p != ']' && !isWhitespace(*m_p)) ++m_p;
+            return m_p > start;
+        }
+        }
+    }
+
+private:
+    static bool isWhitespace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+    void skipWhitespace() {
+        while (m_p < m_end && isWhitespace(*m_p)) ++m_p;
+    }
+
+    bool consume(char c) {
+        if (peek() != c) return false;
+        ++m_p;
+        return true;
+    }
+
+    bool skipString() {
+        if (!consume('"')) return false;
+        while (m_p < m_end) {
+            if (*m_p == '\\') m_p += 2;
+            else if (*m_p++ == '"') return true;
+        }
+        return false;
+    }
+
+    bool readKey(std::string_view *key) {
+        if (!consume('"')) return false;
+        const char *start = m_p;
+        while (m_p < m_end && *m_p != '"') m_p += *m_p == '\\' ? 2 : 1;
+        if (m_p >= m_end) return false;
+        *key = std::string_view(start, static_cast<size_t>(m_p - start));
+        ++m_p;
+        return true;
+    }
+
+    bool readHex4(char32_t *out) {
+        if (m_end - m_p < 4) return false;
+        char32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = *m_p++;
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return false;
+        }
+        *out = value;
+        return true;
+    }
+
+    // A \uDC00-\uDFFF escape at the current position; the position is kept otherwise
+    bool readLowSurrogate(char32_t *out) {
+        const char *start = m_p;
+        if (m_end - m_p >= 6 && m_p[0] == '\\' && m_p[1] == 'u') {
+            m_p += 2;
+            if (readHex4(out) && *out >= 0xDC00 && *out < 0xE000) return true;
+        }
+        m_p = start;
+        return false;
+    }
+
+    const char *m_p;
+    const char *m_end;
+};
+
+bool parseTrackMember(Scanner &s, std::string_view key, SpotifyTrack &track) {
+    if (key == "id") return s.readString(&track.id);
+    if (key == "uri") return s.readString(&track.uri);
+    if (key == "name") return s.readString(&track.title);
+    if (key == "duration_ms") return s.readInteger(&track.durationMs);
+    if (key == "is_local") return s.readBool(&track.isLocal);
+    if (key == "artists") {
+        return s.forEachElement([&]() {
+            QString name;
+            const bool ok = s.forEachMember([&](std::string_view k) {
+                return k == "name" ? s.readString(&name) : s.skipValue();
+            });
+            if (!name.isEmpty()) track.artists.append(name);
+            return ok;
+        });
+    }
+    if (key == "album") {
+        return s.forEachMember([&](std::string_view k) {
+            if (k == "name") return s.readString(&track.album);
+            if (k != "images") return s.skipValue();
+            return s.forEachElement([&]() {
+                return s.forEachMember([&](std::string_view imageKey) {
+                    return imageKey == "url" && track.imageUrl.isEmpty() ? s.readString(&track.imageUrl) : s.skipValue();
+                });
+            });
+        });
+    }
+    if (key == "external_ids") {
+        return s.forEachMember([&](std::string_view k) { return k == "isrc" ? s.readString(&track.isrc) : s.skipValue(); });
+    }
+    return s.skipValue();
+}
+
+} // namespace
+
+//=============================================================================
+// SpotifyTrack
+//=============================================================================
+QVariantMap SpotifyTrack::toVariantMap() const {
+    QVariantMap map;
+    map.insert("title", title);
+    map.insert("artist", artists.join(", "));
+    map.insert("album", album);
+    map.insert("duration", durationMs);
+    map.insert("spotifyId", id);
+    map.insert("spotifyUri", uri);
+    map.insert("imageUrl", imageUrl);
+    if (!isrc.isEmpty()) map.insert("isrc", isrc);
+    if (isLocal) map.insert("isLocal", true);
+    return map;
+}
+
+//=============================================================================
+// FUNCTION: Paging metadata
+//=============================================================================
+SpotifyJsonParser::PageInfo SpotifyJsonParser::pageInfo(const QByteArray &body) {
+    PageInfo info;
+    Scanner s(body);
+    qint64 value = 0;
+    s.forEachMember([&](std::string_view key) {
+        if (key == "total" && s.readInteger(&value)) info.total = int(value);
+        else if (key == "limit" && s.readInteger(&value)) info.limit = int(value);
+        else if (key == "offset" && s.readInteger(&value)) info.offset = int(value);
+        else return s.skipValue();
+        return true;
+    });
+    return info;
+}
+
+//=============================================================================
+// FUNCTION: Track records of one page
+//=============================================================================
+std::vector<SpotifyTrack> SpotifyJsonParser::parseTrackRecords(const QByteArray &body, bool *ok) {
+    std::vector<SpotifyTrack> tracks;
+    Scanner s(body);
+    const bool parsed = s.forEachMember([&](std::string_view key) {
+        if (key != "items") return s.skipValue();
+        return s.forEachElement([&]() {
+            SpotifyTrack track;
+            // Playlist/saved-track items wrap the track; album tracks are bare.
+            // Inside a track object "track" is a boolean and simply skipped.
+            const bool itemParsed = s.forEachMember([&](std::string_view itemKey) {
+                if (itemKey == "track" && s.peek() == '{') {
+                    return s.forEachMember([&](std::string_view k) { return parseTrackMember(s, k, track); });
+                }
+                return parseTrackMember(s, itemKey, track);
+            });
+            // Removed/unavailable entries come as "track": null
+            if (itemParsed && !track.title.isEmpty()) tracks.push_back(std::move(track));
+            return itemParsed;
+        });
+    });
+    if (ok) *ok = parsed;
+    return tracks;
+}
+
+QVariantList SpotifyJsonParser::parseTracks(const QByteArray &body, bool *ok) {
+    const std::vector<SpotifyTrack> records = parseTrackRecords(body, ok);
+    QVariantList tracks;
+    tracks.reserve(static_cast<qsizetype>(records.size()));
+    for (const SpotifyTrack &record : records) tracks.append(record.toVariantMap());
+    return tracks;
+}
@@ -0,0 +1,210 @@
+// SpotifyPager.cpp
+#include "SpotifyPager.h"
+#include "SpotifyJsonParser.h"
+#include "SpotifyResponseCache.h"
+
+#include <QDataStream>
+#include <QNetworkRequest>
+#include <QUrlQuery>
+#include <QtConcurrent>
+#include <QDebug>
+#include <utility>
+
+//=============================================================================
+// Constructor / Destructor
+//=============================================================================
+SpotifyPager::SpotifyPager(SpotifyRequestScheduler *scheduler, QObject *parent)
+    : QObject(parent), m_scheduler(scheduler), m_parser(&SpotifyJsonParser::parseTracks) {}
+
+SpotifyPager::~SpotifyPager() {
+    abort();
+}
+
+void SpotifyPager::setPriority(SpotifyRequestScheduler::Priority priority) { m_priority = priority; }
+
+void SpotifyPager::setMaxConcurrentRequests(int count) { m_maxConcurrent = qMax(1, count); }
+
+void SpotifyPager::setParser(Parser parser) {
+    if (parser) m_parser = std::move(parser);
+}
+
+void SpotifyPager::setSnapshot(const QString &playlistId, const QString &snapshotId) {
+    m_playlistId = playlistId;
+    m_snapshotId = snapshotId;
+}
+
+//=============================================================================
+// SLOT: Starts a new paginated fetch
+//=============================================================================
+void SpotifyPager::start(const QUrl &firstPageUrl) {
+    abort();
+    ++m_generation;
+    m_running = true;
+    m_baseUrl = firstPageUrl;
+    const QUrlQuery query(firstPageUrl);
+    m_firstOffset = query.queryItemValue("offset").toInt();
+    m_limit = query.queryItemValue("limit").toInt(); // 0: learned from the first page
+    m_total = -1;
+    m_pageCount = 1;
+    m_nextPageToRequest = 1;
+    m_nextPageToEmit = 0;
+    m_emittedItems = 0;
+    m_completedPages.clear();
+    m_snapshotItems.clear();
+    if (replaySnapshot()) return;
+    qDebug() << "[SpotifyPager] Fetching" << firstPageUrl.toString(QUrl::RemoveQuery);
+    requestPage(0);
+}
+
+void SpotifyPager::abort() {
+    ++m_generation;
+    m_running = false;
+    // Abandoned responses never report back; coalesced copies other callers share keep going
+    const QList<SpotifyResponse *> responses = std::exchange(m_inFlight, {});
+    for (SpotifyResponse *response : responses) response->abandon();
+}
+
+//=============================================================================
+// Requests
+//=============================================================================
+QUrl SpotifyPager::urlForPage(int page) const {
+    if (page == 0) return m_baseUrl;
+    QUrl url(m_baseUrl);
+    QUrlQuery query(url);
+    query.removeAllQueryItems("offset");
+    query.removeAllQueryItems("limit");
+    query.addQueryItem("offset", QString::number(m_firstOffset + page * m_limit));
+    query.addQueryItem("limit", QString::number(m_limit));
+    url.setQuery(query);
+    return url;
+}
+
+void SpotifyPager::requestPage(int page) {
+    SpotifyResponse *response = m_scheduler->get(QNetworkRequest(urlForPage(page)), m_priority);
+    m_inFlight.append(response);
+    const quint64 generation = m_generation;
+    connect(response, &SpotifyResponse::finished, this, [this, response, page, generation]() {
+        handleResponse(response, page, generation);
+    });
+}
+
+void SpotifyPager::issuePendingRequests() {
+    while (m_inFlight.size() < m_maxConcurrent && m_nextPageToRequest < m_pageCount) {
+        requestPage(m_nextPageToRequest++);
+    }
+}
+
+//=============================================================================
+// Replies
+//=============================================================================
+void SpotifyPager::handleResponse(SpotifyResponse *response, int page, quint64 generation) {
+    m_inFlight.removeOne(response);
+    if (generation != m_generation || !m_running) return;
+
+    // Retries and rate limiting already happened in the scheduler; an error here is final
+    if (!response->isSuccess()) {
+        fail(QString("Page %1 failed (HTTP %2): %3").arg(page).arg(response->statusCode()).arg(response->errorString()));
+        return;
+    }
+
+    // Parsing a full page takes milliseconds; keep it off the GUI thread
+    const Parser parser = m_parser;
+    const QByteArray body = response->body();
+    QtConcurrent::run([parser, body, page]() {
+        ParsedPage parsed;
+        if (page == 0) parsed.info = SpotifyJsonParser::pageInfo(body);
+        parsed.items = parser(body, &parsed.ok);
+        return parsed;
+    }).then(this, [this, page, generation](QFuture<ParsedPage> future) {
+        handleParsedPage(page, future.takeResult(), generation);
+    });
+}
+
+void SpotifyPager::handleParsedPage(int page, ParsedPage parsed, quint64 generation) {
+    if (generation != m_generation || !m_running) return;
+
+    // A 200 with a truncated or garbled body; the scheduler only retries transport errors
+    if (!parsed.ok || (page == 0 && !parsed.info.isValid())) {
+        fail(QString("Page %1 is not a valid paging object").arg(page));
+        return;
+    }
+
+    if (page == 0) {
+        // The first page tells how many requests are needed in total
+        m_total = qMax(0, parsed.info.total);
+        if (parsed.info.limit > 0) m_limit = parsed.info.limit;
+        const int remaining = qMax(0, m_total - m_firstOffset);
+        m_pageCount = m_limit > 0 ? qMax(1, (remaining + m_limit - 1) / m_limit) : 1;
+        qDebug() << "[SpotifyPager]" << m_total << "items in" << m_pageCount << "pages of" << m_limit;
+    }
+
+    m_completedPages.insert(page, std::move(parsed.items));
+    emitContiguousPages();
+    if (m_nextPageToEmit >= m_pageCount) {
+        m_running = false;
+        SpotifyResponseCache *cache = m_scheduler->cache();
+        if (cache && !m_snapshotId.isEmpty()) {
+            QByteArray payload;
+            QDataStream out(&payload, QIODevice::WriteOnly);
+            out << m_snapshotItems;
+            cache->storeSnapshot(m_playlistId, m_snapshotId, payload);
+        }
+        m_snapshotItems.clear();
+        m_playlistId.clear();
+        m_snapshotId.clear();
+        emit finished(m_emittedItems);
+        return;
+    }
+    issuePendingRequests();
+}
+
+void SpotifyPager::emitContiguousPages() {
+    // Pages may finish out of order; only release the run that directly follows what was emitted
+    QVariantList batch;
+    const int firstIndex = m_emittedItems;
+    while (m_completedPages.contains(m_nextPageToEmit)) {
+        batch.append(m_completedPages.take(m_nextPageToEmit));
+        ++m_nextPageToEmit;
+    }
+    if (batch.isEmpty()) return;
+    m_emittedItems += batch.size();
+    if (!m_snapshotId.isEmpty()) m_snapshotItems.append(batch);
+    emit itemsReady(batch, firstIndex);
+    emit progress(m_emittedItems, qMax(m_emittedItems, m_total - m_firstOffset));
+}
+
+bool SpotifyPager::replaySnapshot() {
+    SpotifyResponseCache *cache = m_scheduler->cache();
+    if (!cache || m_snapshotId.isEmpty()) return false;
+    const QByteArray payload = cache->snapshotPayload(m_playlistId, m_snapshotId);
+    if (payload.isEmpty()) return false;
+
+    QVariantList items;
+    QDataStream in(payload);
+    in >> items;
+    if (in.status() != QDataStream::Ok) return false;
+
+    qDebug() << "[SpotifyPager] Snapshot" << m_snapshotId << "unchanged," << items.size() << "items from cache";
+    m_playlistId.clear();
+    m_snapshotId.clear();
+    // Queued so the result arrives like a fetched one, after start() returned
+    const quint64 generation = m_generation;
+    QMetaObject::invokeMethod(this, [this, items, generation]() {
+        if (generation != m_generation || !m_running) return;
+        m_running = false;
+        m_total = m_firstOffset + items.size();
+        m_emittedItems = items.size();
+        if (!items.isEmpty()) emit itemsReady(items, 0);
+        emit progress(m_emittedItems, m_emittedItems);
+        emit finished(m_emittedItems);
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void SpotifyPager::fail(const QString &error) {
+    qWarning() << "[SpotifyPager]" << error;
+    abort();
+    m_playlistId.clear();
+    m_snapshotId.clear();
+    emit failed(error);
+}
@@ -0,0 +1,331 @@
+// SpotifyRequestScheduler.cpp
+#include "SpotifyRequestScheduler.h"
+#include "SpotifyResponseCache.h"
+
+#include <QDateTime>
+#include <QNetworkAccessManager>
+#include <QtMath>
+#include <QDebug>
+#include <utility>
+
+namespace {
+const QString WebApiHost = QStringLiteral("api.spotify.com");
+}
+
+//=============================================================================
+// SpotifyResponse
+//=============================================================================
+SpotifyResponse::SpotifyResponse(SpotifyRequestScheduler *scheduler)
+    : QObject(scheduler), m_scheduler(scheduler) {}
+
+QByteArray SpotifyResponse::rawHeader(const QByteArray &name) const {
+    for (const QNetworkReply::RawHeaderPair &header : m_headers) {
+        if (header.first.compare(name, Qt::CaseInsensitive) == 0) return header.second;
+    }
+    return QByteArray();
+}
+
+void SpotifyResponse::abandon() {
+    if (m_scheduler) m_scheduler->abandon(this);
+    deleteLater();
+}
+
+//=============================================================================
+// Constructor / Settings
+//=============================================================================
+SpotifyRequestScheduler::SpotifyRequestScheduler(QNetworkAccessManager *manager, QObject *parent)
+    : QObject(parent), m_manager(manager), m_random(QRandomGenerator::securelySeeded()) {
+    m_clock.start();
+    m_tokens = m_config.burst;
+    m_wakeTimer.setSingleShot(true);
+    connect(&m_wakeTimer, &QTimer::timeout, this, &SpotifyRequestScheduler::schedule);
+}
+
+SpotifyRequestScheduler::~SpotifyRequestScheduler() {
+    // Every job, queued, waiting for a retry or in flight, is in m_jobsByKey; the
+    // replies belong to the manager and would keep running without us
+    for (Job *job : std::as_const(m_jobsByKey)) {
+        if (QNetworkReply *reply = std::exchange(job->reply, nullptr)) {
+            reply->disconnect(this);
+            reply->abort();
+            reply->deleteLater();
+        }
+    }
+    qDeleteAll(m_jobsByKey);
+}
+
+void SpotifyRequestScheduler::setConfig(const Config &config) {
+    m_config = config;
+    m_config.tokensPerSecond = qMax(0.1, m_config.tokensPerSecond);
+    m_config.burst = qMax(1, m_config.burst);
+    m_config.maxInFlight = qMax(1, m_config.maxInFlight);
+    m_tokens = qMin(m_tokens, double(m_config.burst));
+}
+
+void SpotifyRequestScheduler::setAccessToken(const QString &accessToken) { m_accessToken = accessToken; }
+
+void SpotifyRequestScheduler::setRandomSeed(quint32 seed) { m_random.seed(seed); }
+
+void SpotifyRequestScheduler::setCache(SpotifyResponseCache *cache) { m_cache = cache; }
+
+int SpotifyRequestScheduler::queuedCount() const {
+    return m_lanes[Interactive].size() + m_lanes[Background].size();
+}
+
+//=============================================================================
+// FUNCTION: Queues a GET, sharing an identical one that is already pending
+//=============================================================================
+SpotifyResponse *SpotifyRequestScheduler::get(const QNetworkRequest &request, Priority priority) {
+    auto *response = new SpotifyResponse(this);
+    if (m_cache && request.rawHeader("If-None-Match").isEmpty() && m_cache->isFresh(request.url())) {
+        // Still within max-age (typically cover images): no request, no token
+        const QUrl url = request.url();
+        QMetaObject::invokeMethod(this, [this, response, url]() { deliverFromCache(response, url); },
+                                  Qt::QueuedConnection);
+        return response;
+    }
+
+    const QString key = keyFor(request);
+
+    if (Job *job = m_jobsByKey.value(key)) {
+        job->waiters.append(response);
+        if (priority < job->priority) {
+            // An interactive caller joined a background request: let it jump the queue
+            job->priority = priority;
+            if (m_lanes[Background].removeOne(job)) m_lanes[Interactive].enqueue(job);
+            QMetaObject::invokeMethod(this, &SpotifyRequestScheduler::schedule, Qt::QueuedConnection);
+        }
+        return response;
+    }
+
+    static quint64 nextJobId = 0;
+    auto *job = new Job;
+    job->id = ++nextJobId;
+    job->key = key;
+    job->request = request;
+    job->priority = priority;
+    job->waiters.append(response);
+    m_jobsByKey.insert(key, job);
+    m_lanes[priority].enqueue(job);
+    // Deferred so requests made in the same event loop turn can still coalesce
+    QMetaObject::invokeMethod(this, &SpotifyRequestScheduler::schedule, Qt::QueuedConnection);
+    return response;
+}
+
+void SpotifyRequestScheduler::abandon(SpotifyResponse *response) {
+    Job *job = nullptr;
+    for (Job *candidate : std::as_const(m_jobsByKey)) {
+        if (candidate->waiters.contains(response)) {
+            job = candidate;
+            break;
+        }
+    }
+    if (!job) return;
+    job->waiters.removeAll(response);
+    for (const QPointer<SpotifyResponse> &waiter : std::as_const(job->waiters)) {
+        if (waiter) return; // still wanted by someone else
+    }
+    if (QNetworkReply *reply = std::exchange(job->reply, nullptr)) {
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+        --m_inFlight;
+    }
+    removeJob(job);
+    schedule();
+}
+
+//=============================================================================
+// HELPER: Sends queued jobs while tokens and connection slots allow it
+//=============================================================================
+void SpotifyRequestScheduler::schedule() {
+    m_wakeTimer.stop();
+    const qint64 now = m_clock.elapsed();
+    if (now < m_pausedUntilMs) {
+        if (queuedCount() > 0) m_wakeTimer.start(int(m_pausedUntilMs - now));
+        return;
+    }
+    refillTokens();
+
+    while (m_inFlight < m_config.maxInFlight) {
+        QQueue<Job *> &lane = m_lanes[Interactive].isEmpty() ? m_lanes[Background] : m_lanes[Interactive];
+        if (lane.isEmpty()) return;
+        if (m_tokens < 1.0) {
+            m_wakeTimer.start(qMax(1, qCeil((1.0 - m_tokens) * 1000.0 / m_config.tokensPerSecond)));
+            return;
+        }
+        m_tokens -= 1.0;
+        send(lane.dequeue());
+    }
+}
+
+void SpotifyRequestScheduler::refillTokens() {
+    const qint64 now = m_clock.elapsed();
+    m_tokens = qMin(double(m_config.burst), m_tokens + (now - m_lastRefillMs) * m_config.tokensPerSecond / 1000.0);
+    m_lastRefillMs = now;
+}
+
+void SpotifyRequestScheduler::send(Job *job) {
+    QNetworkRequest request(job->request);
+    // Everything shares one multiplexed connection instead of one TCP/TLS handshake each
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    if (!m_accessToken.isEmpty() && request.url().host().compare(WebApiHost, Qt::CaseInsensitive) == 0) {
+        request.setRawHeader("Authorization", "Bearer " + m_accessToken.toUtf8());
+    }
+    job->revalidating = false;
+    if (m_cache && !job->bypassCache && request.rawHeader("If-None-Match").isEmpty()) {
+        const QByteArray etag = m_cache->etag(request.url());
+        if (!etag.isEmpty()) {
+            request.setRawHeader("If-None-Match", etag);
+            job->revalidating = true;
+        }
+    }
+    ++m_inFlight;
+    job->reply = m_manager->get(request);
+    connect(job->reply, &QNetworkReply::finished, this, [this, job]() { handleReply(job); });
+}
+
+//=============================================================================
+// HELPER: Retries 429 / transient failures, otherwise delivers the reply
+//=============================================================================
+void SpotifyRequestScheduler::handleReply(Job *job) {
+    QNetworkReply *reply = std::exchange(job->reply, nullptr);
+    --m_inFlight;
+    reply->deleteLater();
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if (status == 429) {
+        // Rate limits are per application, so every request waits, not just this one.
+        // Being told when to come back does not count against the failure budget.
+        int retryAfterMs = parseRetryAfterMs(reply->rawHeader("Retry-After"));
+        if (retryAfterMs < 0) retryAfterMs = m_config.defaultRetryAfterMs;
+        m_pausedUntilMs = qMax(m_pausedUntilMs, m_clock.elapsed() + retryAfterMs);
+        m_tokens = 0.0;
+        qWarning() << "[SpotifyRequestScheduler] Rate limited, pausing for" << retryAfterMs << "ms";
+        emit rateLimited(retryAfterMs);
+        m_lanes[job->priority].prepend(job);
+        schedule();
+        return;
+    }
+
+    if (status == 304 && job->revalidating && (!m_cache || !m_cache->contains(job->request.url()))) {
+        // Validated against a body that was evicted meanwhile: fetch it in full
+        job->bypassCache = true;
+        m_lanes[job->priority].prepend(job);
+        schedule();
+        return;
+    }
+
+    const bool transient = (status == 0 && reply->error() != QNetworkReply::NoError
+                            && reply->error() != QNetworkReply::OperationCanceledError)
+                           || status >= 500;
+    if (transient && job->failures < m_config.maxRetries) {
+        const int delayMs = backoffDelayMs(++job->failures);
+        qWarning() << "[SpotifyRequestScheduler] Retry" << job->failures << "in" << delayMs << "ms after:"
+                   << reply->errorString();
+        retryLater(job, delayMs);
+        schedule();
+        return;
+    }
+
+    complete(job, reply);
+    schedule();
+}
+
+void SpotifyRequestScheduler::retryLater(Job *job, int delayMs) {
+    job->waitingForRetry = true;
+    const QString key = job->key;
+    const quint64 id = job->id;
+    // The job may be abandoned meanwhile; look it up again instead of holding the pointer
+    QTimer::singleShot(delayMs, this, [this, key, id]() {
+        Job *job = m_jobsByKey.value(key);
+        if (!job || job->id != id) return;
+        job->waitingForRetry = false;
+        m_lanes[job->priority].enqueue(job);
+        schedule();
+    });
+}
+
+void SpotifyRequestScheduler::complete(Job *job, QNetworkReply *reply) {
+    // Detach first so a receiver asking for the same URL again starts a fresh request
+    const QList<QPointer<SpotifyResponse>> waiters = job->waiters;
+    const QUrl url = job->request.url();
+    const bool revalidating = job->revalidating;
+    removeJob(job);
+
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QByteArray body = reply->readAll();
+    const QList<QNetworkReply::RawHeaderPair> headers = reply->rawHeaderPairs();
+    bool fromCache = false;
+    if (m_cache && reply->error() == QNetworkReply::NoError) {
+        if (status == 304 && revalidating) {
+            // Not modified: callers get the cached body as if it was a 200
+            m_cache->revalidated(url, reply->rawHeader("Cache-Control"));
+            body = m_cache->body(url);
+            status = 200;
+            fromCache = true;
+        } else if (status == 200) {
+            m_cache->store(url, body, reply->rawHeader("ETag"), reply->rawHeader("Cache-Control"));
+        }
+    }
+
+    for (const QPointer<SpotifyResponse> &waiter : waiters) {
+        if (!waiter) continue;
+        waiter->m_statusCode = status;
+        waiter->m_body = body;
+        waiter->m_headers = headers;
+        waiter->m_error = reply->error();
+        waiter->m_errorString = reply->errorString();
+        waiter->m_fromCache = fromCache;
+        emit waiter->finished();
+        waiter->deleteLater();
+    }
+}
+
+void SpotifyRequestScheduler::deliverFromCache(SpotifyResponse *response, const QUrl &url) {
+    response->m_statusCode = 200;
+    response->m_body = m_cache ? m_cache->body(url) : QByteArray();
+    response->m_fromCache = true;
+    if (response->m_body.isEmpty()) {
+        response->m_error = QNetworkReply::ContentNotFoundError;
+        response->m_errorString = "Cached response disappeared";
+    }
+    emit response->finished();
+    response->deleteLater();
+}
+
+void SpotifyRequestScheduler::removeJob(Job *job) {
+    if (m_jobsByKey.value(job->key) == job) m_jobsByKey.remove(job->key);
+    m_lanes[Interactive].removeAll(job);
+    m_lanes[Background].removeAll(job);
+    delete job;
+}
+
+//=============================================================================
+// HELPER: Backoff and Retry-After
+//=============================================================================
+int SpotifyRequestScheduler::backoffDelayMs(int attempt) {
+    // Capped exponential backoff with "equal jitter": half fixed, half random,
+    // so clients that failed together do not retry in lockstep
+    const qint64 ceiling = qMin<qint64>(m_config.maxBackoffMs,
+                                        qint64(m_config.baseBackoffMs) << qBound(0, attempt - 1, 20));
+    const qint64 half = ceiling / 2;
+    return int(half + m_random.bounded(half + 1));
+}
+
+int SpotifyRequestScheduler::parseRetryAfterMs(const QByteArray &value) {
+    // Either delta-seconds or an HTTP-date
+    const QByteArray trimmed = value.trimmed();
+    if (trimmed.isEmpty()) return -1;
+    bool ok = false;
+    const int seconds = trimmed.toInt(&ok);
+    if (ok) return seconds >= 0 ? qMin(seconds, 3600) * 1000 : -1;
+    const QDateTime date = QDateTime::fromString(QString::fromLatin1(trimmed), Qt::RFC2822Date);
+    if (!date.isValid()) return -1;
+    return int(qBound<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(date), 3600 * 1000));
+}
+
+QString SpotifyRequestScheduler::keyFor(const QNetworkRequest &request) {
+    // Conditional requests only coalesce with the same validator
+    return request.url().toString(QUrl::FullyEncoded) + '\n' + QString::fromLatin1(request.rawHeader("If-None-Match"));
+}
@@ -0,0 +1,242 @@
+// SpotifyResponseCache.cpp
+#include "SpotifyResponseCache.h"
+#include "XxHash64.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <algorithm>
+#include <vector>
+
+namespace {
+constexpr quint32 CacheMagic = 0x4C535243; // "LSRC"
+constexpr qint32 CacheVersion = 1;
+
+QString urlKey(const QUrl &url) { return url.toString(QUrl::FullyEncoded); }
+QString snapshotKey(const QString &playlistId) { return "snapshot:" + playlistId; }
+}
+
+//=============================================================================
+// Constructor / Destructor
+//=============================================================================
+SpotifyResponseCache::SpotifyResponseCache(const QString &directory, QObject *parent)
+    : QObject(parent), m_directory(directory) {
+    if (m_directory.isEmpty()) {
+        m_directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/spotify-cache";
+    }
+    QDir().mkpath(m_directory + "/blobs");
+
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(SaveDelayMs);
+    connect(&m_saveTimer, &QTimer::timeout, this, &SpotifyResponseCache::save);
+    load();
+}
+
+SpotifyResponseCache::~SpotifyResponseCache() {
+    if (m_saveTimer.isActive()) save();
+}
+
+void SpotifyResponseCache::setMaxBytes(qint64 maxBytes) {
+    m_maxBytes = qMax<qint64>(1024 * 1024, maxBytes);
+    evict();
+}
+
+//=============================================================================
+// HTTP responses
+//=============================================================================
+bool SpotifyResponseCache::contains(const QUrl &url) const { return m_entries.contains(urlKey(url)); }
+
+bool SpotifyResponseCache::isFresh(const QUrl &url) const {
+    const auto it = m_entries.constFind(urlKey(url));
+    return it != m_entries.cend() && it->expiresAtMs > QDateTime::currentMSecsSinceEpoch();
+}
+
+QByteArray SpotifyResponseCache::etag(const QUrl &url) const { return m_entries.value(urlKey(url)).etag; }
+
+QByteArray SpotifyResponseCache::body(const QUrl &url) { return readEntry(urlKey(url)); }
+
+void SpotifyResponseCache::store(const QUrl &url, const QByteArray &body, const QByteArray &etag,
+                                 const QByteArray &cacheControl) {
+    const qint64 maxAge = maxAgeSeconds(cacheControl);
+    // Without a validator or a lifetime the entry could never be reused
+    if (maxAge < 0 || (etag.isEmpty() && maxAge == 0)) return;
+    Entry entry;
+    entry.etag = etag;
+    entry.expiresAtMs = maxAge > 0 ? QDateTime::currentMSecsSinceEpoch() + maxAge * 1000 : 0;
+    insert(urlKey(url), entry, body);
+}
+
+void SpotifyResponseCache::revalidated(const QUrl &url, const QByteArray &cacheControl) {
+    const auto it = m_entries.find(urlKey(url));
+    if (it == m_entries.end()) return;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 maxAge = maxAgeSeconds(cacheControl);
+    it->expiresAtMs = maxAge > 0 ? now + maxAge * 1000 : 0;
+    it->lastUsedMs = now;
+    m_saveTimer.start();
+}
+
+//=============================================================================
+// Playlist snapshots
+//=============================================================================
+QByteArray SpotifyResponseCache::snapshotPayload(const QString &playlistId, const QString &snapshotId) {
+    const QString key = snapshotKey(playlistId);
+    const auto it = m_entries.constFind(key);
+    if (snapshotId.isEmpty() || it == m_entries.cend() || it->snapshotId != snapshotId) return QByteArray();
+    return readEntry(key);
+}
+
+void SpotifyResponseCache::storeSnapshot(const QString &playlistId, const QString &snapshotId,
+                                         const QByteArray &payload) {
+    if (snapshotId.isEmpty()) return;
+    Entry entry;
+    entry.snapshotId = snapshotId;
+    insert(snapshotKey(playlistId), entry, payload);
+}
+
+//=============================================================================
+// HELPER: Blob storage and LRU eviction
+//=============================================================================
+QString SpotifyResponseCache::blobPath(quint64 blob) const {
+    return m_directory + "/blobs/" + QString::number(blob, 16).rightJustified(16, '0');
+}
+
+QByteArray SpotifyResponseCache::readEntry(const QString &key) {
+    const auto it = m_entries.find(key);
+    if (it == m_entries.end()) return QByteArray();
+    QFile file(blobPath(it->blob));
+    if (!file.open(QIODevice::ReadOnly) || file.size() != it->size) {
+        // Blob deleted behind our back: forget the entry so it is fetched again
+        const Entry entry = *it;
+        m_entries.erase(it);
+        release(entry.blob, entry.size);
+        m_saveTimer.start();
+        return QByteArray();
+    }
+    it->lastUsedMs = QDateTime::currentMSecsSinceEpoch();
+    m_saveTimer.start();
+    return file.readAll();
+}
+
+void SpotifyResponseCache::insert(const QString &key, Entry entry, const QByteArray &body) {
+    entry.blob = XxHash64::hash(body.constData(), static_cast<size_t>(body.size())) | 1;
+    entry.size = body.size();
+    entry.lastUsedMs = QDateTime::currentMSecsSinceEpoch();
+
+    if (!m_blobRefs.contains(entry.blob)) {
+        // Content-addressed: identical bytes under another URL are already on disk
+        QSaveFile file(blobPath(entry.blob));
+        if (!file.open(QIODevice::WriteOnly) || file.write(body) != body.size() || !file.commit()) {
+            qWarning() << "[SpotifyResponseCache] Failed to write blob for" << key;
+            return;
+        }
+        m_totalBytes += entry.size;
+    }
+    ++m_blobRefs[entry.blob];
+
+    const auto old = m_entries.constFind(key);
+    if (old != m_entries.cend()) release(old->blob, old->size);
+    m_entries.insert(key, entry);
+    evict();
+    m_saveTimer.start();
+}
+
+void SpotifyResponseCache::release(quint64 blob, qint64 size) {
+    const auto it = m_blobRefs.find(blob);
+    if (it == m_blobRefs.end()) return;
+    if (--it.value() > 0) return;
+    m_blobRefs.erase(it);
+    QFile::remove(blobPath(blob));
+    m_totalBytes -= size;
+}
+
+void SpotifyResponseCache::evict() {
+    if (m_totalBytes <= m_maxBytes) return;
+
+    std::vector<std::pair<qint64, QString>> byAge;
+    byAge.reserve(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) byAge.emplace_back(it->lastUsedMs, it.key());
+    std::sort(byAge.begin(), byAge.end());
+
+    // Evict down to 90% so a full cache does not evict on every single insert
+    const qint64 target = m_maxBytes / 10 * 9;
+    int evicted = 0;
+    for (const auto &[lastUsed, key] : byAge) {
+        if (m_totalBytes <= target) break;
+        const Entry entry = m_entries.take(key);
+        release(entry.blob, entry.size);
+        ++evicted;
+    }
+    qDebug() << "[SpotifyResponseCache] Evicted" << evicted << "entries, now" << m_totalBytes << "bytes.";
+    m_saveTimer.start();
+}
+
+void SpotifyResponseCache::clear() {
+    m_entries.clear();
+    m_blobRefs.clear();
+    m_totalBytes = 0;
+    QDir(m_directory + "/blobs").removeRecursively();
+    QDir().mkpath(m_directory + "/blobs");
+    save();
+}
+
+qint64 SpotifyResponseCache::maxAgeSeconds(const QByteArray &cacheControl) {
+    qint64 maxAge = 0;
+    for (const QByteArray &part : cacheControl.split(',')) {
+        const QByteArray directive = part.trimmed().toLower();
+        if (directive == "no-store") return -1;
+        if (directive == "no-cache") return 0;
+        if (directive.startsWith("max-age=")) maxAge = qMax<qint64>(0, directive.mid(8).toLongLong());
+    }
+    return maxAge;
+}
+
+//=============================================================================
+// Index file persistence
+//=============================================================================
+void SpotifyResponseCache::load() {
+    QFile file(m_directory + "/index.cache");
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != CacheMagic || version != CacheVersion || count < 0) {
+        qWarning() << "[SpotifyResponseCache] Ignoring incompatible index:" << file.fileName();
+        return;
+    }
+
+    m_entries.reserve(count);
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString key;
+        Entry entry;
+        in >> key >> entry.blob >> entry.size >> entry.etag >> entry.expiresAtMs >> entry.lastUsedMs >> entry.snapshotId;
+        if (in.status() != QDataStream::Ok || !QFile::exists(blobPath(entry.blob))) continue;
+        if (!m_blobRefs.contains(entry.blob)) m_totalBytes += entry.size;
+        ++m_blobRefs[entry.blob];
+        m_entries.insert(key, entry);
+    }
+    qDebug() << "[SpotifyResponseCache] Loaded" << m_entries.size() << "entries," << m_totalBytes << "bytes.";
+    evict();
+}
+
+void SpotifyResponseCache::save() {
+    m_saveTimer.stop();
+    QSaveFile file(m_directory + "/index.cache");
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[SpotifyResponseCache] Failed to write index:" << file.fileName();
+        return;
+    }
+    QDataStream out(&file);
+    out << CacheMagic << CacheVersion << static_cast<qint32>(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        out << it.key() << it->blob << it->size << it->etag << it->expiresAtMs << it->lastUsedMs << it->snapshotId;
+    }
+    file.commit();
+}
@@ -0,0 +1,65 @@
+// StartupProfiler.cpp
+#include "StartupProfiler.h"
+#include "MetricsRegistry.h"
+#include "Trace.h"
+
+#include <QVariantMap>
+#include <QDebug>
+
+namespace {
+struct Phase {
+    const char *name;
+    qint64 durationNs;
+    bool deferred;
+};
+
+QList<Phase> recordedPhases;
+qint64 lastMarkNs = 0;  // Trace clock starts with the process
+bool firstFrameSeen = false;
+}
+
+void StartupProfiler::mark(const char *phase) {
+    const qint64 now = Trace::Detail::nowNs();
+    if (Trace::isEnabled()) Trace::Detail::record("startup", phase, lastMarkNs, now - lastMarkNs, -1);
+    recordedPhases.append({phase, now - lastMarkNs, false});
+    lastMarkNs = now;
+}
+
+//=============================================================================
+// FUNCTION: End of the critical path
+//=============================================================================
+void StartupProfiler::firstFrame() {
+    if (firstFrameSeen) return;
+    firstFrameSeen = true;
+    mark("firstFrame");
+    const qint64 totalMs = lastMarkNs / 1000000;
+    Metrics::startupMicros.record(lastMarkNs / 1000);
+
+    qInfo().noquote() << QStringLiteral("[Startup] First frame after %1 ms (budget %2 ms)").arg(totalMs).arg(BudgetMs);
+    for (const Phase &phase : std::as_const(recordedPhases)) {
+        qInfo().noquote() << QStringLiteral("[Startup]   %1 %2 ms")
+                                 .arg(QString::fromLatin1(phase.name), -20)
+                                 .arg(phase.durationNs / 1e6, 0, 'f', 1);
+    }
+    if (totalMs > BudgetMs) qWarning() << "[Startup] Over the time-to-first-frame budget by" << totalMs - BudgetMs << "ms";
+}
+
+void StartupProfiler::deferred(const char *task, qint64 startNs) {
+    const qint64 now = Trace::Detail::nowNs();
+    if (Trace::isEnabled()) Trace::Detail::record("startup", task, startNs, now - startNs, -1);
+    recordedPhases.append({task, now - startNs, true});
+    qInfo().noquote() << QStringLiteral("[Startup] Deferred %1 took %2 ms, done %3 ms after start")
+                             .arg(QString::fromLatin1(task))
+                             .arg((now - startNs) / 1e6, 0, 'f', 1)
+                             .arg(now / 1000000);
+}
+
+QVariantList StartupProfiler::phases() {
+    QVariantList list;
+    for (const Phase &phase : std::as_const(recordedPhases)) {
+        list.append(QVariantMap{{"phase", QString::fromLatin1(phase.name)},
+                                {"ms", phase.durationNs / 1e6},
+                                {"deferred", phase.deferred}});
+    }
+    return list;
+}
@@ -0,0 +1,92 @@
+// StorageScheduler.cpp
+#include "StorageScheduler.h"
+#include "LibraryIndex.h"
+#include "LogCategories.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStorageInfo>
+#include <QThreadPool>
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <sys/sysmacros.h>
+#endif
+
+//=============================================================================
+// FUNCTION: Groups roots by backing device
+//=============================================================================
+QList<StorageScheduler::Device> StorageScheduler::groupRoots(const QStringList &rootPaths) {
+    QList<Device> devices;
+    const int maxThreads = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    for (const QString &rootPath : rootPaths) {
+        if (rootPath.isEmpty() || !QFileInfo(rootPath).isDir()) continue;
+        Device device;
+        LibraryIndex::FileStat stat;
+        if (LibraryIndex::statFile(rootPath, &stat) && stat.device != 0) {
+            device.key = QStringLiteral("dev:%1").arg(stat.device);
+            device.media = probeMedia(stat.device, &device.name);
+        } else {
+            const QStorageInfo storage(rootPath);
+            device.key = QString::fromLocal8Bit(storage.device());
+            if (device.key.isEmpty()) device.key = storage.rootPath();
+        }
+        if (device.name.isEmpty()) device.name = QStorageInfo(rootPath).rootPath();
+
+        auto it = std::find_if(devices.begin(), devices.end(), [&](const Device &d) { return d.key == device.key; });
+        if (it != devices.end()) {
+            it->roots.append(rootPath);
+            continue;
+        }
+        device.concurrency = qMin(concurrencyFor(device.media), maxThreads);
+        device.roots.append(rootPath);
+        qCDebug(lcScan) << "[StorageScheduler]" << device.name << mediaName(device.media)
+                        << "readers:" << device.concurrency;
+        devices.append(device);
+    }
+    return devices;
+}
+
+int StorageScheduler::concurrencyFor(Media media) {
+    switch (media) {
+    case Media::Rotational: return 1;  // one head: keep the reads sequential
+    case Media::Solid: return 8;
+    case Media::NVMe: return 16;
+    case Media::Unknown: break;
+    }
+    return 4;
+}
+
+QString StorageScheduler::mediaName(Media media) {
+    switch (media) {
+    case Media::Rotational: return QStringLiteral("rotational");
+    case Media::Solid: return QStringLiteral("ssd");
+    case Media::NVMe: return QStringLiteral("nvme");
+    case Media::Unknown: break;
+    }
+    return QStringLiteral("unknown");
+}
+
+//=============================================================================
+// HELPER: Media type of a block device (Linux sysfs)
+//=============================================================================
+StorageScheduler::Media StorageScheduler::probeMedia(quint64 device, QString *name) {
+#ifdef Q_OS_LINUX
+    // /sys/dev/block/8:1 -> .../block/sda/sda1; a partition's queue lives on its disk
+    const dev_t dev = static_cast<dev_t>(device);
+    QString sysPath = QFileInfo(QStringLiteral("/sys/dev/block/%1:%2").arg(major(dev)).arg(minor(dev))).canonicalFilePath();
+    if (sysPath.isEmpty()) return Media::Unknown; // not a block device (NFS, FUSE, tmpfs, btrfs subvolume)
+    if (QFileInfo::exists(sysPath + QStringLiteral("/partition"))) sysPath = QFileInfo(sysPath).path();
+    *name = QFileInfo(sysPath).fileName();
+
+    QFile rotational(sysPath + QStringLiteral("/queue/rotational"));
+    if (!rotational.open(QIODevice::ReadOnly)) return Media::Unknown;
+    if (rotational.readAll().trimmed() == "1") return Media::Rotational;
+    return name->startsWith(QStringLiteral("nvme")) ? Media::NVMe : Media::Solid;
+#else
+    Q_UNUSED(device);
+    Q_UNUSED(name);
+    return Media::Unknown;
+#endif
+}
@@ -0,0 +1,86 @@
+// TagEditJournal.cpp
+#include "TagEditJournal.h"
+#include "LogCategories.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+constexpr quint32 JournalMagic = 0x4C544A31; // "LTJ1"
+constexpr qint32 JournalVersion = 1;
+}
+
+TagEditJournal::TagEditJournal() = default;
+
+void TagEditJournal::setFilePath(const QString &filePath) { m_filePath = filePath; }
+
+QString TagEditJournal::journalFilePath() const {
+    if (!m_filePath.isEmpty()) {
+        QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+        return m_filePath;
+    }
+    QString base = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(base);
+    return base + "/tag-journal.dat";
+}
+
+void TagEditJournal::record(const Batch &batch) {
+    if (batch.originals.isEmpty()) return;
+    m_batches.append(batch);
+    while (m_batches.size() > MaxBatches) m_batches.removeFirst();
+    save();
+}
+
+void TagEditJournal::markRestored(const QDateTime &time, const QStringList &filePaths) {
+    for (qsizetype i = m_batches.size() - 1; i >= 0; --i) {
+        if (m_batches.at(i).time != time) continue;
+        for (const QString &filePath : filePaths) m_batches[i].originals.remove(filePath);
+        if (m_batches.at(i).originals.isEmpty()) m_batches.removeAt(i);
+        save();
+        return;
+    }
+}
+
+//=============================================================================
+// Persistence
+//=============================================================================
+void TagEditJournal::load() {
+    QFile file(journalFilePath());
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != JournalMagic || version != JournalVersion || count < 0) {
+        qWarning() << "[TagEditJournal] Ignoring incompatible journal file:" << file.fileName();
+        return;
+    }
+    m_batches.clear();
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        Batch batch;
+        in >> batch.label >> batch.time >> batch.originals;
+        m_batches.append(batch);
+    }
+    qCDebug(lcTags) << "[TagEditJournal] Loaded" << m_batches.size() << "undoable batches.";
+}
+
+bool TagEditJournal::save() const {
+    QSaveFile file(journalFilePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[TagEditJournal] Failed to write journal file:" << file.fileName();
+        return false;
+    }
+    QDataStream out(&file);
+    out << JournalMagic << JournalVersion << static_cast<qint32>(m_batches.size());
+    for (const Batch &batch : m_batches) {
+        out << batch.label << batch.time << batch.originals;
+    }
+    return file.commit();
+}
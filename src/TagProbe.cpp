@@ -0,0 +1,132 @@
+// TagProbe.cpp
+#include "TagProbe.h"
+#include "LibraryScanner.h"
+#include "LogCategories.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QtEndian>
+#include <QDebug>
+
+#include <cstdio>
+
+namespace {
+constexpr quint32 MaxFrameBytes = 256u * 1024 * 1024; // anything larger is a broken worker
+constexpr int StartTimeoutMs = 3000;
+}
+
+TagProbe::TagProbe(const QString &program) : m_program(program.isEmpty() ? defaultProgram() : program) {}
+
+TagProbe::~TagProbe() { stop(); }
+
+QString TagProbe::defaultProgram() {
+    const QString fromEnvironment = qEnvironmentVariable("LIBRIFY_PROBE");
+    if (!fromEnvironment.isEmpty()) return QFileInfo(fromEnvironment).isExecutable() ? fromEnvironment : QString();
+#ifdef Q_OS_WIN
+    const QString name = QStringLiteral("librify-index.exe");
+#else
+    const QString name = QStringLiteral("librify-index");
+#endif
+    const QString directory = QCoreApplication::applicationDirPath();
+    for (const QString &candidate : {directory + '/' + name, directory + QStringLiteral("/tools/") + name}) {
+        if (QFileInfo(candidate).isExecutable()) return candidate;
+    }
+    return QString();
+}
+
+bool TagProbe::ensureStarted() {
+    if (m_process && m_process->state() == QProcess::Running) return true;
+    if (m_program.isEmpty()) return false;
+    m_process = std::make_unique<QProcess>();
+    m_process->setProgram(m_program);
+    m_process->setArguments({QStringLiteral("--probe")});
+    m_process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    m_process->start();
+    if (!m_process->waitForStarted(StartTimeoutMs)) {
+        qCWarning(lcScan) << "[TagProbe] Could not start" << m_program << ":" << m_process->errorString();
+        m_process.reset();
+        m_program.clear(); // unavailable from now on
+        return false;
+    }
+    return true;
+}
+
+void TagProbe::stop() {
+    if (!m_process) return;
+    if (m_process->state() != QProcess::NotRunning) {
+        m_process->closeWriteChannel(); // the worker exits at end of input
+        if (!m_process->waitForFinished(500)) {
+            m_process->kill();
+            m_process->waitForFinished(1000);
+        }
+    }
+    m_process.reset();
+}
+
+//=============================================================================
+// FUNCTION: One file through the worker, within timeoutMs
+//=============================================================================
+TagProbe::Status TagProbe::read(const QString &filePath, int timeoutMs, QVariantMap *tags) {
+    if (!ensureStarted()) return Status::Unavailable;
+    QElapsedTimer timer;
+    timer.start();
+    m_process->write(filePath.toUtf8() + '\n');
+
+    // Answer: quint32 length (big endian) + QDataStream of the tags
+    qint64 frameBytes = -1;
+    while (frameBytes < 0 || m_process->bytesAvailable() < 4 + frameBytes) {
+        if (frameBytes < 0 && m_process->bytesAvailable() >= 4) {
+            const QByteArray header = m_process->peek(4);
+            frameBytes = qFromBigEndian<quint32>(header.constData());
+            if (frameBytes > MaxFrameBytes) {
+                stop();
+                return Status::Crashed;
+            }
+            continue;
+        }
+        const qint64 remaining = timeoutMs - timer.elapsed();
+        if (remaining <= 0 || !m_process->waitForReadyRead(int(remaining))) {
+            const bool crashed = m_process->state() != QProcess::Running;
+            m_process->kill(); // killed mid-file: the next read starts a fresh worker
+            m_process->waitForFinished(1000);
+            m_process.reset();
+            return crashed ? Status::Crashed : Status::Timeout;
+        }
+    }
+    m_process->read(4);
+    QDataStream in(m_process->read(frameBytes));
+    in.setVersion(QDataStream::Qt_6_5);
+    in >> *tags;
+    return in.status() == QDataStream::Ok ? Status::Ok : Status::Crashed;
+}
+
+//=============================================================================
+// FUNCTION: Worker loop (librify-index --probe)
+//=============================================================================
+int TagProbe::serve() {
+    QFile input;
+    QFile output;
+    if (!input.open(stdin, QIODevice::ReadOnly) || !output.open(stdout, QIODevice::WriteOnly)) return 1;
+    for (;;) {
+        QByteArray line = input.readLine();
+        if (line.isEmpty()) break; // parent closed the pipe
+        if (line.endsWith('\n')) line.chop(1);
+
+        QByteArray payload;
+        {
+            QDataStream out(&payload, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_6_5);
+            out << LibraryScanner::readTags(QString::fromUtf8(line));
+        }
+        char header[4];
+        qToBigEndian<quint32>(quint32(payload.size()), header);
+        output.write(header, 4);
+        output.write(payload);
+        output.flush();
+    }
+    return 0;
+}
@@ -0,0 +1,325 @@
+// TagWriteQueue.cpp
+#include "TagWriteQueue.h"
+#include "LibraryScanner.h"
+#include "LogCategories.h"
+#include "Trace.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QStorageInfo>
+#include <QUrl>
+#include <QDebug>
+#include <exception>
+
+// --- TagLib Includes ---
+#include <taglib/tag.h>
+#include <taglib/mpegfile.h>
+#include <taglib/id3v2tag.h>
+#include <taglib/id3v2header.h>
+#include <taglib/attachedpictureframe.h>
+#include <taglib/privateframe.h>
+#include <taglib/tbytevector.h>
+
+namespace {
+const char *const ReserveOwner = "librify.reserve";
+constexpr int MaxFitAttempts = 4;
+
+TagLib::String toTagString(const QString &value) {
+    return TagLib::String(value.toUtf8().constData(), TagLib::String::UTF8);
+}
+
+//=============================================================================
+// HELPER: Cover bytes for the APIC frame
+//=============================================================================
+bool loadCover(const QString &imagePath, QByteArray *data, QString *mimeType, QString *error) {
+    QString localPath = imagePath;
+    if (imagePath.startsWith("qrc:")) localPath = ':' + QUrl(imagePath).path();
+    else if (imagePath.startsWith("file:")) localPath = QUrl(imagePath).toLocalFile();
+
+    QFile file(localPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QStringLiteral("Cannot read cover image %1").arg(localPath);
+        return false;
+    }
+    *data = file.readAll();
+
+    // Already a format every player understands: embed as-is, no decode/re-encode
+    if (data->startsWith("\xFF\xD8\xFF")) { *mimeType = "image/jpeg"; return true; }
+    if (data->startsWith("\x89PNG\r\n\x1A\n")) { *mimeType = "image/png"; return true; }
+
+    QImage image;
+    if (!image.loadFromData(*data)) {
+        *error = QStringLiteral("Unsupported cover image %1").arg(localPath);
+        return false;
+    }
+    data->clear();
+    QBuffer buffer(data);
+    if (!image.save(&buffer, "JPEG")) {
+        *error = QStringLiteral("Cannot encode cover image %1").arg(localPath);
+        return false;
+    }
+    *mimeType = "image/jpeg";
+    return true;
+}
+
+//=============================================================================
+// HELPER: Reserve frame (padding TagLib keeps across saves)
+//=============================================================================
+void removeReserve(TagLib::ID3v2::Tag *tag) {
+    const TagLib::ID3v2::FrameList frames = tag->frameList("PRIV");
+    for (TagLib::ID3v2::Frame *frame : frames) {
+        auto *priv = dynamic_cast<TagLib::ID3v2::PrivateFrame *>(frame);
+        if (priv && priv->owner() == ReserveOwner) tag->removeFrame(priv);
+    }
+}
+
+void addReserve(TagLib::ID3v2::Tag *tag, long bytes) {
+    auto *frame = new TagLib::ID3v2::PrivateFrame;
+    frame->setOwner(ReserveOwner);
+    frame->setData(TagLib::ByteVector(static_cast<unsigned int>(bytes), '\0'));
+    tag->addFrame(frame);
+}
+
+// TagLib only overwrites a tag in place when the rendered tag is exactly as
+// large as the one on disk; anything else rewrites the whole file. Sizes the
+// reserve frame to hit that, or leaves ReserveBytes of room when the tag has to grow.
+bool fitReserve(TagLib::ID3v2::Tag *tag, long onDiskSize) {
+    removeReserve(tag);
+    if (onDiskSize <= 0) {
+        addReserve(tag, TagWriteQueue::ReserveBytes);
+        return false;
+    }
+    // render() sizes its padding from header()->tagSize() and then updates it,
+    // so every trial (and the final save) has to start from the on-disk value
+    TagLib::ID3v2::Header *header = tag->header();
+    const unsigned int originalTagSize = header->tagSize();
+    long reserve = 0;
+    bool fits = false;
+    for (int attempt = 0; attempt < MaxFitAttempts; ++attempt) {
+        header->setTagSize(originalTagSize);
+        const long size = long(tag->render().size());
+        if (size == onDiskSize) { fits = true; break; }
+        // Smaller: TagLib dropped padding above 1% of the file, park it in the reserve
+        reserve += onDiskSize - size;
+        if (reserve < 0) break;
+        removeReserve(tag);
+        addReserve(tag, reserve);
+    }
+    if (!fits) {
+        removeReserve(tag);
+        addReserve(tag, TagWriteQueue::ReserveBytes);
+    }
+    header->setTagSize(originalTagSize);
+    return fits;
+}
+}
+
+//=============================================================================
+// Constructor / Destructor
+//=============================================================================
+TagWriteQueue::TagWriteQueue(QObject *parent) : QObject(parent) {
+    m_pool.setMaxThreadCount(MaxWorkers);
+}
+
+TagWriteQueue::~TagWriteQueue() {
+    // Running writes finish (a half-written tag is worse than a lost edit); queued ones are dropped
+    m_pending.clear();
+    m_filesByDevice.clear();
+    m_deviceOrder.clear();
+    m_pool.waitForDone();
+}
+
+//=============================================================================
+// FUNCTION: Queues edits (GUI thread)
+//=============================================================================
+int TagWriteQueue::enqueue(const Edit &edit) {
+    const bool wasBusy = isBusy();
+    Job job;
+    job.id = m_nextJobId++;
+    job.edit = edit;
+    addJob(job);
+    emit progressChanged(m_completed, m_total);
+    if (!wasBusy) emit busyChanged();
+    startJobs();
+    return job.id;
+}
+
+int TagWriteQueue::enqueueBatch(const QList<Edit> &edits) {
+    const int batchId = m_nextBatchId++;
+    if (edits.isEmpty()) {
+        QMetaObject::invokeMethod(this, [this, batchId]() {
+            emit batchFinished(batchId, {}, {});
+        }, Qt::QueuedConnection);
+        return batchId;
+    }
+    const bool wasBusy = isBusy();
+    Batch &batch = m_batches[batchId];
+    batch.remaining = int(edits.size());
+    batch.tags.reserve(edits.size());
+    for (const Edit &edit : edits) {
+        Job job;
+        job.id = m_nextJobId++;
+        job.batchId = batchId;
+        job.edit = edit;
+        addJob(job);
+    }
+    emit progressChanged(m_completed, m_total);
+    if (!wasBusy) emit busyChanged();
+    startJobs();
+    return batchId;
+}
+
+void TagWriteQueue::addJob(Job job) {
+    QList<Job> &jobs = m_pending[job.edit.filePath];
+    job.device = jobs.isEmpty() ? deviceFor(job.edit.filePath) : jobs.first().device;
+    if (jobs.isEmpty()) {
+        QList<QString> &files = m_filesByDevice[job.device];
+        if (files.isEmpty()) m_deviceOrder.append(job.device);
+        files.append(job.edit.filePath);
+    }
+    jobs.append(job);
+    ++m_total;
+}
+
+// Storage device holding the file; one lookup per directory, not per file
+QString TagWriteQueue::deviceFor(const QString &filePath) {
+    const QString directory = QFileInfo(filePath).absolutePath();
+    auto it = m_deviceByDirectory.constFind(directory);
+    if (it != m_deviceByDirectory.constEnd()) return it.value();
+    const QStorageInfo storage(directory);
+    QString device = QString::fromLocal8Bit(storage.device());
+    if (device.isEmpty()) device = storage.rootPath();
+    m_deviceByDirectory.insert(directory, device);
+    return device;
+}
+
+// Starts the oldest job of every file that has no write in flight, within the device
+// limits. Runs after every completion, so a saturated device is skipped as a whole and
+// only its running files (at most MaxWritesPerDevice) are stepped over.
+void TagWriteQueue::startJobs() {
+    for (auto deviceIt = m_deviceOrder.begin(); deviceIt != m_deviceOrder.end() && m_running.size() < MaxWorkers;) {
+        const QString device = *deviceIt;
+        QList<QString> &files = m_filesByDevice[device];
+        int &running = m_runningPerDevice[device];
+        for (auto it = files.begin();
+             it != files.end() && running < MaxWritesPerDevice && m_running.size() < MaxWorkers;) {
+            const QString filePath = *it;
+            if (m_running.contains(filePath)) { ++it; continue; }
+            QList<Job> &jobs = m_pending[filePath];
+            const Job job = jobs.takeFirst();
+            if (jobs.isEmpty()) {
+                m_pending.remove(filePath);
+                it = files.erase(it);
+            } else {
+                ++it;
+            }
+            m_running.insert(filePath);
+            ++running;
+            m_pool.start([this, job]() {
+                const Result result = write(job.edit);
+                QMetaObject::invokeMethod(this, [this, job, result]() {
+                    handleJobFinished(job, result);
+                }, Qt::QueuedConnection);
+            });
+        }
+        if (running == 0) m_runningPerDevice.remove(device);
+        if (files.isEmpty()) {
+            m_filesByDevice.remove(device);
+            deviceIt = m_deviceOrder.erase(deviceIt);
+        } else {
+            ++deviceIt;
+        }
+    }
+}
+
+void TagWriteQueue::handleJobFinished(const Job &job, const Result &result) {
+    const QString &filePath = job.edit.filePath;
+    m_running.remove(filePath);
+    if (--m_runningPerDevice[job.device] <= 0) m_runningPerDevice.remove(job.device);
+    ++m_completed;
+    if (result.ok) {
+        qCDebug(lcTags) << "[TagWriteQueue] Saved" << filePath << (result.inPlace ? "in place" : "(file rewritten)");
+    } else {
+        qCWarning(lcTags) << "[TagWriteQueue] Failed to save" << filePath << ":" << result.error;
+    }
+
+    if (job.batchId == 0) {
+        if (result.ok) emit writeFinished(job.id, filePath, result.tags);
+        else emit writeFailed(job.id, filePath, result.error);
+    } else {
+        auto batchIt = m_batches.find(job.batchId);
+        if (result.ok) batchIt->tags.append(result.tags);
+        else batchIt->errors.insert(filePath, result.error);
+        if (--batchIt->remaining == 0) {
+            const Batch batch = m_batches.take(job.batchId);
+            emit batchFinished(job.batchId, batch.tags, batch.errors);
+        }
+    }
+    emit progressChanged(m_completed, m_total);
+    if (!isBusy()) {
+        m_completed = m_total = 0;
+        emit busyChanged();
+    }
+    startJobs();
+}
+
+//=============================================================================
+// FUNCTION: Writes one edit (worker thread)
+//=============================================================================
+TagWriteQueue::Result TagWriteQueue::write(const Edit &edit) {
+    LIBRIFY_TRACE_SCOPE("tags", "writeTags");
+    Result result;
+    QByteArray coverData;
+    QString coverMimeType;
+    if (!edit.imagePath.isEmpty() && !loadCover(edit.imagePath, &coverData, &coverMimeType, &result.error)) {
+        return result;
+    }
+
+    try {
+        const QByteArray pathUtf8 = edit.filePath.toUtf8();
+        TagLib::MPEG::File file(pathUtf8.constData(), false);
+        if (!file.isValid() || !file.isOpen()) {
+            result.error = QStringLiteral("TagLib cannot open the file");
+            return result;
+        }
+        if (file.readOnly()) {
+            result.error = QStringLiteral("The file is read-only");
+            return result;
+        }
+
+        const long onDiskSize = file.hasID3v2Tag() ? long(file.ID3v2Tag()->header()->completeTagSize()) : 0;
+        TagLib::ID3v2::Tag *tag = file.ID3v2Tag(true);
+        for (auto it = edit.fields.constBegin(); it != edit.fields.constEnd(); ++it) {
+            const QString &key = it.key();
+            if (key == "title") tag->setTitle(toTagString(it.value().toString()));
+            else if (key == "artist") tag->setArtist(toTagString(it.value().toString()));
+            else if (key == "album") tag->setAlbum(toTagString(it.value().toString()));
+            else if (key == "genre") tag->setGenre(toTagString(it.value().toString()));
+            else if (key == "year") tag->setYear(it.value().toUInt());
+            else if (key == "track") tag->setTrack(it.value().toUInt());
+        }
+        if (!coverData.isEmpty()) {
+            tag->removeFrames("APIC");
+            auto *frame = new TagLib::ID3v2::AttachedPictureFrame;
+            frame->setMimeType(toTagString(coverMimeType));
+            frame->setPicture(TagLib::ByteVector(coverData.constData(), static_cast<unsigned int>(coverData.size())));
+            frame->setType(TagLib::ID3v2::AttachedPictureFrame::FrontCover);
+            tag->addFrame(frame);
+        }
+
+        result.inPlace = fitReserve(tag, onDiskSize);
+        if (!file.save()) {
+            result.error = QStringLiteral("TagLib could not save the tags");
+            return result;
+        }
+    } catch (const std::exception &e) {
+        result.error = QString::fromUtf8(e.what());
+        return result;
+    }
+
+    result.tags = LibraryScanner::readTags(edit.filePath);
+    result.ok = true;
+    return result;
+}
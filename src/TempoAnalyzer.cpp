@@ -0,0 +1,314 @@
+// TempoAnalyzer.cpp
+#include "TempoAnalyzer.h"
+#include "Fft.h"
+#include "PcmDecoder.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+constexpr quint32 CacheMagic = 0x4C544D31; // "LTM1"
+constexpr qint32 CacheVersion = 1;
+constexpr int SaveDelayMs = 5000;
+constexpr int FlushDelayMs = 3000;
+constexpr int FlushBatchSize = 200;
+constexpr qint64 MinSegmentMs = 10000;  // shorter segments fall back to the start of the file
+
+// Onset envelope: 1024-sample frames every 128 samples (~86 frames/s at 11025 Hz)
+constexpr int FrameSize = 1024;
+constexpr int FrameHop = 128;
+constexpr double MinBpm = 60.0;
+constexpr double MaxBpm = 200.0;
+// Log-Gaussian weighting around a typical tempo keeps half/double tempo
+// peaks from winning the autocorrelation
+constexpr double PriorCenterBpm = 120.0;
+constexpr double PriorWidthOctaves = 1.0;
+
+// Sum of max(0, current - previous), lane-split so it vectorizes without -ffast-math
+float positiveDiffSum(const float *current, const float *previous, int count) {
+    constexpr int Lanes = 8;
+    float sums[Lanes] = {};
+    int i = 0;
+    for (; i + Lanes <= count; i += Lanes) {
+        for (int l = 0; l < Lanes; ++l) {
+            const float d = current[i + l] - previous[i + l];
+            sums[l] += d > 0.0f ? d : 0.0f;
+        }
+    }
+    float total = 0.0f;
+    for (; i < count; ++i) {
+        const float d = current[i] - previous[i];
+        total += d > 0.0f ? d : 0.0f;
+    }
+    for (int l = 0; l < Lanes; ++l) total += sums[l];
+    return total;
+}
+}
+
+//=============================================================================
+// Constructor / Destructor
+//=============================================================================
+TempoAnalyzer::TempoAnalyzer(QObject *parent) : QObject(parent) {
+    // Library-wide analysis must never compete with playback or the UI
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+    m_pool.setThreadPriority(QThread::LowPriority);
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FlushDelayMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &TempoAnalyzer::flushResults);
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(SaveDelayMs);
+    connect(&m_saveTimer, &QTimer::timeout, this, &TempoAnalyzer::saveCacheFile);
+    loadCacheFile();
+}
+
+TempoAnalyzer::~TempoAnalyzer() {
+    m_cancel = true;
+    m_queue.clear();
+    m_pool.clear();
+    m_pool.waitForDone();
+    saveCacheFile();
+}
+
+//=============================================================================
+// Lookups (any thread)
+//=============================================================================
+double TempoAnalyzer::cachedBpm(const QString &filePath) const {
+    Entry entry;
+    {
+        QMutexLocker locker(&m_entriesMutex);
+        auto it = m_entries.constFind(filePath);
+        if (it == m_entries.constEnd()) return 0.0; // no stat() for files never analyzed
+        entry = *it;
+    }
+    QFileInfo info(filePath);
+    const bool fresh = entry.size == info.size()
+                       && entry.modified == info.lastModified().toMSecsSinceEpoch();
+    return fresh ? entry.bpm : 0.0;
+}
+
+void TempoAnalyzer::renameEntry(const QString &oldPath, const QString &newPath) {
+    {
+        QMutexLocker locker(&m_entriesMutex);
+        auto it = m_entries.find(oldPath);
+        if (it == m_entries.end()) return;
+        const Entry entry = *it;
+        m_entries.erase(it);
+        m_entries.insert(newPath, entry);
+    }
+    QMetaObject::invokeMethod(&m_saveTimer, qOverload<>(&QTimer::start), Qt::QueuedConnection);
+}
+
+bool TempoAnalyzer::isFresh(const QString &filePath) const {
+    QFileInfo info(filePath);
+    QMutexLocker locker(&m_entriesMutex);
+    auto it = m_entries.constFind(filePath);
+    return it != m_entries.constEnd()
+           && it->size == info.size()
+           && it->modified == info.lastModified().toMSecsSinceEpoch();
+}
+
+//=============================================================================
+// SLOT: Queues files for analysis, replacing whatever was still pending
+//=============================================================================
+void TempoAnalyzer::analyze(const QStringList &filePaths) {
+    m_queue.clear();
+    for (const QString &filePath : filePaths) {
+        if (!filePath.isEmpty() && !m_running.contains(filePath)) m_queue.enqueue(filePath);
+    }
+    qDebug() << "[TempoAnalyzer] Queued" << m_queue.size() << "files for tempo analysis.";
+    startJobs();
+}
+
+void TempoAnalyzer::startJobs() {
+    // Only keep as many jobs in flight as there are workers, so a new
+    // analyze() call can replace the queue without waiting on the pool
+    while (m_running.size() < m_pool.maxThreadCount() && !m_queue.isEmpty()) {
+        const QString filePath = m_queue.dequeue();
+        if (m_running.contains(filePath)) continue;
+        m_running.insert(filePath);
+        m_pool.start([this, filePath]() {
+            // A fresh entry (including a stored failure) means this file was already done
+            const bool computed = !isFresh(filePath);
+            const Entry entry = computed ? computeEntry(filePath, &m_cancel) : Entry();
+            QMetaObject::invokeMethod(this, [this, filePath, entry, computed]() {
+                handleJobFinished(filePath, entry, computed);
+            }, Qt::QueuedConnection);
+        });
+    }
+    if (m_running.isEmpty() && m_queue.isEmpty()) flushResults();
+}
+
+void TempoAnalyzer::handleJobFinished(const QString &filePath, const Entry &entry, bool computed) {
+    m_running.remove(filePath);
+    if (computed && !m_cancel) {
+        // Failures are stored as 0 BPM so they are not decoded again every scan
+        {
+            QMutexLocker locker(&m_entriesMutex);
+            m_entries.insert(filePath, entry);
+        }
+        m_saveTimer.start();
+        if (entry.bpm > 0.0f) {
+            m_pendingResults.insert(filePath, entry.bpm);
+            if (m_pendingResults.size() >= FlushBatchSize) {
+                flushResults();
+            } else if (!m_flushTimer.isActive()) {
+                m_flushTimer.start();
+            }
+        }
+    }
+    startJobs();
+}
+
+void TempoAnalyzer::flushResults() {
+    m_flushTimer.stop();
+    if (m_pendingResults.isEmpty()) return;
+    const QHash<QString, double> batch = std::exchange(m_pendingResults, {});
+    emit tempoBatchReady(batch);
+}
+
+//=============================================================================
+// WORKER: Decodes a segment of the track and estimates its tempo
+//=============================================================================
+TempoAnalyzer::Entry TempoAnalyzer::computeEntry(const QString &filePath, const std::atomic_bool *cancel) {
+    Entry entry;
+    const QFileInfo info(filePath);
+    entry.size = info.size();
+    entry.modified = info.lastModified().toMSecsSinceEpoch();
+
+    // Skip the intro where possible; short tracks are analyzed from the start
+    std::vector<float> samples = PcmDecoder::decodeMono(filePath, AnalysisSampleRate,
+                                                        SegmentStartMs, SegmentDurationMs, cancel);
+    if (static_cast<qint64>(samples.size()) < MinSegmentMs * AnalysisSampleRate / 1000
+        && !(cancel && cancel->load())) {
+        samples = PcmDecoder::decodeMono(filePath, AnalysisSampleRate, 0, SegmentDurationMs, cancel);
+    }
+    entry.bpm = static_cast<float>(estimateBpm(samples, AnalysisSampleRate));
+    return entry;
+}
+
+double TempoAnalyzer::estimateBpm(const std::vector<float> &samples, int sampleRate) {
+    if (sampleRate <= 0 || samples.size() < static_cast<size_t>(FrameSize * 4)) return 0.0;
+
+    // 1. Onset strength: half-wave rectified flux of the log-compressed spectrum
+    const Fft fft(FrameSize);
+    const std::vector<float> window = Fft::hannWindow(FrameSize);
+    const int bins = FrameSize / 2 + 1;
+    std::vector<float> re(FrameSize), im(FrameSize), magnitude(bins), previous(bins, 0.0f);
+    const int frameCount = static_cast<int>((samples.size() - FrameSize) / FrameHop) + 1;
+    std::vector<float> flux(frameCount, 0.0f);
+    for (int frame = 0; frame < frameCount; ++frame) {
+        const float *input = samples.data() + static_cast<size_t>(frame) * FrameHop;
+        for (int i = 0; i < FrameSize; ++i) re[i] = input[i] * window[i];
+        std::fill(im.begin(), im.end(), 0.0f);
+        fft.transform(re.data(), im.data());
+        for (int k = 0; k < bins; ++k) {
+            magnitude[k] = std::log1p(100.0f * std::sqrt(re[k] * re[k] + im[k] * im[k]));
+        }
+        if (frame > 0) flux[frame] = positiveDiffSum(magnitude.data(), previous.data(), bins);
+        std::swap(magnitude, previous);
+    }
+
+    // 2. Remove the slowly varying loudness so only the onsets remain
+    const double framesPerSecond = static_cast<double>(sampleRate) / FrameHop;
+    const int meanRadius = static_cast<int>(framesPerSecond * 0.25);
+    std::vector<float> onset(frameCount);
+    double windowSum = 0.0;
+    int lo = 0, hi = -1;
+    for (int i = 0; i < frameCount; ++i) {
+        while (hi < std::min(frameCount - 1, i + meanRadius)) windowSum += flux[++hi];
+        while (lo < i - meanRadius) windowSum -= flux[lo++];
+        onset[i] = std::max(0.0f, flux[i] - static_cast<float>(windowSum / (hi - lo + 1)));
+    }
+
+    // 3. Weighted autocorrelation over the lags of the supported tempo range
+    const int minLag = static_cast<int>(std::floor(60.0 * framesPerSecond / MaxBpm));
+    const int maxLag = std::min(frameCount - 2, static_cast<int>(std::ceil(60.0 * framesPerSecond / MinBpm)));
+    if (maxLag <= minLag + 2) return 0.0;
+    std::vector<double> score(maxLag + 2, 0.0);
+    for (int lag = minLag; lag <= maxLag + 1; ++lag) {
+        double sum = 0.0;
+        for (int i = 0; i + lag < frameCount; ++i) sum += onset[i] * onset[i + lag];
+        const double octaves = std::log2(60.0 * framesPerSecond / lag / PriorCenterBpm) / PriorWidthOctaves;
+        score[lag] = sum / (frameCount - lag) * std::exp(-0.5 * octaves * octaves);
+    }
+    int bestLag = minLag;
+    for (int lag = minLag; lag <= maxLag; ++lag) {
+        if (score[lag] > score[bestLag]) bestLag = lag;
+    }
+    if (score[bestLag] <= 0.0) return 0.0;
+
+    // 4. Parabolic interpolation around the peak for sub-frame resolution
+    double refinedLag = bestLag;
+    if (bestLag > minLag && bestLag < maxLag) {
+        const double a = score[bestLag - 1], b = score[bestLag], c = score[bestLag + 1];
+        const double denominator = a - 2.0 * b + c;
+        if (denominator < 0.0) refinedLag += 0.5 * (a - c) / denominator;
+    }
+    return std::round(600.0 * framesPerSecond / refinedLag) / 10.0;
+}
+
+//=============================================================================
+// Cache file persistence
+//=============================================================================
+QString TempoAnalyzer::cacheFilePath() const {
+    QString base = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(base);
+    return base + "/tempo.cache";
+}
+
+void TempoAnalyzer::loadCacheFile() {
+    QFile file(cacheFilePath());
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&file);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != CacheMagic || version != CacheVersion || count < 0) {
+        qWarning() << "[TempoAnalyzer] Ignoring incompatible cache file:" << file.fileName();
+        return;
+    }
+
+    QMutexLocker locker(&m_entriesMutex);
+    m_entries.reserve(count);
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString filePath;
+        Entry entry;
+        in >> filePath >> entry.size >> entry.modified >> entry.bpm;
+        m_entries.insert(filePath, entry);
+    }
+    qDebug() << "[TempoAnalyzer] Loaded" << m_entries.size() << "cached tempos.";
+}
+
+void TempoAnalyzer::saveCacheFile() {
+    QHash<QString, Entry> snapshot;
+    {
+        QMutexLocker locker(&m_entriesMutex);
+        snapshot = m_entries;
+    }
+
+    QSaveFile file(cacheFilePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[TempoAnalyzer] Failed to write cache file:" << file.fileName();
+        return;
+    }
+    QDataStream out(&file);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    out << CacheMagic << CacheVersion << static_cast<qint32>(snapshot.size());
+    for (auto it = snapshot.cbegin(); it != snapshot.cend(); ++it) {
+        out << it.key() << it->size << it->modified << it->bpm;
+    }
+    file.commit();
+}
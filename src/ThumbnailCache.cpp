@@ -0,0 +1,178 @@
+// ThumbnailCache.cpp
+#include "ThumbnailCache.h"
+#include "LibraryIndex.h"
+#include "MetricsRegistry.h"
+#include "Trace.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QDebug>
+
+namespace {
+constexpr int MaxWorkers = 2;
+constexpr int JpegQuality = 85;
+constexpr int PixelSizes[ThumbnailCache::SizeCount] = {128, 256, 512}; // row, tile, now-playing
+const char *const SizeNames[ThumbnailCache::SizeCount] = {"row", "tile", "nowplaying"};
+}
+
+//=============================================================================
+// Constructor / Destructor
+//=============================================================================
+ThumbnailCache::ThumbnailCache(QObject *parent) : QObject(parent) {
+    m_pool.setMaxThreadCount(MaxWorkers);
+    m_memory.setMaxCost(MemoryBudgetBytes);
+    m_directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/thumbnails";
+    QDir().mkpath(m_directory);
+}
+
+ThumbnailCache::~ThumbnailCache() {
+    m_cancel = true;
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+int ThumbnailCache::pixelsFor(Size size) { return PixelSizes[size]; }
+
+ThumbnailCache::Size ThumbnailCache::sizeForPixels(int pixels) {
+    for (int i = 0; i < SizeCount; ++i) {
+        if (PixelSizes[i] >= pixels) return Size(i);
+    }
+    return NowPlaying;
+}
+
+QString ThumbnailCache::sizeName(Size size) { return QString::fromLatin1(SizeNames[size]); }
+
+QString ThumbnailCache::sourceFor(const QString &coverId, Size size) {
+    if (coverId.isEmpty()) return QString();
+    return QStringLiteral("image://covers/") + coverId + '/' + sizeName(size);
+}
+
+// Two-level layout (ab/abcdef...-128.jpg) keeps directories small for big libraries
+QString ThumbnailCache::filePathFor(const QString &coverId, Size size) const {
+    return m_directory + '/' + coverId.left(2) + '/' + coverId + '-' + QString::number(PixelSizes[size]) + ".jpg";
+}
+
+qint64 ThumbnailCache::memoryUsage() const {
+    QMutexLocker locker(&m_memoryMutex);
+    return m_memory.totalCost();
+}
+
+void ThumbnailCache::remember(const QString &coverId, Size size, const QImage &image) {
+    QMutexLocker locker(&m_memoryMutex);
+    m_memory.insert(coverId + '/' + QString::number(size), new QImage(image), int(image.sizeInBytes()));
+}
+
+//=============================================================================
+// FUNCTION: Lookup (any thread)
+//=============================================================================
+QImage ThumbnailCache::thumbnail(const QString &coverId, Size size) {
+    if (coverId.isEmpty()) return QImage();
+    {
+        QMutexLocker locker(&m_memoryMutex);
+        if (const QImage *cached = m_memory.object(coverId + '/' + QString::number(size))) {
+            Metrics::coverCacheHits.fetch_add(1, std::memory_order_relaxed);
+            return *cached;
+        }
+    }
+    const QImage onDisk(filePathFor(coverId, size));
+    if (!onDisk.isNull()) {
+        Metrics::coverCacheHits.fetch_add(1, std::memory_order_relaxed);
+        remember(coverId, size, onDisk);
+        return onDisk;
+    }
+    Metrics::coverCacheMisses.fetch_add(1, std::memory_order_relaxed);
+    const QImage generated = generate(coverId, size);
+    if (!generated.isNull()) remember(coverId, size, generated);
+    return generated;
+}
+
+//=============================================================================
+// HELPER: Scales one original to every size
+//=============================================================================
+QImage ThumbnailCache::generate(const QString &coverId, Size size) {
+    LIBRIFY_TRACE_SCOPE("covers", "generate");
+    if (!m_index) return QImage();
+    QByteArray data = m_index->coverData(coverId);
+    if (data.isEmpty()) return QImage();
+
+    // Let the decoder downscale (JPEG decodes at 1/2, 1/4, 1/8 directly)
+    QBuffer buffer(&data);
+    QImageReader reader(&buffer);
+    const QSize original = reader.size();
+    const int largest = PixelSizes[SizeCount - 1];
+    if (original.isValid() && (original.width() > largest || original.height() > largest)) {
+        reader.setScaledSize(original.scaled(largest, largest, Qt::KeepAspectRatio));
+    }
+    const QImage decoded = reader.read();
+    if (decoded.isNull()) {
+        qWarning() << "[ThumbnailCache] Cannot decode cover" << coverId << ":" << reader.errorString();
+        return QImage();
+    }
+
+    QImage requested;
+    QDir().mkpath(m_directory + '/' + coverId.left(2));
+    for (int i = SizeCount - 1; i >= 0; --i) {
+        const int pixels = PixelSizes[i];
+        const QImage scaled = decoded.width() > pixels || decoded.height() > pixels
+            ? decoded.scaled(pixels, pixels, Qt::KeepAspectRatio, Qt::SmoothTransformation)
+            : decoded;
+        QSaveFile file(filePathFor(coverId, Size(i)));
+        if (!file.open(QIODevice::WriteOnly) || !scaled.save(&file, "JPG", JpegQuality) || !file.commit()) {
+            qWarning() << "[ThumbnailCache] Failed to write thumbnail:" << file.fileName();
+        }
+        if (i == size) requested = scaled;
+    }
+    return requested;
+}
+
+//=============================================================================
+// SLOT: Pre-scales every known cover in the background
+//=============================================================================
+void ThumbnailCache::prepareAll() {
+    if (!m_index) return;
+    // generate() writes the largest size first, so a cover with a Row file is complete
+    QStringList missing;
+    for (const QString &coverId : m_index->coverIds()) {
+        if (!QFile::exists(filePathFor(coverId, Row))) missing.append(coverId);
+    }
+    if (missing.isEmpty()) return;
+    qDebug() << "[ThumbnailCache] Scaling" << missing.size() << "covers in the background.";
+    for (const QString &coverId : std::as_const(missing)) {
+        m_pool.start([this, coverId]() {
+            // A lookup may have scaled it meanwhile
+            if (m_cancel || QFile::exists(filePathFor(coverId, Row))) return;
+            QThread::currentThread()->setPriority(QThread::LowPriority);
+            generate(coverId, Row);
+            QThread::currentThread()->setPriority(QThread::NormalPriority);
+        });
+    }
+}
+
+//=============================================================================
+// Image provider
+//=============================================================================
+CoverImageProvider::CoverImageProvider(ThumbnailCache *cache)
+    : QQuickImageProvider(QQuickImageProvider::Image, QQmlImageProviderBase::ForceAsynchronousImageLoading),
+      m_cache(cache) {}
+
+// id: "<coverId>/<row|tile|nowplaying>"; a sourceSize picks the closest size instead
+QImage CoverImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize) {
+    const QString coverId = id.section('/', 0, 0);
+    const QString sizeName = id.section('/', 1, 1);
+    ThumbnailCache::Size thumbnailSize = ThumbnailCache::Row;
+    if (requestedSize.width() > 0 || requestedSize.height() > 0) {
+        thumbnailSize = ThumbnailCache::sizeForPixels(qMax(requestedSize.width(), requestedSize.height()));
+    } else {
+        for (int i = 0; i < ThumbnailCache::SizeCount; ++i) {
+            if (ThumbnailCache::sizeName(ThumbnailCache::Size(i)) == sizeName) thumbnailSize = ThumbnailCache::Size(i);
+        }
+    }
+    const QImage image = m_cache->thumbnail(coverId, thumbnailSize);
+    if (size) *size = image.size();
+    return image;
+}
@@ -0,0 +1,214 @@
+// Trace.cpp
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QList>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <QDebug>
+#include <chrono>
+#include <memory>
+
+namespace {
+constexpr int MaxRetiredRings = 64; // rings of finished threads kept for export
+
+struct Event {
+    const char *category;
+    const char *name;
+    qint64 startNs;
+    qint64 durationNs; // -1 for instant events
+    qint64 arg;
+};
+
+// One ring entry as a seqlock: the owner thread may overwrite a slot while
+// chromeJson() copies it, so every field is a relaxed atomic and the stamp
+// (event number + 1, 0 while being written) tells the reader whether its
+// copy is the event it wanted
+struct Slot {
+    std::atomic<quint64> stamp{0};
+    std::atomic<const char *> category{nullptr};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<qint64> startNs{0};
+    std::atomic<qint64> durationNs{0};
+    std::atomic<qint64> arg{0};
+
+    void store(quint64 index, const Event &event) {
+        stamp.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        category.store(event.category, std::memory_order_relaxed);
+        name.store(event.name, std::memory_order_relaxed);
+        startNs.store(event.startNs, std::memory_order_relaxed);
+        durationNs.store(event.durationNs, std::memory_order_relaxed);
+        arg.store(event.arg, std::memory_order_relaxed);
+        stamp.store(index + 1, std::memory_order_release);
+    }
+
+    // False when the slot does not hold event index (not written yet, or overwritten meanwhile)
+    bool load(quint64 index, Event *event) const {
+        if (stamp.load(std::memory_order_acquire) != index + 1) return false;
+        *event = {category.load(std::memory_order_relaxed), name.load(std::memory_order_relaxed),
+                  startNs.load(std::memory_order_relaxed), durationNs.load(std::memory_order_relaxed),
+                  arg.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return stamp.load(std::memory_order_relaxed) == index + 1;
+    }
+};
+
+struct Ring {
+    std::unique_ptr<Slot[]> events{new Slot[Trace::RingCapacity]};
+    std::atomic<quint64> written{0};
+    std::atomic<quint64> clearedAt{0};
+    int threadIndex = 0;
+    QByteArray threadName;
+};
+
+struct Registry {
+    QMutex mutex;
+    QList<std::shared_ptr<Ring>> rings;
+    int nextThreadIndex = 1;
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+QString exitTracePath;
+
+QByteArray jsonSafe(QByteArray text) {
+    for (char &c : text) {
+        if (c == '"' || c == 0x5C || uchar(c) < 0x20) c = '_';
+    }
+    return text;
+}
+
+Ring &localRing() {
+    thread_local std::shared_ptr<Ring> ring = []() {
+        auto created = std::make_shared<Ring>();
+        QThread *thread = QThread::currentThread();
+        if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+            created->threadName = "main";
+        } else if (thread && !thread->objectName().isEmpty()) {
+            created->threadName = thread->objectName().toUtf8();
+        }
+        Registry &reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        created->threadIndex = reg.nextThreadIndex++;
+        if (created->threadName.isEmpty()) created->threadName = "thread " + QByteArray::number(created->threadIndex);
+        // Drop the oldest rings of threads that have exited (only the registry holds them)
+        int retired = 0;
+        for (const auto &existing : std::as_const(reg.rings)) retired += existing.use_count() == 1;
+        for (qsizetype i = 0; i < reg.rings.size() && retired > MaxRetiredRings;) {
+            if (reg.rings[i].use_count() == 1) {
+                reg.rings.removeAt(i);
+                --retired;
+            } else {
+                ++i;
+            }
+        }
+        reg.rings.append(created);
+        return created;
+    }();
+    return *ring;
+}
+
+void writeOnExit() {
+    if (exitTracePath.isEmpty()) return;
+    if (Trace::writeChromeJson(exitTracePath)) qDebug() << "[Trace] Wrote trace to" << exitTracePath;
+}
+}
+
+qint64 Trace::Detail::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - processStart).count();
+}
+
+void Trace::Detail::record(const char *category, const char *name, qint64 startNs, qint64 durationNs, qint64 arg) {
+    Ring &ring = localRing();
+    const quint64 slot = ring.written.load(std::memory_order_relaxed);
+    ring.events[slot % RingCapacity].store(slot, {category, name, startNs, durationNs, arg});
+    ring.written.store(slot + 1, std::memory_order_release);
+}
+
+void Trace::setEnabled(bool enabled) {
+    Detail::enabled.store(enabled, std::memory_order_relaxed);
+    qDebug() << "[Trace] Tracing" << (enabled ? "enabled" : "disabled");
+}
+
+void Trace::clear() {
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const auto &ring : std::as_const(reg.rings)) {
+        ring->clearedAt.store(ring->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+void Trace::instant(const char *category, const char *name, qint64 arg) {
+    if (isEnabled()) Detail::record(category, name, Detail::nowNs(), -1, arg);
+}
+
+//=============================================================================
+// FUNCTION: Chrome trace-event export
+//=============================================================================
+QByteArray Trace::chromeJson() {
+    QList<std::shared_ptr<Ring>> rings;
+    {
+        Registry &reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        rings = reg.rings;
+    }
+
+    QByteArray out;
+    out.reserve(1 << 20);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    const auto separator = [&]() {
+        if (!first) out += ",\n";
+        first = false;
+    };
+    for (const auto &ring : std::as_const(rings)) {
+        const QByteArray tid = QByteArray::number(ring->threadIndex);
+        separator();
+        out += "{\"ph\":\"M\",\"pid\":1,\"tid\":" + tid + ",\"name\":\"thread_name\",\"args\":{\"name\":\""
+               + jsonSafe(ring->threadName) + "\"}}";
+
+        // The owner keeps writing while we copy; slots it laps are dropped by their stamp
+        const quint64 end = ring->written.load(std::memory_order_acquire);
+        quint64 begin = end >= quint64(RingCapacity) ? end - RingCapacity : 0;
+        begin = qMax(begin, ring->clearedAt.load(std::memory_order_relaxed));
+        for (quint64 i = begin; i < end; ++i) {
+            Event event;
+            if (!ring->events[i % RingCapacity].load(i, &event)) continue;
+            separator();
+            out += "{\"pid\":1,\"tid\":" + tid + ",\"cat\":\"" + jsonSafe(event.category) + "\",\"name\":\""
+                   + jsonSafe(event.name) + "\",\"ts\":" + QByteArray::number(event.startNs / 1000.0, 'f', 3);
+            if (event.durationNs >= 0) {
+                out += ",\"ph\":\"X\",\"dur\":" + QByteArray::number(event.durationNs / 1000.0, 'f', 3);
+            } else {
+                out += ",\"ph\":\"i\",\"s\":\"t\"";
+            }
+            if (event.arg >= 0) out += ",\"args\":{\"n\":" + QByteArray::number(event.arg) + '}';
+            out += '}';
+        }
+    }
+    out += "]}\n";
+    return out;
+}
+
+bool Trace::writeChromeJson(const QString &filePath) {
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[Trace] Cannot write trace file:" << filePath;
+        return false;
+    }
+    file.write(chromeJson());
+    return file.commit();
+}
+
+void Trace::installFromEnvironment() {
+    exitTracePath = qEnvironmentVariable("LIBRIFY_TRACE");
+    if (exitTracePath.isEmpty()) return;
+    setEnabled(true);
+    qAddPostRoutine(writeOnExit);
+}
@@ -1,10 +1,16 @@
 // TrackListModel.cpp
 #include "TrackListModel.h"
+#include "FrameTimeMonitor.h"
+#include "LogCategories.h"
+#include "MetricsRegistry.h"
+#include "Trace.h"
 #include <QVariantMap>
 #include <QString>
 #include <QtGlobal>   // For Qt::CaseInsensitive
 #include <algorithm>  // For std::sort
 #include <QFileInfo>
+#include <QHash>
+#include <QElapsedTimer>
 
 TrackListModel::TrackListModel(QObject *parent) : QObject(parent){}
 
@@ -27,8 +33,8 @@ Qt::SortOrder TrackListModel::sortOrder() const {
 void TrackListModel::clearTracks(){
     if (!m_tracks.isEmpty()) {
         m_tracks.clear();
-        qDebug() << "[TrackListModel] Track list cleared. Emitting tracksChanged.";
-        emit tracksChanged();
+        qCDebug(lcSort) << "[TrackListModel] Track list cleared. Emitting tracksChanged.";
+        emitTracksChanged();
     }
 }
 
@@ -39,13 +45,13 @@ void TrackListModel::updateTrack(const QVariantMap &updatedData) {
         qWarning() << "[TrackListModel] updateTrack received empty filePath in data."; // Updated log message
         return;
     }
-    qDebug() << "[TrackListModel] updateTrack for:" << filePath; // Updated log message
+    qCDebug(lcSort) << "[TrackListModel] updateTrack for:" << filePath;
 
     bool found = false;
     for (int i = 0; i < m_tracks.size(); ++i) {
         QVariantMap currentTrack = m_tracks[i].toMap();
         if (QFileInfo(currentTrack.value("filePath").toString()).canonicalFilePath() == QFileInfo(filePath).canonicalFilePath()) {
-            qDebug() << "  > Found track at index" << i << ". Updating data.";
+            qCDebug(lcSort) << "  > Found track at index" << i << ". Updating data.";
             m_tracks[i] = updatedData;
             found = true;
             break;
@@ -54,39 +60,64 @@ void TrackListModel::updateTrack(const QVariantMap &updatedData) {
 
     if (found) {
         applySort();
-        qDebug() << "  > Emitting tracksChanged() after single track update and sort.";
-        emit tracksChanged();
+        qCDebug(lcSort) << "  > Emitting tracksChanged() after single track update and sort.";
+        emitTracksChanged();
     } else {
         qWarning() << "[TrackListModel] Track not found in model for single update:" << filePath;
     }
 }
 
+// batched background updates (e.g. tempo analysis results)
+void TrackListModel::patchTracks(const QVariantList &updatedTracks) {
+    if (updatedTracks.isEmpty() || m_tracks.isEmpty()) return;
+    QHash<QString, QVariant> updatesByPath;
+    updatesByPath.reserve(updatedTracks.size());
+    for (const QVariant &track : updatedTracks) {
+        updatesByPath.insert(track.toMap().value("filePath").toString(), track);
+    }
+
+    int patched = 0;
+    for (int i = 0; i < m_tracks.size() && patched < updatesByPath.size(); ++i) {
+        auto it = updatesByPath.constFind(m_tracks[i].toMap().value("filePath").toString());
+        if (it != updatesByPath.constEnd()) {
+            m_tracks[i] = it.value();
+            ++patched;
+        }
+    }
+
+    if (patched > 0) {
+        applySort();
+        qCDebug(lcSort) << "[TrackListModel] Patched" << patched << "tracks. Emitting tracksChanged.";
+        emitTracksChanged();
+    }
+}
 
 // data refreshing
 void TrackListModel::updateTracks(const QVariantList& newTracks)
 {
-    qDebug() << "[TrackListModel] updateTracks called. Received" << newTracks.count() << "tracks.";
+    LIBRIFY_TRACE_SCOPE("model", "updateTracks");
+    qCDebug(lcSort) << "[TrackListModel] updateTracks called. Received" << newTracks.count() << "tracks.";
     // Store the new list first
     m_tracks = newTracks;
     // Apply the *currently active* sort order to the new list
     applySort(); // Sorts m_tracks in place
     // Emit tracksChanged AFTER sorting
-    qDebug() << "[TrackListModel] Track list updated and sorted. Emitting tracksChanged.";
-    emit tracksChanged();
+    qCDebug(lcSort) << "[TrackListModel] Track list updated and sorted. Emitting tracksChanged.";
+    emitTracksChanged();
 }
 
 void TrackListModel::sortTracksBy(SortColumn column, Qt::SortOrder order)
 {
-    qDebug() << "[TrackListModel] sortTracksBy called. Column:" << column << "Order:" << order;
+    qCDebug(lcSort) << "[TrackListModel] sortTracksBy called. Column:" << column << "Order:" << order;
     if (m_sortColumn != column || m_sortOrder != order) {
         m_sortColumn = column;
         m_sortOrder = order;
         applySort(); // Re-sort the existing list with new criteria
-        qDebug() << "[TrackListModel] Sort criteria changed and list resorted. Emitting tracksChanged & sortCriteriaChanged.";
-        emit tracksChanged();       // Notify view about data reorder
+        qCDebug(lcSort) << "[TrackListModel] Sort criteria changed and list resorted. Emitting tracksChanged & sortCriteriaChanged.";
+        emitTracksChanged();        // Notify view about data reorder
         emit sortCriteriaChanged(); // Notify UI about header indicators
     } else {
-        qDebug() << "[TrackListModel] Sort criteria unchanged.";
+        qCDebug(lcSort) << "[TrackListModel] Sort criteria unchanged.";
     }
 }
 
@@ -98,11 +129,15 @@ void TrackListModel::applySort()
     if (m_sortColumn == SortColumn::None || m_tracks.isEmpty()) {
         // No sorting needed or possible
         // Optional: Could revert to an "original" order if one was stored, but usually not needed.
-        qDebug() << "[TrackListModel] applySort: No sort applied (None or empty list).";
+        qCDebug(lcSort) << "[TrackListModel] applySort: No sort applied (None or empty list).";
         return;
     }
 
-    qDebug() << "[TrackListModel] applySort: Sorting by Column" << m_sortColumn << "Order" << m_sortOrder;
+    qCDebug(lcSort) << "[TrackListModel] applySort: Sorting by Column" << m_sortColumn << "Order" << m_sortOrder;
+    Trace::Span span("sort", "applySort");
+    span.setArg(m_tracks.size());
+    QElapsedTimer timer;
+    timer.start();
 
     // Use std::sort with our custom static comparison function
     // Pass the current sort criteria to the comparator lambda which calls the static function
@@ -113,7 +148,26 @@ void TrackListModel::applySort()
                   return TrackListModel::compareTracks(a, b, this->m_sortColumn, this->m_sortOrder);
               });
 
-    qDebug() << "[TrackListModel] applySort: Sorting complete.";
+    Metrics::sortMicros.record(timer.nsecsElapsed() / 1000);
+    qCDebug(lcSort) << "[TrackListModel] applySort: Sorting complete.";
+}
+
+// Walks every track, so only on demand (diagnostics pane open, /metrics) and not per change
+qint64 TrackListModel::memoryUsage() const
+{
+    if (m_payloadBytes < 0) m_payloadBytes = MetricsRegistry::estimateBytes(m_tracks);
+    return m_payloadBytes;
+}
+
+// tracksChanged makes QML re-read the whole list; traced as the model → QML handoff
+void TrackListModel::emitTracksChanged()
+{
+    Trace::Span span("qml", "tracksChanged");
+    span.setArg(m_tracks.size());
+    m_payloadBytes = -1; // estimated again when a memory probe asks
+    Metrics::tracksChangedTracks.record(m_tracks.size());
+    FrameTimeMonitor::noteModelReset(); // the ListView rebuilds every delegate
+    emit tracksChanged();
 }
 
 // Static comparison function used by std::sort
@@ -156,6 +210,13 @@ bool TrackListModel::compareTracks(const QVariant& v1, const QVariant& v2, SortC
         result = QString::compare(str1, str2, Qt::CaseInsensitive);
         break;
 
+    case Bpm: {
+        const double bpm1 = map1.value("bpm").toDouble();
+        const double bpm2 = map2.value("bpm").toDouble();
+        result = (bpm1 < bpm2) ? -1 : (bpm1 > bpm2 ? 1 : 0);
+        break;
+    }
+
     case None:
     default:
         return false; // No sorting or unknown column
@@ -0,0 +1,175 @@
+// TrackMatcher.cpp
+#include "TrackMatcher.h"
+#include "LibraryScanner.h"
+
+#include <QSet>
+#include <QDebug>
+#include <QElapsedTimer>
+
+//=============================================================================
+// FUNCTION: Normalization
+//=============================================================================
+QString TrackMatcher::normalizeText(const QString &text) {
+    // NFKD splits "é" into "e" + combining accent (and folds ligatures/full-width forms)
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString out;
+    out.reserve(decomposed.size());
+    bool pendingSpace = false;
+    for (const QChar c : decomposed) {
+        const QChar::Category category = c.category();
+        if (category == QChar::Mark_NonSpacing || category == QChar::Mark_SpacingCombining
+            || category == QChar::Mark_Enclosing) {
+            continue;
+        }
+        if (c.isLetterOrNumber()) {
+            if (pendingSpace && !out.isEmpty()) out += QLatin1Char(' ');
+            pendingSpace = false;
+            out += c;
+        } else {
+            pendingSpace = true; // punctuation and whitespace runs become one space
+        }
+    }
+    return out.toCaseFolded();
+}
+
+QString TrackMatcher::normalizeTitle(const QString &title) {
+    // "Song (feat. X)", "Song [Live]", "Song - Remastered 2011" all match "Song"
+    qsizetype cut = title.size();
+    for (const QString &marker : {QStringLiteral("("), QStringLiteral("["), QStringLiteral(" - ")}) {
+        const qsizetype position = title.indexOf(marker);
+        if (position > 0) cut = qMin(cut, position);
+    }
+    const QString normalized = normalizeText(title.left(cut));
+    return normalized.isEmpty() ? normalizeText(title) : normalized;
+}
+
+QStringList TrackMatcher::normalizeArtists(const QString &artist) {
+    QStringList artists;
+    if (artist.isEmpty() || artist == QLatin1String("Unknown Artist")) return artists;
+    // Same separators (feat., &, vs., ...) as the sidebar's artist grouping
+    for (const QString &name : LibraryScanner::splitArtistName(artist)) {
+        const QString normalized = normalizeText(name);
+        if (!normalized.isEmpty() && !artists.contains(normalized)) artists.append(normalized);
+    }
+    return artists;
+}
+
+QString TrackMatcher::joinKey(const QString &title, const QString &artist) {
+    return title + QChar(0x1F) + artist;
+}
+
+bool TrackMatcher::durationsAgree(qint64 a, qint64 b) {
+    return a <= 0 || b <= 0 || qAbs(a - b) <= DurationToleranceMs;
+}
+
+double TrackMatcher::albumSimilarity(const QString &a, const QString &b) {
+    if (a == b) return 1.0;
+    const QStringList wordsA = a.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    const QStringList wordsB = b.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    const QSet<QString> setA(wordsA.cbegin(), wordsA.cend());
+    const QSet<QString> setB(wordsB.cbegin(), wordsB.cend());
+    const qsizetype unionSize = QSet<QString>(setA).unite(setB).size();
+    return unionSize > 0 ? double(QSet<QString>(setA).intersect(setB).size()) / unionSize : 0.0;
+}
+
+//=============================================================================
+// FUNCTION: Builds the hash indices over the local library
+//=============================================================================
+void TrackMatcher::build(const QList<QVariantMap> &localTracks) {
+    QElapsedTimer timer;
+    timer.start();
+    clear();
+    m_tracks.reserve(localTracks.size());
+    m_byKey.reserve(localTracks.size() * 2);
+
+    for (int i = 0; i < localTracks.size(); ++i) {
+        const QVariantMap &track = localTracks.at(i);
+        LocalTrack local;
+        local.filePath = track.value("filePath").toString();
+        local.album = normalizeText(track.value("album").toString());
+        local.durationMs = track.value("duration").toLongLong();
+        m_tracks.append(local);
+
+        const QString isrc = track.value("isrc").toString().trimmed().toUpper();
+        if (!isrc.isEmpty() && !m_byIsrc.contains(isrc)) m_byIsrc.insert(isrc, i);
+
+        const QString title = normalizeTitle(track.value("title").toString());
+        if (title.isEmpty()) continue;
+        for (const QString &artist : normalizeArtists(track.value("artist").toString())) {
+            m_byKey.insert(joinKey(title, artist), i);
+        }
+    }
+    qDebug() << "[TrackMatcher] Indexed" << m_tracks.size() << "local tracks," << m_byIsrc.size() << "with ISRC, in"
+             << timer.elapsed() << "ms";
+}
+
+void TrackMatcher::clear() {
+    m_tracks.clear();
+    m_byIsrc.clear();
+    m_byKey.clear();
+}
+
+//=============================================================================
+// FUNCTION: Resolves one Spotify track
+//=============================================================================
+TrackMatcher::Match TrackMatcher::match(const QVariantMap &spotifyTrack) const {
+    const QString isrc = spotifyTrack.value("isrc").toString().trimmed().toUpper();
+    if (!isrc.isEmpty()) {
+        const auto it = m_byIsrc.constFind(isrc);
+        if (it != m_byIsrc.cend()) return {it.value(), Method::Isrc};
+    }
+
+    const QString title = normalizeTitle(spotifyTrack.value("title").toString());
+    if (title.isEmpty()) return {};
+    const qint64 durationMs = spotifyTrack.value("duration").toLongLong();
+
+    QList<int> candidates;
+    for (const QString &artist : normalizeArtists(spotifyTrack.value("artist").toString())) {
+        auto [it, end] = m_byKey.equal_range(joinKey(title, artist));
+        for (; it != end; ++it) {
+            if (!candidates.contains(*it) && durationsAgree(durationMs, m_tracks.at(*it).durationMs)) {
+                candidates.append(*it);
+            }
+        }
+    }
+    if (candidates.isEmpty()) return {};
+    if (candidates.size() == 1) return {candidates.first(), Method::Exact};
+
+    // Collision (same song on several albums/compilations): closest album, then duration
+    const QString album = normalizeText(spotifyTrack.value("album").toString());
+    int best = -1;
+    double bestScore = 0.0;
+    for (int index : std::as_const(candidates)) {
+        const LocalTrack &local = m_tracks.at(index);
+        const double durationPenalty =
+            durationMs > 0 && local.durationMs > 0 ? qAbs(durationMs - local.durationMs) / double(DurationToleranceMs) : 0.5;
+        const double score = 2.0 * albumSimilarity(album, local.album) - durationPenalty;
+        if (best < 0 || score > bestScore) {
+            best = index;
+            bestScore = score;
+        }
+    }
+    return {best, Method::Fuzzy};
+}
+
+QVariantList TrackMatcher::resolve(const QVariantList &spotifyTracks, int *matchedCount) const {
+    QVariantList resolved;
+    resolved.reserve(spotifyTracks.size());
+    int matched = 0;
+    for (const QVariant &value : spotifyTracks) {
+        QVariantMap track = value.toMap();
+        const Match m = match(track);
+        if (m.isValid()) {
+            // Play the local file; the Spotify ids stay for syncing back
+            track.insert("filePath", m_tracks.at(m.localIndex).filePath);
+            track.insert("source", "local");
+            track.insert("matchedBy", m.method == Method::Isrc ? "isrc" : m.method == Method::Exact ? "exact" : "fuzzy");
+            ++matched;
+        } else {
+            track.insert("source", "spotify"); // shown with the Spotify placeholder in the track list
+        }
+        resolved.append(track);
+    }
+    if (matchedCount) *matchedCount = matched;
+    return resolved;
+}
@@ -0,0 +1,330 @@
+// WaveformCache.cpp
+#include "WaveformCache.h"
+#include "PcmDecoder.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPainter>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+constexpr quint32 CacheMagic = 0x4C574631; // "LWF1"
+constexpr qint32 CacheVersion = 1;
+constexpr int MaxWorkers = 2;          // one slot is always left free for the playing/next track
+constexpr int MaxIdleWorkers = 1;
+constexpr int SaveDelayMs = 5000;
+
+struct BucketStats {
+    float min;
+    float max;
+    float sumSquares;
+};
+
+// Lane-split reduction: each lane only depends on itself, so the inner loop
+// vectorizes without needing -ffast-math to reassociate the float math.
+BucketStats reduceRange(const float *data, size_t count) {
+    constexpr int Lanes = 8;
+    float mins[Lanes], maxs[Lanes], sums[Lanes];
+    for (int l = 0; l < Lanes; ++l) {
+        mins[l] = std::numeric_limits<float>::max();
+        maxs[l] = std::numeric_limits<float>::lowest();
+        sums[l] = 0.0f;
+    }
+    size_t i = 0;
+    for (; i + Lanes <= count; i += Lanes) {
+        for (int l = 0; l < Lanes; ++l) {
+            const float v = data[i + l];
+            mins[l] = v < mins[l] ? v : mins[l];
+            maxs[l] = v > maxs[l] ? v : maxs[l];
+            sums[l] += v * v;
+        }
+    }
+    for (; i < count; ++i) {
+        const float v = data[i];
+        mins[0] = std::min(mins[0], v);
+        maxs[0] = std::max(maxs[0], v);
+        sums[0] += v * v;
+    }
+    BucketStats stats{mins[0], maxs[0], sums[0]};
+    for (int l = 1; l < Lanes; ++l) {
+        stats.min = std::min(stats.min, mins[l]);
+        stats.max = std::max(stats.max, maxs[l]);
+        stats.sumSquares += sums[l];
+    }
+    if (count == 0) stats = {0.0f, 0.0f, 0.0f};
+    return stats;
+}
+
+qint8 packSigned(float v) { return static_cast<qint8>(std::lround(std::clamp(v, -1.0f, 1.0f) * 127.0f)); }
+quint8 packUnsigned(float v) { return static_cast<quint8>(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f)); }
+}
+
+//=============================================================================
+// Constructor / Destructor
+//=============================================================================
+WaveformCache::WaveformCache(QObject *parent) : QObject(parent) {
+    m_pool.setMaxThreadCount(MaxWorkers);
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(SaveDelayMs);
+    connect(&m_saveTimer, &QTimer::timeout, this, &WaveformCache::saveCacheFile);
+    loadCacheFile();
+}
+
+WaveformCache::~WaveformCache() {
+    m_cancel = true;
+    m_pool.clear();
+    m_pool.waitForDone();
+    saveCacheFile();
+}
+
+//=============================================================================
+// Lookups (any thread)
+//=============================================================================
+QString WaveformCache::imageIdFor(const QString &filePath) {
+    return QString::fromLatin1(QCryptographicHash::hash(filePath.toUtf8(), QCryptographicHash::Md5).toHex());
+}
+
+QByteArray WaveformCache::summaryForImageId(const QString &imageId) const {
+    QMutexLocker locker(&m_entriesMutex);
+    const QString filePath = m_imageIds.value(imageId);
+    return filePath.isEmpty() ? QByteArray() : m_entries.value(filePath).packed;
+}
+
+QString WaveformCache::sourceFor(const QString &filePath) const {
+    QMutexLocker locker(&m_entriesMutex);
+    auto it = m_entries.constFind(filePath);
+    if (it == m_entries.constEnd() || it->packed.isEmpty()) return QString();
+    return QStringLiteral("image://waveform/") + imageIdFor(filePath);
+}
+
+qint64 WaveformCache::memoryUsage() const {
+    QMutexLocker locker(&m_entriesMutex);
+    qint64 bytes = 0;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        bytes += qint64(sizeof(Entry)) + 2 * it.key().size() + it->packed.size();
+    }
+    for (auto it = m_imageIds.cbegin(); it != m_imageIds.cend(); ++it) bytes += 2 * it.key().size() + qint64(sizeof(QString));
+    return bytes;
+}
+
+bool WaveformCache::hasEntry(const QString &filePath) const {
+    QMutexLocker locker(&m_entriesMutex);
+    return m_entries.contains(filePath);
+}
+
+bool WaveformCache::isFresh(const QString &filePath) const {
+    QFileInfo info(filePath);
+    QMutexLocker locker(&m_entriesMutex);
+    auto it = m_entries.constFind(filePath);
+    return it != m_entries.constEnd()
+           && it->size == info.size()
+           && it->modified == info.lastModified().toMSecsSinceEpoch();
+}
+
+//=============================================================================
+// SLOT: Queues every local track of the library at idle priority
+//=============================================================================
+void WaveformCache::enqueueTracks(const QVariantList &tracks) {
+    for (const QVariant &track : tracks) {
+        const QVariantMap map = track.toMap();
+        if (map.value("source").toString() != "local") continue;
+        request(map.value("filePath").toString(), Idle);
+    }
+    startJobs();
+}
+
+//=============================================================================
+// FUNCTION: Moves the playing and next tracks to the front of the queue
+//=============================================================================
+void WaveformCache::prioritize(const QString &currentPath, const QString &nextPath) {
+    // Whatever was urgent before falls back to the idle queue
+    for (const QString &path : std::as_const(m_urgentQueue)) request(path, Idle);
+    m_urgentQueue.clear();
+    request(currentPath, Current);
+    request(nextPath, Next);
+    startJobs();
+}
+
+void WaveformCache::request(const QString &filePath, Priority priority) {
+    if (filePath.isEmpty() || m_running.contains(filePath)) return;
+    if (priority == Idle) {
+        if (m_idleQueued.contains(filePath) || hasEntry(filePath)) return;
+        m_idleQueue.enqueue(filePath);
+        m_idleQueued.insert(filePath);
+        return;
+    }
+    if (isFresh(filePath) || m_urgentQueue.contains(filePath)) return;
+    if (priority == Current) {
+        m_urgentQueue.prepend(filePath);
+    } else {
+        m_urgentQueue.append(filePath);
+    }
+}
+
+void WaveformCache::startJobs() {
+    while (m_running.size() < m_pool.maxThreadCount()) {
+        QString filePath;
+        bool idleJob = false;
+        if (!m_urgentQueue.isEmpty()) {
+            filePath = m_urgentQueue.takeFirst();
+        } else if (!m_idleQueue.isEmpty() && m_runningIdleJobs < MaxIdleWorkers) {
+            filePath = m_idleQueue.dequeue();
+            m_idleQueued.remove(filePath);
+            if (hasEntry(filePath)) continue; // finished as an urgent job meanwhile
+            idleJob = true;
+        } else {
+            break;
+        }
+        if (m_running.contains(filePath)) continue;
+
+        m_running.insert(filePath);
+        if (idleJob) ++m_runningIdleJobs;
+        m_pool.start([this, filePath, idleJob]() {
+            if (idleJob) QThread::currentThread()->setPriority(QThread::IdlePriority);
+            const Entry entry = computeEntry(filePath, &m_cancel);
+            if (idleJob) QThread::currentThread()->setPriority(QThread::NormalPriority);
+            QMetaObject::invokeMethod(this, [this, filePath, entry, idleJob]() {
+                handleJobFinished(filePath, entry, idleJob);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void WaveformCache::handleJobFinished(const QString &filePath, const Entry &entry, bool idleJob) {
+    m_running.remove(filePath);
+    if (idleJob) --m_runningIdleJobs;
+    if (!m_cancel) {
+        // Failed decodes are stored too (empty summary) so they are not retried every scan
+        {
+            QMutexLocker locker(&m_entriesMutex);
+            m_entries.insert(filePath, entry);
+            m_imageIds.insert(imageIdFor(filePath), filePath);
+        }
+        m_saveTimer.start();
+        if (!entry.packed.isEmpty()) emit waveformReady(filePath);
+    }
+    startJobs();
+}
+
+//=============================================================================
+// WORKER: Decodes a track and reduces it to BucketCount min/max/RMS triples
+//=============================================================================
+WaveformCache::Entry WaveformCache::computeEntry(const QString &filePath, const std::atomic_bool *cancel) {
+    Entry entry;
+    const QFileInfo info(filePath);
+    entry.size = info.size();
+    entry.modified = info.lastModified().toMSecsSinceEpoch();
+
+    const std::vector<float> samples = PcmDecoder::decodeMono(filePath, AnalysisSampleRate, 0, -1, cancel);
+    if (samples.empty()) return entry;
+
+    entry.packed.resize(BucketCount * 3);
+    char *out = entry.packed.data();
+    const size_t total = samples.size();
+    for (int bucket = 0; bucket < BucketCount; ++bucket) {
+        const size_t begin = total * bucket / BucketCount;
+        const size_t end = total * (bucket + 1) / BucketCount;
+        const BucketStats stats = reduceRange(samples.data() + begin, end - begin);
+        const float rms = end > begin ? std::sqrt(stats.sumSquares / (end - begin)) : 0.0f;
+        out[bucket * 3 + 0] = static_cast<char>(packSigned(stats.min));
+        out[bucket * 3 + 1] = static_cast<char>(packSigned(stats.max));
+        out[bucket * 3 + 2] = static_cast<char>(packUnsigned(rms));
+    }
+    return entry;
+}
+
+//=============================================================================
+// Cache file persistence
+//=============================================================================
+QString WaveformCache::cacheFilePath() const {
+    QString base = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(base);
+    return base + "/waveforms.cache";
+}
+
+void WaveformCache::loadCacheFile() {
+    QFile file(cacheFilePath());
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != CacheMagic || version != CacheVersion || count < 0) {
+        qWarning() << "[WaveformCache] Ignoring incompatible cache file:" << file.fileName();
+        return;
+    }
+
+    QMutexLocker locker(&m_entriesMutex);
+    m_entries.reserve(count);
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString filePath;
+        Entry entry;
+        in >> filePath >> entry.size >> entry.modified >> entry.packed;
+        m_entries.insert(filePath, entry);
+        m_imageIds.insert(imageIdFor(filePath), filePath);
+    }
+    qDebug() << "[WaveformCache] Loaded" << m_entries.size() << "cached waveforms.";
+}
+
+void WaveformCache::saveCacheFile() {
+    QHash<QString, Entry> snapshot;
+    {
+        QMutexLocker locker(&m_entriesMutex);
+        snapshot = m_entries;
+    }
+
+    QSaveFile file(cacheFilePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[WaveformCache] Failed to write cache file:" << file.fileName();
+        return;
+    }
+    QDataStream out(&file);
+    out << CacheMagic << CacheVersion << static_cast<qint32>(snapshot.size());
+    for (auto it = snapshot.cbegin(); it != snapshot.cend(); ++it) {
+        out << it.key() << it->size << it->modified << it->packed;
+    }
+    file.commit();
+}
+
+//=============================================================================
+// Image provider
+//=============================================================================
+WaveformImageProvider::WaveformImageProvider(const WaveformCache *cache)
+    : QQuickImageProvider(QQuickImageProvider::Image), m_cache(cache) {}
+
+QImage WaveformImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize) {
+    const int width = requestedSize.width() > 0 ? requestedSize.width() : WaveformCache::BucketCount * 2;
+    const int height = requestedSize.height() > 0 ? requestedSize.height() : 32;
+    if (size) *size = QSize(width, height);
+
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    const QByteArray packed = m_cache->summaryForImageId(id);
+    if (packed.size() != WaveformCache::BucketCount * 3) return image;
+
+    QPainter painter(&image);
+    const qreal mid = height / 2.0;
+    const QColor peakColor(255, 255, 255, 90);
+    const QColor rmsColor(255, 255, 255, 170);
+    for (int x = 0; x < width; ++x) {
+        const int bucket = x * WaveformCache::BucketCount / width;
+        const float minValue = static_cast<qint8>(packed[bucket * 3 + 0]) / 127.0f;
+        const float maxValue = static_cast<qint8>(packed[bucket * 3 + 1]) / 127.0f;
+        const float rmsValue = static_cast<quint8>(packed[bucket * 3 + 2]) / 255.0f;
+        painter.fillRect(QRectF(x, mid - maxValue * mid, 1, qMax<qreal>(1.0, (maxValue - minValue) * mid)), peakColor);
+        painter.fillRect(QRectF(x, mid - rmsValue * mid, 1, qMax<qreal>(1.0, 2 * rmsValue * mid)), rmsColor);
+    }
+    return image;
+}
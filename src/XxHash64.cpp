@@ -0,0 +1,131 @@
+// XxHash64.cpp
+#include "XxHash64.h"
+
+#include <cstring>
+
+namespace {
+constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t Prime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+// Little-endian loads regardless of host order (memcpy compiles to a plain load)
+inline uint64_t read64(const unsigned char *p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+inline uint32_t read32(const unsigned char *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input) {
+    acc += input * Prime2;
+    acc = rotl(acc, 31);
+    return acc * Prime1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t value) {
+    acc ^= round(0, value);
+    return acc * Prime1 + Prime4;
+}
+}
+
+XxHash64::XxHash64(uint64_t seed) { reset(seed); }
+
+void XxHash64::reset(uint64_t seed) {
+    m_seed = seed;
+    m_acc[0] = seed + Prime1 + Prime2;
+    m_acc[1] = seed + Prime2;
+    m_acc[2] = seed;
+    m_acc[3] = seed - Prime1;
+    m_totalLength = 0;
+    m_bufferSize = 0;
+}
+
+void XxHash64::update(const void *data, size_t length) {
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    const unsigned char *const end = p + length;
+    m_totalLength += length;
+
+    if (m_bufferSize + length < sizeof(m_buffer)) {
+        std::memcpy(m_buffer + m_bufferSize, p, length);
+        m_bufferSize += length;
+        return;
+    }
+    if (m_bufferSize > 0) {
+        const size_t fill = sizeof(m_buffer) - m_bufferSize;
+        std::memcpy(m_buffer + m_bufferSize, p, fill);
+        p += fill;
+        for (int lane = 0; lane < 4; ++lane) m_acc[lane] = round(m_acc[lane], read64(m_buffer + lane * 8));
+        m_bufferSize = 0;
+    }
+
+    // Hot loop: four independent lanes per 32-byte stripe
+    uint64_t a0 = m_acc[0], a1 = m_acc[1], a2 = m_acc[2], a3 = m_acc[3];
+    while (p + 32 <= end) {
+        a0 = round(a0, read64(p));
+        a1 = round(a1, read64(p + 8));
+        a2 = round(a2, read64(p + 16));
+        a3 = round(a3, read64(p + 24));
+        p += 32;
+    }
+    m_acc[0] = a0; m_acc[1] = a1; m_acc[2] = a2; m_acc[3] = a3;
+
+    m_bufferSize = static_cast<size_t>(end - p);
+    std::memcpy(m_buffer, p, m_bufferSize);
+}
+
+uint64_t XxHash64::digest() const {
+    uint64_t h;
+    if (m_totalLength >= 32) {
+        h = rotl(m_acc[0], 1) + rotl(m_acc[1], 7) + rotl(m_acc[2], 12) + rotl(m_acc[3], 18);
+        for (int lane = 0; lane < 4; ++lane) h = mergeRound(h, m_acc[lane]);
+    } else {
+        h = m_seed + Prime5;
+    }
+    h += m_totalLength;
+
+    const unsigned char *p = m_buffer;
+    const unsigned char *const end = m_buffer + m_bufferSize;
+    while (p + 8 <= end) {
+        h ^= round(0, read64(p));
+        h = rotl(h, 27) * Prime1 + Prime4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * Prime1;
+        h = rotl(h, 23) * Prime2 + Prime3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= static_cast<uint64_t>(*p) * Prime5;
+        h = rotl(h, 11) * Prime1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= Prime2;
+    h ^= h >> 29;
+    h *= Prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t XxHash64::hash(const void *data, size_t length, uint64_t seed) {
+    XxHash64 state(seed);
+    state.update(data, length);
+    return state.digest();
+}
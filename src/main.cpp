@@ -7,6 +7,15 @@
 #include "TrackListModel.h"
 #include "PlaybackManager.h"
 #include "PlaylistManager.h"
+#include "SpectrumAnalyzer.h"
+#include "SpectrumView.h"
+#include "WaveformCache.h"
+#include "ThumbnailCache.h"
+#include "DiagnosticsMonitor.h"
+#include "FrameTimeMonitor.h"
+#include "MetricsRegistry.h"
+#include "StartupProfiler.h"
+#include "Trace.h"
 #include <QUrl>
 #include <QDebug>
 #include <QFile>
@@ -17,20 +26,29 @@
 #include <QIcon>
 #include <QQuickStyle>
 #include <QFontDatabase>
+#include <QQuickWindow>
+#include <QtConcurrent>
 
 int main(int argc, char *argv[])
 {
+    // Startup is staged around the first frame (StartupProfiler::BudgetMs): only what the
+    // window needs to appear runs before it; playlists, the library index and fonts follow.
     QApplication app(argc, argv);
 
 	QCoreApplication::setOrganizationName("Librify");
     QCoreApplication::setApplicationName("Librify");
-	
-    QString base = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/playlists";
-	qDebug() << base;
+    Trace::installFromEnvironment(); // LIBRIFY_TRACE=<file>
+
+    // Font bytes are read in the background and registered after the first frame
+    QFuture<QByteArray> fontData = QtConcurrent::run([]() {
+        QFile fontFile(":/fonts/yeezy_tstar-bold-webfont.ttf");
+        return fontFile.open(QIODevice::ReadOnly) ? fontFile.readAll() : QByteArray();
+    });
 
     app.setWindowIcon(QIcon(":/icons/batRubyRed2.png"));
 
     QQuickStyle::setStyle("Basic");
+    StartupProfiler::mark("application");
 
     AuthServer authServer;
     SpotifyManager spotifyManager;
@@ -38,11 +56,19 @@ int main(int argc, char *argv[])
     TrackListModel trackListModel;
     PlaybackManager playbackManager;
 	PlaylistManager playlistManager;
+    SpectrumAnalyzer spectrumAnalyzer;
+    WaveformCache waveformCache;
+    DiagnosticsMonitor diagnosticsMonitor;
+    FrameTimeMonitor frameTimeMonitor;
+    ThumbnailCache thumbnailCache;
+    thumbnailCache.setLibraryIndex(&localMusicManager.libraryIndex());
+    StartupProfiler::mark("managers");
 
 	// Ensures enum can be used in Main.qml and TrackListPane.qml
 	qmlRegisterUncreatableType<TrackListModel>(
     "com.librify", 1, 0, "TrackListModel",
     "Enums are only used for accessing constants");
+	qmlRegisterType<SpectrumView>("com.librify", 1, 0, "SpectrumView");
 
     // --- Connect Signals/Slots ---
     qDebug() << "[main] requestAccessToken => authorizationCodeReceived: Connected";
@@ -54,7 +80,36 @@ int main(int argc, char *argv[])
     qDebug() << "[main] trackUpdated => updateTracks: Connected";
     QObject::connect(&localMusicManager, &LocalMusicManager::trackUpdated,
                      &trackListModel, &TrackListModel::updateTrack);
+    qDebug() << "[main] tracksPatched => patchTracks: Connected";
+    QObject::connect(&localMusicManager, &LocalMusicManager::tracksPatched,
+                     &trackListModel, &TrackListModel::patchTracks);
+    qDebug() << "[main] libraryPathsMoved => remapTrackPaths: Connected";
+    QObject::connect(&localMusicManager, &LocalMusicManager::libraryPathsMoved,
+                     &playlistManager, &PlaylistManager::remapTrackPaths);
+    qDebug() << "[main] tracksFetched => resolveSpotifyTracks => updateTracks: Connected";
+    QObject::connect(&spotifyManager, &SpotifyManager::tracksFetched, &trackListModel,
+                     [&localMusicManager, &trackListModel](const QVariantList &tracks) {
+                         // Local copies play instead of Spotify where the library has the track
+                         trackListModel.updateTracks(localMusicManager.resolveSpotifyTracks(tracks));
+                     });
+    authServer.setPlaybackManager(&playbackManager);
+    authServer.setLocalMusicManager(&localMusicManager);
+    qDebug() << "[main] tracksReadyForDisplay => enqueueTracks: Connected";
+    QObject::connect(&localMusicManager, &LocalMusicManager::tracksReadyForDisplay,
+                     &waveformCache, &WaveformCache::enqueueTracks);
+    qDebug() << "[main] scanStateChanged => prepareAll: Connected";
+    QObject::connect(&localMusicManager, &LocalMusicManager::scanStateChanged,
+                     &thumbnailCache, [&thumbnailCache](bool scanning) {
+                         if (!scanning) thumbnailCache.prepareAll();
+                     });
+    // Memory per subsystem for the diagnostics pane and /metrics
+    MetricsRegistry::addMemoryProbe("library", [&localMusicManager]() { return localMusicManager.libraryMemoryUsage(); });
+    MetricsRegistry::addMemoryProbe("libraryIndex", [&localMusicManager]() { return localMusicManager.indexMemoryUsage(); });
+    MetricsRegistry::addMemoryProbe("trackList", [&trackListModel]() { return trackListModel.memoryUsage(); });
+    MetricsRegistry::addMemoryProbe("waveforms", [&waveformCache]() { return waveformCache.memoryUsage(); });
+    MetricsRegistry::addMemoryProbe("thumbnails", [&thumbnailCache]() { return thumbnailCache.memoryUsage(); });
     // ---------------------------
+    StartupProfiler::mark("connections");
 
     QQmlApplicationEngine engine;
 
@@ -64,6 +119,12 @@ int main(int argc, char *argv[])
     engine.rootContext()->setContextProperty("cppTrackModel", &trackListModel);
     engine.rootContext()->setContextProperty("cppPlaybackManager", &playbackManager);
 	engine.rootContext()->setContextProperty("cppPlaylistManager", &playlistManager);
+    engine.rootContext()->setContextProperty("cppSpectrumAnalyzer", &spectrumAnalyzer);
+    engine.rootContext()->setContextProperty("cppWaveformCache", &waveformCache);
+    engine.rootContext()->setContextProperty("cppDiagnostics", &diagnosticsMonitor);
+    engine.rootContext()->setContextProperty("cppFrameMonitor", &frameTimeMonitor);
+    engine.addImageProvider("waveform", new WaveformImageProvider(&waveformCache));
+    engine.addImageProvider("covers", new CoverImageProvider(&thumbnailCache));
 
     // --- Load QML ---
     const QUrl url(QStringLiteral("qrc:/Main.qml"));
@@ -73,17 +134,7 @@ int main(int argc, char *argv[])
         return -1;
     }
 
-    // --- Load fonts ---
-    int fontId = QFontDatabase::addApplicationFont(":/fonts/yeezy_tstar-bold-webfont.ttf");
-    QStringList fontFamilies = QFontDatabase::applicationFontFamilies(fontId);
-    if (!fontFamilies.isEmpty()) {
-        QFont defaultFont(fontFamilies.first());
-        app.setFont(defaultFont);
-    } else { // Set a fallback system font if custom font loading fails
-		qDebug() << "[main] error: Failed to load font family: " << fontFamilies;
-        QFont defaultFont("Segoe UI");
-        app.setFont(defaultFont);
-    }
+    StartupProfiler::mark("qmlEngine");
 
     // *** HANDLERS ***
     QObject::connect(&engine, &QQmlApplicationEngine::objectCreated,
@@ -107,15 +158,55 @@ int main(int argc, char *argv[])
                      });
     // ***********************
     // -------------------------------------------------------
-	engine.load(url);
+	engine.load(url); // precompiled by qmlcachegen (qt_add_qml_module)
     if (engine.rootObjects().isEmpty() && !url.isEmpty()) {
         qWarning() << "[main] FATAL: engine.rootObjects() is empty after load() and URL was specified. QML failed to load correctly.";
         return -1;
     }
+    StartupProfiler::mark("qmlLoad");
+
+    // --- Deferred startup: everything the first frame does not need ---
+    const auto startDeferred = [&]() {
+        StartupProfiler::firstFrame();
+
+        const qint64 playlistsStart = Trace::Detail::nowNs();
+        QObject::connect(&playlistManager, &PlaylistManager::playlistsLoaded, &app,
+                         [playlistsStart]() { StartupProfiler::deferred("playlists", playlistsStart); },
+                         Qt::SingleShotConnection);
+        playlistManager.loadPlaylistsAsync();
+
+        const qint64 stateStart = Trace::Detail::nowNs();
+        QObject::connect(&localMusicManager, &LocalMusicManager::stateLoaded, &app,
+                         [stateStart]() { StartupProfiler::deferred("libraryIndex", stateStart); },
+                         Qt::SingleShotConnection);
+        localMusicManager.loadStateAsync();
+
+        // --- Load fonts ---
+        const qint64 fontsStart = Trace::Detail::nowNs();
+        const int fontId = QFontDatabase::addApplicationFontFromData(fontData.result());
+        const QStringList fontFamilies = QFontDatabase::applicationFontFamilies(fontId);
+        if (!fontFamilies.isEmpty()) {
+            app.setFont(QFont(fontFamilies.first()));
+        } else { // Set a fallback system font if custom font loading fails
+            qDebug() << "[main] error: Failed to load font family: " << fontFamilies;
+            app.setFont(QFont("Segoe UI"));
+        }
+        StartupProfiler::deferred("fonts", fontsStart);
+
+        // --- Local HTTP endpoint: OAuth callback, remote control, /metrics ---
+        qDebug() << "[main] Starting auth server...";
+        authServer.start();
+    };
+    // frameSwapped comes from the render thread; queue it to the GUI thread, once
+    if (auto *window = qobject_cast<QQuickWindow *>(engine.rootObjects().first())) {
+        frameTimeMonitor.attach(window);
+        QObject::connect(window, &QQuickWindow::frameSwapped, &app, startDeferred,
+                         Qt::ConnectionType(Qt::QueuedConnection | Qt::SingleShotConnection));
+    } else {
+        QTimer::singleShot(0, &app, startDeferred);
+    }
 
     // --- Auto-Authenticate ---
-    // qDebug() << "[main] Starting auth server...";
-    // authServer.start();
     // qDebug() << "[main] Scheduling auto-authentication...";
     // QTimer::singleShot(500, &spotifyManager, &SpotifyManager::authenticate);
 
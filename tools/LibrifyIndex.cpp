@@ -0,0 +1,123 @@
+// LibrifyIndex.cpp
+//
+// librify-index: builds the library index (tags, covers, file identities and
+// optionally audio hashes) without the GUI, so clients start from a warm
+// index instead of a cold scan. Typically run nightly on the file server:
+//
+//   librify-index -o /srv/music/.librify/library.index --map-prefix /srv/music=/mnt/music /srv/music
+//
+// Clients copy (or point their AppDataLocation at) the written file; only
+// files changed since the last run are read again on their next scan.
+//
+// `librify-index --probe` is the isolated tag reader the scan uses for risky
+// files (see TagProbe): paths on stdin, serialized tags on stdout.
+
+#include "DuplicateDetector.h"
+#include "LibraryIndex.h"
+#include "LibraryScanner.h"
+#include "ScanQuarantine.h"
+#include "TagProbe.h"
+#include "Trace.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QTextStream>
+#include <QThreadPool>
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    // Same names as the app, so the default output is the file the app loads on startup
+    QCoreApplication::setOrganizationName("Librify");
+    QCoreApplication::setApplicationName("Librify");
+    Trace::installFromEnvironment(); // LIBRIFY_TRACE=<file>
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Scans music folders and writes the Librify library index.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("roots", "Folders to scan.", "<root>...");
+    QCommandLineOption outputOption({"o", "output"}, "Index file to update (default: this user's Librify index).", "file");
+    QCommandLineOption jobsOption({"j", "jobs"}, "Worker threads (default: all cores).", "n");
+    QCommandLineOption mapOption("map-prefix", "Store paths under <from> as <to>, for clients that mount the roots elsewhere.", "from=to");
+    QCommandLineOption hashOption("hash-audio", "Also hash audio payloads so duplicate detection starts warm.");
+    QCommandLineOption verboseOption({"v", "verbose"}, "Print debug logging.");
+    QCommandLineOption probeOption("probe", "Run as the isolated tag reader of a scan (paths on stdin).");
+    parser.addOptions({outputOption, jobsOption, mapOption, hashOption, verboseOption, probeOption});
+    parser.process(app);
+
+    if (!parser.isSet(verboseOption)) QLoggingCategory::setFilterRules("*.debug=false");
+    if (parser.isSet(probeOption)) return TagProbe::serve(); // stdout carries the answers only
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QStringList roots;
+    for (const QString &root : parser.positionalArguments()) {
+        const QFileInfo info(root);
+        if (!info.isDir()) {
+            err << "Not a folder: " << root << Qt::endl;
+            return 1;
+        }
+        roots.append(info.absoluteFilePath());
+    }
+    if (roots.isEmpty()) parser.showHelp(1);
+
+    QString fromPrefix, toPrefix;
+    if (parser.isSet(mapOption)) {
+        const QString mapping = parser.value(mapOption);
+        const qsizetype separator = mapping.indexOf('=');
+        if (separator <= 0) {
+            err << "--map-prefix expects <from>=<to>" << Qt::endl;
+            return 1;
+        }
+        fromPrefix = mapping.left(separator);
+        toPrefix = mapping.mid(separator + 1);
+    }
+    if (parser.isSet(jobsOption)) {
+        QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, parser.value(jobsOption).toInt()));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    LibraryIndex index;
+    if (parser.isSet(outputOption)) index.setFilePath(QFileInfo(parser.value(outputOption)).absoluteFilePath());
+    index.load();
+    // The file holds client paths; scan against local ones and map back before saving
+    if (!fromPrefix.isEmpty()) index.rebase(toPrefix, fromPrefix);
+
+    ScanQuarantine quarantine;
+    quarantine.load();
+    const LibraryScanResults results = LibraryScanner(&index, &quarantine).scan(roots);
+    QSet<QString> livePaths;
+    livePaths.reserve(results.cachedTracks.size());
+    for (const QVariantMap &track : results.cachedTracks) livePaths.insert(track.value("filePath").toString());
+    index.prune(livePaths);
+
+    int duplicateGroups = 0;
+    if (parser.isSet(hashOption)) {
+        QList<DuplicateDetector::Track> tracks;
+        tracks.reserve(results.cachedTracks.size());
+        for (int i = 0; i < results.cachedTracks.size(); ++i) {
+            const QVariantMap &track = results.cachedTracks.at(i);
+            tracks.append({i, track.value("filePath").toString(), track.value("title").toString(),
+                           track.value("duration").toLongLong()});
+        }
+        duplicateGroups = DuplicateDetector::findDuplicates(tracks, &index).size();
+    }
+
+    if (!fromPrefix.isEmpty()) index.rebase(fromPrefix, toPrefix);
+    if (!index.save()) {
+        err << "Failed to write " << index.filePath() << Qt::endl;
+        return 2;
+    }
+
+    out << "Indexed " << results.cachedTracks.size() << " tracks (" << results.readTags << " read, "
+        << results.reusedTags << " reused, " << results.movedPaths.size() << " moved, "
+        << results.isolatedReads << " isolated, " << results.quarantined << " quarantined) with "
+        << QThreadPool::globalInstance()->maxThreadCount() << " threads in " << timer.elapsed() << " ms" << Qt::endl;
+    if (parser.isSet(hashOption)) out << duplicateGroups << " duplicate groups" << Qt::endl;
+    out << "Wrote " << index.size() << " records to " << QDir::toNativeSeparators(index.filePath()) << Qt::endl;
+    return 0;
+}